@@ -2,6 +2,7 @@
 
 
 #include "BlockDataClient.h"
+#include "UbermundoBlockSwarm.h"
 #include "GameFramework/Actor.h"
 #include "Misc/DefaultValueHelper.h"
 #include "AssetRegistryModule.h"
@@ -102,8 +103,60 @@ void UBlockDataClient::RequestShareBlockBinary(FString blockPathAndName, int64&
 #endif
 }
 
+void UBlockDataClient::RequestShareBlockFromPeers(FString blockName, int64 ownerSteamId, const TArray<int64>& peers, int64& requestHandle, bool& success) {
+	requestHandle = -1;
+	success = false;
+
+	UE_LOG(ShareAssetIOCategory, Verbose, TEXT("RequestShareBlockFromPeers %s owner 0x%llX, %d peers"), *blockName, ownerSteamId, peers.Num());
+	UShareGetBlockState* s = NewObject<UShareGetBlockState>();
+	s->status = SharedRequestStatus::Pending;
+	s->share_obj_type = ShareObjectTypes::share_read_block_state_binary;
+	outstanding_requests.Add(s->requestHandle, s);
+
+	TArray<uint64> peerIds;
+	for (int64 p : peers)
+		peerIds.Add((uint64)p);
+	if (!FUbermundoBlockSwarm::Get().Fetch(s->requestHandle, blockName, (uint64)ownerSteamId, peerIds)) {
+		s->status = SharedRequestStatus::Failed;
+		s->fail_reason = "No owner, or already fetching this block.";
+		UE_LOG(ShareAssetIOCategory, Error, TEXT("RequestShareBlockFromPeers %s - %s"), *blockName, *(s->fail_reason));
+	}
+	// The request may already be done, if we had the block.
+	requestHandle = s->requestHandle;
+	success = s->status != SharedRequestStatus::Failed;
+}
+
+void UBlockDataClient::OfferShareBlock(FString blockName, const TArray<uint8>& contents) {
+	FUbermundoBlockSwarm::Get().Offer(blockName, contents);
+}
+
+void UBlockDataClient::GetShareBlockFetchProgress(int64 requestHandle, float& progress, int32& numSources, bool& success) {
+	success = FUbermundoBlockSwarm::Get().GetProgress(requestHandle, progress, numSources);
+	if (!success && outstanding_requests.Contains(requestHandle) && outstanding_requests[requestHandle]->status == SharedRequestStatus::Success)
+		progress = 1.0f;
+}
+
+void UBlockDataClient::OnPeerFetchDone(int64 requestHandle, const TArray<uint8>& contents, bool ok, const FString& failReason) {
+	if (!outstanding_requests.Contains(requestHandle)) {
+		return;
+	}
+	UShareGetBlockState* s = (UShareGetBlockState*)outstanding_requests[requestHandle];
+	if (!ok) {
+		s->status = SharedRequestStatus::Failed;
+		s->fail_reason = failReason;
+		return;
+	}
+	s->blockStateBinary = (int8*)malloc(contents.Num() + 1);
+	s->blockSize = contents.Num();
+	memcpy(s->blockStateBinary, contents.GetData(), contents.Num());
+	s->blockStateBinary[contents.Num()] = '\0';
+	s->status = SharedRequestStatus::Success;
+	UE_LOG(ShareAssetIOCategory, Verbose, TEXT("RequestShareBlockFromPeers (handle is %ld) OK, %d bytes"), requestHandle, contents.Num());
+}
+
 void UBlockDataClient::CancelShareBlockRequest(int64 requestHandle, bool& success) {
 	success = false;
+	FUbermundoBlockSwarm::Get().Cancel(requestHandle);
 	if (outstanding_requests.Contains(requestHandle)) {
 		outstanding_requests.Remove(requestHandle);
 		success = true;
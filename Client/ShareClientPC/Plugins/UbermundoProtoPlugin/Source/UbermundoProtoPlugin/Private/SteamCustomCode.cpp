@@ -2,6 +2,19 @@
 
 
 #include "SteamCustomCode.h"
+#include "UbermundoP2POutbox.h"
+#include "UbermundoSteamSocketsTransport.h"
+#include "UbermundoRateControl.h"
+#include "UbermundoNetThread.h"
+#include "UbermundoP2PInbox.h"
+#include "UbermundoFriendsCache.h"
+#include "UbermundoNetTrace.h"
+#include "UbermundoNetStats.h"
+#include "UbermundoNetTick.h"
+#include "UbermundoNetCapture.h"
+#include "UbermundoAvatarCache.h"
+#include "UbermundoImageMessages.h"
+#include "UbermundoVoice.h"
 
 #include "steam/steam_api.h"
 
@@ -14,7 +27,9 @@ ShareSteamCallbackHooks* Ubermundo_p2PSessionRequestCallback;
 ShareSteamCallbackHooks::ShareSteamCallbackHooks()
 	:
 	m_CallbackP2PSessionRequest(this, &ShareSteamCallbackHooks::OnP2PSessionRequest),
-	m_CallbackP2PSessionConnectFail(this, &ShareSteamCallbackHooks::OnP2PSessionConnectFail)
+	m_CallbackP2PSessionConnectFail(this, &ShareSteamCallbackHooks::OnP2PSessionConnectFail),
+	m_CallbackPersonaStateChange(this, &ShareSteamCallbackHooks::OnPersonaStateChange),
+	m_CallbackAvatarImageLoaded(this, &ShareSteamCallbackHooks::OnAvatarImageLoaded)
 {
 }
 
@@ -37,6 +52,16 @@ void ShareSteamCallbackHooks::OnP2PSessionConnectFail(P2PSessionConnectFail_t* r
 	UE_LOG(UberMundoSteamLog, Verbose, TEXT("												// make sure that UDP ports 3478, 4379, and 4380 are open in an outbound direction"));
 }
 
+void ShareSteamCallbackHooks::OnPersonaStateChange(PersonaStateChange_t* change) {
+	FUbermundoFriendsCache::Get().OnPersonaStateChange(change->m_ulSteamID, change->m_nChangeFlags);
+	if ((change->m_nChangeFlags & k_EPersonaChangeAvatar) != 0)
+		FUbermundoAvatarCache::Get().OnAvatarChanged(change->m_ulSteamID);
+}
+
+void ShareSteamCallbackHooks::OnAvatarImageLoaded(AvatarImageLoaded_t* loaded) {
+	FUbermundoAvatarCache::Get().OnAvatarChanged(loaded->m_steamID.ConvertToUint64());
+}
+
 // ---------------------------------------------------------------------- Debug Hook
 extern "C" void SteamAPIDebugTextHook(int nSeverity, const char* pchDebugText)
 {
@@ -52,9 +77,7 @@ bool USteamCustomCode::InitSteam() {
 		return false;
 	}
 
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("Setup P2P Callbacks"));
 	Ubermundo_p2PSessionRequestCallback = new ShareSteamCallbackHooks();
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("Hooking Message Hook"));
 	SteamClient()->SetWarningMessageHook(&SteamAPIDebugTextHook);
 	UE_LOG(UberMundoSteamLog, Warning, TEXT("Steam Init OK"));
 	return true;
@@ -63,35 +86,34 @@ bool USteamCustomCode::InitSteam() {
 bool USteamCustomCode::ShutdownSteam() {
 	UE_LOG(UberMundoSteamLog, Display, TEXT("Stop Steam"));
 	SteamAPI_Shutdown();
+	FUbermundoFriendsCache::Get().Reset();
+	FUbermundoAvatarCache::Get().Reset();
+	FUbermundoImageMessages::Get().Reset();
+	FUbermundoVoice::Get().Reset();
 	return true;
 }
 
 bool USteamCustomCode::IsSteamRunning() {
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("IsSteamRunning"));
 	return SteamAPI_IsSteamRunning();
 }
 
 bool USteamCustomCode::IsLocalSteamID(int64 id, bool ifNoSteam) {
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("GetLocalSteamID"));
 	if (!SteamAPI_IsSteamRunning() || SteamUser() == nullptr) {
 		return ifNoSteam;
 	}
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("GetLocalSteamID 0x%llX"), SteamUser()->GetSteamID().ConvertToUint64());
+	UBERMUNDO_TRACE(LocalId, SteamUser()->GetSteamID().ConvertToUint64(), nullptr, 0, true);
 	return SteamUser()->GetSteamID().ConvertToUint64() == (uint64)id;
 }
 
 TArray<uint8> USteamCustomCode::GetLocalSteamID() {
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("GetLocalSteamID"));
 	if (!SteamAPI_IsSteamRunning() || SteamUser() == nullptr) {
 		return ToBytes(0);
 	}
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("GetLocalSteamID 0x%llX"), SteamUser()->GetSteamID().ConvertToUint64());
+	UBERMUNDO_TRACE(LocalId, SteamUser()->GetSteamID().ConvertToUint64(), nullptr, 0, true);
 	return ToBytes(SteamUser()->GetSteamID().ConvertToUint64());
 }
 
 TArray<uint8> USteamCustomCode::GetLocalSteamIDSafe(UObject* WorldContextObject) {
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("GetLocalSteamIDSafe"));
-
 	if (!WorldContextObject)
 		return ToBytes(0xFF01010100000000ULL);
 
@@ -107,24 +129,21 @@ TArray<uint8> USteamCustomCode::GetLocalSteamIDSafe(UObject* WorldContextObject)
 		if (!SteamAPI_IsSteamRunning() || SteamUser() == nullptr) {
 			return ToBytes(0);
 		}
-		UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("GetLocalSteamIDSafe 0x%llX"), SteamUser()->GetSteamID().ConvertToUint64());
+		UBERMUNDO_TRACE(LocalId, SteamUser()->GetSteamID().ConvertToUint64(), nullptr, 0, true);
 		return ToBytes(SteamUser()->GetSteamID().ConvertToUint64());
 	}
 
 }
 
 int64 USteamCustomCode::GetLocalSteamIDInt64() {
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("GetLocalSteamIDInt64"));
 	if (!SteamAPI_IsSteamRunning() || SteamUser() == nullptr) {
 		return 0;
 	}
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("GetLocalSteamIDInt64 0x%llX"), SteamUser()->GetSteamID().ConvertToUint64());
+	UBERMUNDO_TRACE(LocalId, SteamUser()->GetSteamID().ConvertToUint64(), nullptr, 0, true);
 	return (int64)SteamUser()->GetSteamID().ConvertToUint64();
 }
 
 int64 USteamCustomCode::GetLocalSteamIDSafeInt64(UObject* WorldContextObject) {
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("GetLocalSteamIDSafeInt64"));
-
 	if (!WorldContextObject)
 		return 0xFF01010100000000ULL;
 
@@ -140,7 +159,7 @@ int64 USteamCustomCode::GetLocalSteamIDSafeInt64(UObject* WorldContextObject) {
 		if (!SteamAPI_IsSteamRunning() || SteamUser() == nullptr) {
 			return 0;
 		}
-		UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("GetLocalSteamIDSafeInt64 0x%llX"), SteamUser()->GetSteamID().ConvertToUint64());
+		UBERMUNDO_TRACE(LocalId, SteamUser()->GetSteamID().ConvertToUint64(), nullptr, 0, true);
 		return (int64)SteamUser()->GetSteamID().ConvertToUint64();
 	}
 
@@ -148,116 +167,213 @@ int64 USteamCustomCode::GetLocalSteamIDSafeInt64(UObject* WorldContextObject) {
 
 FString USteamCustomCode::GetRemoteSteamName(int64 steamUserID) {
 	CSteamID id((uint64)steamUserID);
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("GetRemoteSteamName for 0x%llX"), (uint64)steamUserID);
 	if (!SteamAPI_IsSteamRunning() || SteamFriends() == nullptr)
 		return FString();
 	return FString(ANSI_TO_TCHAR(SteamFriends()->GetFriendPersonaName(id)));
 }
 
 FString USteamCustomCode::GetLocalSteamName() {
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("GetLocalSteamName"));
 	if (!SteamAPI_IsSteamRunning() || SteamFriends() == nullptr)
 		return FString();
 	return FString(ANSI_TO_TCHAR(SteamFriends()->GetPersonaName()));
 }
 
 bool USteamCustomCode::Tick() {
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("Tick"));
-	if (SteamAPI_IsSteamRunning()) {
-		UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("SteamAPI_RunCallbacks"));
+	// The network thread, if it is running, does all this itself.
+	if (UUbermundoNetThreadLibrary::IsNetworkThreadRunning())
+		return SteamAPI_IsSteamRunning();
+	FUbermundoGameThreadNetScope timing;
+	GetTransport().Tick(FPlatformTime::Seconds());
+	bool running = SteamAPI_IsSteamRunning();
+	if (running)
 		SteamAPI_RunCallbacks();
-		return true;
-	}
-	return false;
+	UBERMUNDO_TRACE(Tick, 0, nullptr, 0, running);
+	return running;
 }
 
-bool USteamCustomCode::SendP2PPacket_UnreliableNoDelay(int64 targetUserSteamId, TArray<uint8> bytes) {
-	CSteamID id((uint64)targetUserSteamId);
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("SendP2PPacket_UnreliableNoDelay 0x%llX N=%d"), (uint64)targetUserSteamId, bytes.Num());
-	if (!SteamAPI_IsSteamRunning() || SteamNetworking() == nullptr)
-		return false;
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("SendP2PPacket_UnreliableNoDelay 0x%llX N=%d - Sending"), (uint64)targetUserSteamId, bytes.Num());
-	return SteamNetworking()->SendP2PPacket(id, bytes.GetData(), bytes.Num(), EP2PSend::k_EP2PSendUnreliableNoDelay);
+/** The Blueprint sends skip the outbox, but the rate controller still has to know what they cost. */
+static bool SendDirect(int64 targetUserSteamId, const TArray<uint8>& bytes, EUbermundoP2PSendMode mode) {
+	if (bytes.Num() > 0)
+		FUbermundoRateController::Get().OnSent((uint64)targetUserSteamId, bytes.Num(), FUbermundoRateController::ClassOf(bytes[0]));
+	FUbermundoNetStats::Get().OnMessageOut((uint64)targetUserSteamId, bytes.GetData(), bytes.Num());
+	return USteamCustomCode::SendP2P((uint64)targetUserSteamId, bytes.GetData(), (uint32)bytes.Num(), mode);
 }
 
-bool USteamCustomCode::SendP2PPacket_Unreliable(int64 targetUserSteamId, TArray<uint8> bytes) {
-	CSteamID id((uint64)targetUserSteamId);
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("SendP2PPacket_Unreliable 0x%llX N=%d"), (uint64)targetUserSteamId, bytes.Num());
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("SendP2PPacket_ReliableWithBuffered Disected SteamID type 0x%X Universe 0x%X, Instance 0x%X, ID 0x%X"),
-		(int)id.GetEAccountType(), (int)id.GetEUniverse(), (int)id.GetUnAccountInstance(), (int)id.GetAccountID());
-	if (!SteamAPI_IsSteamRunning() || SteamNetworking() == nullptr)
-		return false;
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("SendP2PPacket_Unreliable 0x%llX N=%d - Sending"), (uint64)targetUserSteamId, bytes.Num());
-	return SteamNetworking()->SendP2PPacket(id, bytes.GetData(), bytes.Num(), EP2PSend::k_EP2PSendUnreliable);
+bool USteamCustomCode::SendP2PPacket_UnreliableNoDelay(int64 targetUserSteamId, const TArray<uint8>& bytes) {
+	return SendDirect(targetUserSteamId, bytes, EUbermundoP2PSendMode::UnreliableNoDelay);
 }
 
-bool USteamCustomCode::SendP2PPacket_Reliable(int64 targetUserSteamId, TArray<uint8> bytes) {
-	CSteamID id((uint64)targetUserSteamId);
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("SendP2PPacket_Reliable 0x%llX N=%d"), (uint64)targetUserSteamId, bytes.Num());
-	if (!SteamAPI_IsSteamRunning() || SteamNetworking() == nullptr)
-		return false;
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("SendP2PPacket_Reliable 0x%llX N=%d - Sending"), (uint64)targetUserSteamId, bytes.Num());
-	return SteamNetworking()->SendP2PPacket(id, bytes.GetData(), bytes.Num(), EP2PSend::k_EP2PSendReliable);
+bool USteamCustomCode::SendP2PPacket_Unreliable(int64 targetUserSteamId, const TArray<uint8>& bytes) {
+	return SendDirect(targetUserSteamId, bytes, EUbermundoP2PSendMode::Unreliable);
 }
 
-bool USteamCustomCode::SendP2PPacket_ReliableWithBuffered(int64 targetUserSteamId, TArray<uint8> bytes) {
-	CSteamID id((uint64)targetUserSteamId);
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("SendP2PPacket_ReliableWithBuffered 0x%llX N=%d"), (uint64)targetUserSteamId, bytes.Num());
-	if (!SteamAPI_IsSteamRunning() || SteamNetworking() == nullptr)
-		return false;
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("SendP2PPacket_ReliableWithBuffered 0x%llX N=%d - Sending"), (uint64)targetUserSteamId, bytes.Num());
-	return SteamNetworking()->SendP2PPacket(id, bytes.GetData(), bytes.Num(), EP2PSend::k_EP2PSendReliableWithBuffering);
+bool USteamCustomCode::SendP2PPacket_Reliable(int64 targetUserSteamId, const TArray<uint8>& bytes) {
+	return SendDirect(targetUserSteamId, bytes, EUbermundoP2PSendMode::Reliable);
 }
 
-int USteamCustomCode::IsP2PPacketAvailable() {
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("IsP2PPacketAvailable"));
-	if (!SteamAPI_IsSteamRunning() || SteamNetworking() == nullptr)
+bool USteamCustomCode::SendP2PPacket_ReliableWithBuffered(int64 targetUserSteamId, const TArray<uint8>& bytes) {
+	return SendDirect(targetUserSteamId, bytes, EUbermundoP2PSendMode::ReliableWithBuffering);
+}
+
+bool USteamCustomCode::SendP2P(uint64 targetUserSteamId, const uint8* data, uint32 numBytes, EUbermundoP2PSendMode mode) {
+	FUbermundoGameThreadNetScope timing;
+	bool ok = GetTransport().Send(targetUserSteamId, data, numBytes, mode);
+	UBERMUNDO_TRACE(Send, targetUserSteamId, data, numBytes, ok);
+	if (ok)
+		FUbermundoNetStats::Get().OnPacketOut(targetUserSteamId, (int32)numBytes);
+	FUbermundoNetCapture& capture = FUbermundoNetCapture::Get();
+	if (capture.IsCapturing())
+		capture.OnSend(targetUserSteamId, data, numBytes, mode);
+	return ok;
+}
+
+int32 USteamCustomCode::SendP2PToPeers(TArrayView<const uint64> targetUserSteamIds, const FUbermundoPacketRef& packet, EUbermundoP2PSendMode mode) {
+	FUbermundoGameThreadNetScope timing;
+	TArray<bool, TInlineAllocator<64>> sent;
+	int32 n = GetTransport().SendToMany(targetUserSteamIds, packet, mode, sent);
+	FUbermundoNetStats& stats = FUbermundoNetStats::Get();
+	FUbermundoNetCapture& capture = FUbermundoNetCapture::Get();
+	for (int32 i = 0; i < targetUserSteamIds.Num(); i++) {
+		uint64 peer = targetUserSteamIds[i];
+		UBERMUNDO_TRACE(Send, peer, packet.GetData(), (uint32)packet.Num(), sent[i]);
+		if (sent[i])
+			stats.OnPacketOut(peer, packet.Num());
+		if (capture.IsCapturing())
+			capture.OnSend(peer, packet.GetData(), (uint32)packet.Num(), mode);
+	}
+	return n;
+}
+
+int32 USteamCustomCode::SendP2PPacketToPeers(const TArray<int64>& targetUserSteamIds, const TArray<uint8>& bytes, EUbermundoP2PSendMode mode) {
+	if (targetUserSteamIds.Num() == 0)
 		return 0;
+	// The one copy every peer's send shares. The Blueprint array can't be held on to past this call.
+	FUbermundoPacketRef packet = FUbermundoPacketBufferPool::Get().Acquire(bytes.Num());
+	packet.GetMutableBytes().Append(bytes);
+	TArrayView<const uint64> targets(reinterpret_cast<const uint64*>(targetUserSteamIds.GetData()), targetUserSteamIds.Num());
+
+	FUbermundoRateController& rate = FUbermundoRateController::Get();
+	FUbermundoNetStats& stats = FUbermundoNetStats::Get();
+	for (uint64 peer : targets) {
+		if (bytes.Num() > 0)
+			rate.OnSent(peer, bytes.Num(), FUbermundoRateController::ClassOf(bytes[0]));
+		stats.OnMessageOut(peer, bytes.GetData(), bytes.Num());
+	}
+	int32 n = SendP2PToPeers(targets, packet, mode);
+
+	// Hand the lot over now, in one SendMessages call on SteamSockets.
+	FUbermundoGameThreadNetScope timing;
+	GetTransport().FlushSends();
+	return n;
+}
+
+bool USteamCustomCode::QueueP2PMessage(int64 targetUserSteamId, const TArray<uint8>& bytes, EUbermundoP2PSendMode mode) {
+	return FUbermundoP2POutbox::Get().Queue((uint64)targetUserSteamId, bytes.GetData(), bytes.Num(), mode);
+}
+
+int USteamCustomCode::FlushP2POutbox() {
+	FUbermundoNetTick::Get().Tick(FPlatformTime::Seconds());
+	return FUbermundoP2POutbox::Get().Flush();
+}
+
+int USteamCustomCode::IsP2PPacketAvailable() {
 	uint32 N;
-	if (SteamNetworking()->IsP2PPacketAvailable(&N)) {
-		UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("IsP2PPacketAvailable: N=%d"), N);
+	if (UUbermundoP2PInbox::GetP2PInbox()->GetNextMessageSize(N))
 		return (int)N;
-	}
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("IsP2PPacketAvailable: N=0"));
 	return 0;
 }
 
 bool USteamCustomCode::ReadP2PPacket(TArray<uint8>& bytes, int64& remoteSteamID) {
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("ReadP2PPacket"));
-	if (!SteamAPI_IsSteamRunning() || SteamNetworking() == nullptr) {
-		remoteSteamID = 0;
-		return 0;
-	}
-	uint32 N;
-	if (!SteamNetworking()->IsP2PPacketAvailable(&N)) {
-		UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("ReadP2PPacket No Data"));
-		remoteSteamID = 0;
+	// Through the inbox, so bundles are unpacked and the plugin's own packets never reach game code.
+	remoteSteamID = 0;
+	uint64 sender;
+	if (!UUbermundoP2PInbox::GetP2PInbox()->ReadMessage(bytes, sender)) {
+		bytes.Reset();
 		return false;
 	}
-	TArray<uint8>buf;
-	buf.SetNum(N);
-	uint32 N2;
-	CSteamID stm;
-	bool b = SteamNetworking()->ReadP2PPacket(buf.GetData(), N, &N2, &stm);
-	if (b) {
-		UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("ReadP2PPacket Data: N=%d From:0x%llX"), N, stm.ConvertToUint64());
-		bytes = buf;
-		remoteSteamID = (int64)stm.ConvertToUint64();
-	}
-	else {
-		remoteSteamID = 0;
-		UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("ReadP2PPacket Data: No Data"));
-	}
-	return b;
+	remoteSteamID = (int64)sender;
+	return true;
 }
 
 bool USteamCustomCode::CloseP2PBySteamID(int64 remoteSteamID) {
-	UE_LOG(UberMundoSteamLog, VeryVerbose, TEXT("CloseP2PBySteamID Remote:0x%llX"), (uint64)remoteSteamID);
-	if (!SteamAPI_IsSteamRunning() || SteamNetworking() == nullptr)
+	UBERMUNDO_TRACE(Close, (uint64)remoteSteamID, nullptr, 0, true);
+	if (!GetTransport().IsAvailable())
 		return 0;
 
-	CSteamID id((uint64)remoteSteamID);
-	return SteamNetworking()->CloseP2PSessionWithUser(id);
+	FUbermundoNetTick::Get().ForgetPeer((uint64)remoteSteamID);
+	return GetTransport().Close((uint64)remoteSteamID);
+}
+
+static TUniquePtr<IUbermundoTransport> currentTransport;
+
+/** Before a transport swap. If the network thread runs, stop it and hand the packets it already read to the
+	inbox, they would go with the threaded transport otherwise. */
+static void HandOverReceived() {
+	if (!currentTransport.IsValid() || !UUbermundoNetThreadLibrary::IsNetworkThreadRunning())
+		return;
+	static_cast<FUbermundoThreadedTransport&>(*currentTransport).StopThread();
+	UUbermundoP2PInbox::GetP2PInbox()->DrainP2PPackets();
+}
+
+IUbermundoTransport& USteamCustomCode::GetTransport() {
+	if (!currentTransport.IsValid())
+		currentTransport = MakeUnique<FUbermundoSteamTransport>();
+	return *currentTransport;
+}
+
+void USteamCustomCode::SetTransport(TUniquePtr<IUbermundoTransport> transport) {
+	HandOverReceived();
+	// Anything queued was for the old transport's peers.
+	FUbermundoP2POutbox::Get().Flush();
+	currentTransport = MoveTemp(transport);
+	UE_LOG(UberMundoSteamLog, Display, TEXT("P2P transport is now %s"), currentTransport.IsValid() ? currentTransport->GetName() : TEXT("Steam"));
+}
+
+void USteamCustomCode::ReplaceTransport(TFunctionRef<TUniquePtr<IUbermundoTransport>(TUniquePtr<IUbermundoTransport>)> fn) {
+	HandOverReceived();
+	FUbermundoP2POutbox::Get().Flush();
+	GetTransport();
+	currentTransport = fn(MoveTemp(currentTransport));
+	UE_LOG(UberMundoSteamLog, Display, TEXT("P2P transport is now %s"), currentTransport.IsValid() ? currentTransport->GetName() : TEXT("Steam"));
+}
+
+void USteamCustomCode::UseSteamTransport() {
+	SetTransport(MakeUnique<FUbermundoSteamTransport>());
+}
+
+bool USteamCustomCode::UseSteamSocketsTransport() {
+	TUniquePtr<FUbermundoSteamSocketsTransport> sockets = MakeUnique<FUbermundoSteamSocketsTransport>();
+	if (!sockets->IsAvailable())
+		return false;
+	SetTransport(MoveTemp(sockets));
+	return true;
+}
+
+bool USteamCustomCode::UseLoopbackTransport(int32 localPort, const FUbermundoNetConditions& conditions) {
+	TUniquePtr<FUbermundoLoopbackTransport> loopback = MakeUnique<FUbermundoLoopbackTransport>(localPort);
+	if (!loopback->IsAvailable())
+		return false;
+	loopback->SetConditions(conditions);
+	SetTransport(MoveTemp(loopback));
+	return true;
+}
+
+bool USteamCustomCode::SetLoopbackConditions(const FUbermundoNetConditions& conditions) {
+	if (GetTransport().SetConditions(conditions))
+		return true;
+	UE_LOG(UberMundoSteamLog, Warning, TEXT("SetLoopbackConditions: the %s transport has no conditioner"), GetTransport().GetName());
+	return false;
+}
+
+bool USteamCustomCode::AddLoopbackPeer(int64 peer, const FString& address, int32 port) {
+	if (GetTransport().AddPeer((uint64)peer, address, port))
+		return true;
+	UE_LOG(UberMundoSteamLog, Warning, TEXT("AddLoopbackPeer 0x%llX %s:%d failed on the %s transport"), (uint64)peer, *address, port, GetTransport().GetName());
+	return false;
+}
+
+FString USteamCustomCode::GetTransportName() {
+	return GetTransport().GetName();
 }
 
 bool USteamCustomCode::IsValidSteamID(int64 steamID) {
@@ -0,0 +1,186 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+
+#include "UbermundoAvatarCache.h"
+#include "SteamCustomCode.h"
+#include "Engine/Texture2D.h"
+#include "Async/Async.h"
+#include "steam/steam_api.h"
+
+// --------------------------------------------------------------------------------- FUbermundoAvatarCache
+FUbermundoAvatarCache& FUbermundoAvatarCache::Get() {
+	static FUbermundoAvatarCache cache;
+	return cache;
+}
+
+int32 FUbermundoAvatarCache::HandleFromSteam(uint64 steamId, EUbermundoAvatarSize size) {
+	if (!SteamAPI_IsSteamRunning() || SteamFriends() == nullptr)
+		return 0;
+	CSteamID id(steamId);
+	int32 handle;
+	switch (size) {
+	case EUbermundoAvatarSize::Small:
+		handle = SteamFriends()->GetSmallFriendAvatar(id);
+		break;
+	case EUbermundoAvatarSize::Medium:
+		handle = SteamFriends()->GetMediumFriendAvatar(id);
+		break;
+	default:
+		// -1 while Steam loads it, AvatarImageLoaded_t says when it has.
+		handle = SteamFriends()->GetLargeFriendAvatar(id);
+		break;
+	}
+	// Not someone Steam has told us about yet. A PersonaStateChange_t follows once it has.
+	if (handle == 0)
+		SteamFriends()->RequestUserInformation(id, false);
+	return handle;
+}
+
+UTexture2D* FUbermundoAvatarCache::Find(uint64 steamId, EUbermundoAvatarSize size) {
+	check(IsInGameThread());
+	TakeDecoded();
+	{
+		FScopeLock scope(&changedLock);
+		for (uint64 id : changed) {
+			for (int32 s = 0; s <= (int32)EUbermundoAvatarSize::Large; s++) {
+				if (FKey* k = keys.Find(KeyOf(id, (EUbermundoAvatarSize)s))) {
+					k->handle = 0;
+					k->retryAt = 0.0;
+				}
+			}
+		}
+		changed.Reset();
+	}
+
+	double now = FPlatformTime::Seconds();
+	FKey& k = keys.FindOrAdd(KeyOf(steamId, size));
+	if (k.handle <= 0) {
+		if (now < k.retryAt)
+			return nullptr;
+		k.handle = HandleFromSteam(steamId, size);
+		if (k.handle <= 0) {
+			k.retryAt = now + UBERMUNDO_AVATAR_RETRY;
+			return nullptr;
+		}
+	}
+
+	FImage* img = images.Find(k.handle);
+	if (img == nullptr || (img->texture == nullptr && !img->decoding && now - img->failedAt >= UBERMUNDO_AVATAR_RETRY)) {
+		StartDecode(k.handle);
+		return nullptr;
+	}
+	img->lastUsed = ++useCounter;
+	return img->texture;
+}
+
+void FUbermundoAvatarCache::StartDecode(int32 handle) {
+	FImage& img = images.FindOrAdd(handle);
+	img.decoding = true;
+	img.lastUsed = ++useCounter;
+	uint32 gen = generation;
+	TWeakPtr<FDecodedQueue, ESPMode::ThreadSafe> out = decoded;
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [out, handle, gen]() {
+		FDecoded d;
+		d.handle = handle;
+		d.generation = gen;
+		ISteamUtils* utils = SteamUtils();
+		uint32 w = 0;
+		uint32 h = 0;
+		if (utils != nullptr && utils->GetImageSize(handle, &w, &h) && w > 0 && h > 0) {
+			d.pixels.SetNumUninitialized((int32)(w * h * 4));
+			if (utils->GetImageRGBA(handle, d.pixels.GetData(), d.pixels.Num())) {
+				d.width = (int32)w;
+				d.height = (int32)h;
+				// Steam gives RGBA, the texture wants BGRA.
+				uint8* p = d.pixels.GetData();
+				for (int32 i = 0; i < d.pixels.Num(); i += 4)
+					Swap(p[i], p[i + 2]);
+			}
+			else {
+				d.pixels.Reset();
+			}
+		}
+		if (TSharedPtr<FDecodedQueue, ESPMode::ThreadSafe> queue = out.Pin())
+			queue->Enqueue(MoveTemp(d));
+	});
+}
+
+void FUbermundoAvatarCache::TakeDecoded() {
+	FDecoded d;
+	while (decoded->Dequeue(d)) {
+		FImage* img = images.Find(d.handle);
+		if (d.generation != generation || img == nullptr)
+			continue;
+		img->decoding = false;
+		UTexture2D* t = d.pixels.Num() > 0 ? UTexture2D::CreateTransient(d.width, d.height, PF_B8G8R8A8) : nullptr;
+		if (t == nullptr) {
+			UE_LOG(UberMundoSteamLog, Warning, TEXT("Avatar image %d could not be read from Steam"), d.handle);
+			img->failedAt = FPlatformTime::Seconds();
+			continue;
+		}
+		t->SRGB = true;
+		t->LODGroup = TEXTUREGROUP_UI;
+		FTexture2DMipMap& mip = t->PlatformData->Mips[0];
+		FMemory::Memcpy(mip.BulkData.Lock(LOCK_READ_WRITE), d.pixels.GetData(), d.pixels.Num());
+		mip.BulkData.Unlock();
+		t->UpdateResource();
+		img->texture = t;
+		numReady++;
+		version++;
+	}
+	if (numReady > UBERMUNDO_AVATAR_CACHE_SIZE)
+		Evict();
+}
+
+void FUbermundoAvatarCache::Evict() {
+	while (numReady > UBERMUNDO_AVATAR_CACHE_SIZE) {
+		int32 oldest = 0;
+		uint64 oldestUse = MAX_uint64;
+		for (const TPair<int32, FImage>& kv : images) {
+			if (kv.Value.texture != nullptr && kv.Value.lastUsed < oldestUse) {
+				oldest = kv.Key;
+				oldestUse = kv.Value.lastUsed;
+			}
+		}
+		// Players still pointing at it decode it again if they are asked for.
+		images.Remove(oldest);
+		numReady--;
+	}
+}
+
+void FUbermundoAvatarCache::OnAvatarChanged(uint64 steamId) {
+	FScopeLock scope(&changedLock);
+	changed.Add(steamId);
+}
+
+void FUbermundoAvatarCache::Reset() {
+	check(IsInGameThread());
+	keys.Empty();
+	images.Empty();
+	numReady = 0;
+	generation++;
+	version++;
+	FDecoded d;
+	while (decoded->Dequeue(d)) {
+	}
+	FScopeLock scope(&changedLock);
+	changed.Empty();
+}
+
+void FUbermundoAvatarCache::AddReferencedObjects(FReferenceCollector& collector) {
+	for (TPair<int32, FImage>& kv : images) {
+		if (kv.Value.texture != nullptr)
+			collector.AddReferencedObject(kv.Value.texture);
+	}
+}
+
+// --------------------------------------------------------------------------------- UUbermundoAvatarLibrary
+UTexture2D* UUbermundoAvatarLibrary::GetSteamAvatar(int64 steamId, EUbermundoAvatarSize size, UTexture2D* placeholder, bool& ready) {
+	UTexture2D* t = FUbermundoAvatarCache::Get().Find((uint64)steamId, size);
+	ready = t != nullptr;
+	return ready ? t : placeholder;
+}
+
+int32 UUbermundoAvatarLibrary::GetAvatarCacheVersion() {
+	return FUbermundoAvatarCache::Get().GetVersion();
+}
@@ -0,0 +1,583 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+
+#include "UbermundoBlockSwarm.h"
+#include "SteamCustomCode.h"
+#include "BlockDataClient.h"
+#include "UbermundoP2POutbox.h"
+#include "UbermundoBulkTransfer.h"
+#include "UbermundoRateControl.h"
+#include "UbermundoPacketBuffer.h"
+#include "Hash/CityHash.h"
+
+/** Chunks asked of one player at once, at most. */
+#define UBERMUNDO_SWARM_MAX_WINDOW 64.0f
+/** Once other players are delivering, the owner is only kept this busy, so most of the load is off them. */
+#define UBERMUNDO_SWARM_OWNER_WINDOW 4
+/** A chunk that failed this often is only asked of the owner. */
+#define UBERMUNDO_SWARM_OWNER_AFTER 2
+/** A player who sent this many chunks that failed their hash is dropped. */
+#define UBERMUNDO_SWARM_MAX_BAD 2
+/** Most chunk indices in one ChunkRequest. */
+#define UBERMUNDO_SWARM_MAX_ASK 32
+#define UBERMUNDO_SWARM_MANIFEST_RETRY 3.0
+#define UBERMUNDO_SWARM_MANIFEST_TRIES 5
+/** How often players not yet delivering are asked again, they may have finished their own fetch since. */
+#define UBERMUNDO_SWARM_WANT_SECONDS 5.0
+/** A fetch nothing has arrived for in this long has failed. */
+#define UBERMUNDO_SWARM_STALL_SECONDS 30.0
+
+static uint64 ReadU64(const uint8* p) {
+	uint64 v = 0;
+	for (int32 i = 0; i < 8; i++)
+		v = (v << 8) | p[i];
+	return v;
+}
+
+static uint32 ReadU32(const uint8* p) {
+	return ((uint32)p[0] << 24) | ((uint32)p[1] << 16) | ((uint32)p[2] << 8) | p[3];
+}
+
+static uint16 ReadU16(const uint8* p) {
+	return (uint16)((p[0] << 8) | p[1]);
+}
+
+static void SendBlockMessage(uint64 peer, EUbermundoPacketCodes code, uint64 id, EUbermundoP2PSendMode mode) {
+	FUbermundoPacketBuilder b(code, 1 + 8);
+	b.AddInt64((int64)id);
+	FUbermundoP2POutbox::Get().Queue(peer, b.GetPacket().View(), mode);
+}
+
+/** How long to wait for a chunk asked of peer, from what the rate controller knows of the link. */
+static double ChunkTimeout(uint64 peer) {
+	FUbermundoLinkStats link;
+	if (FUbermundoRateController::Get().GetLinkStats(peer, link) && link.RttMs > 0.0f)
+		return FMath::Max(0.25, 2.0 * (link.RttMs + 4.0 * link.RttVarMs) / 1000.0);
+	return 1.0;
+}
+
+// --------------------------------------------------------------------------------- FUbermundoBlockSwarm
+FUbermundoBlockSwarm& FUbermundoBlockSwarm::Get() {
+	static FUbermundoBlockSwarm swarm;
+	return swarm;
+}
+
+uint64 FUbermundoBlockSwarm::BlockId(const FString& blockName) {
+	FTCHARToUTF8 utf8(*blockName);
+	return CityHash64(utf8.Get(), utf8.Length());
+}
+
+int32 FUbermundoBlockSwarm::ChunkSize(int32 totalBytes, int32 index) {
+	return FMath::Min(UBERMUNDO_SWARM_CHUNK, totalBytes - index * UBERMUNDO_SWARM_CHUNK);
+}
+
+uint32 FUbermundoBlockSwarm::VersionOf(const FSHAHash& hash) {
+	return ReadU32(hash.Hash);
+}
+
+FSHAHash FUbermundoBlockSwarm::HashChunk(const uint8* data, int32 numBytes) {
+	FSHAHash h;
+	FSHA1::HashBuffer(data, numBytes, h.Hash);
+	return h;
+}
+
+void FUbermundoBlockSwarm::Offer(const FString& blockName, TArrayView<const uint8> bytes) {
+	if (bytes.Num() == 0 || bytes.Num() > UBERMUNDO_SWARM_MAX_BYTES) {
+		UE_LOG(UberMundoSteamLog, Warning, TEXT("Swarm Offer %s N=%d, must be 1 to %d bytes"), *blockName, bytes.Num(), UBERMUNDO_SWARM_MAX_BYTES);
+		return;
+	}
+	Withdraw(blockName);
+	FOffered& o = offered.Add(BlockId(blockName));
+	o.name = blockName;
+	o.bytes.Append(bytes.GetData(), bytes.Num());
+	o.hash = HashChunk(bytes.GetData(), bytes.Num());
+	int32 numChunks = (bytes.Num() + UBERMUNDO_SWARM_CHUNK - 1) / UBERMUNDO_SWARM_CHUNK;
+	o.chunkHashes.Reserve(numChunks);
+	for (int32 i = 0; i < numChunks; i++)
+		o.chunkHashes.Add(HashChunk(bytes.GetData() + i * UBERMUNDO_SWARM_CHUNK, ChunkSize(bytes.Num(), i)));
+	o.lastUsed = FPlatformTime::Seconds();
+	offeredBytes += bytes.Num();
+	TrimOffered();
+}
+
+void FUbermundoBlockSwarm::Withdraw(const FString& blockName) {
+	uint64 id = BlockId(blockName);
+	if (const FOffered* o = offered.Find(id)) {
+		offeredBytes -= o->bytes.Num();
+		offered.Remove(id);
+	}
+}
+
+bool FUbermundoBlockSwarm::IsOffered(const FString& blockName) const {
+	return offered.Contains(BlockId(blockName));
+}
+
+void FUbermundoBlockSwarm::TrimOffered() {
+	while (offeredBytes > UBERMUNDO_SWARM_MAX_OFFERED && offered.Num() > 1) {
+		uint64 oldest = 0;
+		double oldestUsed = TNumericLimits<double>::Max();
+		for (const TPair<uint64, FOffered>& kv : offered) {
+			if (kv.Value.lastUsed < oldestUsed) {
+				oldest = kv.Key;
+				oldestUsed = kv.Value.lastUsed;
+			}
+		}
+		UE_LOG(UberMundoSteamLog, Verbose, TEXT("Swarm no longer offering %s"), *offered[oldest].name);
+		offeredBytes -= offered[oldest].bytes.Num();
+		offered.Remove(oldest);
+	}
+}
+
+bool FUbermundoBlockSwarm::Fetch(int64 requestHandle, const FString& blockName, uint64 owner, TArrayView<const uint64> peers) {
+	uint64 id = BlockId(blockName);
+	if (FOffered* o = offered.Find(id)) {
+		// Already here, from an earlier fetch or our own. The caller hears on the next Tick, like for any other fetch.
+		o->lastUsed = FPlatformTime::Seconds();
+		FReady& r = ready.AddDefaulted_GetRef();
+		r.requestHandle = requestHandle;
+		r.id = id;
+		return true;
+	}
+	uint64 self = (uint64)USteamCustomCode::GetLocalSteamIDInt64();
+	if (owner == 0 || owner == self || FindFetch(id) != nullptr) {
+		UE_LOG(UberMundoSteamLog, Warning, TEXT("Swarm Fetch %s, bad owner 0x%llX or already fetching it"), *blockName, owner);
+		return false;
+	}
+
+	double now = FPlatformTime::Seconds();
+	FFetch& f = fetches.AddDefaulted_GetRef();
+	f.requestHandle = requestHandle;
+	f.id = id;
+	f.name = blockName;
+	f.owner = owner;
+	for (uint64 p : peers) {
+		if (p != owner && p != self && p != 0)
+			f.candidates.AddUnique(p);
+	}
+	f.lastProgress = now;
+	AddSource(f, owner);
+	SendWants(f, now);
+	UE_LOG(UberMundoSteamLog, Verbose, TEXT("Swarm Fetch %s id %016llX from 0x%llX and %d others"), *blockName, id, owner, f.candidates.Num());
+	return true;
+}
+
+void FUbermundoBlockSwarm::Cancel(int64 requestHandle) {
+	ready.RemoveAll([requestHandle](const FReady& r) { return r.requestHandle == requestHandle; });
+	fetches.RemoveAll([requestHandle](const FFetch& f) { return f.requestHandle == requestHandle; });
+}
+
+bool FUbermundoBlockSwarm::GetProgress(int64 requestHandle, float& progress, int32& numSources) const {
+	progress = 0.0f;
+	numSources = 0;
+	const FFetch* f = fetches.FindByPredicate([requestHandle](const FFetch& x) { return x.requestHandle == requestHandle; });
+	if (f == nullptr)
+		return false;
+	progress = f->haveManifest ? (float)f->numHave / f->chunks.Num() : 0.0f;
+	numSources = f->sources.Num();
+	return true;
+}
+
+FUbermundoBlockSwarm::FFetch* FUbermundoBlockSwarm::FindFetch(uint64 id) {
+	return fetches.FindByPredicate([id](const FFetch& f) { return f.id == id; });
+}
+
+FUbermundoBlockSwarm::FSource* FUbermundoBlockSwarm::FindSource(FFetch& f, uint64 peer) {
+	return f.sources.FindByPredicate([peer](const FSource& s) { return s.peer == peer; });
+}
+
+void FUbermundoBlockSwarm::AddSource(FFetch& f, uint64 peer) {
+	if (FindSource(f, peer) != nullptr || f.dropped.Contains(peer))
+		return;
+	FSource& s = f.sources.AddDefaulted_GetRef();
+	s.peer = peer;
+	s.owner = peer == f.owner;
+}
+
+void FUbermundoBlockSwarm::DropSource(FFetch& f, uint64 peer) {
+	f.sources.RemoveAll([peer](const FSource& s) { return s.peer == peer; });
+	f.dropped.Add(peer);
+	for (int32 i = 0; i < f.chunks.Num(); i++) {
+		if (f.chunks[i] == EChunk::Requested && f.requestedFrom[i] == peer) {
+			f.chunks[i] = EChunk::Missing;
+			f.nextMissing = FMath::Min(f.nextMissing, i);
+		}
+	}
+}
+
+void FUbermundoBlockSwarm::RequestFailed(FFetch& f, int32 index) {
+	f.chunks[index] = EChunk::Missing;
+	f.tries[index] = (uint8)FMath::Min(f.tries[index] + 1, 255);
+	f.nextMissing = FMath::Min(f.nextMissing, index);
+}
+
+void FUbermundoBlockSwarm::SendWants(FFetch& f, double now) {
+	f.lastWant = now;
+	for (uint64 p : f.candidates) {
+		if (FindSource(f, p) == nullptr && !f.dropped.Contains(p))
+			SendBlockMessage(p, UBERMUNDOPC_P2P_BlockWant, f.id, EUbermundoP2PSendMode::Reliable);
+	}
+}
+
+void FUbermundoBlockSwarm::Tick(double now) {
+	// Taken out first, a callback may well start another fetch.
+	TArray<FReady> answer = MoveTemp(ready);
+	ready.Reset();
+	for (const FReady& r : answer) {
+		if (const FOffered* o = offered.Find(r.id))
+			UBlockDataClient::OnPeerFetchDone(r.requestHandle, o->bytes, true, FString());
+		else
+			UBlockDataClient::OnPeerFetchDone(r.requestHandle, TArray<uint8>(), false, TEXT("The block was withdrawn before it could be handed over."));
+	}
+
+	for (int32 fi = fetches.Num() - 1; fi >= 0; fi--) {
+		FFetch& f = fetches[fi];
+		if (now - f.lastProgress > UBERMUNDO_SWARM_STALL_SECONDS) {
+			Finish(fi, false, TEXT("Nothing arrived from the owner or any other player."));
+			continue;
+		}
+		if (IsStranded(f)) {
+			Finish(fi, false, TEXT("Lost the connection to the owner, and some chunks only the owner could send."));
+			continue;
+		}
+		if (now - f.lastWant > UBERMUNDO_SWARM_WANT_SECONDS)
+			SendWants(f, now);
+		if (f.haveManifest) {
+			TickFetch(f, now);
+			continue;
+		}
+		if (now - f.lastManifestRequest < UBERMUNDO_SWARM_MANIFEST_RETRY)
+			continue;
+		if (f.manifestRequests >= UBERMUNDO_SWARM_MANIFEST_TRIES) {
+			Finish(fi, false, TEXT("The owner did not send the block manifest."));
+			continue;
+		}
+		f.lastManifestRequest = now;
+		f.manifestRequests++;
+		FUbermundoPacketBuilder b(UBERMUNDOPC_P2P_BlockManifestRequest, 1 + 8 + 4);
+		b.AddInt64((int64)f.id).AddInt32((int32)f.requestHandle);
+		FUbermundoP2POutbox::Get().Queue(f.owner, b.GetPacket().View(), EUbermundoP2PSendMode::Reliable);
+	}
+}
+
+void FUbermundoBlockSwarm::TickFetch(FFetch& f, double now) {
+	TMap<uint64, double> timeouts;
+	TSet<uint64> cut;
+	for (int32 i = 0; i < f.chunks.Num(); i++) {
+		if (f.chunks[i] != EChunk::Requested)
+			continue;
+		uint64 peer = f.requestedFrom[i];
+		double* timeout = timeouts.Find(peer);
+		if (timeout == nullptr)
+			timeout = &timeouts.Add(peer, ChunkTimeout(peer));
+		if (now - f.requestedAt[i] <= *timeout)
+			continue;
+		RequestFailed(f, i);
+		if (FSource* s = FindSource(f, peer)) {
+			s->inFlight--;
+			// Halve once per tick, however many of its chunks timed out together.
+			if (!cut.Contains(peer)) {
+				s->window = FMath::Max(1.0f, s->window * 0.5f);
+				cut.Add(peer);
+			}
+		}
+	}
+
+	bool othersDelivering = f.sources.ContainsByPredicate([](const FSource& s) { return !s.owner; });
+	auto room = [othersDelivering](const FSource& s) {
+		int32 window = (int32)s.window;
+		if (s.owner && othersDelivering)
+			window = FMath::Min(window, UBERMUNDO_SWARM_OWNER_WINDOW);
+		return window - s.inFlight;
+	};
+
+	TMap<uint64, TArray<uint16, TInlineAllocator<UBERMUNDO_SWARM_MAX_ASK>>> asks;
+	auto sendAsk = [&f](uint64 peer, TArray<uint16, TInlineAllocator<UBERMUNDO_SWARM_MAX_ASK>>& indices) {
+		FUbermundoPacketBuilder b(UBERMUNDOPC_P2P_BlockChunkRequest, 1 + 8 + 1 + 2 * indices.Num());
+		b.AddInt64((int64)f.id).AddByte((uint8)indices.Num());
+		for (uint16 index : indices)
+			b.AddInt16((int16)index);
+		FUbermundoP2POutbox::Get().Queue(peer, b.GetPacket().View(), EUbermundoP2PSendMode::Unreliable);
+		indices.Reset();
+	};
+	int32 firstUnasked = f.chunks.Num();
+	for (int32 i = f.nextMissing; i < f.chunks.Num(); i++) {
+		if (f.chunks[i] != EChunk::Missing)
+			continue;
+		// Whoever has the most room, the owner only when it has to be them.
+		FSource* best = nullptr;
+		for (FSource& s : f.sources) {
+			if (f.tries[i] >= UBERMUNDO_SWARM_OWNER_AFTER && !s.owner)
+				continue;
+			if (room(s) > 0 && (best == nullptr || room(s) > room(*best) || (best->owner && !s.owner)))
+				best = &s;
+		}
+		if (best == nullptr) {
+			firstUnasked = FMath::Min(firstUnasked, i);
+			continue;
+		}
+		best->inFlight++;
+		f.chunks[i] = EChunk::Requested;
+		f.requestedFrom[i] = best->peer;
+		f.requestedAt[i] = now;
+		auto& indices = asks.FindOrAdd(best->peer);
+		indices.Add((uint16)i);
+		if (indices.Num() == UBERMUNDO_SWARM_MAX_ASK)
+			sendAsk(best->peer, indices);
+	}
+	f.nextMissing = firstUnasked;
+
+	for (auto& kv : asks) {
+		if (kv.Value.Num() > 0)
+			sendAsk(kv.Key, kv.Value);
+	}
+}
+
+bool FUbermundoBlockSwarm::IsStranded(const FFetch& f) const {
+	if (!f.haveManifest || f.sources.ContainsByPredicate([](const FSource& s) { return s.owner; }))
+		return false;
+	for (int32 i = 0; i < f.chunks.Num(); i++) {
+		if (f.chunks[i] == EChunk::Missing && f.tries[i] >= UBERMUNDO_SWARM_OWNER_AFTER)
+			return true;
+	}
+	return false;
+}
+
+void FUbermundoBlockSwarm::Finish(int32 fetchIdx, bool ok, const FString& failReason) {
+	FFetch f = MoveTemp(fetches[fetchIdx]);
+	fetches.RemoveAt(fetchIdx);
+	if (!ok) {
+		UE_LOG(UberMundoSteamLog, Warning, TEXT("Swarm Fetch %s failed: %s"), *f.name, *failReason);
+		UBlockDataClient::OnPeerFetchDone(f.requestHandle, TArray<uint8>(), false, failReason);
+		return;
+	}
+
+	UE_LOG(UberMundoSteamLog, Verbose, TEXT("Swarm Fetch %s done N=%u from %d players"), *f.name, f.totalBytes, f.sources.Num());
+	UBlockDataClient::OnPeerFetchDone(f.requestHandle, f.data, true, FString());
+
+	// Now we have it too. Tell whoever did not have it, they may be fetching it themselves.
+	FOffered& o = offered.Add(f.id);
+	o.name = f.name;
+	o.bytes = MoveTemp(f.data);
+	o.hash = f.hash;
+	o.chunkHashes = MoveTemp(f.chunkHashes);
+	o.lastUsed = FPlatformTime::Seconds();
+	offeredBytes += o.bytes.Num();
+	for (uint64 p : f.candidates) {
+		if (FindSource(f, p) == nullptr && !f.dropped.Contains(p)) {
+			FUbermundoPacketBuilder b(UBERMUNDOPC_P2P_BlockHave, 1 + 8 + 4);
+			b.AddInt64((int64)f.id).AddInt32((int32)VersionOf(f.hash));
+			FUbermundoP2POutbox::Get().Queue(p, b.GetPacket().View(), EUbermundoP2PSendMode::Reliable);
+		}
+	}
+	TrimOffered();
+}
+
+bool FUbermundoBlockSwarm::HandlePacket(uint64 sender, const uint8* data, int32 numBytes) {
+	if (numBytes <= 0 || data[0] < UBERMUNDOPC_P2P_BlockWant || data[0] > UBERMUNDOPC_P2P_BlockMissing)
+		return false;
+	if (numBytes < 1 + 8)
+		return true;
+	uint64 id = ReadU64(data + 1);
+	switch (data[0]) {
+	case UBERMUNDOPC_P2P_BlockWant:
+		OnWant(sender, id);
+		return true;
+	case UBERMUNDOPC_P2P_BlockHave:
+		if (numBytes >= 1 + 8 + 4)
+			OnHave(sender, id, ReadU32(data + 9));
+		return true;
+	case UBERMUNDOPC_P2P_BlockManifestRequest:
+		if (numBytes >= 1 + 8 + 4)
+			OnManifestRequest(sender, id, ReadU32(data + 9));
+		return true;
+	case UBERMUNDOPC_P2P_BlockManifest:
+		OnManifest(sender, data, numBytes);
+		return true;
+	case UBERMUNDOPC_P2P_BlockChunkRequest:
+		OnChunkRequest(sender, data, numBytes);
+		return true;
+	case UBERMUNDOPC_P2P_BlockChunk:
+		OnChunk(sender, data, numBytes);
+		return true;
+	case UBERMUNDOPC_P2P_BlockMissing:
+		OnMissing(sender, id);
+		return true;
+	default:
+		return false;
+	}
+}
+
+void FUbermundoBlockSwarm::OnWant(uint64 sender, uint64 id) {
+	// No answer if we don't have it, the asker only waits on the ones that do.
+	if (const FOffered* o = offered.Find(id)) {
+		FUbermundoPacketBuilder b(UBERMUNDOPC_P2P_BlockHave, 1 + 8 + 4);
+		b.AddInt64((int64)id).AddInt32((int32)VersionOf(o->hash));
+		FUbermundoP2POutbox::Get().Queue(sender, b.GetPacket().View(), EUbermundoP2PSendMode::Reliable);
+	}
+}
+
+void FUbermundoBlockSwarm::OnHave(uint64 sender, uint64 id, uint32 version) {
+	FFetch* f = FindFetch(id);
+	if (f == nullptr || sender == f->owner)
+		return;
+	if (!f->haveManifest) {
+		f->haves.Add(sender, version);
+		return;
+	}
+	// Someone holding an older or newer copy is no use to us.
+	if (version == VersionOf(f->hash))
+		AddSource(*f, sender);
+}
+
+void FUbermundoBlockSwarm::OnManifestRequest(uint64 sender, uint64 id, uint32 nonce) {
+	FOffered* o = offered.Find(id);
+	if (o == nullptr) {
+		SendBlockMessage(sender, UBERMUNDOPC_P2P_BlockMissing, id, EUbermundoP2PSendMode::Reliable);
+		return;
+	}
+	o->lastUsed = FPlatformTime::Seconds();
+	FUbermundoPacketBuilder b(UBERMUNDOPC_P2P_BlockManifest, 1 + 8 + 4 + 20 * (1 + o->chunkHashes.Num()));
+	b.AddInt64((int64)id).AddInt32(o->bytes.Num()).AddBytes(o->hash.Hash, 20);
+	for (const FSHAHash& h : o->chunkHashes)
+		b.AddBytes(h.Hash, 20);
+	// A resend of the same request resumes the same transfer, a new fetch gets a new one.
+	FUbermundoBulkTransfer::Get().Send(sender, b.GetPacket().View(), FCrc::MemCrc32(b.GetPacket().GetData(), b.Num(), nonce));
+}
+
+void FUbermundoBlockSwarm::OnManifest(uint64 sender, const uint8* data, int32 numBytes) {
+	if (numBytes < 1 + 8 + 4 + 20)
+		return;
+	FFetch* f = FindFetch(ReadU64(data + 1));
+	if (f == nullptr || f->haveManifest || sender != f->owner)
+		return;
+	uint32 total = ReadU32(data + 9);
+	int32 numChunks = ((int32)total + UBERMUNDO_SWARM_CHUNK - 1) / UBERMUNDO_SWARM_CHUNK;
+	if (total == 0 || total > UBERMUNDO_SWARM_MAX_BYTES || numBytes != 1 + 8 + 4 + 20 * (1 + numChunks)) {
+		UE_LOG(UberMundoSteamLog, Warning, TEXT("Swarm bad manifest for %s from 0x%llX N=%d"), *f->name, sender, numBytes);
+		return;
+	}
+
+	f->haveManifest = true;
+	f->lastProgress = FPlatformTime::Seconds();
+	f->totalBytes = total;
+	FMemory::Memcpy(f->hash.Hash, data + 13, 20);
+	f->chunkHashes.SetNum(numChunks);
+	for (int32 i = 0; i < numChunks; i++)
+		FMemory::Memcpy(f->chunkHashes[i].Hash, data + 33 + 20 * i, 20);
+	f->data.SetNumUninitialized((int32)total);
+	f->chunks.Init(EChunk::Missing, numChunks);
+	f->requestedFrom.Init(0, numChunks);
+	f->requestedAt.Init(0.0, numChunks);
+	f->tries.Init(0, numChunks);
+
+	uint32 version = VersionOf(f->hash);
+	for (const TPair<uint64, uint32>& kv : f->haves) {
+		if (kv.Value == version)
+			AddSource(*f, kv.Key);
+	}
+	f->haves.Empty();
+}
+
+void FUbermundoBlockSwarm::OnChunkRequest(uint64 sender, const uint8* data, int32 numBytes) {
+	if (numBytes < 1 + 8 + 1)
+		return;
+	uint64 id = ReadU64(data + 1);
+	FOffered* o = offered.Find(id);
+	if (o == nullptr) {
+		SendBlockMessage(sender, UBERMUNDOPC_P2P_BlockMissing, id, EUbermundoP2PSendMode::Reliable);
+		return;
+	}
+	o->lastUsed = FPlatformTime::Seconds();
+	int32 n = FMath::Min((int32)data[9], (numBytes - 10) / 2);
+	for (int32 k = 0; k < n; k++) {
+		int32 index = ReadU16(data + 10 + 2 * k);
+		if (index >= o->chunkHashes.Num())
+			continue;
+		int32 size = ChunkSize(o->bytes.Num(), index);
+		FUbermundoPacketBuilder b(UBERMUNDOPC_P2P_BlockChunk, UBERMUNDO_SWARM_CHUNK_HEADER + size);
+		b.AddInt64((int64)id).AddInt16((int16)index).AddBytes(o->bytes.GetData() + index * UBERMUNDO_SWARM_CHUNK, size);
+		FUbermundoP2POutbox::Get().Queue(sender, b.GetPacket().View(), EUbermundoP2PSendMode::UnreliableBulk);
+	}
+}
+
+void FUbermundoBlockSwarm::OnChunk(uint64 sender, const uint8* data, int32 numBytes) {
+	if (numBytes <= UBERMUNDO_SWARM_CHUNK_HEADER)
+		return;
+	uint64 id = ReadU64(data + 1);
+	int32 fi = fetches.IndexOfByPredicate([id](const FFetch& x) { return x.id == id; });
+	if (fi == INDEX_NONE || !fetches[fi].haveManifest)
+		return;
+	FFetch& f = fetches[fi];
+	int32 index = ReadU16(data + 9);
+	int32 n = numBytes - UBERMUNDO_SWARM_CHUNK_HEADER;
+	if (index >= f.chunks.Num() || n != ChunkSize((int32)f.totalBytes, index) || f.chunks[index] == EChunk::Have)
+		return; // A late copy of one we already have.
+
+	const uint8* bytes = data + UBERMUNDO_SWARM_CHUNK_HEADER;
+	FSource* s = FindSource(f, sender);
+	bool askedOfSender = f.chunks[index] == EChunk::Requested && f.requestedFrom[index] == sender;
+	if (HashChunk(bytes, n) != f.chunkHashes[index]) {
+		UE_LOG(UberMundoSteamLog, Warning, TEXT("Swarm chunk %d of %s from 0x%llX failed its hash"), index, *f.name, sender);
+		if (askedOfSender) {
+			RequestFailed(f, index);
+			if (s)
+				s->inFlight--;
+		}
+		if (s && !s->owner && ++s->badChunks >= UBERMUNDO_SWARM_MAX_BAD)
+			DropSource(f, sender);
+		return;
+	}
+
+	// It may have come from whoever it was asked of before it timed out, the one asked now is off the hook.
+	if (f.chunks[index] == EChunk::Requested) {
+		if (FSource* asked = FindSource(f, f.requestedFrom[index]))
+			asked->inFlight--;
+	}
+	FMemory::Memcpy(f.data.GetData() + index * UBERMUNDO_SWARM_CHUNK, bytes, n);
+	f.chunks[index] = EChunk::Have;
+	f.numHave++;
+	f.lastProgress = FPlatformTime::Seconds();
+	if (s) {
+		s->bytesReceived += n;
+		s->window += s->window < 16.0f ? 1.0f : 1.0f / s->window;
+		s->window = FMath::Min(s->window, UBERMUNDO_SWARM_MAX_WINDOW);
+	}
+	if (f.numHave < f.chunks.Num())
+		return;
+
+	if (HashChunk(f.data.GetData(), f.data.Num()) != f.hash) {
+		// Every chunk matched the owner's manifest, so it is the manifest that is wrong.
+		Finish(fi, false, TEXT("The block did not match its manifest."));
+		return;
+	}
+	Finish(fi, true, FString());
+}
+
+void FUbermundoBlockSwarm::OnMissing(uint64 sender, uint64 id) {
+	int32 fi = fetches.IndexOfByPredicate([id](const FFetch& x) { return x.id == id; });
+	if (fi == INDEX_NONE)
+		return;
+	if (sender == fetches[fi].owner) {
+		Finish(fi, false, TEXT("The owner does not have the block."));
+		return;
+	}
+	DropSource(fetches[fi], sender);
+}
+
+void FUbermundoBlockSwarm::ForgetPeer(uint64 peer) {
+	for (int32 fi = fetches.Num() - 1; fi >= 0; fi--) {
+		if (fetches[fi].owner == peer) {
+			// Without the owner there is nobody to fall back on, but what the others have may still be enough.
+			if (!fetches[fi].haveManifest) {
+				Finish(fi, false, TEXT("Lost the connection to the owner."));
+				continue;
+			}
+		}
+		DropSource(fetches[fi], peer);
+		// Dropped for good only if they sent bad data or said no. A reconnect may bring them back.
+		fetches[fi].dropped.Remove(peer);
+		// The owner is never asked again, so chunks only it could send now never come.
+		if (fetches[fi].owner == peer && IsStranded(fetches[fi]))
+			Finish(fi, false, TEXT("Lost the connection to the owner, and some chunks only the owner could send."));
+	}
+}
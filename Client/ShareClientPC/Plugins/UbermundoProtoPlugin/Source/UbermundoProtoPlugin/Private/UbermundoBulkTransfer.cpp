@@ -0,0 +1,370 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+
+#include "UbermundoBulkTransfer.h"
+#include "SteamCustomCode.h"
+#include "UbermundoP2POutbox.h"
+#include "UbermundoRateControl.h"
+
+/** Most chunks in flight to one peer per transfer. */
+#define UBERMUNDO_BULK_MAX_WINDOW 512.0f
+/** A chunk this many places behind one that was acked is taken as lost, without waiting for the timeout. */
+#define UBERMUNDO_BULK_REORDER 3
+/** How long a finished or failed outgoing transfer stays around for GetProgress. */
+#define UBERMUNDO_BULK_DONE_SECONDS 60.0
+
+static uint32 ReadU32(const uint8* p) {
+	return ((uint32)p[0] << 24) | ((uint32)p[1] << 16) | ((uint32)p[2] << 8) | p[3];
+}
+
+static uint16 ReadU16(const uint8* p) {
+	return (uint16)((p[0] << 8) | p[1]);
+}
+
+// --------------------------------------------------------------------------------- FUbermundoBulkTransfer
+FUbermundoBulkTransfer& FUbermundoBulkTransfer::Get() {
+	static FUbermundoBulkTransfer transfer;
+	return transfer;
+}
+
+int32 FUbermundoBulkTransfer::ChunkSize(int32 totalBytes, int32 index) {
+	return FMath::Min(UBERMUNDO_BULK_CHUNK, totalBytes - index * UBERMUNDO_BULK_CHUNK);
+}
+
+uint32 FUbermundoBulkTransfer::Send(uint64 peer, TArrayView<const uint8> payload) {
+	return Send(peer, payload, FCrc::MemCrc32(payload.GetData(), payload.Num()));
+}
+
+uint32 FUbermundoBulkTransfer::Send(uint64 peer, TArrayView<const uint8> payload, uint32 id) {
+	if (payload.Num() == 0 || payload.Num() > UBERMUNDO_BULK_MAX_BYTES) {
+		UE_LOG(UberMundoSteamLog, Warning, TEXT("Bulk Send to 0x%llX N=%d, must be 1 to %d bytes"), peer, payload.Num(), UBERMUNDO_BULK_MAX_BYTES);
+		return 0;
+	}
+	// 0 means failed to callers.
+	if (id == 0)
+		id = 1;
+
+	TArray<FOutgoing>& list = outgoing.FindOrAdd(peer);
+	for (FOutgoing& t : list) {
+		if (t.id == id && t.doneAt == 0.0)
+			return id; // Already on its way.
+	}
+	list.RemoveAll([id](const FOutgoing& t) { return t.id == id; });
+
+	FOutgoing& t = list.AddDefaulted_GetRef();
+	t.id = id;
+	t.payload = FUbermundoPacketBufferPool::Get().Acquire(payload.Num());
+	t.payload.GetMutableBytes().Append(payload.GetData(), payload.Num());
+	t.numChunks = (payload.Num() + UBERMUNDO_BULK_CHUNK - 1) / UBERMUNDO_BULK_CHUNK;
+	t.acked.Init(false, t.numChunks);
+	t.sentAt.SetNumZeroed(t.numChunks);
+	UE_LOG(UberMundoSteamLog, Verbose, TEXT("Bulk Send to 0x%llX id %08X N=%d chunks %d"), peer, id, payload.Num(), t.numChunks);
+	return id;
+}
+
+void FUbermundoBulkTransfer::Cancel(uint64 peer, uint32 id) {
+	if (TArray<FOutgoing>* list = outgoing.Find(peer))
+		list->RemoveAll([id](const FOutgoing& t) { return t.id == id; });
+}
+
+bool FUbermundoBulkTransfer::SendChunk(uint64 peer, const FOutgoing& t, int32 index) {
+	int32 n = ChunkSize(t.payload.Num(), index);
+	FUbermundoPacketBuilder b(UBERMUNDOPC_P2P_BulkChunk, UBERMUNDO_BULK_HEADER + n);
+	b.AddInt32((int32)t.id).AddInt32(t.payload.Num()).AddInt16((int16)index);
+	b.AddBytes(t.payload.GetData() + index * UBERMUNDO_BULK_CHUNK, n);
+	return FUbermundoP2POutbox::Get().Queue(peer, b.GetPacket().View(), EUbermundoP2PSendMode::UnreliableBulk);
+}
+
+void FUbermundoBulkTransfer::Tick(double now) {
+	FUbermundoRateController& rate = FUbermundoRateController::Get();
+	for (auto peerIt = outgoing.CreateIterator(); peerIt; ++peerIt) {
+		uint64 peer = peerIt.Key();
+		TArray<FOutgoing>& list = peerIt.Value();
+		list.RemoveAll([now](const FOutgoing& t) { return t.doneAt != 0.0 && now - t.doneAt > UBERMUNDO_BULK_DONE_SECONDS; });
+		if (list.Num() == 0) {
+			peerIt.RemoveCurrent();
+			continue;
+		}
+
+		FUbermundoLinkStats link;
+		double rtt = 0.2;
+		double rto = 0.5;
+		if (rate.GetLinkStats(peer, link) && link.RttMs > 0.0f) {
+			rtt = link.RttMs / 1000.0;
+			rto = FMath::Max(0.1, rtt + 4.0 * link.RttVarMs / 1000.0);
+		}
+		// Oldest first, and only as many at once as the receiver takes, see CanAcceptIncoming. Chunks of any
+		// more would be dropped there, so a new transfer waits for the ones before it.
+		int32 numActive = 0;
+		uint64 activeBytes = 0;
+		for (FOutgoing& t : list) {
+			if (t.doneAt != 0.0)
+				continue;
+			activeBytes += t.payload.Num();
+			if (numActive >= UBERMUNDO_BULK_MAX_INCOMING || (numActive > 0 && activeBytes > UBERMUNDO_BULK_MAX_INCOMING_BYTES))
+				break;
+			numActive++;
+			if (rate.ShouldDeferBulk(peer) || FUbermundoP2POutbox::Get().GetDeferredBytes(peer) > 0)
+				break;
+			TickOutgoing(peer, t, now, rto, rtt);
+		}
+	}
+
+	for (auto peerIt = incoming.CreateIterator(); peerIt; ++peerIt) {
+		for (auto it = peerIt.Value().CreateIterator(); it; ++it) {
+			FIncoming& in = it.Value();
+			if (in.ackDue) {
+				SendAck(peerIt.Key(), it.Key(), in);
+				in.ackDue = false;
+			}
+			if (now - in.lastActivity > UBERMUNDO_BULK_KEEP_SECONDS)
+				it.RemoveCurrent();
+		}
+		if (peerIt.Value().Num() == 0)
+			peerIt.RemoveCurrent();
+	}
+}
+
+void FUbermundoBulkTransfer::TickOutgoing(uint64 peer, FOutgoing& t, double now, double rto, double rtt) {
+	// What is still in flight, and which holes need filling.
+	int32 inFlight = 0;
+	bool lost = false;
+	bool timedOut = false;
+	TArray<int32, TInlineAllocator<64>> resend;
+	for (int32 i = t.firstUnacked; i < t.nextNew; i++) {
+		if (t.acked[i])
+			continue;
+		double age = now - t.sentAt[i];
+		// Overtaken by later acked chunks, but give a resent one a round trip before judging it again.
+		bool overtaken = t.highestAcked >= i + UBERMUNDO_BULK_REORDER && age > rtt;
+		if (age > rto || overtaken) {
+			resend.Add(i);
+			lost = true;
+			timedOut |= age > rto;
+		}
+		else {
+			inFlight++;
+		}
+	}
+
+	if (timedOut && now - t.lastTimeout > rto) {
+		t.lastTimeout = now;
+		// Nothing acked for that long, the peer has most likely gone.
+		if (++t.numTimeouts > UBERMUNDO_BULK_MAX_TIMEOUTS) {
+			UE_LOG(UberMundoSteamLog, Warning, TEXT("Bulk to 0x%llX id %08X failed, no ack after %d timeouts, %d of %d chunks acked"),
+				peer, t.id, UBERMUNDO_BULK_MAX_TIMEOUTS, t.numAcked, t.numChunks);
+			t.failed = true;
+			t.doneAt = now;
+			t.payload.Reset();
+			return;
+		}
+	}
+
+	if (lost && now - t.lastCut > rtt) {
+		t.window = FMath::Max(2.0f, t.window * 0.5f);
+		t.slowStart = false;
+		t.lastCut = now;
+	}
+
+	int32 room = (int32)t.window - inFlight;
+	for (int32 i : resend) {
+		if (room <= 0)
+			return;
+		SendChunk(peer, t, i);
+		t.sentAt[i] = now;
+		room--;
+	}
+	while (room > 0 && t.nextNew < t.numChunks) {
+		int32 i = t.nextNew++;
+		if (t.acked[i])
+			continue; // The receiver had it from an earlier try.
+		SendChunk(peer, t, i);
+		t.sentAt[i] = now;
+		room--;
+	}
+}
+
+void FUbermundoBulkTransfer::SendAck(uint64 peer, uint32 id, const FIncoming& in) {
+	uint8 bitmap[UBERMUNDO_BULK_ACK_BITMAP];
+	int32 bitmapBytes = 0;
+	if (!in.complete) {
+		int32 from = in.inOrder + 1;
+		int32 to = FMath::Min(in.numChunks, from + UBERMUNDO_BULK_ACK_BITMAP * 8);
+		FMemory::Memzero(bitmap);
+		for (int32 i = from; i < to; i++) {
+			if (in.have[i]) {
+				bitmap[(i - from) >> 3] |= 1 << ((i - from) & 7);
+				bitmapBytes = ((i - from) >> 3) + 1;
+			}
+		}
+	}
+	FUbermundoPacketBuilder b(UBERMUNDOPC_P2P_BulkAck, 1 + 4 + 2 + 1 + bitmapBytes);
+	b.AddInt32((int32)id).AddInt16((int16)in.inOrder).AddByte((uint8)bitmapBytes).AddBytes(bitmap, bitmapBytes);
+	FUbermundoP2POutbox::Get().Queue(peer, b.GetPacket().View(), EUbermundoP2PSendMode::UnreliableNoDelay);
+}
+
+bool FUbermundoBulkTransfer::OnChunk(uint64 sender, const uint8* data, int32 numBytes, TArray<uint8>& completed) {
+	if (numBytes <= UBERMUNDO_BULK_HEADER)
+		return false;
+	uint32 id = ReadU32(data + 1);
+	uint32 total = ReadU32(data + 5);
+	int32 index = ReadU16(data + 9);
+	int32 n = numBytes - UBERMUNDO_BULK_HEADER;
+	if (total == 0 || total > UBERMUNDO_BULK_MAX_BYTES)
+		return false;
+	int32 numChunks = ((int32)total + UBERMUNDO_BULK_CHUNK - 1) / UBERMUNDO_BULK_CHUNK;
+	if (index >= numChunks || n != ChunkSize((int32)total, index)) {
+		UE_LOG(UberMundoSteamLog, Warning, TEXT("Bulk bad chunk from 0x%llX id %08X index %d N=%d"), sender, id, index, n);
+		return false;
+	}
+
+	FIncoming* found = nullptr;
+	if (TMap<uint32, FIncoming>* map = incoming.Find(sender))
+		found = map->Find(id);
+	if (found == nullptr || found->totalBytes != total) {
+		// Nothing is allocated, and no entry made, for a transfer over the sender's limits.
+		if (!CanAcceptIncoming(sender, id, total)) {
+			UE_LOG(UberMundoSteamLog, Verbose, TEXT("Bulk from 0x%llX id %08X N=%u refused, too many or too big"), sender, id, total);
+			return false;
+		}
+	}
+
+	FIncoming& in = found != nullptr ? *found : incoming.FindOrAdd(sender).Add(id);
+	in.lastActivity = FPlatformTime::Seconds();
+	in.ackDue = true;
+	if (in.totalBytes != total) {
+		// New, or a different message that happens to have the same id. Start over.
+		in = FIncoming();
+		in.lastActivity = FPlatformTime::Seconds();
+		in.ackDue = true;
+		in.totalBytes = total;
+		in.numChunks = numChunks;
+		in.data.SetNumUninitialized((int32)total);
+		in.have.Init(false, numChunks);
+	}
+	if (in.complete || in.have[index])
+		return false; // Our ack got lost, the one going out now says we have it all.
+
+	FMemory::Memcpy(in.data.GetData() + index * UBERMUNDO_BULK_CHUNK, data + UBERMUNDO_BULK_HEADER, n);
+	in.have[index] = true;
+	in.numHave++;
+	while (in.inOrder < in.numChunks && in.have[in.inOrder])
+		in.inOrder++;
+	if (in.numHave < in.numChunks)
+		return false;
+
+	// Keep the entry, without its bytes, to answer resends with a full ack.
+	in.complete = true;
+	completed = MoveTemp(in.data);
+	in.data.Empty();
+	in.have.Empty();
+	UE_LOG(UberMundoSteamLog, Verbose, TEXT("Bulk from 0x%llX id %08X complete N=%u"), sender, id, total);
+	return true;
+}
+
+bool FUbermundoBulkTransfer::CanAcceptIncoming(uint64 sender, uint32 id, uint32 totalBytes) const {
+	const TMap<uint32, FIncoming>* map = incoming.Find(sender);
+	if (map == nullptr)
+		return true;
+	int32 count = 0;
+	uint64 bytes = totalBytes;
+	for (const TPair<uint32, FIncoming>& kv : *map) {
+		// Finished ones keep no bytes, and the one with this id is about to be replaced.
+		if (kv.Key == id || kv.Value.complete)
+			continue;
+		count++;
+		bytes += kv.Value.totalBytes;
+	}
+	return count < UBERMUNDO_BULK_MAX_INCOMING && bytes <= UBERMUNDO_BULK_MAX_INCOMING_BYTES;
+}
+
+void FUbermundoBulkTransfer::OnAck(uint64 peer, const uint8* data, int32 numBytes) {
+	if (numBytes < 8)
+		return;
+	uint32 id = ReadU32(data + 1);
+	int32 inOrder = ReadU16(data + 5);
+	int32 bitmapBytes = FMath::Min((int32)data[7], numBytes - 8);
+	TArray<FOutgoing>* list = outgoing.Find(peer);
+	if (list == nullptr)
+		return;
+	FOutgoing* t = list->FindByPredicate([id](const FOutgoing& o) { return o.id == id; });
+	if (t == nullptr || t->doneAt != 0.0)
+		return;
+
+	int32 newlyAcked = 0;
+	auto ack = [t, &newlyAcked](int32 i) {
+		if (i < t->numChunks && !t->acked[i]) {
+			t->acked[i] = true;
+			t->numAcked++;
+			t->highestAcked = FMath::Max(t->highestAcked, i);
+			newlyAcked++;
+		}
+	};
+	for (int32 i = t->firstUnacked; i < FMath::Min(inOrder, t->numChunks); i++)
+		ack(i);
+	const uint8* bitmap = data + 8;
+	for (int32 b = 0; b < bitmapBytes * 8; b++) {
+		if (bitmap[b >> 3] & (1 << (b & 7)))
+			ack(inOrder + 1 + b);
+	}
+	while (t->firstUnacked < t->numChunks && t->acked[t->firstUnacked])
+		t->firstUnacked++;
+	if (newlyAcked > 0)
+		t->numTimeouts = 0;
+
+	// A chunk the receiver already had from before counts as acked without ever being sent this time.
+	t->nextNew = FMath::Max(t->nextNew, t->firstUnacked);
+	if (t->slowStart)
+		t->window += newlyAcked;
+	else if (newlyAcked > 0)
+		t->window += (float)newlyAcked / t->window;
+	t->window = FMath::Min(t->window, UBERMUNDO_BULK_MAX_WINDOW);
+
+	if (t->numAcked == t->numChunks) {
+		t->doneAt = FPlatformTime::Seconds();
+		t->payload.Reset();
+		UE_LOG(UberMundoSteamLog, Verbose, TEXT("Bulk to 0x%llX id %08X complete"), peer, id);
+	}
+}
+
+float FUbermundoBulkTransfer::GetProgress(uint64 peer, uint32 id, bool isOutgoing) const {
+	if (isOutgoing) {
+		if (const TArray<FOutgoing>* list = outgoing.Find(peer)) {
+			if (const FOutgoing* t = list->FindByPredicate([id](const FOutgoing& o) { return o.id == id; }))
+				return t->failed ? -1.0f : (float)t->numAcked / t->numChunks;
+		}
+		return -1.0f;
+	}
+	if (const TMap<uint32, FIncoming>* map = incoming.Find(peer)) {
+		if (const FIncoming* in = map->Find(id))
+			return in->complete ? 1.0f : (float)in->numHave / in->numChunks;
+	}
+	return -1.0f;
+}
+
+int32 FUbermundoBulkTransfer::NumOutgoing() const {
+	int32 n = 0;
+	for (const TPair<uint64, TArray<FOutgoing>>& kv : outgoing) {
+		for (const FOutgoing& t : kv.Value)
+			n += t.doneAt == 0.0 ? 1 : 0;
+	}
+	return n;
+}
+
+void FUbermundoBulkTransfer::ForgetPeer(uint64 peer) {
+	// Incoming transfers are kept, they are what makes resuming after a reconnect work.
+	outgoing.Remove(peer);
+}
+
+// --------------------------------------------------------------------------------- UUbermundoBulkTransferLibrary
+int64 UUbermundoBulkTransferLibrary::SendBulkP2P(int64 targetUserSteamId, const TArray<uint8>& bytes) {
+	return FUbermundoBulkTransfer::Get().Send((uint64)targetUserSteamId, bytes);
+}
+
+float UUbermundoBulkTransferLibrary::GetBulkP2PProgress(int64 peer, int64 transferId, bool outgoing) {
+	return FUbermundoBulkTransfer::Get().GetProgress((uint64)peer, (uint32)transferId, outgoing);
+}
+
+void UUbermundoBulkTransferLibrary::CancelBulkP2P(int64 targetUserSteamId, int64 transferId) {
+	FUbermundoBulkTransfer::Get().Cancel((uint64)targetUserSteamId, (uint32)transferId);
+}
@@ -0,0 +1,202 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+
+#include "UbermundoClockSync.h"
+#include "SteamCustomCode.h"
+#include "UbermundoPacketCodes.h"
+#include "UbermundoP2POutbox.h"
+
+/** Synced once this many samples are in. */
+#define UBERMUNDO_CLOCK_MIN_SAMPLES 4
+/** Shortest gap between two trusted offsets that drift is measured over, seconds. Shorter and the offset noise swamps it. */
+#define UBERMUNDO_CLOCK_DRIFT_SPAN 20.0
+
+static uint64 ToMicros(double seconds) {
+	return (uint64)FMath::Max(seconds * 1000000.0, 0.0);
+}
+
+static double FromMicros(uint64 micros) {
+	return micros / 1000000.0;
+}
+
+static uint64 ReadU64(const uint8* p) {
+	uint64 v = 0;
+	for (int32 i = 0; i < 8; i++)
+		v = (v << 8) | p[i];
+	return v;
+}
+
+// --------------------------------------------------------------------------------- FUbermundoClockSync
+FUbermundoClockSync& FUbermundoClockSync::Get() {
+	static FUbermundoClockSync sync;
+	return sync;
+}
+
+void FUbermundoClockSync::OnHeard(uint64 peer, double now) {
+	FPeer* p = peers.Find(peer);
+	if (p == nullptr) {
+		p = &peers.Add(peer);
+		p->nextPing = now;
+	}
+	p->lastHeard = now;
+}
+
+void FUbermundoClockSync::Tick(double now) {
+	FUbermundoP2POutbox& outbox = FUbermundoP2POutbox::Get();
+	for (TPair<uint64, FPeer>& kv : peers) {
+		FPeer& p = kv.Value;
+		if (now < p.nextPing || now - p.lastHeard > UBERMUNDO_CLOCK_IDLE)
+			continue;
+		FUbermundoPacketBuilder b(UBERMUNDOPC_P2P_ClockPing, 1 + 8);
+		b.AddInt64((int64)ToMicros(now));
+		outbox.Queue(kv.Key, b.GetPacket().View(), EUbermundoP2PSendMode::UnreliableNoDelay);
+		p.nextPing = now + (p.numSamples < UBERMUNDO_CLOCK_MIN_SAMPLES ? UBERMUNDO_CLOCK_FAST_POLL : UBERMUNDO_CLOCK_POLL);
+	}
+}
+
+bool FUbermundoClockSync::HandlePacket(uint64 sender, const uint8* data, int32 numBytes, double now) {
+	if (numBytes <= 0)
+		return false;
+	switch (data[0]) {
+	case UBERMUNDOPC_P2P_ClockPing:
+		if (numBytes >= 1 + 8) {
+			// Their time back, with ours on arrival and on the way out. Both are now, the pong is
+			// queued this tick; the wait for the flush is as much part of the round trip as theirs is.
+			FUbermundoPacketBuilder b(UBERMUNDOPC_P2P_ClockPong, 1 + 3 * 8);
+			b.AddBytes(data + 1, 8);
+			b.AddInt64((int64)ToMicros(now));
+			b.AddInt64((int64)ToMicros(FPlatformTime::Seconds()));
+			FUbermundoP2POutbox::Get().Queue(sender, b.GetPacket().View(), EUbermundoP2PSendMode::UnreliableNoDelay);
+		}
+		return true;
+	case UBERMUNDOPC_P2P_ClockPong:
+		if (numBytes >= 1 + 3 * 8)
+			OnPong(sender, ReadU64(data + 1), ReadU64(data + 9), ReadU64(data + 17), now);
+		return true;
+	default:
+		return false;
+	}
+}
+
+void FUbermundoClockSync::OnPong(uint64 sender, uint64 t0, uint64 t1, uint64 t2, double now) {
+	FPeer* found = peers.Find(sender);
+	if (found == nullptr)
+		return;
+	FPeer& p = *found;
+	double sent = FromMicros(t0);
+	double theirIn = FromMicros(t1);
+	double theirOut = FromMicros(t2);
+	double rtt = (now - sent) - (theirOut - theirIn);
+	if (rtt < 0.0 || now - sent > UBERMUNDO_CLOCK_IDLE)
+		return; // Not one of ours, or from long ago.
+
+	FSample& s = p.samples[p.nextSample];
+	s.localTime = now;
+	s.offset = ((theirIn - sent) + (theirOut - now)) / 2.0;
+	s.rtt = rtt;
+	p.nextSample = (p.nextSample + 1) % UBERMUNDO_CLOCK_SAMPLES;
+	p.numSamples = FMath::Min(p.numSamples + 1, UBERMUNDO_CLOCK_SAMPLES);
+
+	// Trust the quickest round trip, it had the least queueing on one side only.
+	const FSample* best = &p.samples[0];
+	for (int32 i = 1; i < p.numSamples; i++) {
+		if (p.samples[i].rtt < best->rtt)
+			best = &p.samples[i];
+	}
+	if (p.synced && best->localTime <= p.refTime)
+		return; // Nothing better than what the estimate already rests on.
+
+	if (p.synced && best->localTime - p.refTime >= UBERMUNDO_CLOCK_DRIFT_SPAN) {
+		double measured = (best->offset - p.refOffset) / (best->localTime - p.refTime);
+		double maxDrift = UBERMUNDO_CLOCK_MAX_DRIFT_PPM / 1000000.0;
+		p.drift = FMath::Clamp(p.drift + (measured - p.drift) / 4.0, -maxDrift, maxDrift);
+	}
+	if (!p.synced || best->localTime - p.refTime >= UBERMUNDO_CLOCK_DRIFT_SPAN || best->rtt < p.refRtt) {
+		p.refTime = best->localTime;
+		p.refOffset = best->offset;
+		p.refRtt = best->rtt;
+	}
+	p.synced = p.numSamples >= UBERMUNDO_CLOCK_MIN_SAMPLES;
+}
+
+bool FUbermundoClockSync::GetOffset(uint64 peer, double now, double& offset) const {
+	offset = 0.0;
+	const FPeer* p = peers.Find(peer);
+	if (p == nullptr || p->numSamples == 0 || p->refTime <= 0.0)
+		return false;
+	offset = Offset(*p, now);
+	return true;
+}
+
+double FUbermundoClockSync::RemoteToLocal(uint64 peer, double remoteTime) const {
+	double offset;
+	GetOffset(peer, remoteTime, offset);
+	return remoteTime - offset;
+}
+
+double FUbermundoClockSync::LocalToRemote(uint64 peer, double localTime) const {
+	double offset;
+	GetOffset(peer, localTime, offset);
+	return localTime + offset;
+}
+
+uint64 FUbermundoClockSync::GetReferencePeer() const {
+	uint64 reference = USteamCustomCode::GetTransport().GetLocalId();
+	for (const TPair<uint64, FPeer>& kv : peers) {
+		if (kv.Value.synced && (reference == 0 || kv.Key < reference))
+			reference = kv.Key;
+	}
+	return reference;
+}
+
+double FUbermundoClockSync::LocalToShared(double localTime) const {
+	return LocalToRemote(GetReferencePeer(), localTime);
+}
+
+double FUbermundoClockSync::SharedToLocal(double sharedTime) const {
+	return RemoteToLocal(GetReferencePeer(), sharedTime);
+}
+
+uint32 FUbermundoClockSync::GetSharedTimeMs() const {
+	return (uint32)(uint64)(GetSharedTime() * 1000.0);
+}
+
+double FUbermundoClockSync::SharedMsToLocal(uint32 stamp) const {
+	double shared = GetSharedTime();
+	int32 delta = (int32)(stamp - (uint32)(uint64)(shared * 1000.0));
+	return SharedToLocal(shared + delta / 1000.0);
+}
+
+bool FUbermundoClockSync::GetStats(uint64 peer, FUbermundoClockStats& out) const {
+	out = FUbermundoClockStats();
+	const FPeer* p = peers.Find(peer);
+	if (p == nullptr || p->numSamples == 0)
+		return false;
+	out.Synced = p->synced;
+	out.OffsetMs = (float)(Offset(*p, FPlatformTime::Seconds()) * 1000.0);
+	out.RttMs = (float)(p->refRtt * 1000.0);
+	out.DriftPpm = (float)(p->drift * 1000000.0);
+	out.NumSamples = p->numSamples;
+	return true;
+}
+
+void FUbermundoClockSync::ForgetPeer(uint64 peer) {
+	peers.Remove(peer);
+}
+
+// --------------------------------------------------------------------------------- UUbermundoClockSyncLibrary
+int32 UUbermundoClockSyncLibrary::GetSharedTimeMs() {
+	return (int32)FUbermundoClockSync::Get().GetSharedTimeMs();
+}
+
+float UUbermundoClockSyncLibrary::GetSharedTimeAgeMs(int32 stamp) {
+	return (float)((FPlatformTime::Seconds() - FUbermundoClockSync::Get().SharedMsToLocal((uint32)stamp)) * 1000.0);
+}
+
+int64 UUbermundoClockSyncLibrary::GetClockReferencePeer() {
+	return (int64)FUbermundoClockSync::Get().GetReferencePeer();
+}
+
+bool UUbermundoClockSyncLibrary::GetPeerClockStats(int64 peer, FUbermundoClockStats& stats) {
+	return FUbermundoClockSync::Get().GetStats((uint64)peer, stats);
+}
@@ -0,0 +1,60 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+
+#include "UbermundoDeadReckoning.h"
+#include "SteamCustomCode.h"
+#include "UbermundoJitterBuffer.h"
+
+// --------------------------------------------------------------------------------- FUbermundoDeadReckoning
+FUbermundoDeadReckoning& FUbermundoDeadReckoning::Get() {
+	static FUbermundoDeadReckoning reckoning;
+	return reckoning;
+}
+
+bool FUbermundoDeadReckoning::ShouldSend(uint64 peer, const FUbermundoPlayer3DState& state, double now) {
+	FQuat rotation = state.Rotation.Quaternion();
+	FSent* s = lastSent.Find(peer);
+	if (settings.Enabled && s != nullptr) {
+		bool heartbeat = now - s->sentAt >= settings.HeartbeatSeconds;
+		// What the jitter buffer over there makes of our last state by now, on our clock as it does. Past
+		// MaxExtrapolationMs it holds us still, which is what brings a steady mover's next state due.
+		float maxAheadMs = FUbermundoJitterBuffer::Get().GetSettings().MaxExtrapolationMs;
+		float aheadMs = FMath::Clamp((float)(int32)((uint32)state.TimestampMs - (uint32)s->timestampMs), 0.0f, maxAheadMs);
+		FVector predicted = s->location + s->velocity * (aheadMs / 1000.0f);
+		bool off = FVector::DistSquared(predicted, state.Location) > FMath::Square(settings.PositionErrorCm)
+			|| FMath::RadiansToDegrees(s->rotation.AngularDistance(rotation)) > settings.RotationErrorDegrees
+			|| (settings.VelocityErrorCmPerSec > 0.0f && FVector::DistSquared(s->velocity, state.Velocity) > FMath::Square(settings.VelocityErrorCmPerSec));
+		if (!off && !heartbeat) {
+			stats.NumSkipped++;
+			return false;
+		}
+		if (!off)
+			stats.NumHeartbeats++;
+	}
+	if (s == nullptr)
+		s = &lastSent.Add(peer);
+	s->location = state.Location;
+	s->velocity = state.Velocity;
+	s->rotation = rotation;
+	s->timestampMs = state.TimestampMs;
+	s->sentAt = now;
+	stats.NumSent++;
+	return true;
+}
+
+void FUbermundoDeadReckoning::ForgetPeer(uint64 peer) {
+	lastSent.Remove(peer);
+}
+
+// --------------------------------------------------------------------------------- UUbermundoDeadReckoningLibrary
+void UUbermundoDeadReckoningLibrary::SetDeadReckoningSettings(const FUbermundoDeadReckoningSettings& settings) {
+	FUbermundoDeadReckoning::Get().SetSettings(settings);
+}
+
+void UUbermundoDeadReckoningLibrary::GetDeadReckoningStats(FUbermundoDeadReckoningStats& stats) {
+	stats = FUbermundoDeadReckoning::Get().GetStats();
+}
+
+void UUbermundoDeadReckoningLibrary::ResetDeadReckoningStats() {
+	FUbermundoDeadReckoning::Get().ResetStats();
+}
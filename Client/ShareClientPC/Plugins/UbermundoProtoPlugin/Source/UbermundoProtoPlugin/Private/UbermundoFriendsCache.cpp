@@ -0,0 +1,149 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+
+#include "UbermundoFriendsCache.h"
+
+// --------------------------------------------------------------------------------- FUbermundoFriendsCache
+FUbermundoFriendsCache& FUbermundoFriendsCache::Get() {
+	static FUbermundoFriendsCache cache;
+	return cache;
+}
+
+void FUbermundoFriendsCache::SetFlags(int32 friendFlags) {
+	FScopeLock scope(&lock);
+	flags = friendFlags;
+	stale = true;
+}
+
+void FUbermundoFriendsCache::Invalidate() {
+	FScopeLock scope(&lock);
+	stale = true;
+}
+
+void FUbermundoFriendsCache::OnPersonaStateChange(uint64 steamId, int32 changeFlags) {
+	FScopeLock scope(&lock);
+	// Someone became or stopped being a friend, only a new list tells who is in it now.
+	if ((changeFlags & k_EPersonaChangeRelationshipChanged) != 0)
+		stale = true;
+	else if (indexOf.Contains(steamId))
+		changed.Add(steamId);
+}
+
+bool FUbermundoFriendsCache::Snapshot(int32 sinceVersion, TArray<FUbermundoFriend>& out, int32& outVersion) {
+	bool refetch;
+	{
+		FScopeLock scope(&lock);
+		refetch = stale;
+	}
+	if (refetch)
+		Refetch();
+	else
+		ApplyChanges();
+
+	FScopeLock scope(&lock);
+	outVersion = version;
+	if (sinceVersion == version)
+		return false;
+	out = friends;
+	return true;
+}
+
+int32 FUbermundoFriendsCache::GetVersion() const {
+	FScopeLock scope(&lock);
+	return version;
+}
+
+void FUbermundoFriendsCache::Reset() {
+	FScopeLock scope(&lock);
+	friends.Reset();
+	indexOf.Reset();
+	changed.Reset();
+	version++;
+	stale = true;
+}
+
+void FUbermundoFriendsCache::Read(uint64 steamId, FUbermundoFriend& out) {
+	ISteamFriends* sf = SteamFriends();
+	CSteamID id(steamId);
+	out.SteamId = (int64)steamId;
+	out.Name = UTF8_TO_TCHAR(sf->GetFriendPersonaName(id));
+	out.PersonaState = (EPersonaStateUM)sf->GetFriendPersonaState(id);
+	FriendGameInfo_t game;
+	out.InGame = sf->GetFriendGamePlayed(id, &game);
+	out.InThisGame = out.InGame && SteamUtils() != nullptr && game.m_gameID.AppID() == SteamUtils()->GetAppID();
+}
+
+void FUbermundoFriendsCache::Refetch() {
+	int32 friendFlags;
+	{
+		FScopeLock scope(&lock);
+		friendFlags = flags;
+		stale = false;
+		changed.Reset();
+	}
+	// Steam is asked outside the lock, so a callback on the network thread never waits on it.
+	TArray<FUbermundoFriend> fresh;
+	if (SteamAPI_IsSteamRunning() && SteamFriends() != nullptr) {
+		int32 n = FMath::Max(SteamFriends()->GetFriendCount(friendFlags), 0);
+		fresh.SetNum(n);
+		for (int32 i = 0; i < n; i++)
+			Read(SteamFriends()->GetFriendByIndex(i, friendFlags).ConvertToUint64(), fresh[i]);
+	}
+
+	FScopeLock scope(&lock);
+	friends = MoveTemp(fresh);
+	indexOf.Reset();
+	for (int32 i = 0; i < friends.Num(); i++)
+		indexOf.Add((uint64)friends[i].SteamId, i);
+	version++;
+}
+
+void FUbermundoFriendsCache::ApplyChanges() {
+	TArray<uint64> ids;
+	{
+		FScopeLock scope(&lock);
+		if (changed.Num() == 0)
+			return;
+		ids = changed.Array();
+		changed.Reset();
+	}
+	if (!SteamAPI_IsSteamRunning() || SteamFriends() == nullptr)
+		return;
+
+	TArray<FUbermundoFriend> fresh;
+	fresh.SetNum(ids.Num());
+	for (int32 i = 0; i < ids.Num(); i++)
+		Read(ids[i], fresh[i]);
+
+	FScopeLock scope(&lock);
+	bool any = false;
+	for (FUbermundoFriend& f : fresh) {
+		const int32* idx = indexOf.Find((uint64)f.SteamId);
+		if (idx == nullptr)
+			continue;
+		FUbermundoFriend& cached = friends[*idx];
+		if (cached.Name == f.Name && cached.PersonaState == f.PersonaState && cached.InGame == f.InGame && cached.InThisGame == f.InThisGame)
+			continue;
+		cached = MoveTemp(f);
+		any = true;
+	}
+	if (any)
+		version++;
+}
+
+// --------------------------------------------------------------------------------- UUbermundoFriendsCacheLibrary
+void UUbermundoFriendsCacheLibrary::GetFriendsSnapshot(int32 sinceVersion, TArray<FUbermundoFriend>& friends, int32& version, bool& changed) {
+	changed = FUbermundoFriendsCache::Get().Snapshot(sinceVersion, friends, version);
+}
+
+int32 UUbermundoFriendsCacheLibrary::GetFriendsCacheVersion() {
+	return FUbermundoFriendsCache::Get().GetVersion();
+}
+
+void UUbermundoFriendsCacheLibrary::SetFriendsCacheFlags(EFriendFlagsUM friendFlags) {
+	FUbermundoFriendsCache::Get().SetFlags((int32)friendFlags);
+}
+
+void UUbermundoFriendsCacheLibrary::RefreshFriendsCache() {
+	FUbermundoFriendsCache::Get().Invalidate();
+}
@@ -0,0 +1,489 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+
+#include "UbermundoImageMessages.h"
+#include "SteamCustomCode.h"
+#include "UbermundoPacketCodes.h"
+#include "UbermundoP2POutbox.h"
+#include "UbermundoBulkTransfer.h"
+#include "Engine/Texture2D.h"
+#include "ImageUtils.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "Modules/ModuleManager.h"
+#include "Async/Async.h"
+
+/** Tiles smaller than this are all header, and the tile index is a byte. */
+#define UBERMUNDO_IMAGE_MIN_TILE 16
+#define UBERMUNDO_IMAGE_THUMBNAIL_QUALITY 50
+
+static uint32 ReadU32(const uint8* p) {
+	return ((uint32)p[0] << 24) | ((uint32)p[1] << 16) | ((uint32)p[2] << 8) | p[3];
+}
+
+static int32 ReadU16(const uint8* p) {
+	return (p[0] << 8) | p[1];
+}
+
+static void AddU32(TArray<uint8>& b, uint32 v) {
+	b.Add((uint8)(v >> 24));
+	b.Add((uint8)(v >> 16));
+	b.Add((uint8)(v >> 8));
+	b.Add((uint8)v);
+}
+
+static void AddU16(TArray<uint8>& b, int32 v) {
+	b.Add((uint8)(v >> 8));
+	b.Add((uint8)v);
+}
+
+static IImageWrapperModule& ImageWrapper() {
+	return FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+}
+
+/** Scale w x h down, keeping its shape, so neither side is over maxSide. */
+static void FitInside(int32 w, int32 h, int32 maxSide, int32& outW, int32& outH) {
+	float scale = FMath::Min(1.0f, (float)maxSide / FMath::Max(w, h));
+	outW = FMath::Max(1, FMath::RoundToInt(w * scale));
+	outH = FMath::Max(1, FMath::RoundToInt(h * scale));
+}
+
+/** Any format ImageWrapper knows, to BGRA. Safe on a worker once the module is loaded.
+	False, before anything is decoded, if a side is over maxSide. */
+static bool ReadImage(IImageWrapperModule& module, const TArray<uint8>& file, int32 maxSide, int32& w, int32& h, TArray<FColor>& out) {
+	EImageFormat format = module.DetectImageFormat(file.GetData(), file.Num());
+	if (format == EImageFormat::Invalid)
+		return false;
+	TSharedPtr<IImageWrapper> wrapper = module.CreateImageWrapper(format);
+	if (!wrapper.IsValid() || !wrapper->SetCompressed(file.GetData(), file.Num()))
+		return false;
+	w = wrapper->GetWidth();
+	h = wrapper->GetHeight();
+	if (w <= 0 || h <= 0 || w > maxSide || h > maxSide)
+		return false;
+	TArray<uint8> raw;
+	if (!wrapper->GetRaw(ERGBFormat::BGRA, 8, raw) || raw.Num() != w * h * 4)
+		return false;
+	out.SetNumUninitialized(w * h);
+	FMemory::Memcpy(out.GetData(), raw.GetData(), raw.Num());
+	return true;
+}
+
+static bool AppendJpeg(IImageWrapperModule& module, const TArray<FColor>& pixels, int32 w, int32 h, int32 quality, TArray<uint8>& out) {
+	TSharedPtr<IImageWrapper> wrapper = module.CreateImageWrapper(EImageFormat::JPEG);
+	if (!wrapper.IsValid() || !wrapper->SetRaw(pixels.GetData(), pixels.Num() * sizeof(FColor), w, h, ERGBFormat::BGRA, 8))
+		return false;
+	const auto& jpeg = wrapper->GetCompressed(quality);
+	if (jpeg.Num() == 0)
+		return false;
+	out.Append(jpeg.GetData(), (int32)jpeg.Num());
+	return true;
+}
+
+/** The P2P_PlayerImageMsg and P2P_PlayerImageTiles for imageFile. Worker thread. Nothing if it is not an image. */
+static void EncodeImage(IImageWrapperModule& module, const FUbermundoImageSettings& s, const TArray<uint8>& file, uint32 id, TArray<uint8>& header, TArray<TArray<uint8>>& batches) {
+	int32 srcW, srcH;
+	TArray<FColor> src;
+	// Our own file, scaled down below, so any size will do.
+	if (!ReadImage(module, file, MAX_int32, srcW, srcH, src))
+		return;
+	int32 w, h;
+	FitInside(srcW, srcH, FMath::Clamp(s.MaxSize, UBERMUNDO_IMAGE_MIN_TILE, UBERMUNDO_IMAGE_MAX_SIZE), w, h);
+	TArray<FColor> image;
+	if (w != srcW || h != srcH)
+		FImageUtils::ImageResize(srcW, srcH, src, w, h, image, false);
+	else
+		image = MoveTemp(src);
+
+	// Halve the thumbnail until it fits one datagram. Without one the receiver starts from grey.
+	TArray<uint8> thumbnail;
+	for (int32 side = FMath::Clamp(s.ThumbnailSize, 4, 256); side >= 4 && thumbnail.Num() == 0; side /= 2) {
+		int32 tw, th;
+		FitInside(w, h, side, tw, th);
+		TArray<FColor> small;
+		FImageUtils::ImageResize(w, h, image, tw, th, small, false);
+		if (!AppendJpeg(module, small, tw, th, UBERMUNDO_IMAGE_THUMBNAIL_QUALITY, thumbnail) || thumbnail.Num() > UBERMUNDO_IMAGE_MAX_THUMBNAIL)
+			thumbnail.Reset();
+	}
+
+	int32 tileSize = FMath::Clamp(s.TileSize, UBERMUNDO_IMAGE_MIN_TILE, UBERMUNDO_IMAGE_MAX_SIZE);
+	int32 quality[2] = { FMath::Clamp(s.CoarseQuality, 1, 100), FMath::Clamp(s.FineQuality, 1, 100) };
+	int32 numPasses = quality[1] > quality[0] ? 2 : 1;
+	if (numPasses == 1)
+		quality[0] = quality[1];
+
+	header.Reserve(UBERMUNDO_IMAGE_HEADER + thumbnail.Num());
+	header.Add((uint8)UBERMUNDOPC_P2P_PlayerImageMsg);
+	AddU32(header, id);
+	AddU16(header, w);
+	AddU16(header, h);
+	AddU16(header, tileSize);
+	header.Add((uint8)numPasses);
+	header.Append(thumbnail);
+
+	// A bulk transfer per tile would be over a hundred of them for a big image, so they go a bundle at a time.
+	TArray<FColor> region;
+	TArray<uint8> tile;
+	for (int32 pass = 0; pass < numPasses; pass++) {
+		TArray<uint8>* batch = nullptr;
+		for (int32 y = 0; y < h; y += tileSize) {
+			for (int32 x = 0; x < w; x += tileSize) {
+				int32 rw = FMath::Min(tileSize, w - x);
+				int32 rh = FMath::Min(tileSize, h - y);
+				region.SetNumUninitialized(rw * rh, false);
+				for (int32 row = 0; row < rh; row++)
+					FMemory::Memcpy(&region[row * rw], &image[(y + row) * w + x], rw * sizeof(FColor));
+				tile.Reset();
+				tile.Add((uint8)UBERMUNDOPC_P2P_PlayerImageTile);
+				AddU32(tile, id);
+				tile.Add((uint8)(x / tileSize));
+				tile.Add((uint8)(y / tileSize));
+				tile.Add((uint8)pass);
+				if (!AppendJpeg(module, region, rw, rh, quality[pass], tile))
+					continue;
+				if (tile.Num() > UBERMUNDO_BUNDLE_MAX_MSG) {
+					batches.Add(tile);
+					continue;
+				}
+				if (batch == nullptr || batch->Num() + tile.Num() > UBERMUNDO_IMAGE_BATCH_BYTES) {
+					batch = &batches.AddDefaulted_GetRef();
+					batch->Add((uint8)UBERMUNDOPC_P2P_Bundle);
+				}
+				FUbermundoP2POutbox::AddToBundle(*batch, tile.GetData(), tile.Num());
+			}
+		}
+	}
+}
+
+// --------------------------------------------------------------------------------- FUbermundoImageMessages
+FUbermundoImageMessages& FUbermundoImageMessages::Get() {
+	static FUbermundoImageMessages messages;
+	return messages;
+}
+
+uint32 FUbermundoImageMessages::Send(TArrayView<const uint64> peers, TArrayView<const uint8> imageFile) {
+	if (peers.Num() == 0 || imageFile.Num() == 0)
+		return 0;
+	// Not starting from 1 each run, so a receiver who still has our images from before a restart doesn't mix them up.
+	if (lastId == 0)
+		lastId = FPlatformTime::Cycles();
+	if (++lastId == 0)
+		lastId = 1;
+
+	FEncoded e;
+	e.id = lastId;
+	e.peers.Append(peers.GetData(), peers.Num());
+	TArray<uint8> file(imageFile.GetData(), imageFile.Num());
+	// Loading a module is game thread only.
+	IImageWrapperModule* module = &ImageWrapper();
+	TWeakPtr<FEncodedQueue, ESPMode::ThreadSafe> out = encoded;
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [out, module, s = settings, e = MoveTemp(e), file = MoveTemp(file)]() mutable {
+		EncodeImage(*module, s, file, e.id, e.header, e.batches);
+		if (TSharedPtr<FEncodedQueue, ESPMode::ThreadSafe> queue = out.Pin())
+			queue->Enqueue(MoveTemp(e));
+	});
+	return lastId;
+}
+
+void FUbermundoImageMessages::SendEncoded(const FEncoded& e) {
+	if (e.header.Num() == 0) {
+		UE_LOG(UberMundoSteamLog, Warning, TEXT("SendP2PImage %u is not an image ImageWrapper can read"), e.id);
+		return;
+	}
+	FUbermundoP2POutbox& outbox = FUbermundoP2POutbox::Get();
+	FUbermundoBulkTransfer& bulk = FUbermundoBulkTransfer::Get();
+	for (uint64 peer : e.peers) {
+		outbox.Queue(peer, e.header, EUbermundoP2PSendMode::Reliable);
+		// Bulk starts transfers oldest first, a few at a time, so the coarse pass is mostly in before the fine
+		// one. A coarse tile that comes in late never covers a fine one anyway.
+		for (const TArray<uint8>& batch : e.batches)
+			bulk.Send(peer, batch);
+	}
+	UE_LOG(UberMundoSteamLog, Verbose, TEXT("SendP2PImage %u to %d peers, header N=%d, %d bulk transfers"), e.id, e.peers.Num(), e.header.Num(), e.batches.Num());
+}
+
+void FUbermundoImageMessages::Tick(double now) {
+	FEncoded e;
+	while (encoded->Dequeue(e))
+		SendEncoded(e);
+
+	FDecoded d;
+	while (decoded->Dequeue(d)) {
+		uint64 key = KeyOf(d.sender, d.id);
+		FReceived* r = received.Find(key);
+		if (d.generation != generation || r == nullptr)
+			continue;
+		if (d.pass == UBERMUNDO_IMAGE_THUMBNAIL_PASS) {
+			ShowThumbnail(*r, d);
+		}
+		else if (r->texture == nullptr) {
+			// Making room may let go of other images of this sender, r is not one of them.
+			if (MakeRoom(d.sender, d.pixels.Num(), key))
+				r->waiting.Add(MoveTemp(d));
+		}
+		else {
+			ShowTile(*r, d);
+		}
+	}
+}
+
+bool FUbermundoImageMessages::DecodeHeader(const uint8* data, int32 numBytes, uint32& id, int32& width, int32& height) {
+	if (numBytes < UBERMUNDO_IMAGE_HEADER || data[0] != UBERMUNDOPC_P2P_PlayerImageMsg)
+		return false;
+	id = ReadU32(data + 1);
+	width = ReadU16(data + 5);
+	height = ReadU16(data + 7);
+	return width > 0 && height > 0 && width <= UBERMUNDO_IMAGE_MAX_SIZE && height <= UBERMUNDO_IMAGE_MAX_SIZE;
+}
+
+bool FUbermundoImageMessages::HandlePacket(uint64 sender, const uint8* data, int32 numBytes) {
+	if (numBytes <= 0)
+		return false;
+	double now = FPlatformTime::Seconds();
+
+	if (data[0] == UBERMUNDOPC_P2P_PlayerImageMsg) {
+		uint32 id;
+		int32 width, height;
+		int32 tileSize = numBytes >= UBERMUNDO_IMAGE_HEADER ? ReadU16(data + 9) : 0;
+		int32 numPasses = numBytes >= UBERMUNDO_IMAGE_HEADER ? data[11] : 0;
+		if (!DecodeHeader(data, numBytes, id, width, height) || tileSize < UBERMUNDO_IMAGE_MIN_TILE || numPasses < 1) {
+			UE_LOG(UberMundoSteamLog, Warning, TEXT("Bad P2P_PlayerImageMsg from 0x%llX N=%d"), sender, numBytes);
+			return false;
+		}
+		uint64 key = KeyOf(sender, id);
+		FReceived* existing = received.Find(key);
+		// Passed on to game code either way, it is the chat message.
+		if (existing != nullptr && existing->width != 0)
+			return false;
+		if (!MakeRoom(sender, (int64)width * height * 4, key)) {
+			UE_LOG(UberMundoSteamLog, Warning, TEXT("P2P image %u from 0x%llX, %d x %d, is more than its sender may have kept"), id, sender, width, height);
+			return false;
+		}
+		FReceived& r = received.FindOrAdd(key);
+		r.sender = sender;
+		r.width = width;
+		r.height = height;
+		r.tileSize = tileSize;
+		r.numPasses = numPasses;
+		r.numTiles = ((width + tileSize - 1) / tileSize) * ((height + tileSize - 1) / tileSize);
+		if (r.receivedAt == 0.0)
+			r.receivedAt = now;
+		Decode(sender, id, UBERMUNDO_IMAGE_THUMBNAIL_PASS, 0, 0, width, height,
+			TArrayView<const uint8>(data + UBERMUNDO_IMAGE_HEADER, numBytes - UBERMUNDO_IMAGE_HEADER));
+		DropOldest(sender);
+		return false;
+	}
+
+	if (data[0] != UBERMUNDOPC_P2P_PlayerImageTile)
+		return false;
+	if (numBytes <= UBERMUNDO_IMAGE_TILE_HEADER)
+		return true;
+	uint32 id = ReadU32(data + 1);
+	uint8 x = data[5];
+	uint8 y = data[6];
+	uint8 pass = data[7];
+	if (pass == UBERMUNDO_IMAGE_THUMBNAIL_PASS)
+		return true;
+	// Tiles may beat the header here, bulk and reliable are separate ways in.
+	FReceived& r = received.FindOrAdd(KeyOf(sender, id));
+	r.sender = sender;
+	if (r.receivedAt == 0.0)
+		r.receivedAt = now;
+	const uint8* shown = r.shown.Find((uint16)(x | (y << 8)));
+	if (shown == nullptr || *shown < pass)
+		Decode(sender, id, pass, x, y, 0, 0, TArrayView<const uint8>(data + UBERMUNDO_IMAGE_TILE_HEADER, numBytes - UBERMUNDO_IMAGE_TILE_HEADER));
+	DropOldest(sender);
+	return true;
+}
+
+void FUbermundoImageMessages::Decode(uint64 sender, uint32 id, uint8 pass, int32 x, int32 y, int32 width, int32 height, TArrayView<const uint8> jpeg) {
+	TArray<uint8> bytes(jpeg.GetData(), jpeg.Num());
+	IImageWrapperModule* module = &ImageWrapper();
+	uint32 gen = generation;
+	TWeakPtr<FDecodedQueue, ESPMode::ThreadSafe> out = decoded;
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [out, module, sender, id, gen, pass, x, y, width, height, bytes = MoveTemp(bytes)]() {
+		FDecoded d;
+		d.sender = sender;
+		d.id = id;
+		d.generation = gen;
+		d.pass = pass;
+		d.x = x;
+		d.y = y;
+		int32 w = 0;
+		int32 h = 0;
+		TArray<FColor> pixels;
+		bool ok = bytes.Num() > 0 && ReadImage(*module, bytes, UBERMUNDO_IMAGE_MAX_SIZE, w, h, pixels);
+		if (pass == UBERMUNDO_IMAGE_THUMBNAIL_PASS) {
+			// Stretched to full size, so tiles can be written straight over it.
+			TArray<FColor> full;
+			if (ok)
+				FImageUtils::ImageResize(w, h, pixels, width, height, full, false);
+			else
+				full.Init(FColor(128, 128, 128), width * height);
+			pixels = MoveTemp(full);
+			w = width;
+			h = height;
+			ok = true;
+		}
+		if (ok) {
+			d.width = w;
+			d.height = h;
+			d.pixels.SetNumUninitialized(pixels.Num() * sizeof(FColor));
+			FMemory::Memcpy(d.pixels.GetData(), pixels.GetData(), d.pixels.Num());
+		}
+		if (TSharedPtr<FDecodedQueue, ESPMode::ThreadSafe> queue = out.Pin())
+			queue->Enqueue(MoveTemp(d));
+	});
+}
+
+void FUbermundoImageMessages::ShowThumbnail(FReceived& r, const FDecoded& d) {
+	if (r.texture != nullptr)
+		return;
+	UTexture2D* t = UTexture2D::CreateTransient(d.width, d.height, PF_B8G8R8A8);
+	if (t == nullptr) {
+		UE_LOG(UberMundoSteamLog, Warning, TEXT("No texture for P2P image %u from 0x%llX, %d x %d"), d.id, d.sender, d.width, d.height);
+		return;
+	}
+	t->SRGB = true;
+	t->LODGroup = TEXTUREGROUP_UI;
+	FTexture2DMipMap& mip = t->PlatformData->Mips[0];
+	FMemory::Memcpy(mip.BulkData.Lock(LOCK_READ_WRITE), d.pixels.GetData(), d.pixels.Num());
+	mip.BulkData.Unlock();
+	t->UpdateResource();
+	r.texture = t;
+	version++;
+
+	for (const FDecoded& tile : r.waiting)
+		ShowTile(r, tile);
+	r.waiting.Empty();
+}
+
+void FUbermundoImageMessages::ShowTile(FReceived& r, const FDecoded& d) {
+	uint16 key = (uint16)(d.x | (d.y << 8));
+	uint8* shown = r.shown.Find(key);
+	if (shown != nullptr && *shown >= d.pass)
+		return; // A finer pass of it got here first.
+	int32 px = d.x * r.tileSize;
+	int32 py = d.y * r.tileSize;
+	if (d.pixels.Num() == 0 || d.pass >= r.numPasses || px + d.width > r.width || py + d.height > r.height) {
+		UE_LOG(UberMundoSteamLog, Warning, TEXT("Bad tile %d,%d pass %d of P2P image %u from 0x%llX"), d.x, d.y, d.pass, d.id, d.sender);
+		return;
+	}
+
+	// The render thread reads the pixels later, it frees them and the region when it has.
+	FUpdateTextureRegion2D* region = new FUpdateTextureRegion2D(px, py, 0, 0, d.width, d.height);
+	uint8* pixels = (uint8*)FMemory::Malloc(d.pixels.Num());
+	FMemory::Memcpy(pixels, d.pixels.GetData(), d.pixels.Num());
+	r.texture->UpdateTextureRegions(0, 1, region, d.width * 4, 4, pixels, [](uint8* data, const FUpdateTextureRegion2D* regions) {
+		FMemory::Free(data);
+		delete regions;
+	});
+
+	r.numShown += d.pass + 1 - (shown != nullptr ? *shown + 1 : 0);
+	r.shown.Add(key, d.pass);
+	version++;
+}
+
+void FUbermundoImageMessages::DropOldest(uint64 sender) {
+	// Per sender, so one sending tiles for made up ids can't push out everyone else's images.
+	for (;;) {
+		int32 count = 0;
+		uint64 oldest = 0;
+		double oldestAt = DBL_MAX;
+		for (const TPair<uint64, FReceived>& kv : received) {
+			if (kv.Value.sender != sender)
+				continue;
+			count++;
+			if (kv.Value.receivedAt < oldestAt) {
+				oldest = kv.Key;
+				oldestAt = kv.Value.receivedAt;
+			}
+		}
+		if (count <= UBERMUNDO_IMAGE_KEEP)
+			return;
+		received.Remove(oldest);
+	}
+}
+
+int64 FUbermundoImageMessages::BytesOf(const FReceived& r) {
+	int64 n = (int64)r.width * r.height * 4;
+	for (const FDecoded& d : r.waiting)
+		n += d.pixels.Num();
+	return n;
+}
+
+bool FUbermundoImageMessages::MakeRoom(uint64 sender, int64 numBytes, uint64 keep) {
+	for (;;) {
+		int64 used = 0;
+		uint64 oldest = 0;
+		double oldestAt = DBL_MAX;
+		for (const TPair<uint64, FReceived>& kv : received) {
+			if (kv.Value.sender != sender)
+				continue;
+			used += BytesOf(kv.Value);
+			if (kv.Key != keep && kv.Value.receivedAt < oldestAt) {
+				oldest = kv.Key;
+				oldestAt = kv.Value.receivedAt;
+			}
+		}
+		if (used + numBytes <= UBERMUNDO_IMAGE_MAX_SENDER_BYTES)
+			return true;
+		if (oldestAt == DBL_MAX)
+			return false;
+		received.Remove(oldest);
+		version++;
+	}
+}
+
+UTexture2D* FUbermundoImageMessages::Find(uint64 sender, uint32 id, float& progress) const {
+	const FReceived* r = received.Find(KeyOf(sender, id));
+	if (r == nullptr) {
+		progress = -1.0f;
+		return nullptr;
+	}
+	progress = r->numTiles > 0 ? FMath::Min(1.0f, (float)r->numShown / (r->numTiles * r->numPasses)) : 0.0f;
+	return r->texture;
+}
+
+void FUbermundoImageMessages::Reset() {
+	received.Empty();
+	generation++;
+	version++;
+	FDecoded d;
+	while (decoded->Dequeue(d)) {
+	}
+}
+
+void FUbermundoImageMessages::AddReferencedObjects(FReferenceCollector& collector) {
+	for (TPair<uint64, FReceived>& kv : received) {
+		if (kv.Value.texture != nullptr)
+			collector.AddReferencedObject(kv.Value.texture);
+	}
+}
+
+// --------------------------------------------------------------------------------- UUbermundoImageMessageLibrary
+int64 UUbermundoImageMessageLibrary::SendP2PImage(const TArray<int64>& peers, const TArray<uint8>& imageFile) {
+	return FUbermundoImageMessages::Get().Send(TArrayView<const uint64>(reinterpret_cast<const uint64*>(peers.GetData()), peers.Num()), imageFile);
+}
+
+bool UUbermundoImageMessageLibrary::DecodeP2PImageMsg(const TArray<uint8>& message, int64& imageId, int32& width, int32& height) {
+	uint32 id = 0;
+	width = 0;
+	height = 0;
+	bool ok = FUbermundoImageMessages::DecodeHeader(message.GetData(), message.Num(), id, width, height);
+	imageId = id;
+	return ok;
+}
+
+UTexture2D* UUbermundoImageMessageLibrary::GetP2PImage(int64 sender, int64 imageId, UTexture2D* placeholder, float& progress) {
+	UTexture2D* t = FUbermundoImageMessages::Get().Find((uint64)sender, (uint32)imageId, progress);
+	return t != nullptr ? t : placeholder;
+}
+
+int32 UUbermundoImageMessageLibrary::GetP2PImageVersion() {
+	return FUbermundoImageMessages::Get().GetVersion();
+}
+
+void UUbermundoImageMessageLibrary::SetP2PImageSettings(const FUbermundoImageSettings& settings) {
+	FUbermundoImageMessages::Get().SetSettings(settings);
+}
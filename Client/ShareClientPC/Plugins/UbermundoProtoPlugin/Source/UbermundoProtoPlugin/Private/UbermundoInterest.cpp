@@ -0,0 +1,148 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+
+#include "UbermundoInterest.h"
+#include "SteamCustomCode.h"
+#include "UbermundoP2POutbox.h"
+#include "UbermundoRateControl.h"
+#include "UbermundoDeadReckoning.h"
+
+// --------------------------------------------------------------------------------- FUbermundoInterestManager
+FUbermundoInterestManager& FUbermundoInterestManager::Get() {
+	static FUbermundoInterestManager manager;
+	return manager;
+}
+
+float FUbermundoInterestManager::ComputeRateHz(uint64 peer, const FPeer& p, double now) const {
+	float full = settings.FullRateHz * playerUpdateFactor * FUbermundoRateController::Get().GetStateRateFactor(peer);
+	float heartbeat = FMath::Min(settings.HeartbeatHz, full);
+	if (now - p.lastInteraction < settings.InteractionSeconds)
+		return full;
+
+	FVector toUs = localLocation - p.location;
+	float d = toUs.Size();
+	if (d > settings.MaxDistance)
+		return heartbeat;
+
+	float frac = 1.0f;
+	if (d > settings.FullRateDistance)
+		frac = FMath::Max(settings.MinFraction, settings.FullRateDistance / d);
+	if (d > KINDA_SMALL_NUMBER) {
+		float cosCone = FMath::Cos(FMath::DegreesToRadians(settings.ViewConeDegrees));
+		if (FVector::DotProduct(p.forward, toUs / d) < cosCone)
+			frac *= settings.OutOfViewFactor;
+	}
+	return FMath::Max(full * frac, heartbeat);
+}
+
+void FUbermundoInterestManager::Schedule(uint64 peer, FPeer& p, double when) {
+	p.generation = ++nextGeneration;
+	heap.HeapPush({ when, peer, p.generation });
+}
+
+void FUbermundoInterestManager::UpdatePeer(uint64 peer, const FVector& location, const FRotator& rotation, double now) {
+	FPeer* p = peers.Find(peer);
+	bool isNew = p == nullptr;
+	if (isNew)
+		p = &peers.Add(peer);
+	p->location = location;
+	p->forward = rotation.Vector();
+
+	if (isNew) {
+		// Whatever they were last sent, they need a state of ours now.
+		FUbermundoDeadReckoning::Get().ForgetPeer(peer);
+		p->rateHz = ComputeRateHz(peer, *p, now);
+		Schedule(peer, *p, now);
+		return;
+	}
+	// Don't make someone who just walked up to us wait out a heartbeat interval.
+	float rate = ComputeRateHz(peer, *p, now);
+	if (rate > p->rateHz * 2.0f) {
+		p->rateHz = rate;
+		Schedule(peer, *p, now + 1.0 / rate);
+	}
+}
+
+void FUbermundoInterestManager::NoteInteraction(uint64 peer, double now) {
+	FPeer* p = peers.Find(peer);
+	if (p == nullptr)
+		return;
+	p->lastInteraction = now;
+	p->rateHz = ComputeRateHz(peer, *p, now);
+	Schedule(peer, *p, now);
+}
+
+void FUbermundoInterestManager::RemovePeer(uint64 peer) {
+	// Its heap entries are skipped when they come due, even if it is added again by then.
+	peers.Remove(peer);
+}
+
+void FUbermundoInterestManager::CollectDuePeers(double now, TArray<uint64>& outPeers) {
+	outPeers.Reset();
+	while (heap.Num() > 0 && heap.HeapTop().time <= now) {
+		FDue d;
+		heap.HeapPop(d, false);
+		FPeer* p = peers.Find(d.peer);
+		if (p == nullptr || p->generation != d.generation)
+			continue;
+		outPeers.Add(d.peer);
+
+		p->rateHz = ComputeRateHz(d.peer, *p, now);
+		double interval = 1.0 / FMath::Max(p->rateHz, 0.01f);
+		// Keep a steady cadence, unless we've fallen a whole interval behind.
+		double next = d.time + interval;
+		if (next <= now)
+			next = now + interval;
+		Schedule(d.peer, *p, next);
+	}
+}
+
+int32 FUbermundoInterestManager::SendStateToDuePeers(const FUbermundoPlayer3DState& state, double now) {
+	SetLocalLocation(state.Location);
+	CollectDuePeers(now, due);
+	// Of those, only the ones whose picture of us has drifted, or who are due a heartbeat.
+	FUbermundoDeadReckoning& reckoning = FUbermundoDeadReckoning::Get();
+	due.RemoveAllSwap([&](uint64 peer) { return !reckoning.ShouldSend(peer, state, now); }, false);
+	if (due.Num() == 0)
+		return 0;
+
+	FUbermundoSnapshotCodec& codec = FUbermundoSnapshotCodec::Get();
+	codec.BeginSnapshot(state);
+	for (uint64 peer : due)
+		FUbermundoP2POutbox::Get().Queue(peer, codec.GetPacketFor(peer).View(), EUbermundoP2PSendMode::UnreliableNoDelay);
+	return due.Num();
+}
+
+float FUbermundoInterestManager::GetRateHz(uint64 peer) const {
+	const FPeer* p = peers.Find(peer);
+	return p ? p->rateHz : 0.0f;
+}
+
+// --------------------------------------------------------------------------------- UUbermundoInterestLibrary
+void UUbermundoInterestLibrary::SetInterestSettings(const FUbermundoInterestSettings& settings) {
+	FUbermundoInterestManager::Get().SetSettings(settings);
+}
+
+void UUbermundoInterestLibrary::SetInterestWorld(const FWorldDefinitionStruct& world) {
+	FUbermundoInterestManager::Get().SetPlayerUpdateFactor(world.PlayerUpdateFactor);
+}
+
+void UUbermundoInterestLibrary::UpdateRemotePlayerView(int64 peer, FVector location, FRotator rotation) {
+	FUbermundoInterestManager::Get().UpdatePeer((uint64)peer, location, rotation, FPlatformTime::Seconds());
+}
+
+void UUbermundoInterestLibrary::NoteRemotePlayerInteraction(int64 peer) {
+	FUbermundoInterestManager::Get().NoteInteraction((uint64)peer, FPlatformTime::Seconds());
+}
+
+void UUbermundoInterestLibrary::RemoveRemotePlayer(int64 peer) {
+	FUbermundoInterestManager::Get().RemovePeer((uint64)peer);
+}
+
+float UUbermundoInterestLibrary::GetRemotePlayerUpdateRate(int64 peer) {
+	return FUbermundoInterestManager::Get().GetRateHz((uint64)peer);
+}
+
+int32 UUbermundoInterestLibrary::SendPlayer3DStateToDuePeers(const FUbermundoPlayer3DState& state) {
+	return FUbermundoInterestManager::Get().SendStateToDuePeers(state, FPlatformTime::Seconds());
+}
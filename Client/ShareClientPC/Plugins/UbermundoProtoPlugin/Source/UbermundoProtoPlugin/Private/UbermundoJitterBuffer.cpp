@@ -0,0 +1,206 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+
+#include "UbermundoJitterBuffer.h"
+#include "SteamCustomCode.h"
+
+/** How far the fastest packet offset is let up per state, so a slower path or clock drift is picked up in time. Milliseconds. */
+#define UBERMUNDO_JITTER_OFFSET_CREEP 0.05
+/** Gaps between states longer than this are the sender holding back a state nothing had changed in, not its send rate. Milliseconds. */
+#define UBERMUNDO_JITTER_MAX_INTERVAL 250.0
+
+// --------------------------------------------------------------------------------- FUbermundoJitterBuffer
+FUbermundoJitterBuffer& FUbermundoJitterBuffer::Get() {
+	static FUbermundoJitterBuffer buffer;
+	return buffer;
+}
+
+void FUbermundoJitterBuffer::Push(uint64 sender, const FUbermundoPlayer3DState& state, double now) {
+	int32* idx = indexOf.Find(sender);
+	if (idx == nullptr) {
+		idx = &indexOf.Add(sender, peers.Num());
+		peers.Add(sender);
+		remotes.AddDefaulted();
+		transforms.Add(FTransform::Identity);
+	}
+	FRemote& r = remotes[*idx];
+
+	double nowMs = now * 1000.0;
+	// Timestamps are 32 bit milliseconds, unwrap them against the last one.
+	double time = r.any ? r.lastTime + (double)(int32)((uint32)state.TimestampMs - (uint32)r.lastTimestampMs) : (double)state.TimestampMs;
+	double offset = nowMs - time;
+	if (!r.any) {
+		r.minOffset = offset;
+		r.delay = settings.MinDelayMs + r.interval;
+		r.playedTime = time - r.delay;
+		r.lastTime = time;
+		r.lastTimestampMs = state.TimestampMs;
+		r.any = true;
+	}
+	else {
+		r.minOffset = FMath::Min(r.minOffset + UBERMUNDO_JITTER_OFFSET_CREEP, offset);
+		r.jitter += ((offset - r.minOffset) - r.jitter) / 16.0;
+		if (time > r.lastTime) {
+			// A player standing still sends a heartbeat a second, that must not turn into a second of playout delay.
+			if (time - r.lastTime <= UBERMUNDO_JITTER_MAX_INTERVAL)
+				r.interval += (FMath::Max(time - r.lastTime, 5.0) - r.interval) / 8.0;
+			r.lastTime = time;
+			r.lastTimestampMs = state.TimestampMs;
+		}
+	}
+
+	if (time <= r.playedTime && r.numSnapshots > 0) {
+		// Its moment has been and gone. Make sure the next one like it is in time.
+		r.numLate++;
+		r.delay = FMath::Min(r.delay + (r.playedTime - time), (double)settings.MaxDelayMs);
+		return;
+	}
+
+	FSnapshot s;
+	s.time = time;
+	s.location = state.Location;
+	s.velocity = state.Velocity;
+	s.rotation = state.Rotation.Quaternion();
+	Insert(r, s);
+}
+
+void FUbermundoJitterBuffer::Insert(FRemote& r, const FSnapshot& s) {
+	int32 at = r.numSnapshots;
+	while (at > 0 && r.snapshots[at - 1].time > s.time)
+		at--;
+	if (at > 0 && r.snapshots[at - 1].time == s.time) {
+		r.snapshots[at - 1] = s;
+		return;
+	}
+	if (r.numSnapshots == UBERMUNDO_JITTER_SNAPSHOTS) {
+		if (at == 0)
+			return; // Older than everything in a full buffer.
+		// Drop the oldest, which frees the slot just before the new one.
+		FMemory::Memmove(&r.snapshots[0], &r.snapshots[1], (at - 1) * sizeof(FSnapshot));
+		r.snapshots[at - 1] = s;
+		return;
+	}
+	FMemory::Memmove(&r.snapshots[at + 1], &r.snapshots[at], (r.numSnapshots - at) * sizeof(FSnapshot));
+	r.snapshots[at] = s;
+	r.numSnapshots++;
+}
+
+void FUbermundoJitterBuffer::Evaluate(double now) {
+	double dt = lastEvaluate > 0.0 ? FMath::Clamp(now - lastEvaluate, 0.0, 0.25) : 0.0;
+	lastEvaluate = now;
+	double nowMs = now * 1000.0;
+	FRemote* r = remotes.GetData();
+	FTransform* out = transforms.GetData();
+	for (int32 i = 0; i < remotes.Num(); i++)
+		EvaluateRemote(r[i], out[i], nowMs, dt);
+}
+
+void FUbermundoJitterBuffer::EvaluateRemote(FRemote& r, FTransform& out, double nowMs, double dt) {
+	if (r.numSnapshots == 0)
+		return;
+
+	double target = FMath::Clamp(r.interval + settings.JitterMultiplier * r.jitter, (double)settings.MinDelayMs, (double)settings.MaxDelayMs);
+	r.delay = target > r.delay ? target : FMath::Max(target, r.delay - settings.ShrinkMsPerSecond * dt);
+
+	// Never back in time, even when the offset estimate creeps up.
+	double t = FMath::Max(nowMs - r.minOffset - r.delay, r.playedTime);
+	r.playedTime = t;
+
+	// Only the last state at or before t, and the ones after it, are any use now.
+	int32 first = 0;
+	while (first + 1 < r.numSnapshots && r.snapshots[first + 1].time <= t)
+		first++;
+	if (first > 0) {
+		FMemory::Memmove(&r.snapshots[0], &r.snapshots[first], (r.numSnapshots - first) * sizeof(FSnapshot));
+		r.numSnapshots -= first;
+	}
+
+	const FSnapshot& a = r.snapshots[0];
+	r.extrapolating = false;
+	if (t <= a.time) {
+		out = FTransform(a.rotation, a.location);
+		return;
+	}
+	if (r.numSnapshots == 1) {
+		// Nothing newer yet. Dead reckon, but not forever.
+		double ahead = FMath::Min(t - a.time, (double)settings.MaxExtrapolationMs) / 1000.0;
+		out = FTransform(a.rotation, a.location + a.velocity * (float)ahead);
+		r.extrapolating = true;
+		r.numExtrapolated++;
+		return;
+	}
+
+	const FSnapshot& b = r.snapshots[1];
+	float span = (float)((b.time - a.time) / 1000.0);
+	float u = (float)((t - a.time) / (b.time - a.time));
+	float u2 = u * u;
+	float u3 = u2 * u;
+	FVector p = (2.0f * u3 - 3.0f * u2 + 1.0f) * a.location
+		+ ((u3 - 2.0f * u2 + u) * span) * a.velocity
+		+ (-2.0f * u3 + 3.0f * u2) * b.location
+		+ ((u3 - u2) * span) * b.velocity;
+	out = FTransform(FQuat::Slerp(a.rotation, b.rotation, u), p);
+}
+
+bool FUbermundoJitterBuffer::GetTransform(uint64 peer, FTransform& out, bool& extrapolating) const {
+	out = FTransform::Identity;
+	extrapolating = false;
+	const int32* idx = indexOf.Find(peer);
+	if (idx == nullptr || remotes[*idx].numSnapshots == 0)
+		return false;
+	out = transforms[*idx];
+	extrapolating = remotes[*idx].extrapolating;
+	return true;
+}
+
+bool FUbermundoJitterBuffer::GetStats(uint64 peer, FUbermundoJitterStats& out) const {
+	out = FUbermundoJitterStats();
+	const int32* idx = indexOf.Find(peer);
+	if (idx == nullptr)
+		return false;
+	const FRemote& r = remotes[*idx];
+	out.DelayMs = (float)r.delay;
+	out.JitterMs = (float)r.jitter;
+	out.IntervalMs = (float)r.interval;
+	out.NumBuffered = r.numSnapshots;
+	out.NumLate = r.numLate;
+	out.NumExtrapolated = r.numExtrapolated;
+	return true;
+}
+
+void FUbermundoJitterBuffer::ForgetPeer(uint64 peer) {
+	int32 idx;
+	if (!indexOf.RemoveAndCopyValue(peer, idx))
+		return;
+	peers.RemoveAtSwap(idx, 1, false);
+	remotes.RemoveAtSwap(idx, 1, false);
+	transforms.RemoveAtSwap(idx, 1, false);
+	if (idx < peers.Num())
+		indexOf[peers[idx]] = idx;
+}
+
+// --------------------------------------------------------------------------------- UUbermundoJitterBufferLibrary
+void UUbermundoJitterBufferLibrary::SetJitterBufferSettings(const FUbermundoJitterSettings& settings) {
+	FUbermundoJitterBuffer::Get().SetSettings(settings);
+}
+
+void UUbermundoJitterBufferLibrary::PushRemotePlayer3DState(int64 sender, const FUbermundoPlayer3DState& state) {
+	FUbermundoJitterBuffer::Get().Push((uint64)sender, state, FPlatformTime::Seconds());
+}
+
+void UUbermundoJitterBufferLibrary::EvaluateRemotePlayers(TArray<int64>& peers, TArray<FTransform>& transforms) {
+	FUbermundoJitterBuffer& buffer = FUbermundoJitterBuffer::Get();
+	buffer.Evaluate(FPlatformTime::Seconds());
+	peers.Reset(buffer.GetPeers().Num());
+	for (uint64 p : buffer.GetPeers())
+		peers.Add((int64)p);
+	transforms = buffer.GetTransforms();
+}
+
+bool UUbermundoJitterBufferLibrary::GetRemotePlayerTransform(int64 peer, FTransform& transform, bool& extrapolating) {
+	return FUbermundoJitterBuffer::Get().GetTransform((uint64)peer, transform, extrapolating);
+}
+
+bool UUbermundoJitterBufferLibrary::GetJitterBufferStats(int64 peer, FUbermundoJitterStats& stats) {
+	return FUbermundoJitterBuffer::Get().GetStats((uint64)peer, stats);
+}
@@ -0,0 +1,1535 @@
+// Copyright 2020 Bahnda. All rights reserved.
+// Generated by Tools/gen_message_codecs.py from Tools/ubermundo_messages.schema. Do not edit, change the schema and run it again.
+
+
+#include "UbermundoMessages.h"
+#include "SteamCustomCode.h"
+
+template<typename TWire, typename TField>
+static bool ReadAs(FUbermundoWireReader& r, TField& out) {
+	TWire v;
+	if (!r.Read(v))
+		return false;
+	out = (TField)v;
+	return true;
+}
+
+static bool ReadSteamIdAs(FUbermundoWireReader& r, int64& out) {
+	uint64 v;
+	if (!r.ReadSteamId(v))
+		return false;
+	out = (int64)v;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- AnnouncedPlayer
+void FUbermundoAnnouncedPlayerWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(UbermundoId);
+	w.WriteSteamId(SteamId);
+}
+
+bool FUbermundoAnnouncedPlayerWire::Read(FUbermundoWireReader& r) {
+	return r.Read(UbermundoId)
+		&& r.ReadSteamId(SteamId);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoAnnouncedPlayerMsg& m) {
+	w.Write(m.UbermundoId);
+	w.WriteSteamId((uint64)m.SteamId);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoAnnouncedPlayerMsg& m) {
+	if (!ReadAs<int32>(r, m.UbermundoId))
+		return false;
+	if (!ReadSteamIdAs(r, m.SteamId))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- WorldMetadata
+void FUbermundoWorldMetadataWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(WorldId);
+	w.WriteSized(WorldName);
+	w.Write(OwningPlayerId);
+	w.Write(WotToSee);
+	w.WriteCount(WorldVersion);
+	w.Write(PlayerUpdateIntervalFactor);
+}
+
+bool FUbermundoWorldMetadataWire::Read(FUbermundoWireReader& r) {
+	return r.Read(WorldId)
+		&& r.ReadSized(WorldName)
+		&& r.Read(OwningPlayerId)
+		&& r.Read(WotToSee)
+		&& r.ReadCount(WorldVersion)
+		&& r.Read(PlayerUpdateIntervalFactor);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoWorldMetadataMsg& m) {
+	w.Write(m.WorldId);
+	w.WriteString(m.WorldName);
+	w.Write(m.OwningPlayerId);
+	w.Write(m.WotToSee);
+	w.WriteCount(m.WorldVersion);
+	w.Write(m.PlayerUpdateIntervalFactor);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoWorldMetadataMsg& m) {
+	if (!ReadAs<int32>(r, m.WorldId))
+		return false;
+	if (!r.ReadString(m.WorldName))
+		return false;
+	if (!ReadAs<int32>(r, m.OwningPlayerId))
+		return false;
+	if (!ReadAs<uint8>(r, m.WotToSee))
+		return false;
+	if (!r.ReadCount(m.WorldVersion))
+		return false;
+	if (!ReadAs<float>(r, m.PlayerUpdateIntervalFactor))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- BlockChunkHash
+void FUbermundoBlockChunkHashWire::Write(FUbermundoWireWriter& w) const {
+	w.WriteFixed(Sha1, 20);
+}
+
+bool FUbermundoBlockChunkHashWire::Read(FUbermundoWireReader& r) {
+	return r.ReadRaw(20, Sha1);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoBlockChunkHashMsg& m) {
+	w.WriteFixed(m.Sha1, 20);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoBlockChunkHashMsg& m) {
+	if (!r.ReadBytes(20, m.Sha1))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- P2SPlayerAnnounce_Steam
+void FUbermundoP2SPlayerAnnounce_SteamWire::Write(FUbermundoWireWriter& w) const {
+	w.WriteSteamId(SteamId);
+}
+
+bool FUbermundoP2SPlayerAnnounce_SteamWire::Read(FUbermundoWireReader& r) {
+	return r.ReadSteamId(SteamId);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoP2SPlayerAnnounce_SteamMsg& m) {
+	w.WriteSteamId((uint64)m.SteamId);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoP2SPlayerAnnounce_SteamMsg& m) {
+	if (!ReadSteamIdAs(r, m.SteamId))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- P2SPlayerUpdate
+void FUbermundoP2SPlayerUpdateWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(WorldId);
+	w.Write(X);
+	w.Write(Y);
+	w.Write(Z);
+}
+
+bool FUbermundoP2SPlayerUpdateWire::Read(FUbermundoWireReader& r) {
+	return r.Read(WorldId)
+		&& r.Read(X)
+		&& r.Read(Y)
+		&& r.Read(Z);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoP2SPlayerUpdateMsg& m) {
+	w.Write(m.WorldId);
+	w.Write((int16)m.X);
+	w.Write((int16)m.Y);
+	w.Write((int16)m.Z);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoP2SPlayerUpdateMsg& m) {
+	if (!ReadAs<int32>(r, m.WorldId))
+		return false;
+	if (!ReadAs<int16>(r, m.X))
+		return false;
+	if (!ReadAs<int16>(r, m.Y))
+		return false;
+	if (!ReadAs<int16>(r, m.Z))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- P2SLeavingGame
+void FUbermundoP2SLeavingGameWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(UbermundoId);
+}
+
+bool FUbermundoP2SLeavingGameWire::Read(FUbermundoWireReader& r) {
+	return r.Read(UbermundoId);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoP2SLeavingGameMsg& m) {
+	w.Write(m.UbermundoId);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoP2SLeavingGameMsg& m) {
+	if (!ReadAs<int32>(r, m.UbermundoId))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- P2SRequestLevelData
+void FUbermundoP2SRequestLevelDataWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(WorldId);
+}
+
+bool FUbermundoP2SRequestLevelDataWire::Read(FUbermundoWireReader& r) {
+	return r.Read(WorldId);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoP2SRequestLevelDataMsg& m) {
+	w.Write(m.WorldId);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoP2SRequestLevelDataMsg& m) {
+	if (!ReadAs<int32>(r, m.WorldId))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- P2SSaveLevelData
+void FUbermundoP2SSaveLevelDataWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(Metadata);
+	w.WriteSized(Contents);
+}
+
+bool FUbermundoP2SSaveLevelDataWire::Read(FUbermundoWireReader& r) {
+	return r.Read(Metadata)
+		&& r.ReadSized(Contents);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoP2SSaveLevelDataMsg& m) {
+	WriteMsg(w, m.Metadata);
+	w.WriteSized(m.Contents);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoP2SSaveLevelDataMsg& m) {
+	if (!ReadMsg(r, m.Metadata))
+		return false;
+	{
+		int32 n;
+		if (!r.ReadCount(n) || !r.ReadBytes(n, m.Contents))
+			return false;
+	}
+	return true;
+}
+
+// --------------------------------------------------------------------------------- P2SCreateNewWorld
+void FUbermundoP2SCreateNewWorldWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(Metadata);
+}
+
+bool FUbermundoP2SCreateNewWorldWire::Read(FUbermundoWireReader& r) {
+	return r.Read(Metadata);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoP2SCreateNewWorldMsg& m) {
+	WriteMsg(w, m.Metadata);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoP2SCreateNewWorldMsg& m) {
+	if (!ReadMsg(r, m.Metadata))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- P2SRequestLevelMetadata
+void FUbermundoP2SRequestLevelMetadataWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(WorldId);
+}
+
+bool FUbermundoP2SRequestLevelMetadataWire::Read(FUbermundoWireReader& r) {
+	return r.Read(WorldId);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoP2SRequestLevelMetadataMsg& m) {
+	w.Write(m.WorldId);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoP2SRequestLevelMetadataMsg& m) {
+	if (!ReadAs<int32>(r, m.WorldId))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- P2SRequestAllLevelMetas
+void FUbermundoP2SRequestAllLevelMetasWire::Write(FUbermundoWireWriter& w) const {
+}
+
+bool FUbermundoP2SRequestAllLevelMetasWire::Read(FUbermundoWireReader& r) {
+	return true;
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoP2SRequestAllLevelMetasMsg&) {
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoP2SRequestAllLevelMetasMsg&) {
+	return true;
+}
+
+// --------------------------------------------------------------------------------- P2SAddThing
+void FUbermundoP2SAddThingWire::Write(FUbermundoWireWriter& w) const {
+	w.WriteSized(AssetPath);
+}
+
+bool FUbermundoP2SAddThingWire::Read(FUbermundoWireReader& r) {
+	return r.ReadSized(AssetPath);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoP2SAddThingMsg& m) {
+	w.WriteString(m.AssetPath);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoP2SAddThingMsg& m) {
+	if (!r.ReadString(m.AssetPath))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- P2SRemoveThing
+void FUbermundoP2SRemoveThingWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(ThingId);
+}
+
+bool FUbermundoP2SRemoveThingWire::Read(FUbermundoWireReader& r) {
+	return r.Read(ThingId);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoP2SRemoveThingMsg& m) {
+	w.Write(m.ThingId);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoP2SRemoveThingMsg& m) {
+	if (!ReadAs<int32>(r, m.ThingId))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- P2SGetNextObjectID
+void FUbermundoP2SGetNextObjectIDWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(WorldId);
+}
+
+bool FUbermundoP2SGetNextObjectIDWire::Read(FUbermundoWireReader& r) {
+	return r.Read(WorldId);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoP2SGetNextObjectIDMsg& m) {
+	w.Write(m.WorldId);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoP2SGetNextObjectIDMsg& m) {
+	if (!ReadAs<int32>(r, m.WorldId))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- S2PYourUbermundoID
+void FUbermundoS2PYourUbermundoIDWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(UbermundoId);
+}
+
+bool FUbermundoS2PYourUbermundoIDWire::Read(FUbermundoWireReader& r) {
+	return r.Read(UbermundoId);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoS2PYourUbermundoIDMsg& m) {
+	w.Write(m.UbermundoId);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoS2PYourUbermundoIDMsg& m) {
+	if (!ReadAs<int32>(r, m.UbermundoId))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- S2PPlayerLeftLevel
+void FUbermundoS2PPlayerLeftLevelWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(UbermundoId);
+	w.WriteSteamId(SteamId);
+}
+
+bool FUbermundoS2PPlayerLeftLevelWire::Read(FUbermundoWireReader& r) {
+	return r.Read(UbermundoId)
+		&& r.ReadSteamId(SteamId);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoS2PPlayerLeftLevelMsg& m) {
+	w.Write(m.UbermundoId);
+	w.WriteSteamId((uint64)m.SteamId);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoS2PPlayerLeftLevelMsg& m) {
+	if (!ReadAs<int32>(r, m.UbermundoId))
+		return false;
+	if (!ReadSteamIdAs(r, m.SteamId))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- S2PPlayerEnteredLevel
+void FUbermundoS2PPlayerEnteredLevelWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(UbermundoId);
+	w.WriteSteamId(SteamId);
+}
+
+bool FUbermundoS2PPlayerEnteredLevelWire::Read(FUbermundoWireReader& r) {
+	return r.Read(UbermundoId)
+		&& r.ReadSteamId(SteamId);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoS2PPlayerEnteredLevelMsg& m) {
+	w.Write(m.UbermundoId);
+	w.WriteSteamId((uint64)m.SteamId);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoS2PPlayerEnteredLevelMsg& m) {
+	if (!ReadAs<int32>(r, m.UbermundoId))
+		return false;
+	if (!ReadSteamIdAs(r, m.SteamId))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- S2PAnnouncePlayersToClient_Steam
+void FUbermundoS2PAnnouncePlayersToClient_SteamWire::Write(FUbermundoWireWriter& w) const {
+	w.WriteCount(Players.Count());
+	Players.WriteItems(w);
+}
+
+bool FUbermundoS2PAnnouncePlayersToClient_SteamWire::Read(FUbermundoWireReader& r) {
+	int32 n;
+	return r.ReadCount(n)
+		&& Players.ReadItems(r, n);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoS2PAnnouncePlayersToClient_SteamMsg& m) {
+	w.WriteCount(m.Players.Num());
+	for (const FUbermundoAnnouncedPlayerMsg& v : m.Players)
+		WriteMsg(w, v);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoS2PAnnouncePlayersToClient_SteamMsg& m) {
+	{
+		int32 n;
+		if (!r.ReadCount(n))
+			return false;
+		m.Players.Reset();
+		// A bad count must not reserve gigabytes.
+		m.Players.Reserve(FMath::Min(n, r.Remaining() / 13));
+		for (int32 i = 0; i < n; i++) {
+			if (!ReadMsg(r, m.Players.AddDefaulted_GetRef()))
+				return false;
+		}
+	}
+	return true;
+}
+
+// --------------------------------------------------------------------------------- S2PLevelData
+void FUbermundoS2PLevelDataWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(Metadata);
+	w.WriteSized(Contents);
+}
+
+bool FUbermundoS2PLevelDataWire::Read(FUbermundoWireReader& r) {
+	return r.Read(Metadata)
+		&& r.ReadSized(Contents);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoS2PLevelDataMsg& m) {
+	WriteMsg(w, m.Metadata);
+	w.WriteSized(m.Contents);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoS2PLevelDataMsg& m) {
+	if (!ReadMsg(r, m.Metadata))
+		return false;
+	{
+		int32 n;
+		if (!r.ReadCount(n) || !r.ReadBytes(n, m.Contents))
+			return false;
+	}
+	return true;
+}
+
+// --------------------------------------------------------------------------------- S2PWorldCreated
+void FUbermundoS2PWorldCreatedWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(WorldId);
+}
+
+bool FUbermundoS2PWorldCreatedWire::Read(FUbermundoWireReader& r) {
+	return r.Read(WorldId);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoS2PWorldCreatedMsg& m) {
+	w.Write(m.WorldId);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoS2PWorldCreatedMsg& m) {
+	if (!ReadAs<int32>(r, m.WorldId))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- S2PLevelMetadata
+void FUbermundoS2PLevelMetadataWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(Metadata);
+}
+
+bool FUbermundoS2PLevelMetadataWire::Read(FUbermundoWireReader& r) {
+	return r.Read(Metadata);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoS2PLevelMetadataMsg& m) {
+	WriteMsg(w, m.Metadata);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoS2PLevelMetadataMsg& m) {
+	if (!ReadMsg(r, m.Metadata))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- S2PAllLevelMetadata
+void FUbermundoS2PAllLevelMetadataWire::Write(FUbermundoWireWriter& w) const {
+	w.WriteCountAs<int32>(Worlds.Count());
+	Worlds.WriteItems(w);
+}
+
+bool FUbermundoS2PAllLevelMetadataWire::Read(FUbermundoWireReader& r) {
+	int32 n;
+	return r.ReadCountAs<int32>(n)
+		&& Worlds.ReadItems(r, n);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoS2PAllLevelMetadataMsg& m) {
+	w.WriteCountAs<int32>(m.Worlds.Num());
+	for (const FUbermundoWorldMetadataMsg& v : m.Worlds)
+		WriteMsg(w, v);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoS2PAllLevelMetadataMsg& m) {
+	{
+		int32 n;
+		if (!r.ReadCountAs<int32>(n))
+			return false;
+		m.Worlds.Reset();
+		// A bad count must not reserve gigabytes.
+		m.Worlds.Reserve(FMath::Min(n, r.Remaining() / 15));
+		for (int32 i = 0; i < n; i++) {
+			if (!ReadMsg(r, m.Worlds.AddDefaulted_GetRef()))
+				return false;
+		}
+	}
+	return true;
+}
+
+// --------------------------------------------------------------------------------- S2PNextObjectID
+void FUbermundoS2PNextObjectIDWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(ObjectId);
+}
+
+bool FUbermundoS2PNextObjectIDWire::Read(FUbermundoWireReader& r) {
+	return r.Read(ObjectId);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoS2PNextObjectIDMsg& m) {
+	w.Write(m.ObjectId);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoS2PNextObjectIDMsg& m) {
+	if (!ReadAs<int32>(r, m.ObjectId))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- S2PAnnouncementMsg
+void FUbermundoS2PAnnouncementMsgWire::Write(FUbermundoWireWriter& w) const {
+	w.WriteSized(Message);
+}
+
+bool FUbermundoS2PAnnouncementMsgWire::Read(FUbermundoWireReader& r) {
+	return r.ReadSized(Message);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoS2PAnnouncementMsg& m) {
+	w.WriteString(m.Message);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoS2PAnnouncementMsg& m) {
+	if (!r.ReadString(m.Message))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- Bundle
+void FUbermundoBundleWire::Write(FUbermundoWireWriter& w) const {
+	w.WriteRaw(Messages);
+}
+
+bool FUbermundoBundleWire::Read(FUbermundoWireReader& r) {
+	return r.ReadRest(Messages);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoBundleMsg& m) {
+	w.WriteRaw(m.Messages);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoBundleMsg& m) {
+	if (!r.ReadBytes(r.Remaining(), m.Messages))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- Player3DState
+void FUbermundoPlayer3DStateWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(Sequence);
+	w.Write(BaselineOffset);
+	w.WriteRaw(Bits);
+}
+
+bool FUbermundoPlayer3DStateWire::Read(FUbermundoWireReader& r) {
+	return r.Read(Sequence)
+		&& r.Read(BaselineOffset)
+		&& r.ReadRest(Bits);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoPlayer3DStateMsg& m) {
+	w.Write((uint16)m.Sequence);
+	w.Write(m.BaselineOffset);
+	w.WriteRaw(m.Bits);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoPlayer3DStateMsg& m) {
+	if (!ReadAs<uint16>(r, m.Sequence))
+		return false;
+	if (!ReadAs<uint8>(r, m.BaselineOffset))
+		return false;
+	if (!r.ReadBytes(r.Remaining(), m.Bits))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- PlayerGrabbed
+void FUbermundoPlayerGrabbedWire::Write(FUbermundoWireWriter& w) const {
+	w.WriteRaw(Payload);
+}
+
+bool FUbermundoPlayerGrabbedWire::Read(FUbermundoWireReader& r) {
+	return r.ReadRest(Payload);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoPlayerGrabbedMsg& m) {
+	w.WriteRaw(m.Payload);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoPlayerGrabbedMsg& m) {
+	if (!r.ReadBytes(r.Remaining(), m.Payload))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- PlayerReleased
+void FUbermundoPlayerReleasedWire::Write(FUbermundoWireWriter& w) const {
+	w.WriteRaw(Payload);
+}
+
+bool FUbermundoPlayerReleasedWire::Read(FUbermundoWireReader& r) {
+	return r.ReadRest(Payload);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoPlayerReleasedMsg& m) {
+	w.WriteRaw(m.Payload);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoPlayerReleasedMsg& m) {
+	if (!r.ReadBytes(r.Remaining(), m.Payload))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- Player3DStateAck
+void FUbermundoPlayer3DStateAckWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(Sequence);
+}
+
+bool FUbermundoPlayer3DStateAckWire::Read(FUbermundoWireReader& r) {
+	return r.Read(Sequence);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoPlayer3DStateAckMsg& m) {
+	w.Write((uint16)m.Sequence);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoPlayer3DStateAckMsg& m) {
+	if (!ReadAs<uint16>(r, m.Sequence))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- ClockPing
+void FUbermundoClockPingWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(SentMicros);
+}
+
+bool FUbermundoClockPingWire::Read(FUbermundoWireReader& r) {
+	return r.Read(SentMicros);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoClockPingMsg& m) {
+	w.Write((uint64)m.SentMicros);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoClockPingMsg& m) {
+	if (!ReadAs<uint64>(r, m.SentMicros))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- ClockPong
+void FUbermundoClockPongWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(PingSentMicros);
+	w.Write(ArrivedMicros);
+	w.Write(SentMicros);
+}
+
+bool FUbermundoClockPongWire::Read(FUbermundoWireReader& r) {
+	return r.Read(PingSentMicros)
+		&& r.Read(ArrivedMicros)
+		&& r.Read(SentMicros);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoClockPongMsg& m) {
+	w.Write((uint64)m.PingSentMicros);
+	w.Write((uint64)m.ArrivedMicros);
+	w.Write((uint64)m.SentMicros);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoClockPongMsg& m) {
+	if (!ReadAs<uint64>(r, m.PingSentMicros))
+		return false;
+	if (!ReadAs<uint64>(r, m.ArrivedMicros))
+		return false;
+	if (!ReadAs<uint64>(r, m.SentMicros))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- SessionPing
+void FUbermundoSessionPingWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(Kind);
+	w.Write(Micros);
+}
+
+bool FUbermundoSessionPingWire::Read(FUbermundoWireReader& r) {
+	return r.Read(Kind)
+		&& r.Read(Micros);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoSessionPingMsg& m) {
+	w.Write(m.Kind);
+	w.Write((uint64)m.Micros);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoSessionPingMsg& m) {
+	if (!ReadAs<uint8>(r, m.Kind))
+		return false;
+	if (!ReadAs<uint64>(r, m.Micros))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- BulkChunk
+void FUbermundoBulkChunkWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(TransferId);
+	w.Write(TotalSize);
+	w.Write(Index);
+	w.WriteRaw(Bytes);
+}
+
+bool FUbermundoBulkChunkWire::Read(FUbermundoWireReader& r) {
+	return r.Read(TransferId)
+		&& r.Read(TotalSize)
+		&& r.Read(Index)
+		&& r.ReadRest(Bytes);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoBulkChunkMsg& m) {
+	w.Write((uint32)m.TransferId);
+	w.Write((uint32)m.TotalSize);
+	w.Write((uint16)m.Index);
+	w.WriteRaw(m.Bytes);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoBulkChunkMsg& m) {
+	if (!ReadAs<uint32>(r, m.TransferId))
+		return false;
+	if (!ReadAs<uint32>(r, m.TotalSize))
+		return false;
+	if (!ReadAs<uint16>(r, m.Index))
+		return false;
+	if (!r.ReadBytes(r.Remaining(), m.Bytes))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- BulkAck
+void FUbermundoBulkAckWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(TransferId);
+	w.Write(InOrder);
+	w.WriteCountAs<uint8>(Bitmap.Num());
+	w.WriteRaw(Bitmap);
+}
+
+bool FUbermundoBulkAckWire::Read(FUbermundoWireReader& r) {
+	int32 n;
+	return r.Read(TransferId)
+		&& r.Read(InOrder)
+		&& r.ReadCountAs<uint8>(n)
+		&& r.ReadRaw(n, Bitmap);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoBulkAckMsg& m) {
+	w.Write((uint32)m.TransferId);
+	w.Write((uint16)m.InOrder);
+	w.WriteCountAs<uint8>(m.Bitmap.Num());
+	w.WriteRaw(m.Bitmap);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoBulkAckMsg& m) {
+	if (!ReadAs<uint32>(r, m.TransferId))
+		return false;
+	if (!ReadAs<uint16>(r, m.InOrder))
+		return false;
+	{
+		int32 n;
+		if (!r.ReadCountAs<uint8>(n) || !r.ReadBytes(n, m.Bitmap))
+			return false;
+	}
+	return true;
+}
+
+// --------------------------------------------------------------------------------- PlayerTextMsg
+void FUbermundoPlayerTextMsgWire::Write(FUbermundoWireWriter& w) const {
+	w.WriteSized(Text);
+}
+
+bool FUbermundoPlayerTextMsgWire::Read(FUbermundoWireReader& r) {
+	return r.ReadSized(Text);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoPlayerTextMsg& m) {
+	w.WriteString(m.Text);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoPlayerTextMsg& m) {
+	if (!r.ReadString(m.Text))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- PlayerImageMsg
+void FUbermundoPlayerImageMsgWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(ImageId);
+	w.Write(Width);
+	w.Write(Height);
+	w.Write(TileSize);
+	w.Write(NumPasses);
+	w.WriteRaw(Thumbnail);
+}
+
+bool FUbermundoPlayerImageMsgWire::Read(FUbermundoWireReader& r) {
+	return r.Read(ImageId)
+		&& r.Read(Width)
+		&& r.Read(Height)
+		&& r.Read(TileSize)
+		&& r.Read(NumPasses)
+		&& r.ReadRest(Thumbnail);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoPlayerImageMsg& m) {
+	w.Write((uint32)m.ImageId);
+	w.Write((uint16)m.Width);
+	w.Write((uint16)m.Height);
+	w.Write((uint16)m.TileSize);
+	w.Write(m.NumPasses);
+	w.WriteRaw(m.Thumbnail);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoPlayerImageMsg& m) {
+	if (!ReadAs<uint32>(r, m.ImageId))
+		return false;
+	if (!ReadAs<uint16>(r, m.Width))
+		return false;
+	if (!ReadAs<uint16>(r, m.Height))
+		return false;
+	if (!ReadAs<uint16>(r, m.TileSize))
+		return false;
+	if (!ReadAs<uint8>(r, m.NumPasses))
+		return false;
+	if (!r.ReadBytes(r.Remaining(), m.Thumbnail))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- PlayerVoiceMsg
+void FUbermundoPlayerVoiceMsgWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(Sequence);
+	w.Write(CapturedMs);
+	w.WriteRaw(Opus);
+}
+
+bool FUbermundoPlayerVoiceMsgWire::Read(FUbermundoWireReader& r) {
+	return r.Read(Sequence)
+		&& r.Read(CapturedMs)
+		&& r.ReadRest(Opus);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoPlayerVoiceMsg& m) {
+	w.Write((uint16)m.Sequence);
+	w.Write((uint32)m.CapturedMs);
+	w.WriteRaw(m.Opus);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoPlayerVoiceMsg& m) {
+	if (!ReadAs<uint16>(r, m.Sequence))
+		return false;
+	if (!ReadAs<uint32>(r, m.CapturedMs))
+		return false;
+	if (!r.ReadBytes(r.Remaining(), m.Opus))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- PlayerEmoteMsg
+void FUbermundoPlayerEmoteMsgWire::Write(FUbermundoWireWriter& w) const {
+	w.WriteRaw(Payload);
+}
+
+bool FUbermundoPlayerEmoteMsgWire::Read(FUbermundoWireReader& r) {
+	return r.ReadRest(Payload);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoPlayerEmoteMsg& m) {
+	w.WriteRaw(m.Payload);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoPlayerEmoteMsg& m) {
+	if (!r.ReadBytes(r.Remaining(), m.Payload))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- PlayerImageTile
+void FUbermundoPlayerImageTileWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(ImageId);
+	w.Write(TileX);
+	w.Write(TileY);
+	w.Write(Pass);
+	w.WriteRaw(Tile);
+}
+
+bool FUbermundoPlayerImageTileWire::Read(FUbermundoWireReader& r) {
+	return r.Read(ImageId)
+		&& r.Read(TileX)
+		&& r.Read(TileY)
+		&& r.Read(Pass)
+		&& r.ReadRest(Tile);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoPlayerImageTileMsg& m) {
+	w.Write((uint32)m.ImageId);
+	w.Write(m.TileX);
+	w.Write(m.TileY);
+	w.Write(m.Pass);
+	w.WriteRaw(m.Tile);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoPlayerImageTileMsg& m) {
+	if (!ReadAs<uint32>(r, m.ImageId))
+		return false;
+	if (!ReadAs<uint8>(r, m.TileX))
+		return false;
+	if (!ReadAs<uint8>(r, m.TileY))
+		return false;
+	if (!ReadAs<uint8>(r, m.Pass))
+		return false;
+	if (!r.ReadBytes(r.Remaining(), m.Tile))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- BlockWant
+void FUbermundoBlockWantWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(BlockId);
+}
+
+bool FUbermundoBlockWantWire::Read(FUbermundoWireReader& r) {
+	return r.Read(BlockId);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoBlockWantMsg& m) {
+	w.Write((uint64)m.BlockId);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoBlockWantMsg& m) {
+	if (!ReadAs<uint64>(r, m.BlockId))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- BlockHave
+void FUbermundoBlockHaveWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(BlockId);
+	w.Write(Version);
+}
+
+bool FUbermundoBlockHaveWire::Read(FUbermundoWireReader& r) {
+	return r.Read(BlockId)
+		&& r.Read(Version);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoBlockHaveMsg& m) {
+	w.Write((uint64)m.BlockId);
+	w.Write((uint32)m.Version);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoBlockHaveMsg& m) {
+	if (!ReadAs<uint64>(r, m.BlockId))
+		return false;
+	if (!ReadAs<uint32>(r, m.Version))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- BlockManifestRequest
+void FUbermundoBlockManifestRequestWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(BlockId);
+	w.Write(Nonce);
+}
+
+bool FUbermundoBlockManifestRequestWire::Read(FUbermundoWireReader& r) {
+	return r.Read(BlockId)
+		&& r.Read(Nonce);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoBlockManifestRequestMsg& m) {
+	w.Write((uint64)m.BlockId);
+	w.Write((uint32)m.Nonce);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoBlockManifestRequestMsg& m) {
+	if (!ReadAs<uint64>(r, m.BlockId))
+		return false;
+	if (!ReadAs<uint32>(r, m.Nonce))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- BlockManifest
+void FUbermundoBlockManifestWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(BlockId);
+	w.Write(BlockSize);
+	w.WriteFixed(Sha1, 20);
+	Chunks.WriteItems(w);
+}
+
+bool FUbermundoBlockManifestWire::Read(FUbermundoWireReader& r) {
+	return r.Read(BlockId)
+		&& r.Read(BlockSize)
+		&& r.ReadRaw(20, Sha1)
+		&& Chunks.ReadItems(r, -1);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoBlockManifestMsg& m) {
+	w.Write((uint64)m.BlockId);
+	w.Write((uint32)m.BlockSize);
+	w.WriteFixed(m.Sha1, 20);
+	for (const FUbermundoBlockChunkHashMsg& v : m.Chunks)
+		WriteMsg(w, v);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoBlockManifestMsg& m) {
+	if (!ReadAs<uint64>(r, m.BlockId))
+		return false;
+	if (!ReadAs<uint32>(r, m.BlockSize))
+		return false;
+	if (!r.ReadBytes(20, m.Sha1))
+		return false;
+	m.Chunks.Reset();
+	while (r.Remaining() > 0) {
+		if (!ReadMsg(r, m.Chunks.AddDefaulted_GetRef()))
+			return false;
+	}
+	return true;
+}
+
+// --------------------------------------------------------------------------------- BlockChunkRequest
+void FUbermundoBlockChunkRequestWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(BlockId);
+	w.WriteCountAs<uint8>(Chunks.Count());
+	Chunks.WriteItems(w);
+}
+
+bool FUbermundoBlockChunkRequestWire::Read(FUbermundoWireReader& r) {
+	int32 n;
+	return r.Read(BlockId)
+		&& r.ReadCountAs<uint8>(n)
+		&& Chunks.ReadItems(r, n);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoBlockChunkRequestMsg& m) {
+	w.Write((uint64)m.BlockId);
+	w.WriteCountAs<uint8>(m.Chunks.Num());
+	for (int32 v : m.Chunks)
+		w.Write((uint16)v);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoBlockChunkRequestMsg& m) {
+	if (!ReadAs<uint64>(r, m.BlockId))
+		return false;
+	{
+		int32 n;
+		if (!r.ReadCountAs<uint8>(n))
+			return false;
+		m.Chunks.Reset();
+		// A bad count must not reserve gigabytes.
+		m.Chunks.Reserve(FMath::Min(n, r.Remaining() / 2));
+		for (int32 i = 0; i < n; i++) {
+			if (!ReadAs<uint16>(r, m.Chunks.AddDefaulted_GetRef()))
+				return false;
+		}
+	}
+	return true;
+}
+
+// --------------------------------------------------------------------------------- BlockChunk
+void FUbermundoBlockChunkWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(BlockId);
+	w.Write(Index);
+	w.WriteRaw(Bytes);
+}
+
+bool FUbermundoBlockChunkWire::Read(FUbermundoWireReader& r) {
+	return r.Read(BlockId)
+		&& r.Read(Index)
+		&& r.ReadRest(Bytes);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoBlockChunkMsg& m) {
+	w.Write((uint64)m.BlockId);
+	w.Write((uint16)m.Index);
+	w.WriteRaw(m.Bytes);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoBlockChunkMsg& m) {
+	if (!ReadAs<uint64>(r, m.BlockId))
+		return false;
+	if (!ReadAs<uint16>(r, m.Index))
+		return false;
+	if (!r.ReadBytes(r.Remaining(), m.Bytes))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- BlockMissing
+void FUbermundoBlockMissingWire::Write(FUbermundoWireWriter& w) const {
+	w.Write(BlockId);
+}
+
+bool FUbermundoBlockMissingWire::Read(FUbermundoWireReader& r) {
+	return r.Read(BlockId);
+}
+
+static void WriteMsg(FUbermundoWireWriter& w, const FUbermundoBlockMissingMsg& m) {
+	w.Write((uint64)m.BlockId);
+}
+
+static bool ReadMsg(FUbermundoWireReader& r, FUbermundoBlockMissingMsg& m) {
+	if (!ReadAs<uint64>(r, m.BlockId))
+		return false;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- UUbermundoMessageLibrary
+template<typename TMsg>
+static TArray<uint8> EncodeMsg(uint8 code, const TMsg& m) {
+	FUbermundoWireWriter size(nullptr, 0);
+	size.Write(code);
+	WriteMsg(size, m);
+	TArray<uint8> out;
+	out.SetNumUninitialized(size.Num());
+	FUbermundoWireWriter w(out.GetData(), out.Num());
+	w.Write(code);
+	WriteMsg(w, m);
+	if (!w.IsOk()) {
+		UE_LOG(UberMundoSteamLog, Warning, TEXT("Message %d not encoded, a count or fixed size field is out of range"), code);
+		out.Reset();
+	}
+	return out;
+}
+
+template<typename TMsg>
+static bool DecodeMsg(uint8 code, const TArray<uint8>& message, TMsg& out) {
+	out = TMsg();
+	FUbermundoWireReader r(message.GetData(), message.Num());
+	uint8 c;
+	return r.Read(c) && c == code && ReadMsg(r, out);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeP2SPlayerAnnounce_Steam(const FUbermundoP2SPlayerAnnounce_SteamMsg& message) {
+	return EncodeMsg(FUbermundoP2SPlayerAnnounce_SteamWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeP2SPlayerAnnounce_Steam(const TArray<uint8>& message, FUbermundoP2SPlayerAnnounce_SteamMsg& decoded) {
+	return DecodeMsg(FUbermundoP2SPlayerAnnounce_SteamWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeP2SPlayerUpdate(const FUbermundoP2SPlayerUpdateMsg& message) {
+	return EncodeMsg(FUbermundoP2SPlayerUpdateWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeP2SPlayerUpdate(const TArray<uint8>& message, FUbermundoP2SPlayerUpdateMsg& decoded) {
+	return DecodeMsg(FUbermundoP2SPlayerUpdateWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeP2SLeavingGame(const FUbermundoP2SLeavingGameMsg& message) {
+	return EncodeMsg(FUbermundoP2SLeavingGameWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeP2SLeavingGame(const TArray<uint8>& message, FUbermundoP2SLeavingGameMsg& decoded) {
+	return DecodeMsg(FUbermundoP2SLeavingGameWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeP2SRequestLevelData(const FUbermundoP2SRequestLevelDataMsg& message) {
+	return EncodeMsg(FUbermundoP2SRequestLevelDataWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeP2SRequestLevelData(const TArray<uint8>& message, FUbermundoP2SRequestLevelDataMsg& decoded) {
+	return DecodeMsg(FUbermundoP2SRequestLevelDataWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeP2SSaveLevelData(const FUbermundoP2SSaveLevelDataMsg& message) {
+	return EncodeMsg(FUbermundoP2SSaveLevelDataWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeP2SSaveLevelData(const TArray<uint8>& message, FUbermundoP2SSaveLevelDataMsg& decoded) {
+	return DecodeMsg(FUbermundoP2SSaveLevelDataWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeP2SCreateNewWorld(const FUbermundoP2SCreateNewWorldMsg& message) {
+	return EncodeMsg(FUbermundoP2SCreateNewWorldWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeP2SCreateNewWorld(const TArray<uint8>& message, FUbermundoP2SCreateNewWorldMsg& decoded) {
+	return DecodeMsg(FUbermundoP2SCreateNewWorldWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeP2SRequestLevelMetadata(const FUbermundoP2SRequestLevelMetadataMsg& message) {
+	return EncodeMsg(FUbermundoP2SRequestLevelMetadataWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeP2SRequestLevelMetadata(const TArray<uint8>& message, FUbermundoP2SRequestLevelMetadataMsg& decoded) {
+	return DecodeMsg(FUbermundoP2SRequestLevelMetadataWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeP2SRequestAllLevelMetas(const FUbermundoP2SRequestAllLevelMetasMsg& message) {
+	return EncodeMsg(FUbermundoP2SRequestAllLevelMetasWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeP2SRequestAllLevelMetas(const TArray<uint8>& message, FUbermundoP2SRequestAllLevelMetasMsg& decoded) {
+	return DecodeMsg(FUbermundoP2SRequestAllLevelMetasWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeP2SAddThing(const FUbermundoP2SAddThingMsg& message) {
+	return EncodeMsg(FUbermundoP2SAddThingWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeP2SAddThing(const TArray<uint8>& message, FUbermundoP2SAddThingMsg& decoded) {
+	return DecodeMsg(FUbermundoP2SAddThingWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeP2SRemoveThing(const FUbermundoP2SRemoveThingMsg& message) {
+	return EncodeMsg(FUbermundoP2SRemoveThingWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeP2SRemoveThing(const TArray<uint8>& message, FUbermundoP2SRemoveThingMsg& decoded) {
+	return DecodeMsg(FUbermundoP2SRemoveThingWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeP2SGetNextObjectID(const FUbermundoP2SGetNextObjectIDMsg& message) {
+	return EncodeMsg(FUbermundoP2SGetNextObjectIDWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeP2SGetNextObjectID(const TArray<uint8>& message, FUbermundoP2SGetNextObjectIDMsg& decoded) {
+	return DecodeMsg(FUbermundoP2SGetNextObjectIDWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeS2PYourUbermundoID(const FUbermundoS2PYourUbermundoIDMsg& message) {
+	return EncodeMsg(FUbermundoS2PYourUbermundoIDWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeS2PYourUbermundoID(const TArray<uint8>& message, FUbermundoS2PYourUbermundoIDMsg& decoded) {
+	return DecodeMsg(FUbermundoS2PYourUbermundoIDWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeS2PPlayerLeftLevel(const FUbermundoS2PPlayerLeftLevelMsg& message) {
+	return EncodeMsg(FUbermundoS2PPlayerLeftLevelWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeS2PPlayerLeftLevel(const TArray<uint8>& message, FUbermundoS2PPlayerLeftLevelMsg& decoded) {
+	return DecodeMsg(FUbermundoS2PPlayerLeftLevelWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeS2PPlayerEnteredLevel(const FUbermundoS2PPlayerEnteredLevelMsg& message) {
+	return EncodeMsg(FUbermundoS2PPlayerEnteredLevelWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeS2PPlayerEnteredLevel(const TArray<uint8>& message, FUbermundoS2PPlayerEnteredLevelMsg& decoded) {
+	return DecodeMsg(FUbermundoS2PPlayerEnteredLevelWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeS2PAnnouncePlayersToClient_Steam(const FUbermundoS2PAnnouncePlayersToClient_SteamMsg& message) {
+	return EncodeMsg(FUbermundoS2PAnnouncePlayersToClient_SteamWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeS2PAnnouncePlayersToClient_Steam(const TArray<uint8>& message, FUbermundoS2PAnnouncePlayersToClient_SteamMsg& decoded) {
+	return DecodeMsg(FUbermundoS2PAnnouncePlayersToClient_SteamWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeS2PLevelData(const FUbermundoS2PLevelDataMsg& message) {
+	return EncodeMsg(FUbermundoS2PLevelDataWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeS2PLevelData(const TArray<uint8>& message, FUbermundoS2PLevelDataMsg& decoded) {
+	return DecodeMsg(FUbermundoS2PLevelDataWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeS2PWorldCreated(const FUbermundoS2PWorldCreatedMsg& message) {
+	return EncodeMsg(FUbermundoS2PWorldCreatedWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeS2PWorldCreated(const TArray<uint8>& message, FUbermundoS2PWorldCreatedMsg& decoded) {
+	return DecodeMsg(FUbermundoS2PWorldCreatedWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeS2PLevelMetadata(const FUbermundoS2PLevelMetadataMsg& message) {
+	return EncodeMsg(FUbermundoS2PLevelMetadataWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeS2PLevelMetadata(const TArray<uint8>& message, FUbermundoS2PLevelMetadataMsg& decoded) {
+	return DecodeMsg(FUbermundoS2PLevelMetadataWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeS2PAllLevelMetadata(const FUbermundoS2PAllLevelMetadataMsg& message) {
+	return EncodeMsg(FUbermundoS2PAllLevelMetadataWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeS2PAllLevelMetadata(const TArray<uint8>& message, FUbermundoS2PAllLevelMetadataMsg& decoded) {
+	return DecodeMsg(FUbermundoS2PAllLevelMetadataWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeS2PNextObjectID(const FUbermundoS2PNextObjectIDMsg& message) {
+	return EncodeMsg(FUbermundoS2PNextObjectIDWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeS2PNextObjectID(const TArray<uint8>& message, FUbermundoS2PNextObjectIDMsg& decoded) {
+	return DecodeMsg(FUbermundoS2PNextObjectIDWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeS2PAnnouncementMsg(const FUbermundoS2PAnnouncementMsg& message) {
+	return EncodeMsg(FUbermundoS2PAnnouncementMsgWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeS2PAnnouncementMsg(const TArray<uint8>& message, FUbermundoS2PAnnouncementMsg& decoded) {
+	return DecodeMsg(FUbermundoS2PAnnouncementMsgWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeBundle(const FUbermundoBundleMsg& message) {
+	return EncodeMsg(FUbermundoBundleWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeBundle(const TArray<uint8>& message, FUbermundoBundleMsg& decoded) {
+	return DecodeMsg(FUbermundoBundleWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodePlayer3DState(const FUbermundoPlayer3DStateMsg& message) {
+	return EncodeMsg(FUbermundoPlayer3DStateWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodePlayer3DState(const TArray<uint8>& message, FUbermundoPlayer3DStateMsg& decoded) {
+	return DecodeMsg(FUbermundoPlayer3DStateWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodePlayerGrabbed(const FUbermundoPlayerGrabbedMsg& message) {
+	return EncodeMsg(FUbermundoPlayerGrabbedWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodePlayerGrabbed(const TArray<uint8>& message, FUbermundoPlayerGrabbedMsg& decoded) {
+	return DecodeMsg(FUbermundoPlayerGrabbedWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodePlayerReleased(const FUbermundoPlayerReleasedMsg& message) {
+	return EncodeMsg(FUbermundoPlayerReleasedWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodePlayerReleased(const TArray<uint8>& message, FUbermundoPlayerReleasedMsg& decoded) {
+	return DecodeMsg(FUbermundoPlayerReleasedWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodePlayer3DStateAck(const FUbermundoPlayer3DStateAckMsg& message) {
+	return EncodeMsg(FUbermundoPlayer3DStateAckWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodePlayer3DStateAck(const TArray<uint8>& message, FUbermundoPlayer3DStateAckMsg& decoded) {
+	return DecodeMsg(FUbermundoPlayer3DStateAckWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeClockPing(const FUbermundoClockPingMsg& message) {
+	return EncodeMsg(FUbermundoClockPingWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeClockPing(const TArray<uint8>& message, FUbermundoClockPingMsg& decoded) {
+	return DecodeMsg(FUbermundoClockPingWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeClockPong(const FUbermundoClockPongMsg& message) {
+	return EncodeMsg(FUbermundoClockPongWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeClockPong(const TArray<uint8>& message, FUbermundoClockPongMsg& decoded) {
+	return DecodeMsg(FUbermundoClockPongWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeSessionPing(const FUbermundoSessionPingMsg& message) {
+	return EncodeMsg(FUbermundoSessionPingWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeSessionPing(const TArray<uint8>& message, FUbermundoSessionPingMsg& decoded) {
+	return DecodeMsg(FUbermundoSessionPingWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeBulkChunk(const FUbermundoBulkChunkMsg& message) {
+	return EncodeMsg(FUbermundoBulkChunkWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeBulkChunk(const TArray<uint8>& message, FUbermundoBulkChunkMsg& decoded) {
+	return DecodeMsg(FUbermundoBulkChunkWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeBulkAck(const FUbermundoBulkAckMsg& message) {
+	return EncodeMsg(FUbermundoBulkAckWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeBulkAck(const TArray<uint8>& message, FUbermundoBulkAckMsg& decoded) {
+	return DecodeMsg(FUbermundoBulkAckWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodePlayerTextMsg(const FUbermundoPlayerTextMsg& message) {
+	return EncodeMsg(FUbermundoPlayerTextMsgWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodePlayerTextMsg(const TArray<uint8>& message, FUbermundoPlayerTextMsg& decoded) {
+	return DecodeMsg(FUbermundoPlayerTextMsgWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodePlayerImageMsg(const FUbermundoPlayerImageMsg& message) {
+	return EncodeMsg(FUbermundoPlayerImageMsgWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodePlayerImageMsg(const TArray<uint8>& message, FUbermundoPlayerImageMsg& decoded) {
+	return DecodeMsg(FUbermundoPlayerImageMsgWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodePlayerVoiceMsg(const FUbermundoPlayerVoiceMsg& message) {
+	return EncodeMsg(FUbermundoPlayerVoiceMsgWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodePlayerVoiceMsg(const TArray<uint8>& message, FUbermundoPlayerVoiceMsg& decoded) {
+	return DecodeMsg(FUbermundoPlayerVoiceMsgWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodePlayerEmoteMsg(const FUbermundoPlayerEmoteMsg& message) {
+	return EncodeMsg(FUbermundoPlayerEmoteMsgWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodePlayerEmoteMsg(const TArray<uint8>& message, FUbermundoPlayerEmoteMsg& decoded) {
+	return DecodeMsg(FUbermundoPlayerEmoteMsgWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodePlayerImageTile(const FUbermundoPlayerImageTileMsg& message) {
+	return EncodeMsg(FUbermundoPlayerImageTileWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodePlayerImageTile(const TArray<uint8>& message, FUbermundoPlayerImageTileMsg& decoded) {
+	return DecodeMsg(FUbermundoPlayerImageTileWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeBlockWant(const FUbermundoBlockWantMsg& message) {
+	return EncodeMsg(FUbermundoBlockWantWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeBlockWant(const TArray<uint8>& message, FUbermundoBlockWantMsg& decoded) {
+	return DecodeMsg(FUbermundoBlockWantWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeBlockHave(const FUbermundoBlockHaveMsg& message) {
+	return EncodeMsg(FUbermundoBlockHaveWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeBlockHave(const TArray<uint8>& message, FUbermundoBlockHaveMsg& decoded) {
+	return DecodeMsg(FUbermundoBlockHaveWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeBlockManifestRequest(const FUbermundoBlockManifestRequestMsg& message) {
+	return EncodeMsg(FUbermundoBlockManifestRequestWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeBlockManifestRequest(const TArray<uint8>& message, FUbermundoBlockManifestRequestMsg& decoded) {
+	return DecodeMsg(FUbermundoBlockManifestRequestWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeBlockManifest(const FUbermundoBlockManifestMsg& message) {
+	return EncodeMsg(FUbermundoBlockManifestWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeBlockManifest(const TArray<uint8>& message, FUbermundoBlockManifestMsg& decoded) {
+	return DecodeMsg(FUbermundoBlockManifestWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeBlockChunkRequest(const FUbermundoBlockChunkRequestMsg& message) {
+	return EncodeMsg(FUbermundoBlockChunkRequestWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeBlockChunkRequest(const TArray<uint8>& message, FUbermundoBlockChunkRequestMsg& decoded) {
+	return DecodeMsg(FUbermundoBlockChunkRequestWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeBlockChunk(const FUbermundoBlockChunkMsg& message) {
+	return EncodeMsg(FUbermundoBlockChunkWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeBlockChunk(const TArray<uint8>& message, FUbermundoBlockChunkMsg& decoded) {
+	return DecodeMsg(FUbermundoBlockChunkWire::Code, message, decoded);
+}
+
+TArray<uint8> UUbermundoMessageLibrary::EncodeBlockMissing(const FUbermundoBlockMissingMsg& message) {
+	return EncodeMsg(FUbermundoBlockMissingWire::Code, message);
+}
+
+bool UUbermundoMessageLibrary::DecodeBlockMissing(const TArray<uint8>& message, FUbermundoBlockMissingMsg& decoded) {
+	return DecodeMsg(FUbermundoBlockMissingWire::Code, message, decoded);
+}
@@ -0,0 +1,525 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+
+#include "UbermundoNetBenchmarks.h"
+#include "SteamCustomCode.h"
+#include "UbermundoTransport.h"
+#include "UbermundoSteamSocketsTransport.h"
+#include "UbermundoNetCapture.h"
+#include "UbermundoP2PInbox.h"
+#include "UbermundoP2POutbox.h"
+#include "UbermundoNetTick.h"
+#include "UbermundoVoice.h"
+#include "UbermundoClockSync.h"
+#include "UbermundoMessages.h"
+#include "Misc/FileHelper.h"
+#include "Math/RandomStream.h"
+
+TArray<FUbermundoPlayer3DState> UUbermundoNetBenchmarks::recordedTrace;
+
+/** Player3DState as plain floats: code, location, rotation, velocity, Int32 time. What the codec is compared against. */
+#define UBERMUNDO_RAW_STATE_BYTES (1 + 9 * 4 + 4)
+
+/** Local ports the transport benchmark's loopback pair binds. */
+#define UBERMUNDO_BENCH_PORT_A 47101
+#define UBERMUNDO_BENCH_PORT_B 47102
+
+/** Game ticks per second the unpaced capture replay pretends to run at, so drains come in the sizes a real frame sees. */
+#define UBERMUNDO_BENCH_REPLAY_HZ 60.0
+
+/** Everything the codec benchmark decodes is added here, so the compiler can't drop the work. */
+static volatile uint64 benchmarkSink = 0;
+
+void UUbermundoNetBenchmarks::RecordMovementTraceSample(const FUbermundoPlayer3DState& state) {
+	recordedTrace.Add(state);
+}
+
+bool UUbermundoNetBenchmarks::SaveMovementTrace(const FString& csvPath) {
+	TArray<FString> lines;
+	lines.Reserve(recordedTrace.Num());
+	for (const FUbermundoPlayer3DState& s : recordedTrace) {
+		lines.Add(FString::Printf(TEXT("%d,%f,%f,%f,%f,%f,%f,%f,%f,%f"), s.TimestampMs,
+			s.Location.X, s.Location.Y, s.Location.Z,
+			s.Rotation.Pitch, s.Rotation.Yaw, s.Rotation.Roll,
+			s.Velocity.X, s.Velocity.Y, s.Velocity.Z));
+	}
+	if (!FFileHelper::SaveStringArrayToFile(lines, *csvPath)) {
+		UE_LOG(UberMundoSteamLog, Error, TEXT("SaveMovementTrace could not write %s"), *csvPath);
+		return false;
+	}
+	UE_LOG(UberMundoSteamLog, Display, TEXT("SaveMovementTrace %d samples to %s"), recordedTrace.Num(), *csvPath);
+	recordedTrace.Empty();
+	return true;
+}
+
+bool UUbermundoNetBenchmarks::LoadMovementTrace(const FString& csvPath, TArray<FUbermundoPlayer3DState>& trace) {
+	TArray<FString> lines;
+	if (!FFileHelper::LoadFileToStringArray(lines, *csvPath)) {
+		UE_LOG(UberMundoSteamLog, Error, TEXT("LoadMovementTrace could not read %s"), *csvPath);
+		return false;
+	}
+	trace.Reset(lines.Num());
+	TArray<FString> cols;
+	for (const FString& line : lines) {
+		cols.Reset();
+		line.ParseIntoArray(cols, TEXT(","));
+		if (cols.Num() < 10)
+			continue;
+		FUbermundoPlayer3DState& s = trace.AddDefaulted_GetRef();
+		s.TimestampMs = FCString::Atoi(*cols[0]);
+		s.Location = FVector(FCString::Atof(*cols[1]), FCString::Atof(*cols[2]), FCString::Atof(*cols[3]));
+		s.Rotation = FRotator(FCString::Atof(*cols[4]), FCString::Atof(*cols[5]), FCString::Atof(*cols[6]));
+		s.Velocity = FVector(FCString::Atof(*cols[7]), FCString::Atof(*cols[8]), FCString::Atof(*cols[9]));
+	}
+	return trace.Num() > 0;
+}
+
+bool UUbermundoNetBenchmarks::BenchmarkSnapshotCodec(const FString& traceCsvPath, float lossRate, int32 ackDelaySnapshots, FString& report) {
+	TArray<FUbermundoPlayer3DState> trace;
+	if (!LoadMovementTrace(traceCsvPath, trace)) {
+		report = FString::Printf(TEXT("No movement trace in %s"), *traceCsvPath);
+		return false;
+	}
+
+	// Two codecs talking to each other: one sends, one receives and acks.
+	const uint64 receiverId = 1;
+	const uint64 senderId = 2;
+	FUbermundoSnapshotCodec sender;
+	FUbermundoSnapshotCodec receiver;
+	FRandomStream rng(1234);
+
+	struct FPendingAck {
+		int32 deliverAt;
+		uint16 seq;
+	};
+	TArray<FPendingAck> acks;
+
+	int64 bytes = 0;
+	int32 fulls = 0;
+	int32 lost = 0;
+	int32 undecodable = 0;
+	float maxLocError = 0.0f;
+	uint64 encodeCycles = 0;
+	uint64 decodeCycles = 0;
+
+	for (int32 i = 0; i < trace.Num(); i++) {
+		// Acks that have made it back by now.
+		for (int32 a = acks.Num() - 1; a >= 0; a--) {
+			if (acks[a].deliverAt <= i) {
+				sender.OnAck(receiverId, acks[a].seq);
+				acks.RemoveAtSwap(a, 1, false);
+			}
+		}
+
+		uint64 t0 = FPlatformTime::Cycles64();
+		sender.BeginSnapshot(trace[i]);
+		const FUbermundoPacketRef& p = sender.GetPacketFor(receiverId);
+		encodeCycles += FPlatformTime::Cycles64() - t0;
+
+		bytes += p.Num();
+		if (p.GetData()[3] == 0)
+			fulls++;
+
+		if (rng.FRand() < lossRate) {
+			lost++;
+			continue;
+		}
+
+		FUbermundoPlayer3DState out;
+		uint16 seq;
+		t0 = FPlatformTime::Cycles64();
+		bool ok = receiver.Decode(senderId, p.GetData(), p.Num(), out, seq);
+		decodeCycles += FPlatformTime::Cycles64() - t0;
+		if (!ok) {
+			undecodable++;
+			continue;
+		}
+		maxLocError = FMath::Max(maxLocError, FVector::Dist(out.Location, trace[i].Location));
+		if (rng.FRand() >= lossRate)
+			acks.Add({ i + FMath::Max(1, ackDelaySnapshots), seq });
+	}
+
+	int32 n = trace.Num();
+	double avg = (double)bytes / n;
+	report = FString::Printf(TEXT("Snapshot codec: %d snapshots, loss %.1f%%, ack delay %d\n")
+		TEXT("  bytes/snapshot %.2f (raw floats %d, %.1fx smaller)\n")
+		TEXT("  at 20 Hz per peer: %.2f kbit/s (raw %.2f kbit/s)\n")
+		TEXT("  full snapshots %d, lost %d, undecodable %d, max location error %.2f cm\n")
+		TEXT("  encode %.3f us, decode %.3f us per snapshot"),
+		n, lossRate * 100.0f, ackDelaySnapshots,
+		avg, UBERMUNDO_RAW_STATE_BYTES, UBERMUNDO_RAW_STATE_BYTES / avg,
+		avg * 8 * 20 / 1000.0, UBERMUNDO_RAW_STATE_BYTES * 8 * 20 / 1000.0,
+		fulls, lost, undecodable, maxLocError,
+		FPlatformTime::ToMilliseconds64(encodeCycles) * 1000.0 / n,
+		FPlatformTime::ToMilliseconds64(decodeCycles) * 1000.0 / FMath::Max(1, n - lost));
+	UE_LOG(UberMundoSteamLog, Display, TEXT("%s"), *report);
+	return true;
+}
+
+struct FTransportRun {
+	double sendUsPerMessage = 0.0;
+	int32 delivered = 0;
+	double deliverMs = 0.0;
+};
+
+/** Send numMessages from one transport to the other, flushing every perTick, and count what arrives within 2 s. */
+static FTransportRun RunTransport(IUbermundoTransport& from, IUbermundoTransport& to, uint64 toId, int32 numMessages, int32 messageBytes, int32 perTick) {
+	TArray<uint8> msg;
+	msg.SetNumZeroed(messageBytes);
+	TArray<uint8> in;
+	in.SetNumUninitialized(FMath::Max(messageBytes, 1));
+	FTransportRun r;
+
+	auto drain = [&]() {
+		uint32 n;
+		uint64 sender;
+		while (to.IsPacketAvailable(n) && to.Read(in.GetData(), (uint32)in.Num(), n, sender))
+			r.delivered++;
+	};
+
+	double start = FPlatformTime::Seconds();
+	uint64 sendCycles = 0;
+	for (int32 i = 0; i < numMessages; i++) {
+		uint64 t0 = FPlatformTime::Cycles64();
+		from.Send(toId, msg.GetData(), (uint32)messageBytes, EUbermundoP2PSendMode::Reliable);
+		if ((i + 1) % perTick == 0 || i == numMessages - 1)
+			from.FlushSends();
+		sendCycles += FPlatformTime::Cycles64() - t0;
+		// Keep reading as we go so the receive buffer never overflows.
+		if ((i + 1) % perTick == 0)
+			drain();
+	}
+	while (r.delivered < numMessages && FPlatformTime::Seconds() - start < 2.0) {
+		from.Tick(FPlatformTime::Seconds());
+		drain();
+		if (r.delivered < numMessages)
+			FPlatformProcess::Sleep(0.001f);
+	}
+	r.deliverMs = (FPlatformTime::Seconds() - start) * 1000.0;
+	r.sendUsPerMessage = FPlatformTime::ToMilliseconds64(sendCycles) * 1000.0 / numMessages;
+	return r;
+}
+
+bool UUbermundoNetBenchmarks::BenchmarkP2PTransports(int32 numMessages, int32 messageBytes, int32 messagesPerTick, FString& report) {
+	numMessages = FMath::Max(numMessages, 1);
+	messageBytes = FMath::Clamp(messageBytes, 1, UBERMUNDO_P2P_MAX_UNRELIABLE);
+	messagesPerTick = FMath::Max(messagesPerTick, 1);
+	report = FString::Printf(TEXT("P2P transports: %d messages of %d bytes, %d per tick\n"), numMessages, messageBytes, messagesPerTick);
+
+	auto line = [&](const TCHAR* name, const FTransportRun& r) {
+		report += FString::Printf(TEXT("  %-36s send %.3f us/msg, delivered %d in %.1f ms\n"), name, r.sendUsPerMessage, r.delivered, r.deliverMs);
+	};
+
+	{
+		FUbermundoLoopbackTransport a(UBERMUNDO_BENCH_PORT_A);
+		FUbermundoLoopbackTransport b(UBERMUNDO_BENCH_PORT_B);
+		if (!a.IsAvailable() || !b.IsAvailable()) {
+			report += TEXT("  Could not bind the loopback ports");
+			UE_LOG(UberMundoSteamLog, Display, TEXT("%s"), *report);
+			return false;
+		}
+		line(TEXT("UDP stand-in, one call per message"), RunTransport(a, b, UBERMUNDO_BENCH_PORT_B, numMessages, messageBytes, 1));
+	}
+
+	TUniquePtr<FUbermundoSteamSocketsTransport> a, b;
+	if (FUbermundoSteamSocketsTransport::CreateLocalPair(1, 2, a, b)) {
+		line(TEXT("SteamSockets, one call per message"), RunTransport(*a, *b, 2, numMessages, messageBytes, 1));
+		line(TEXT("SteamSockets, one call per tick"), RunTransport(*a, *b, 2, numMessages, messageBytes, messagesPerTick));
+	}
+	else {
+		report += TEXT("  SteamSockets skipped, Steam is not running\n");
+	}
+	UE_LOG(UberMundoSteamLog, Display, TEXT("%s"), *report);
+	return true;
+}
+
+bool UUbermundoNetBenchmarks::BenchmarkCaptureReplay(const FString& capturePath, bool realTime, FString& report) {
+	TSharedRef<FUbermundoCapture> capture = MakeShared<FUbermundoCapture>();
+	if (!capture->Load(capturePath) || capture->numIncoming == 0) {
+		report = FString::Printf(TEXT("Capture replay: nothing to replay in %s"), *capturePath);
+		UE_LOG(UberMundoSteamLog, Display, TEXT("%s"), *report);
+		return false;
+	}
+
+	// Put the replay in place of the real transport, and the real one back after.
+	TUniquePtr<IUbermundoTransport> saved;
+	FUbermundoReplayTransport* replay = nullptr;
+	USteamCustomCode::ReplaceTransport([&](TUniquePtr<IUbermundoTransport> current) -> TUniquePtr<IUbermundoTransport> {
+		saved = MoveTemp(current);
+		// Always paced by the clock Tick is given. Unpaced runs give it a clock of their own, a tick at a time.
+		TUniquePtr<FUbermundoReplayTransport> r = MakeUnique<FUbermundoReplayTransport>(capture, true);
+		replay = r.Get();
+		return r;
+	});
+
+	UUbermundoP2PInbox* inbox = UUbermundoP2PInbox::GetP2PInbox();
+	FUbermundoP2POutbox& outbox = FUbermundoP2POutbox::Get();
+	TArray<double> drainUs;
+	int32 drains = 0;
+	double start = FPlatformTime::Seconds();
+	double clock = start;
+	while (!replay->IsFinished()) {
+		double now = FPlatformTime::Seconds();
+		replay->Tick(realTime ? now : clock);
+		clock += 1.0 / UBERMUNDO_BENCH_REPLAY_HZ;
+
+		int32 before = replay->GetNumRead();
+		uint64 t0 = FPlatformTime::Cycles64();
+		inbox->DrainP2PPackets();
+		FUbermundoNetTick::Get().Tick(FPlatformTime::Seconds());
+		outbox.Flush();
+		uint64 cycles = FPlatformTime::Cycles64() - t0;
+		if (replay->GetNumRead() > before) {
+			drainUs.Add(FPlatformTime::ToMilliseconds64(cycles) * 1000.0);
+			drains++;
+		}
+		if (realTime) {
+			double wait = replay->GetNextDue() - FPlatformTime::Seconds();
+			if (wait > 0.0)
+				FPlatformProcess::Sleep((float)FMath::Min(wait, 0.1));
+		}
+	}
+	double wallMs = (FPlatformTime::Seconds() - start) * 1000.0;
+	int32 numRead = replay->GetNumRead();
+	int32 numSent = replay->GetNumSent();
+	int64 bytesSent = replay->GetBytesSent();
+	double totalLateness = replay->GetTotalLateness();
+	double maxLateness = replay->GetMaxLateness();
+
+	USteamCustomCode::ReplaceTransport([&](TUniquePtr<IUbermundoTransport> current) -> TUniquePtr<IUbermundoTransport> {
+		return MoveTemp(saved);
+	});
+
+	drainUs.Sort();
+	double totalUs = 0.0;
+	for (double us : drainUs)
+		totalUs += us;
+	auto percentile = [&](double p) { return drainUs.Num() > 0 ? drainUs[FMath::Min(drainUs.Num() - 1, (int32)(p * drainUs.Num()))] : 0.0; };
+
+	report = FString::Printf(TEXT("Capture replay %s: %d packets in, %lld bytes, %s\n")
+		TEXT("  %.1f ms wall, %.0f packets/s, %.2f MB/s through the pipeline\n")
+		TEXT("  %d drains, per drain avg %.1f us, p50 %.1f us, p99 %.1f us, max %.1f us, %.3f us per packet\n")
+		TEXT("  pipeline sent %d packets, %lld bytes (capture had %d, %lld bytes)"),
+		*capturePath, numRead, capture->incomingBytes, realTime ? TEXT("original pace") : TEXT("as fast as possible"),
+		wallMs, realTime ? numRead / (wallMs / 1000.0) : numRead / (totalUs / 1000000.0), realTime ? capture->incomingBytes / (wallMs * 1000.0) : capture->incomingBytes / totalUs,
+		drains, drains > 0 ? totalUs / drains : 0.0, percentile(0.5), percentile(0.99), percentile(1.0), totalUs / FMath::Max(1, numRead),
+		numSent, bytesSent, capture->numOutgoing, capture->outgoingBytes);
+	if (realTime)
+		report += FString::Printf(TEXT("\n  handled after due: avg %.2f ms, max %.2f ms"), totalLateness * 1000.0 / FMath::Max(1, numRead), maxLateness * 1000.0);
+	UE_LOG(UberMundoSteamLog, Display, TEXT("%s"), *report);
+	return true;
+}
+
+bool UUbermundoNetBenchmarks::BenchmarkVoiceLoopback(float seconds, const FUbermundoNetConditions& conditions, FString& report) {
+	seconds = FMath::Clamp(seconds, 1.0f, 600.0f);
+	FUbermundoVoiceEncoder encoder;
+	TSharedRef<FUbermundoVoiceStream, ESPMode::ThreadSafe> stream = MakeShared<FUbermundoVoiceStream, ESPMode::ThreadSafe>(FUbermundoVoice::Get().GetSettings());
+	if (!encoder.Init() || !stream->Init()) {
+		report = TEXT("Voice loopback: no voice codec");
+		UE_LOG(UberMundoSteamLog, Display, TEXT("%s"), *report);
+		return false;
+	}
+	FUbermundoLoopbackTransport a(UBERMUNDO_BENCH_PORT_A);
+	FUbermundoLoopbackTransport b(UBERMUNDO_BENCH_PORT_B);
+	if (!a.IsAvailable() || !b.IsAvailable()) {
+		report = TEXT("Voice loopback: could not bind the loopback ports");
+		UE_LOG(UberMundoSteamLog, Display, TEXT("%s"), *report);
+		return false;
+	}
+	a.SetConditions(conditions);
+
+	// A 440 Hz tone, so the codec has something to chew on.
+	TArray<int16> frame;
+	frame.SetNumUninitialized(UBERMUNDO_VOICE_FRAME_SAMPLES);
+	TArray<uint8> packet;
+	TArray<uint8> in;
+	in.SetNumUninitialized(UBERMUNDO_P2P_MAX_UNRELIABLE);
+	FUbermundoClockSync& clock = FUbermundoClockSync::Get();
+	const double frameSeconds = UBERMUNDO_VOICE_FRAME_MS / 1000.0;
+	int32 numSent = 0;
+	int64 bytesSent = 0;
+	int64 sample = 0;
+
+	double start = FPlatformTime::Seconds();
+	double nextCapture = start;
+	// The audio thread asks for a frame's worth every frame, starting once the first is on its way.
+	double nextPlayout = start + frameSeconds;
+	double now = start;
+	while (now - start < seconds) {
+		if (now >= nextCapture) {
+			for (int32 i = 0; i < UBERMUNDO_VOICE_FRAME_SAMPLES; i++, sample++)
+				frame[i] = (int16)(8000.0 * FMath::Sin(2.0 * PI * 440.0 * sample / UBERMUNDO_VOICE_SAMPLE_RATE));
+			if (encoder.Encode(frame.GetData(), clock.GetSharedTimeMs(), packet)) {
+				a.Send(UBERMUNDO_BENCH_PORT_B, packet.GetData(), (uint32)packet.Num(), EUbermundoP2PSendMode::UnreliableNoDelay);
+				a.FlushSends();
+				numSent++;
+				bytesSent += packet.Num();
+			}
+			nextCapture += frameSeconds;
+		}
+		a.Tick(now);
+		uint32 n;
+		uint64 sender;
+		while (b.IsPacketAvailable(n) && b.Read(in.GetData(), (uint32)in.Num(), n, sender))
+			stream->OnPacket(in.GetData(), (int32)n, FPlatformTime::Seconds());
+		if (now >= nextPlayout) {
+			stream->Pull(UBERMUNDO_VOICE_FRAME_SAMPLES);
+			nextPlayout += frameSeconds;
+		}
+		FPlatformProcess::Sleep(0.001f);
+		now = FPlatformTime::Seconds();
+	}
+
+	FUbermundoVoiceStats s = stream->GetStats();
+	report = FString::Printf(TEXT("Voice loopback: %.0f s, latency %.0f ms, jitter %.0f ms, loss %.0f%%, reorder %.0f%%\n")
+		TEXT("  sent %d frames, %.1f kbit/s, received %d, played %d\n")
+		TEXT("  capture to playout avg %.1f ms, max %.1f ms, jitter %.1f ms, target buffer %.0f ms\n")
+		TEXT("  concealed %d, late %d, dropped %d"),
+		seconds, conditions.LatencyMs, conditions.JitterMs, conditions.LossPercent, conditions.ReorderPercent,
+		numSent, bytesSent * 8.0 / seconds / 1000.0, s.FramesReceived, s.FramesPlayed,
+		s.LatencyMs, s.MaxLatencyMs, s.JitterMs, s.TargetDelayMs,
+		s.FramesConcealed, s.FramesLate, s.FramesDropped);
+	UE_LOG(UberMundoSteamLog, Display, TEXT("%s"), *report);
+	return true;
+}
+
+/** ns per call of fn, over iterations calls. */
+template<typename TFn>
+static double NsPerCall(int32 iterations, TFn&& fn) {
+	uint64 t0 = FPlatformTime::Cycles64();
+	for (int32 i = 0; i < iterations; i++)
+		fn();
+	return FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - t0) * 1000000.0 / iterations;
+}
+
+static void AddCodecLine(FString& report, const TCHAR* message, const TCHAR* path, int32 bytes, double ns) {
+	report += FString::Printf(TEXT("  %-18s %-20s %5d bytes %9.1f ns %9.1f MB/s\n"), message, path, bytes, ns, ns > 0.0 ? bytes * 1000.0 / ns : 0.0);
+}
+
+/** The generated codec of one message, native into a stack buffer and Blueprint into a new array, both ways. False if the two encode differently. */
+template<typename TWire, typename TMsg>
+static bool BenchmarkGeneratedCodec(const TCHAR* message, const TWire& wire, const TMsg& msg, TArray<uint8>(*encode)(const TMsg&), bool(*decode)(const TArray<uint8>&, TMsg&), int32 iterations, FString& report) {
+	uint8 out[UBERMUNDO_P2P_MAX_UNRELIABLE];
+	int32 n = wire.Encode(out, sizeof(out));
+	AddCodecLine(report, message, TEXT("Wire encode"), n, NsPerCall(iterations, [&]() {
+		benchmarkSink += wire.Encode(out, sizeof(out));
+	}));
+	AddCodecLine(report, message, TEXT("Wire decode"), n, NsPerCall(iterations, [&]() {
+		TWire decoded;
+		benchmarkSink += decoded.Decode(out, n);
+	}));
+
+	TArray<uint8> bytes = encode(msg);
+	AddCodecLine(report, message, TEXT("Blueprint encode"), bytes.Num(), NsPerCall(iterations, [&]() {
+		benchmarkSink += encode(msg).Num();
+	}));
+	AddCodecLine(report, message, TEXT("Blueprint decode"), bytes.Num(), NsPerCall(iterations, [&]() {
+		TMsg decoded;
+		benchmarkSink += decode(bytes, decoded);
+	}));
+	if (bytes.Num() != n || FMemory::Memcmp(bytes.GetData(), out, n) != 0) {
+		report += FString::Printf(TEXT("  %s: native and Blueprint bytes differ\n"), message);
+		return false;
+	}
+	return true;
+}
+
+bool UUbermundoNetBenchmarks::BenchmarkMessageCodecs(int32 iterations, FString& report) {
+	iterations = FMath::Max(iterations, 1);
+	report = FString::Printf(TEXT("Message codecs: %d iterations each\n"), iterations);
+	bool same = true;
+
+	{
+		FUbermundoClockPongWire wire;
+		wire.PingSentMicros = 1000000;
+		wire.ArrivedMicros = 1012000;
+		wire.SentMicros = 1012050;
+		FUbermundoClockPongMsg msg;
+		msg.PingSentMicros = wire.PingSentMicros;
+		msg.ArrivedMicros = wire.ArrivedMicros;
+		msg.SentMicros = wire.SentMicros;
+		same &= BenchmarkGeneratedCodec(TEXT("ClockPong"), wire, msg, &UUbermundoMessageLibrary::EncodeClockPong, &UUbermundoMessageLibrary::DecodeClockPong, iterations, report);
+		int32 n = 0;
+		AddCodecLine(report, TEXT("ClockPong"), TEXT("PacketBuilder"), wire.Size(), NsPerCall(iterations, [&]() {
+			FUbermundoPacketBuilder b(UBERMUNDOPC_P2P_ClockPong);
+			b.AddInt64(wire.PingSentMicros).AddInt64(wire.ArrivedMicros).AddInt64(wire.SentMicros);
+			n = b.Num();
+		}));
+		benchmarkSink += n;
+	}
+
+	{
+		TArray<uint8> chunk;
+		chunk.SetNumUninitialized(1024);
+		for (int32 i = 0; i < chunk.Num(); i++)
+			chunk[i] = (uint8)i;
+		FUbermundoBlockChunkWire wire;
+		wire.BlockId = 0x0123456789ABCDEFull;
+		wire.Index = 7;
+		wire.Bytes = chunk;
+		FUbermundoBlockChunkMsg msg;
+		msg.BlockId = (int64)wire.BlockId;
+		msg.Index = wire.Index;
+		msg.Bytes = chunk;
+		same &= BenchmarkGeneratedCodec(TEXT("BlockChunk 1 KB"), wire, msg, &UUbermundoMessageLibrary::EncodeBlockChunk, &UUbermundoMessageLibrary::DecodeBlockChunk, iterations, report);
+		int32 n = 0;
+		AddCodecLine(report, TEXT("BlockChunk 1 KB"), TEXT("PacketBuilder"), wire.Size(), NsPerCall(iterations, [&]() {
+			FUbermundoPacketBuilder b(UBERMUNDOPC_P2P_BlockChunk);
+			b.AddInt64((int64)wire.BlockId).AddInt16((int16)wire.Index).AddBytes(chunk.GetData(), chunk.Num());
+			n = b.Num();
+		}));
+		benchmarkSink += n;
+	}
+
+	{
+		TArray<FUbermundoAnnouncedPlayerWire> players;
+		FUbermundoS2PAnnouncePlayersToClient_SteamMsg msg;
+		for (int32 i = 0; i < 16; i++) {
+			FUbermundoAnnouncedPlayerWire& p = players.AddDefaulted_GetRef();
+			p.UbermundoId = 1000 + i;
+			p.SteamId = 76561197960265728ull + i;
+			FUbermundoAnnouncedPlayerMsg& m = msg.Players.AddDefaulted_GetRef();
+			m.UbermundoId = p.UbermundoId;
+			m.SteamId = (int64)p.SteamId;
+		}
+		FUbermundoS2PAnnouncePlayersToClient_SteamWire wire;
+		wire.Players.Items = players;
+		same &= BenchmarkGeneratedCodec(TEXT("Announce 16"), wire, msg, &UUbermundoMessageLibrary::EncodeS2PAnnouncePlayersToClient_Steam, &UUbermundoMessageLibrary::DecodeS2PAnnouncePlayersToClient_Steam, iterations, report);
+
+		// A native decode only checks the list, reading the players is the receiver's. Do that too, to be fair to the Blueprint one.
+		uint8 out[UBERMUNDO_P2P_MAX_UNRELIABLE];
+		int32 n = wire.Encode(out, sizeof(out));
+		AddCodecLine(report, TEXT("Announce 16"), TEXT("Wire decode, read"), n, NsPerCall(iterations, [&]() {
+			FUbermundoS2PAnnouncePlayersToClient_SteamWire decoded;
+			if (!decoded.Decode(out, n))
+				return;
+			TUbermundoWireList<FUbermundoAnnouncedPlayerWire>::FReader r = decoded.Players.MakeReader();
+			FUbermundoAnnouncedPlayerWire p;
+			while (r.Next(p))
+				benchmarkSink += p.SteamId;
+		}));
+	}
+
+	{
+		const TCHAR* worldName = TEXT("Bahnda's test world");
+		FTCHARToUTF8 name(worldName);
+		FUbermundoS2PLevelMetadataWire wire;
+		wire.Metadata.WorldId = 42;
+		wire.Metadata.WorldName = TArrayView<const uint8>((const uint8*)name.Get(), name.Length());
+		wire.Metadata.OwningPlayerId = 1000;
+		wire.Metadata.WotToSee = 50;
+		wire.Metadata.WorldVersion = 300;
+		wire.Metadata.PlayerUpdateIntervalFactor = 1.0f;
+		FUbermundoS2PLevelMetadataMsg msg;
+		msg.Metadata.WorldId = wire.Metadata.WorldId;
+		msg.Metadata.WorldName = worldName;
+		msg.Metadata.OwningPlayerId = wire.Metadata.OwningPlayerId;
+		msg.Metadata.WotToSee = wire.Metadata.WotToSee;
+		msg.Metadata.WorldVersion = wire.Metadata.WorldVersion;
+		msg.Metadata.PlayerUpdateIntervalFactor = wire.Metadata.PlayerUpdateIntervalFactor;
+		same &= BenchmarkGeneratedCodec(TEXT("LevelMetadata"), wire, msg, &UUbermundoMessageLibrary::EncodeS2PLevelMetadata, &UUbermundoMessageLibrary::DecodeS2PLevelMetadata, iterations, report);
+	}
+
+	UE_LOG(UberMundoSteamLog, Display, TEXT("%s"), *report);
+	return same;
+}
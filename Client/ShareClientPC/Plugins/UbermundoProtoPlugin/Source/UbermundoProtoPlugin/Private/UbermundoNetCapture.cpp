@@ -0,0 +1,209 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+
+#include "UbermundoNetCapture.h"
+#include "SteamCustomCode.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+
+/** Bytes before each packet's own. */
+#define UBERMUNDO_CAPTURE_RECORD_HEADER (8 + 8 + 4 + 1 + 1)
+
+template<typename T>
+static void Put(TArray<uint8>& out, T v) {
+	out.Append((const uint8*)&v, sizeof(T));
+}
+
+template<typename T>
+static T Take(const uint8* at) {
+	T v;
+	FMemory::Memcpy(&v, at, sizeof(T));
+	return v;
+}
+
+// --------------------------------------------------------------------------------- FUbermundoNetCapture
+FUbermundoNetCapture& FUbermundoNetCapture::Get() {
+	static FUbermundoNetCapture capture;
+	return capture;
+}
+
+bool FUbermundoNetCapture::Start(const FString& newPath) {
+	if (IsCapturing())
+		Stop();
+	buffer.Reset();
+	buffer.Append((const uint8*)"UMCP", 4);
+	Put<uint16>(buffer, UBERMUNDO_NET_CAPTURE_VERSION);
+	Put<uint16>(buffer, 0);
+	Put<uint64>(buffer, USteamCustomCode::GetTransport().GetLocalId());
+	if (!FFileHelper::SaveArrayToFile(buffer, *newPath)) {
+		UE_LOG(UberMundoSteamLog, Error, TEXT("StartP2PCapture could not write %s"), *newPath);
+		buffer.Reset();
+		return false;
+	}
+	buffer.Reset();
+	path = newPath;
+	start = FPlatformTime::Seconds();
+	numPackets = 0;
+	UE_LOG(UberMundoSteamLog, Display, TEXT("Capturing P2P packets to %s"), *path);
+	return true;
+}
+
+int32 FUbermundoNetCapture::Stop() {
+	if (!IsCapturing())
+		return 0;
+	Write();
+	UE_LOG(UberMundoSteamLog, Display, TEXT("Captured %d P2P packets to %s"), numPackets, *path);
+	path.Reset();
+	buffer.Empty();
+	return numPackets;
+}
+
+void FUbermundoNetCapture::Add(uint64 peer, const uint8* data, uint32 numBytes, uint8 direction, uint8 mode) {
+	if (!IsCapturing())
+		return;
+	Put<uint64>(buffer, (uint64)((FPlatformTime::Seconds() - start) * 1000000.0));
+	Put<uint64>(buffer, peer);
+	Put<uint32>(buffer, numBytes);
+	Put<uint8>(buffer, direction);
+	Put<uint8>(buffer, mode);
+	buffer.Append(data, (int32)numBytes);
+	numPackets++;
+	if (buffer.Num() >= UBERMUNDO_NET_CAPTURE_FLUSH && !Write()) {
+		UE_LOG(UberMundoSteamLog, Error, TEXT("P2P capture could not append to %s, stopping"), *path);
+		path.Reset();
+		buffer.Empty();
+	}
+}
+
+bool FUbermundoNetCapture::Write() {
+	if (buffer.Num() == 0)
+		return true;
+	bool ok = FFileHelper::SaveArrayToFile(buffer, *path, &IFileManager::Get(), FILEWRITE_Append);
+	buffer.Reset();
+	return ok;
+}
+
+// --------------------------------------------------------------------------------- FUbermundoCapture
+bool FUbermundoCapture::Load(const FString& path) {
+	packets.Reset();
+	numIncoming = numOutgoing = 0;
+	incomingBytes = outgoingBytes = 0;
+	if (!FFileHelper::LoadFileToArray(data, *path)) {
+		UE_LOG(UberMundoSteamLog, Error, TEXT("Could not read capture %s"), *path);
+		return false;
+	}
+	if (data.Num() < 16 || FMemory::Memcmp(data.GetData(), "UMCP", 4) != 0 || Take<uint16>(&data[4]) != UBERMUNDO_NET_CAPTURE_VERSION) {
+		UE_LOG(UberMundoSteamLog, Error, TEXT("%s is not a version %d P2P capture"), *path, UBERMUNDO_NET_CAPTURE_VERSION);
+		return false;
+	}
+	localId = Take<uint64>(&data[8]);
+
+	int32 at = 16;
+	while (at + UBERMUNDO_CAPTURE_RECORD_HEADER <= data.Num()) {
+		const uint8* h = &data[at];
+		FPacket& p = packets.AddDefaulted_GetRef();
+		p.time = Take<uint64>(h) / 1000000.0;
+		p.peer = Take<uint64>(h + 8);
+		p.numBytes = (int32)Take<uint32>(h + 16);
+		p.outgoing = h[20] != 0;
+		p.mode = (EUbermundoP2PSendMode)h[21];
+		p.offset = at + UBERMUNDO_CAPTURE_RECORD_HEADER;
+		// Against what is left, a crafted length must not overflow offset + numBytes.
+		if (p.numBytes < 0 || p.numBytes > data.Num() - p.offset) {
+			// Cut off mid packet, e.g. the game died while capturing. Keep what came before.
+			UE_LOG(UberMundoSteamLog, Warning, TEXT("Capture %s ends mid packet after %d packets"), *path, packets.Num() - 1);
+			packets.Pop(false);
+			break;
+		}
+		at = p.offset + p.numBytes;
+		if (p.outgoing) {
+			numOutgoing++;
+			outgoingBytes += p.numBytes;
+		}
+		else {
+			numIncoming++;
+			incomingBytes += p.numBytes;
+		}
+	}
+	return true;
+}
+
+// --------------------------------------------------------------------------------- FUbermundoReplayTransport
+FUbermundoReplayTransport::FUbermundoReplayTransport(TSharedRef<const FUbermundoCapture> capture, bool realTime)
+	: capture(capture), realTime(realTime) {
+	Advance();
+}
+
+void FUbermundoReplayTransport::Advance() {
+	const TArray<FUbermundoCapture::FPacket>& packets = capture->packets;
+	while (next < packets.Num() && packets[next].outgoing)
+		next++;
+}
+
+void FUbermundoReplayTransport::Tick(double t) {
+	now = t;
+	if (start <= 0.0)
+		start = t;
+}
+
+double FUbermundoReplayTransport::GetNextDue() const {
+	if (!realTime || IsFinished() || start <= 0.0)
+		return 0.0;
+	return start + capture->packets[next].time;
+}
+
+bool FUbermundoReplayTransport::IsPacketAvailable(uint32& numBytes) {
+	numBytes = 0;
+	if (IsFinished())
+		return false;
+	const FUbermundoCapture::FPacket& p = capture->packets[next];
+	if (realTime && (start <= 0.0 || now < start + p.time))
+		return false;
+	numBytes = (uint32)p.numBytes;
+	return true;
+}
+
+bool FUbermundoReplayTransport::Read(uint8* dest, uint32 destSize, uint32& numBytes, uint64& sender) {
+	if (!IsPacketAvailable(numBytes))
+		return false;
+	const FUbermundoCapture::FPacket& p = capture->packets[next];
+	numBytes = FMath::Min(destSize, (uint32)p.numBytes);
+	FMemory::Memcpy(dest, capture->Bytes(p).GetData(), numBytes);
+	sender = p.peer;
+	if (realTime) {
+		double late = FMath::Max(0.0, FPlatformTime::Seconds() - (start + p.time));
+		totalLateness += late;
+		maxLateness = FMath::Max(maxLateness, late);
+	}
+	numRead++;
+	next++;
+	Advance();
+	return true;
+}
+
+bool FUbermundoReplayTransport::Send(uint64 peer, const uint8* data, uint32 numBytes, EUbermundoP2PSendMode mode) {
+	numSent++;
+	bytesSent += numBytes;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- UUbermundoNetCaptureLibrary
+bool UUbermundoNetCaptureLibrary::StartP2PCapture(const FString& path) {
+	return FUbermundoNetCapture::Get().Start(path);
+}
+
+int32 UUbermundoNetCaptureLibrary::StopP2PCapture() {
+	return FUbermundoNetCapture::Get().Stop();
+}
+
+bool UUbermundoNetCaptureLibrary::IsP2PCapturing() {
+	return FUbermundoNetCapture::Get().IsCapturing();
+}
+
+bool UUbermundoNetCaptureLibrary::UseReplayTransport(const FString& capturePath, bool realTime) {
+	TSharedRef<FUbermundoCapture> capture = MakeShared<FUbermundoCapture>();
+	if (!capture->Load(capturePath))
+		return false;
+	USteamCustomCode::SetTransport(MakeUnique<FUbermundoReplayTransport>(capture, realTime));
+	return true;
+}
@@ -0,0 +1,195 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+
+#include "UbermundoNetStats.h"
+#include "SteamCustomCode.h"
+#include "UbermundoRateControl.h"
+#include "UbermundoP2POutbox.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/DateTime.h"
+
+// --------------------------------------------------------------------------------- FUbermundoNetStats
+FUbermundoNetStats& FUbermundoNetStats::Get() {
+	static FUbermundoNetStats stats;
+	return stats;
+}
+
+void FUbermundoNetStats::OnPacketOut(uint64 peer, int32 numBytes) {
+	FPeer& p = peers.FindOrAdd(peer);
+	p.window.packetsOut++;
+	p.window.bytesOut += numBytes;
+	p.totalBytesOut += numBytes;
+}
+
+void FUbermundoNetStats::OnPacketIn(uint64 peer, int32 numBytes) {
+	FPeer& p = peers.FindOrAdd(peer);
+	p.window.packetsIn++;
+	p.window.bytesIn += numBytes;
+	p.totalBytesIn += numBytes;
+}
+
+void FUbermundoNetStats::OnMessageOut(uint64 peer, const uint8* data, int32 numBytes) {
+	if (numBytes <= 0)
+		return;
+	FCounts& c = peers.FindOrAdd(peer).window;
+	c.messagesOut++;
+	c.codeMessagesOut[data[0]]++;
+	c.codeBytesOut[data[0]] += numBytes;
+}
+
+void FUbermundoNetStats::OnMessageIn(uint64 peer, const uint8* data, int32 numBytes) {
+	if (numBytes <= 0)
+		return;
+	FCounts& c = peers.FindOrAdd(peer).window;
+	c.messagesIn++;
+	c.codeMessagesIn[data[0]]++;
+	c.codeBytesIn[data[0]] += numBytes;
+}
+
+void FUbermundoNetStats::Tick(double now) {
+	if (windowStart <= 0.0)
+		windowStart = now;
+	double seconds = now - windowStart;
+	if (seconds >= UBERMUNDO_NET_STATS_WINDOW) {
+		for (TPair<uint64, FPeer>& kv : peers)
+			EndWindow(kv.Key, kv.Value, seconds);
+		windowStart = now;
+	}
+	if (!csvPath.IsEmpty() && now >= csvNext) {
+		WriteCsv(now);
+		csvNext = now + csvInterval;
+	}
+}
+
+void FUbermundoNetStats::EndWindow(uint64 peer, FPeer& p, double seconds) {
+	const FCounts& c = p.window;
+	FUbermundoPeerNetStats& s = p.last;
+	float inv = (float)(1.0 / seconds);
+	s.Peer = (int64)peer;
+	s.PacketsInPerSec = c.packetsIn * inv;
+	s.PacketsOutPerSec = c.packetsOut * inv;
+	s.BytesInPerSec = c.bytesIn * inv;
+	s.BytesOutPerSec = c.bytesOut * inv;
+	s.MessagesInPerSec = c.messagesIn * inv;
+	s.MessagesOutPerSec = c.messagesOut * inv;
+	s.Codes.Reset();
+	for (int32 code = 0; code < 256; code++) {
+		if (c.codeMessagesIn[code] == 0 && c.codeMessagesOut[code] == 0)
+			continue;
+		FUbermundoCodeNetStats& cs = s.Codes.AddDefaulted_GetRef();
+		cs.Code = code;
+		cs.MessagesInPerSec = c.codeMessagesIn[code] * inv;
+		cs.MessagesOutPerSec = c.codeMessagesOut[code] * inv;
+		cs.BytesInPerSec = c.codeBytesIn[code] * inv;
+		cs.BytesOutPerSec = c.codeBytesOut[code] * inv;
+	}
+	p.window = FCounts();
+}
+
+void FUbermundoNetStats::Fill(uint64 peer, const FPeer& p, FUbermundoPeerNetStats& out) const {
+	out = p.last;
+	out.Peer = (int64)peer;
+	out.TotalBytesIn = p.totalBytesIn;
+	out.TotalBytesOut = p.totalBytesOut;
+	out.OutboxQueuedBytes = FUbermundoP2POutbox::Get().GetDeferredBytes(peer);
+
+	// Our own acks first, they measure what the game sees. Steam's figures where we have none yet.
+	FUbermundoLinkStats link;
+	bool ownRtt = FUbermundoRateController::Get().GetLinkStats(peer, link) && link.RttMs > 0.0f;
+	if (ownRtt) {
+		out.RttMs = link.RttMs;
+		out.LossPercent = link.LossPercent;
+	}
+	FUbermundoTransportPeerStatus status;
+	if (USteamCustomCode::GetTransport().GetPeerStatus(peer, status)) {
+		out.TransportQueuedBytes = status.queuedBytes;
+		out.TransportQueuedPackets = status.queuedPackets;
+		if (!ownRtt && status.pingMs >= 0)
+			out.RttMs = (float)status.pingMs;
+		if (!ownRtt && status.deliveredFraction >= 0.0f)
+			out.LossPercent = (1.0f - status.deliveredFraction) * 100.0f;
+	}
+}
+
+bool FUbermundoNetStats::GetPeerStats(uint64 peer, FUbermundoPeerNetStats& out) const {
+	out = FUbermundoPeerNetStats();
+	const FPeer* p = peers.Find(peer);
+	if (p == nullptr)
+		return false;
+	Fill(peer, *p, out);
+	return true;
+}
+
+void FUbermundoNetStats::GetAllPeerStats(TArray<FUbermundoPeerNetStats>& out) const {
+	out.Reset(peers.Num());
+	for (const TPair<uint64, FPeer>& kv : peers)
+		Fill(kv.Key, kv.Value, out.AddDefaulted_GetRef());
+}
+
+bool FUbermundoNetStats::StartCsv(const FString& path, float intervalSeconds) {
+	if (!IFileManager::Get().FileExists(*path)) {
+		FString header = TEXT("utc,seconds,peer,packets_in_s,packets_out_s,bytes_in_s,bytes_out_s,messages_in_s,messages_out_s,")
+			TEXT("rtt_ms,loss_pct,outbox_queued_bytes,transport_queued_bytes,transport_queued_packets,total_bytes_in,total_bytes_out,codes_out_bytes_s\n");
+		if (!FFileHelper::SaveStringToFile(header, *path)) {
+			UE_LOG(UberMundoSteamLog, Error, TEXT("StartNetStatsCsv could not write %s"), *path);
+			return false;
+		}
+	}
+	csvPath = path;
+	csvInterval = FMath::Max(intervalSeconds, (float)UBERMUNDO_NET_STATS_WINDOW);
+	csvStart = FPlatformTime::Seconds();
+	csvNext = csvStart + csvInterval;
+	UE_LOG(UberMundoSteamLog, Display, TEXT("Net stats every %.1f s to %s"), csvInterval, *csvPath);
+	return true;
+}
+
+void FUbermundoNetStats::StopCsv() {
+	csvPath.Reset();
+}
+
+void FUbermundoNetStats::WriteCsv(double now) {
+	FString utc = FDateTime::UtcNow().ToIso8601();
+	FString lines;
+	FUbermundoPeerNetStats s;
+	for (const TPair<uint64, FPeer>& kv : peers) {
+		Fill(kv.Key, kv.Value, s);
+		// The codes that cost the most bytes out are what a complaint usually comes down to.
+		FString codes;
+		for (const FUbermundoCodeNetStats& c : s.Codes) {
+			if (c.BytesOutPerSec > 0.0f)
+				codes += FString::Printf(TEXT("%s%d=%.0f"), codes.IsEmpty() ? TEXT("") : TEXT(" "), c.Code, c.BytesOutPerSec);
+		}
+		lines += FString::Printf(TEXT("%s,%.1f,0x%llX,%.1f,%.1f,%.0f,%.0f,%.1f,%.1f,%.1f,%.1f,%d,%d,%d,%lld,%lld,%s\n"),
+			*utc, now - csvStart, kv.Key, s.PacketsInPerSec, s.PacketsOutPerSec, s.BytesInPerSec, s.BytesOutPerSec,
+			s.MessagesInPerSec, s.MessagesOutPerSec, s.RttMs, s.LossPercent, s.OutboxQueuedBytes,
+			s.TransportQueuedBytes, s.TransportQueuedPackets, s.TotalBytesIn, s.TotalBytesOut, *codes);
+	}
+	if (lines.IsEmpty())
+		return;
+	if (!FFileHelper::SaveStringToFile(lines, *csvPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append)) {
+		UE_LOG(UberMundoSteamLog, Error, TEXT("Net stats could not append to %s, stopping"), *csvPath);
+		StopCsv();
+	}
+}
+
+void FUbermundoNetStats::ForgetPeer(uint64 peer) {
+	peers.Remove(peer);
+}
+
+// --------------------------------------------------------------------------------- UUbermundoNetStatsLibrary
+bool UUbermundoNetStatsLibrary::GetPeerNetStats(int64 peer, FUbermundoPeerNetStats& stats) {
+	return FUbermundoNetStats::Get().GetPeerStats((uint64)peer, stats);
+}
+
+void UUbermundoNetStatsLibrary::GetAllPeerNetStats(TArray<FUbermundoPeerNetStats>& stats) {
+	FUbermundoNetStats::Get().GetAllPeerStats(stats);
+}
+
+bool UUbermundoNetStatsLibrary::StartNetStatsCsv(const FString& path, float intervalSeconds) {
+	return FUbermundoNetStats::Get().StartCsv(path, intervalSeconds);
+}
+
+void UUbermundoNetStatsLibrary::StopNetStatsCsv() {
+	FUbermundoNetStats::Get().StopCsv();
+}
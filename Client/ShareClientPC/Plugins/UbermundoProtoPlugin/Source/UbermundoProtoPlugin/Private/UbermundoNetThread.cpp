@@ -0,0 +1,323 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+
+#include "UbermundoNetThread.h"
+#include "SteamCustomCode.h"
+#include "UbermundoNetTrace.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "steam/steam_api.h"
+
+// --------------------------------------------------------------------------------- FUbermundoNetLatency
+FUbermundoNetLatency& FUbermundoNetLatency::Get() {
+	static FUbermundoNetLatency latency;
+	return latency;
+}
+
+void FUbermundoNetLatency::OnDrain(double now) {
+	if (lastDrain > 0.0) {
+		drainGap.Add(now - lastDrain);
+		gameThreadNet.Add(FPlatformTime::ToSeconds64(frameCycles));
+	}
+	lastDrain = now;
+	frameCycles = 0;
+}
+
+void FUbermundoNetLatency::OnInbound(double waitSeconds) {
+	inboundWait.Add(waitSeconds);
+}
+
+void FUbermundoNetLatency::GetStats(FUbermundoNetLatencyStats& out) const {
+	out = FUbermundoNetLatencyStats();
+	out.AvgGameThreadNetMs = gameThreadNet.AvgMs();
+	out.MaxGameThreadNetMs = gameThreadNet.MaxMs();
+	out.AvgDrainGapMs = drainGap.AvgMs();
+	out.MaxDrainGapMs = drainGap.MaxMs();
+	out.AvgInboundWaitMs = inboundWait.AvgMs();
+	out.MaxInboundWaitMs = inboundWait.MaxMs();
+}
+
+void FUbermundoNetLatency::Reset() {
+	gameThreadNet = FAccum();
+	drainGap = FAccum();
+	inboundWait = FAccum();
+	lastDrain = 0.0;
+	frameCycles = 0;
+}
+
+// --------------------------------------------------------------------------------- FUbermundoThreadedTransport
+FUbermundoThreadedTransport::FUbermundoThreadedTransport(TUniquePtr<IUbermundoTransport> inner, float tickHz)
+	: inner(MoveTemp(inner)), tickSeconds(1.0 / FMath::Clamp(tickHz, 10.0f, 2000.0f)),
+	outbound(UBERMUNDO_NET_THREAD_RING), inbound(UBERMUNDO_NET_THREAD_RING) {
+	wake = FPlatformProcess::GetSynchEventFromPool(false);
+	thread = FRunnableThread::Create(this, TEXT("UbermundoNet"), 0, TPri_AboveNormal);
+}
+
+FUbermundoThreadedTransport::~FUbermundoThreadedTransport() {
+	Release();
+}
+
+void FUbermundoThreadedTransport::StopThread() {
+	if (thread == nullptr)
+		return;
+	Stop();
+	wake->Trigger();
+	thread->WaitForCompletion();
+	delete thread;
+	thread = nullptr;
+	FPlatformProcess::ReturnSynchEventToPool(wake);
+	wake = nullptr;
+}
+
+TUniquePtr<IUbermundoTransport> FUbermundoThreadedTransport::Release() {
+	StopThread();
+	if (inner.IsValid()) {
+		// The thread is gone, so nothing else is touching the rings. Send what the game thread left, but
+		// read nothing more: whatever inner still holds stays with it for whoever uses it next.
+		double waitTotal = 0.0;
+		double waitMax = 0.0;
+		SendQueued(FPlatformTime::Seconds(), waitTotal, waitMax);
+		if (inbound.Num() > 0)
+			UE_LOG(UberMundoSteamLog, Error, TEXT("Network thread released with %d received packets never read"), inbound.Num());
+	}
+	return MoveTemp(inner);
+}
+
+bool FUbermundoThreadedTransport::PushOutbound(FOutbound&& o, const uint8* data, uint32 numBytes) {
+	if (outbound.Push(MoveTemp(o)))
+		return true;
+	// A close is no more to be lost than a reliable send.
+	bool reliable = o.close || o.mode == EUbermundoP2PSendMode::Reliable || o.mode == EUbermundoP2PSendMode::ReliableWithBuffering;
+	if (reliable && thread != nullptr) {
+		// Losing it would break the reliable stream, so give the network thread a moment to make room.
+		double giveUpAt = FPlatformTime::Seconds() + UBERMUNDO_NET_THREAD_RELIABLE_WAIT;
+		do {
+			wake->Trigger();
+			FPlatformProcess::Sleep(0.0005f);
+			if (outbound.Push(MoveTemp(o)))
+				return true;
+		} while (FPlatformTime::Seconds() < giveUpAt);
+	}
+	else if (reliable && inner.IsValid()) {
+		// The thread is stopped, so the ring is ours to empty.
+		double waitTotal = 0.0;
+		double waitMax = 0.0;
+		SendQueued(FPlatformTime::Seconds(), waitTotal, waitMax);
+		if (outbound.Push(MoveTemp(o)))
+			return true;
+	}
+	if (o.close)
+		return false;
+	UBERMUNDO_TRACE(Drop, o.peer, data, numBytes, false);
+	numOutboundDropped++;
+	if (reliable)
+		UE_LOG(UberMundoSteamLog, Error, TEXT("Network thread outbound ring full, reliable send to 0x%llX N=%u lost"), o.peer, numBytes);
+	return false;
+}
+
+bool FUbermundoThreadedTransport::Send(uint64 peer, const uint8* data, uint32 numBytes, EUbermundoP2PSendMode mode) {
+	FOutbound o;
+	o.peer = peer;
+	o.packet = FUbermundoPacketBufferPool::Get().Acquire((int32)numBytes);
+	o.packet.GetMutableBytes().Append(data, (int32)numBytes);
+	o.mode = mode;
+	o.queuedAt = FPlatformTime::Seconds();
+	return PushOutbound(MoveTemp(o), data, numBytes);
+}
+
+int32 FUbermundoThreadedTransport::SendToMany(TArrayView<const uint64> peers, const FUbermundoPacketRef& packet, EUbermundoP2PSendMode mode, TArray<bool, TInlineAllocator<64>>& sent) {
+	sent.SetNumZeroed(peers.Num(), false);
+	double now = FPlatformTime::Seconds();
+	int32 n = 0;
+	for (int32 i = 0; i < peers.Num(); i++) {
+		FOutbound o;
+		o.peer = peers[i];
+		o.packet = packet;
+		o.mode = mode;
+		o.queuedAt = now;
+		if (!PushOutbound(MoveTemp(o), packet.GetData(), (uint32)packet.Num()))
+			continue;
+		sent[i] = true;
+		n++;
+	}
+	return n;
+}
+
+bool FUbermundoThreadedTransport::IsPacketAvailable(uint32& numBytes) {
+	FInbound* in = inbound.Peek();
+	numBytes = in ? (uint32)in->packet.Num() : 0;
+	return in != nullptr;
+}
+
+bool FUbermundoThreadedTransport::Read(uint8* dest, uint32 destSize, uint32& numBytes, uint64& sender) {
+	FInbound* in = inbound.Peek();
+	if (in == nullptr) {
+		numBytes = 0;
+		return false;
+	}
+	numBytes = FMath::Min(destSize, (uint32)in->packet.Num());
+	FMemory::Memcpy(dest, in->packet.GetData(), numBytes);
+	sender = in->sender;
+	FUbermundoNetLatency::Get().OnInbound(FPlatformTime::Seconds() - in->readAt);
+	inbound.Pop();
+	return true;
+}
+
+bool FUbermundoThreadedTransport::Close(uint64 peer) {
+	FOutbound o;
+	o.peer = peer;
+	o.close = true;
+	o.queuedAt = FPlatformTime::Seconds();
+	if (PushOutbound(MoveTemp(o), nullptr, 0))
+		return true;
+	// Closing ahead of sends queued before it beats leaving open a session game code is done with.
+	UE_LOG(UberMundoSteamLog, Warning, TEXT("Network thread outbound ring full, closing 0x%llX right away"), peer);
+	FScopeLock lock(&innerLock);
+	return inner.IsValid() && inner->Close(peer);
+}
+
+int32 FUbermundoThreadedTransport::FlushSends() {
+	if (wake != nullptr)
+		wake->Trigger();
+	return 0;
+}
+
+bool FUbermundoThreadedTransport::GetPeerStatus(uint64 peer, FUbermundoTransportPeerStatus& out) const {
+	FScopeLock lock(&innerLock);
+	return inner.IsValid() && inner->GetPeerStatus(peer, out);
+}
+
+bool FUbermundoThreadedTransport::SetConditions(const FUbermundoNetConditions& c) {
+	FScopeLock lock(&innerLock);
+	return inner.IsValid() && inner->SetConditions(c);
+}
+
+bool FUbermundoThreadedTransport::AddPeer(uint64 peer, const FString& address, int32 port) {
+	FScopeLock lock(&innerLock);
+	return inner.IsValid() && inner->AddPeer(peer, address, port);
+}
+
+uint32 FUbermundoThreadedTransport::Run() {
+	UE_LOG(UberMundoSteamLog, Display, TEXT("Network thread running %s at %.0f Hz"), inner->GetName(), 1.0 / tickSeconds);
+	while (!stopping) {
+		double start = FPlatformTime::Seconds();
+		if (SteamAPI_IsSteamRunning()) {
+			// Callbacks change the wrapped transport too, connection status on SteamSockets, and the game
+			// thread reads it under innerLock.
+			FScopeLock lock(&innerLock);
+			SteamAPI_RunCallbacks();
+		}
+		Service(start);
+
+		double elapsed = FPlatformTime::Seconds() - start;
+		if (elapsed < tickSeconds)
+			wake->Wait(FTimespan::FromSeconds(tickSeconds - elapsed));
+	}
+	UE_LOG(UberMundoSteamLog, Display, TEXT("Network thread stopped"));
+	return 0;
+}
+
+void FUbermundoThreadedTransport::Service(double now) {
+	double waitTotal = 0.0;
+	double waitMax = 0.0;
+	int32 n;
+	{
+		FScopeLock lock(&innerLock);
+		inner->Tick(now);
+		n = SendQueued(now, waitTotal, waitMax);
+		ReadArrived(now);
+	}
+
+	FScopeLock lock(&statsLock);
+	outboundWaitTotal += waitTotal;
+	outboundWaitMax = FMath::Max(outboundWaitMax, waitMax);
+	numOutbound += n;
+	if (numTicks++ == 0)
+		firstTick = now;
+	lastTick = now;
+}
+
+int32 FUbermundoThreadedTransport::SendQueued(double now, double& waitTotal, double& waitMax) {
+	int32 n = 0;
+	while (FOutbound* o = outbound.Peek()) {
+		if (o->close) {
+			inner->Close(o->peer);
+		}
+		else {
+			bool ok = inner->Send(o->peer, o->packet.GetData(), (uint32)o->packet.Num(), o->mode);
+			UBERMUNDO_TRACE(ThreadSend, o->peer, o->packet.GetData(), (uint32)o->packet.Num(), ok);
+			double wait = now - o->queuedAt;
+			waitTotal += wait;
+			waitMax = FMath::Max(waitMax, wait);
+			n++;
+		}
+		outbound.Pop();
+	}
+	inner->FlushSends();
+	return n;
+}
+
+void FUbermundoThreadedTransport::ReadArrived(double now) {
+	uint32 size;
+	while (!inbound.IsFull() && inner->IsPacketAvailable(size)) {
+		FInbound in;
+		in.packet = FUbermundoPacketBufferPool::Get().Acquire((int32)size);
+		TArray<uint8>& bytes = in.packet.GetMutableBytes();
+		bytes.SetNumUninitialized((int32)size, false);
+		uint32 read = 0;
+		if (!inner->Read(bytes.GetData(), size, read, in.sender))
+			break;
+		bytes.SetNum((int32)read, false);
+		UBERMUNDO_TRACE(ThreadRead, in.sender, bytes.GetData(), read, true);
+		in.readAt = now;
+		inbound.Push(MoveTemp(in));
+	}
+}
+
+void FUbermundoThreadedTransport::GetStats(FUbermundoNetLatencyStats& out) const {
+	FScopeLock lock(&statsLock);
+	out.NetworkThread = true;
+	out.NetTickHz = numTicks > 1 && lastTick > firstTick ? (float)((numTicks - 1) / (lastTick - firstTick)) : 0.0f;
+	out.AvgOutboundWaitMs = numOutbound > 0 ? (float)(outboundWaitTotal / numOutbound * 1000.0) : 0.0f;
+	out.MaxOutboundWaitMs = (float)(outboundWaitMax * 1000.0);
+	out.NumOutboundDropped = numOutboundDropped.load();
+}
+
+// --------------------------------------------------------------------------------- UUbermundoNetThreadLibrary
+static bool IsThreaded(IUbermundoTransport& t) {
+	return FCString::Strcmp(t.GetName(), TEXT("Threaded")) == 0;
+}
+
+bool UUbermundoNetThreadLibrary::StartNetworkThread(float tickHz) {
+	if (IsThreaded(USteamCustomCode::GetTransport()))
+		return true;
+	USteamCustomCode::ReplaceTransport([tickHz](TUniquePtr<IUbermundoTransport> current) -> TUniquePtr<IUbermundoTransport> {
+		return MakeUnique<FUbermundoThreadedTransport>(MoveTemp(current), tickHz);
+	});
+	FUbermundoNetLatency::Get().Reset();
+	return true;
+}
+
+void UUbermundoNetThreadLibrary::StopNetworkThread() {
+	if (!IsThreaded(USteamCustomCode::GetTransport()))
+		return;
+	USteamCustomCode::ReplaceTransport([](TUniquePtr<IUbermundoTransport> current) -> TUniquePtr<IUbermundoTransport> {
+		return static_cast<FUbermundoThreadedTransport&>(*current).Release();
+	});
+	FUbermundoNetLatency::Get().Reset();
+}
+
+bool UUbermundoNetThreadLibrary::IsNetworkThreadRunning() {
+	return IsThreaded(USteamCustomCode::GetTransport());
+}
+
+void UUbermundoNetThreadLibrary::GetNetLatencyStats(FUbermundoNetLatencyStats& stats) {
+	FUbermundoNetLatency::Get().GetStats(stats);
+	IUbermundoTransport& t = USteamCustomCode::GetTransport();
+	if (IsThreaded(t))
+		static_cast<FUbermundoThreadedTransport&>(t).GetStats(stats);
+}
+
+void UUbermundoNetThreadLibrary::ResetNetLatencyStats() {
+	FUbermundoNetLatency::Get().Reset();
+}
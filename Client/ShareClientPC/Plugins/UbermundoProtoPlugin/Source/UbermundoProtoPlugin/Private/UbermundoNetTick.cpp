@@ -0,0 +1,149 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+
+#include "UbermundoNetTick.h"
+#include "SteamCustomCode.h"
+#include "UbermundoP2PInbox.h"
+#include "UbermundoP2POutbox.h"
+#include "UbermundoSnapshotCodec.h"
+#include "UbermundoInterest.h"
+#include "UbermundoRateControl.h"
+#include "UbermundoBulkTransfer.h"
+#include "UbermundoBlockSwarm.h"
+#include "UbermundoJitterBuffer.h"
+#include "UbermundoNetStats.h"
+#include "UbermundoClockSync.h"
+#include "UbermundoSessionWarmup.h"
+#include "UbermundoDeadReckoning.h"
+#include "UbermundoImageMessages.h"
+#include "UbermundoVoice.h"
+
+// --------------------------------------------------------------------------------- FUbermundoNetTick
+FUbermundoNetTick& FUbermundoNetTick::Get() {
+	static FUbermundoNetTick tick;
+	return tick;
+}
+
+FUbermundoNetTick::FUbermundoNetTick() {
+	FMemory::Memzero(handlerFor);
+	AddPluginSubsystems();
+}
+
+void FUbermundoNetTick::AddPluginSubsystems() {
+	// Budgets are refilled before anything spends them.
+	AddTick([](double now) { FUbermundoRateController::Get().BeginTick(now); });
+	AddTick([](double now) { FUbermundoNetStats::Get().Tick(now); });
+	AddTick([](double now) { FUbermundoClockSync::Get().Tick(now); });
+	AddTick([](double now) { FUbermundoSessionWarmup::Get().Tick(now); });
+	AddTick([](double now) { FUbermundoVoice::Get().Tick(now); });
+	AddTick([](double now) { FUbermundoBlockSwarm::Get().Tick(now); });
+	AddTick([](double now) { FUbermundoImageMessages::Get().Tick(now); });
+	AddTick([](double now) { FUbermundoBulkTransfer::Get().Tick(now); });
+
+	AddHeard([](uint64 peer, double now) { FUbermundoClockSync::Get().OnHeard(peer, now); });
+	AddHeard([](uint64 peer, double now) { FUbermundoSessionWarmup::Get().OnHeard(peer, now); });
+
+	AddForget([](uint64 peer) { FUbermundoP2POutbox::Get().ForgetPeer(peer); });
+	AddForget([](uint64 peer) { FUbermundoSnapshotCodec::Get().ForgetPeer(peer); });
+	AddForget([](uint64 peer) { FUbermundoInterestManager::Get().RemovePeer(peer); });
+	AddForget([](uint64 peer) { FUbermundoRateController::Get().ForgetPeer(peer); });
+	AddForget([](uint64 peer) { FUbermundoBulkTransfer::Get().ForgetPeer(peer); });
+	AddForget([](uint64 peer) { FUbermundoBlockSwarm::Get().ForgetPeer(peer); });
+	AddForget([](uint64 peer) { FUbermundoJitterBuffer::Get().ForgetPeer(peer); });
+	AddForget([](uint64 peer) { FUbermundoNetStats::Get().ForgetPeer(peer); });
+	AddForget([](uint64 peer) { FUbermundoClockSync::Get().ForgetPeer(peer); });
+	AddForget([](uint64 peer) { FUbermundoSessionWarmup::Get().ForgetPeer(peer); });
+	AddForget([](uint64 peer) { FUbermundoDeadReckoning::Get().ForgetPeer(peer); });
+	AddForget([](uint64 peer) { FUbermundoVoice::Get().ForgetPeer(peer); });
+
+	AddHandler(UBERMUNDOPC_P2P_Player3DStateAck, [](uint64 sender, const uint8* data, int32 numBytes, double now) {
+		if (numBytes >= 3) {
+			uint16 seq = (uint16)((data[1] << 8) | data[2]);
+			FUbermundoSnapshotCodec& codec = FUbermundoSnapshotCodec::Get();
+			codec.OnAck(sender, seq);
+			double sentAt;
+			if (codec.GetSendTime(sender, seq, sentAt))
+				FUbermundoRateController::Get().OnStateAck(sender, now - sentAt);
+		}
+		return true;
+	});
+	AddHandler(UBERMUNDOPC_P2P_BulkChunk, [](uint64 sender, const uint8* data, int32 numBytes, double) {
+		TArray<uint8> completed;
+		// What comes out of a bulk transfer may be one of ours too, a block manifest say.
+		if (FUbermundoBulkTransfer::Get().OnChunk(sender, data, numBytes, completed))
+			UUbermundoP2PInbox::GetP2PInbox()->Deliver(sender, completed.GetData(), completed.Num());
+		return true;
+	});
+	AddHandler(UBERMUNDOPC_P2P_BulkAck, [](uint64 sender, const uint8* data, int32 numBytes, double) {
+		FUbermundoBulkTransfer::Get().OnAck(sender, data, numBytes);
+		return true;
+	});
+	AddHandler(UBERMUNDOPC_P2P_ClockPing, UBERMUNDOPC_P2P_ClockPong, [](uint64 sender, const uint8* data, int32 numBytes, double now) {
+		return FUbermundoClockSync::Get().HandlePacket(sender, data, numBytes, now);
+	});
+	AddHandler(UBERMUNDOPC_P2P_SessionPing, [](uint64 sender, const uint8* data, int32 numBytes, double now) {
+		return FUbermundoSessionWarmup::Get().HandlePacket(sender, data, numBytes, now);
+	});
+	FHandler image = [](uint64 sender, const uint8* data, int32 numBytes, double) {
+		return FUbermundoImageMessages::Get().HandlePacket(sender, data, numBytes);
+	};
+	AddHandler(UBERMUNDOPC_P2P_PlayerImageMsg, image);
+	AddHandler(UBERMUNDOPC_P2P_PlayerImageTile, image);
+	AddHandler(UBERMUNDOPC_P2P_PlayerVoiceMsg, [](uint64 sender, const uint8* data, int32 numBytes, double) {
+		return FUbermundoVoice::Get().HandlePacket(sender, data, numBytes);
+	});
+	AddHandler(UBERMUNDOPC_P2P_BlockWant, UBERMUNDOPC_P2P_BlockMissing, [](uint64 sender, const uint8* data, int32 numBytes, double) {
+		return FUbermundoBlockSwarm::Get().HandlePacket(sender, data, numBytes);
+	});
+}
+
+void FUbermundoNetTick::AddTick(TFunction<void(double now)> fn) {
+	ticks.Add(MoveTemp(fn));
+}
+
+bool FUbermundoNetTick::AddHandler(uint8 firstCode, uint8 lastCode, FHandler fn) {
+	for (int32 c = firstCode; c <= lastCode; c++) {
+		if (handlerFor[c] != 0) {
+			UE_LOG(UberMundoSteamLog, Error, TEXT("Net tick: packet code %d already has a handler"), c);
+			return false;
+		}
+	}
+	if (handlers.Num() >= 255) {
+		UE_LOG(UberMundoSteamLog, Error, TEXT("Net tick: too many packet handlers"));
+		return false;
+	}
+	handlers.Add(MoveTemp(fn));
+	for (int32 c = firstCode; c <= lastCode; c++)
+		handlerFor[c] = (uint8)handlers.Num();
+	return true;
+}
+
+void FUbermundoNetTick::AddHeard(TFunction<void(uint64 peer, double now)> fn) {
+	heard.Add(MoveTemp(fn));
+}
+
+void FUbermundoNetTick::AddForget(TFunction<void(uint64 peer)> fn) {
+	forget.Add(MoveTemp(fn));
+}
+
+void FUbermundoNetTick::Tick(double now) {
+	for (const TFunction<void(double)>& fn : ticks)
+		fn(now);
+}
+
+bool FUbermundoNetTick::Dispatch(uint64 sender, const uint8* data, int32 numBytes, double now) const {
+	if (numBytes <= 0)
+		return false;
+	uint8 h = handlerFor[data[0]];
+	return h != 0 && handlers[h - 1](sender, data, numBytes, now);
+}
+
+void FUbermundoNetTick::OnHeard(uint64 peer, double now) const {
+	for (const TFunction<void(uint64, double)>& fn : heard)
+		fn(peer, now);
+}
+
+void FUbermundoNetTick::ForgetPeer(uint64 peer) const {
+	for (const TFunction<void(uint64)>& fn : forget)
+		fn(peer);
+}
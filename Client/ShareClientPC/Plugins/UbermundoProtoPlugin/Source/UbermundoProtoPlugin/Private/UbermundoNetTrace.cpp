@@ -0,0 +1,123 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+
+#include "UbermundoNetTrace.h"
+#include "SteamCustomCode.h"
+#include "HAL/PlatformTLS.h"
+#include "HAL/ThreadManager.h"
+#include "Misc/FileHelper.h"
+
+static_assert(sizeof(FUbermundoTraceRecord) == 24, "The trace file format and the decoder expect 24 byte records.");
+static_assert((UBERMUNDO_NET_TRACE_RECORDS & (UBERMUNDO_NET_TRACE_RECORDS - 1)) == 0, "UBERMUNDO_NET_TRACE_RECORDS must be a power of two.");
+
+/** One thread's records. Only its own thread writes it, Save reads it. */
+struct FUbermundoTraceRing {
+	uint32 threadId = 0;
+	FString threadName;
+	FUbermundoTraceRecord records[UBERMUNDO_NET_TRACE_RECORDS];
+	/** Records ever written, so next & mask is where the next one goes. */
+	std::atomic<uint64> next{ 0 };
+};
+
+std::atomic<bool> FUbermundoNetTrace::enabled{ false };
+
+/** Every ring made so far. Rings live as long as the process, threads come and go too rarely to matter. */
+static FCriticalSection ringsLock;
+static TArray<FUbermundoTraceRing*> rings;
+static uint64 startCycles = 0;
+static thread_local FUbermundoTraceRing* threadRing = nullptr;
+
+static FUbermundoTraceRing* MakeRing() {
+	FUbermundoTraceRing* ring = new FUbermundoTraceRing();
+	ring->threadId = FPlatformTLS::GetCurrentThreadId();
+	ring->threadName = FThreadManager::GetThreadName(ring->threadId);
+	FScopeLock lock(&ringsLock);
+	rings.Add(ring);
+	return ring;
+}
+
+// --------------------------------------------------------------------------------- FUbermundoNetTrace
+void FUbermundoNetTrace::Start() {
+	// Rings are not cleared, another thread may be writing. Save leaves out what is older than this instead.
+	FScopeLock lock(&ringsLock);
+	startCycles = FPlatformTime::Cycles64();
+	enabled.store(true, std::memory_order_release);
+}
+
+void FUbermundoNetTrace::Stop() {
+	enabled.store(false, std::memory_order_release);
+}
+
+void FUbermundoNetTrace::Record(EUbermundoTraceEvent event, uint64 peer, const uint8* data, uint32 size, bool result) {
+	FUbermundoTraceRing* ring = threadRing;
+	if (ring == nullptr)
+		ring = threadRing = MakeRing();
+	uint64 n = ring->next.load(std::memory_order_relaxed);
+	FUbermundoTraceRecord& r = ring->records[n & (UBERMUNDO_NET_TRACE_RECORDS - 1)];
+	r.cycles = FPlatformTime::Cycles64();
+	r.peer = peer;
+	r.size = size;
+	r.event = (uint8)event;
+	r.code = data != nullptr && size > 0 ? data[0] : 0;
+	r.result = result ? 1 : 0;
+	r.unused = 0;
+	ring->next.store(n + 1, std::memory_order_release);
+}
+
+template<typename T>
+static void Put(TArray<uint8>& out, T v) {
+	out.Append((const uint8*)&v, sizeof(T));
+}
+
+bool FUbermundoNetTrace::Save(const FString& path, int32& numRecords) {
+	numRecords = 0;
+	TArray<uint8> out;
+	{
+		FScopeLock lock(&ringsLock);
+		out.Append((const uint8*)"UMNT", 4);
+		Put<uint16>(out, UBERMUNDO_NET_TRACE_VERSION);
+		Put<uint16>(out, (uint16)sizeof(FUbermundoTraceRecord));
+		Put<double>(out, FPlatformTime::GetSecondsPerCycle64());
+		Put<uint64>(out, startCycles);
+		Put<uint32>(out, (uint32)rings.Num());
+		for (FUbermundoTraceRing* ring : rings) {
+			FTCHARToUTF8 name(*ring->threadName);
+			Put<uint32>(out, ring->threadId);
+			Put<uint16>(out, (uint16)name.Length());
+			out.Append((const uint8*)name.Get(), name.Length());
+
+			uint64 end = ring->next.load(std::memory_order_acquire);
+			uint64 begin = end > UBERMUNDO_NET_TRACE_RECORDS ? end - UBERMUNDO_NET_TRACE_RECORDS : 0;
+			while (begin < end && ring->records[begin & (UBERMUNDO_NET_TRACE_RECORDS - 1)].cycles < startCycles)
+				begin++;
+			Put<uint32>(out, (uint32)(end - begin));
+			for (uint64 i = begin; i < end; i++)
+				Put<FUbermundoTraceRecord>(out, ring->records[i & (UBERMUNDO_NET_TRACE_RECORDS - 1)]);
+			numRecords += (int32)(end - begin);
+		}
+	}
+	if (!FFileHelper::SaveArrayToFile(out, *path)) {
+		UE_LOG(UberMundoSteamLog, Error, TEXT("SaveNetTrace could not write %s"), *path);
+		return false;
+	}
+	UE_LOG(UberMundoSteamLog, Display, TEXT("SaveNetTrace %d records to %s"), numRecords, *path);
+	return true;
+}
+
+// --------------------------------------------------------------------------------- UUbermundoNetTraceLibrary
+void UUbermundoNetTraceLibrary::StartNetTrace() {
+	FUbermundoNetTrace::Start();
+}
+
+void UUbermundoNetTraceLibrary::StopNetTrace() {
+	FUbermundoNetTrace::Stop();
+}
+
+bool UUbermundoNetTraceLibrary::IsNetTraceRunning() {
+	return FUbermundoNetTrace::IsEnabled();
+}
+
+bool UUbermundoNetTraceLibrary::SaveNetTrace(const FString& path, int32& numRecords) {
+	FUbermundoNetTrace::Stop();
+	return FUbermundoNetTrace::Save(path, numRecords);
+}
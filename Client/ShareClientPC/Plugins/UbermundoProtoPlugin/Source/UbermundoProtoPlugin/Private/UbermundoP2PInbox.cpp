@@ -0,0 +1,212 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+
+#include "UbermundoP2PInbox.h"
+#include "SteamCustomCode.h"
+#include "UbermundoP2POutbox.h"
+#include "UbermundoNetThread.h"
+#include "UbermundoNetTrace.h"
+#include "UbermundoNetStats.h"
+#include "UbermundoNetCapture.h"
+#include "UbermundoNetTick.h"
+
+// --------------------------------------------------------------------------------- FUbermundoPacketRing
+FUbermundoPacketRing::FUbermundoPacketRing(int32 numSlots, int32 slotReserve)
+	: slotReserve(slotReserve), head(0), claimedThisTick(0) {
+	slots.SetNum(numSlots);
+	for (TArray<uint8>& s : slots)
+		s.Reserve(slotReserve);
+}
+
+int32 FUbermundoPacketRing::Claim(int32 numBytes) {
+	if (claimedThisTick >= slots.Num()) {
+		// Every slot is holding a packet from this tick. Grow rather than overwrite.
+		// New slots go on the end so the slot numbers already handed out stay good.
+		int32 oldNum = slots.Num();
+		UE_LOG(UberMundoSteamLog, Log, TEXT("FUbermundoPacketRing growing to %d slots"), oldNum * 2);
+		slots.SetNum(oldNum * 2);
+		for (int32 i = oldNum; i < slots.Num(); i++)
+			slots[i].Reserve(slotReserve);
+		head = oldNum;
+	}
+	int32 slot = head;
+	head = (head + 1) % slots.Num();
+	claimedThisTick++;
+	slots[slot].SetNumUninitialized(numBytes, false);
+	return slot;
+}
+
+// --------------------------------------------------------------------------------- UUbermundoP2PInbox
+UUbermundoP2PInbox* UUbermundoP2PInbox::GetP2PInbox() {
+	static UUbermundoP2PInbox* inbox = nullptr;
+	if (inbox == nullptr) {
+		inbox = NewObject<UUbermundoP2PInbox>();
+		// Lives for the life of the program, same as the rest of the static P2P state.
+		inbox->AddToRoot();
+		inbox->packets.Reserve(256);
+		inbox->groups.Reserve(64);
+	}
+	return inbox;
+}
+
+int32 UUbermundoP2PInbox::DrainP2PPackets() {
+	ring.BeginTick();
+	packets.Reset();
+	groups.Reset();
+
+	IUbermundoTransport& transport = USteamCustomCode::GetTransport();
+	if (!transport.IsAvailable())
+		return 0;
+	FUbermundoNetLatency::Get().OnDrain(FPlatformTime::Seconds());
+	while (ReadDatagram(transport)) {
+	}
+	// These are game code's through OnPacketsReceived, ReadMessage starts after them.
+	nextRead = packets.Num();
+
+	if (packets.Num() > 0) {
+		BuildGroups();
+		OnPacketsReceived.Broadcast(this);
+	}
+	return packets.Num();
+}
+
+bool UUbermundoP2PInbox::ReadDatagram(IUbermundoTransport& transport) {
+	uint32 N;
+	int32 slot;
+	uint32 N2 = 0;
+	uint64 sender = 0;
+	{
+		FUbermundoGameThreadNetScope timing;
+		if (!transport.IsPacketAvailable(N))
+			return false;
+		slot = ring.Claim((int32)N);
+		if (!transport.Read(ring.GetSlotData(slot), N, N2, sender))
+			return false;
+	}
+	ring.SetSlotSize(slot, (int32)N2);
+	const uint8* data = ring.GetSlotData(slot);
+	UBERMUNDO_TRACE(Read, sender, data, N2, true);
+	FUbermundoNetStats& stats = FUbermundoNetStats::Get();
+	stats.OnPacketIn(sender, (int32)N2);
+	FUbermundoNetCapture& capture = FUbermundoNetCapture::Get();
+	if (capture.IsCapturing())
+		capture.OnReceive(sender, data, N2);
+	FUbermundoNetTick::Get().OnHeard(sender, FPlatformTime::Seconds());
+
+	if (N2 > 0 && data[0] == UBERMUNDOPC_P2P_Bundle) {
+		// Split it back into the messages the sender queued. The bundle's own slot just sits idle until next tick.
+		if (!FUbermundoP2POutbox::UnpackBundle(data, (int32)N2, [this, sender, &stats](const uint8* msg, int32 msgBytes) {
+				stats.OnMessageIn(sender, msg, msgBytes);
+				if (!HandleInternal(sender, msg, msgBytes))
+					AddPacket(sender, msg, msgBytes);
+			}))
+			UE_LOG(UberMundoSteamLog, Warning, TEXT("P2P inbox bad bundle from 0x%llX N=%d"), sender, N2);
+		return true;
+	}
+	stats.OnMessageIn(sender, data, (int32)N2);
+	if (HandleInternal(sender, data, (int32)N2))
+		return true;
+
+	FUbermundoReceivedPacket& p = packets.AddDefaulted_GetRef();
+	p.Sender = (int64)sender;
+	p.Slot = slot;
+	p.NumBytes = (int32)N2;
+	p.Code = N2 > 0 ? (EUbermundoPacketCodes)data[0] : UBERMUNDOPC_DB_START;
+	return true;
+}
+
+bool UUbermundoP2PInbox::GetNextMessageSize(uint32& numBytes) {
+	if (nextRead < packets.Num()) {
+		numBytes = (uint32)packets[nextRead].NumBytes;
+		return true;
+	}
+	// The next datagram's size. It may turn out to be a bundle, or only internal packets.
+	return USteamCustomCode::GetTransport().IsPacketAvailable(numBytes);
+}
+
+bool UUbermundoP2PInbox::ReadMessage(TArray<uint8>& bytes, uint64& sender) {
+	IUbermundoTransport& transport = USteamCustomCode::GetTransport();
+	while (nextRead >= packets.Num()) {
+		// One datagram at a time: a bundle gives several messages, one the plugin handles itself none.
+		ring.BeginTick();
+		packets.Reset();
+		groups.Reset();
+		nextRead = 0;
+		if (!transport.IsAvailable() || !ReadDatagram(transport))
+			return false;
+	}
+	const FUbermundoReceivedPacket& p = packets[nextRead++];
+	sender = (uint64)p.Sender;
+	TArrayView<const uint8> v = ring.GetSlot(p.Slot);
+	bytes.SetNumUninitialized(v.Num(), false);
+	FMemory::Memcpy(bytes.GetData(), v.GetData(), v.Num());
+	return true;
+}
+
+bool UUbermundoP2PInbox::HandleInternal(uint64 sender, const uint8* data, int32 numBytes) {
+	return FUbermundoNetTick::Get().Dispatch(sender, data, numBytes, FPlatformTime::Seconds());
+}
+
+void UUbermundoP2PInbox::Deliver(uint64 sender, const uint8* data, int32 numBytes) {
+	if (numBytes > 0 && data[0] == UBERMUNDOPC_P2P_Bundle) {
+		// Messages sent together as one bulk transfer, image tiles say.
+		if (!FUbermundoP2POutbox::UnpackBundle(data, numBytes, [this, sender](const uint8* msg, int32 msgBytes) { Deliver(sender, msg, msgBytes); }))
+			UE_LOG(UberMundoSteamLog, Warning, TEXT("P2P inbox bad bundle from 0x%llX N=%d in a bulk transfer"), sender, numBytes);
+		return;
+	}
+	if (!HandleInternal(sender, data, numBytes))
+		AddPacket(sender, data, numBytes);
+}
+
+int32 UUbermundoP2PInbox::AddPacket(uint64 sender, const uint8* data, int32 numBytes) {
+	int32 slot = ring.Claim(numBytes);
+	FMemory::Memcpy(ring.GetSlotData(slot), data, numBytes);
+	FUbermundoReceivedPacket& p = packets.AddDefaulted_GetRef();
+	p.Sender = (int64)sender;
+	p.Slot = slot;
+	p.NumBytes = numBytes;
+	p.Code = numBytes > 0 ? (EUbermundoPacketCodes)data[0] : UBERMUNDOPC_DB_START;
+	return packets.Num() - 1;
+}
+
+void UUbermundoP2PInbox::BuildGroups() {
+	// Stable so packets from one sender with one code stay in the order they arrived.
+	packets.StableSort([](const FUbermundoReceivedPacket& a, const FUbermundoReceivedPacket& b) {
+		if (a.Sender != b.Sender)
+			return a.Sender < b.Sender;
+		return (uint8)a.Code.GetValue() < (uint8)b.Code.GetValue();
+	});
+
+	for (int32 i = 0; i < packets.Num(); i++) {
+		const FUbermundoReceivedPacket& p = packets[i];
+		if (groups.Num() > 0 && groups.Last().Sender == p.Sender && groups.Last().Code == p.Code) {
+			groups.Last().NumPackets++;
+			continue;
+		}
+		FUbermundoReceivedPacketGroup& g = groups.AddDefaulted_GetRef();
+		g.Sender = p.Sender;
+		g.Code = p.Code;
+		g.FirstPacket = i;
+		g.NumPackets = 1;
+	}
+}
+
+FUbermundoReceivedPacket UUbermundoP2PInbox::GetPacket(int32 packetIndex) const {
+	if (!packets.IsValidIndex(packetIndex))
+		return FUbermundoReceivedPacket();
+	return packets[packetIndex];
+}
+
+bool UUbermundoP2PInbox::GetPacketBytes(int32 packetIndex, TArray<uint8>& bytes) const {
+	if (!packets.IsValidIndex(packetIndex))
+		return false;
+	TArrayView<const uint8> v = GetPacketView(packetIndex);
+	bytes.SetNumUninitialized(v.Num(), false);
+	FMemory::Memcpy(bytes.GetData(), v.GetData(), v.Num());
+	return true;
+}
+
+TArrayView<const uint8> UUbermundoP2PInbox::GetPacketView(int32 packetIndex) const {
+	const FUbermundoReceivedPacket& p = packets[packetIndex];
+	return ring.GetSlot(p.Slot);
+}
@@ -0,0 +1,126 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+
+#include "UbermundoP2POutbox.h"
+#include "SteamCustomCode.h"
+#include "UbermundoRateControl.h"
+#include "UbermundoNetThread.h"
+#include "UbermundoNetStats.h"
+#include "UbermundoSendScheduler.h"
+
+FUbermundoP2POutbox& FUbermundoP2POutbox::Get() {
+	static FUbermundoP2POutbox outbox;
+	return outbox;
+}
+
+bool FUbermundoP2POutbox::Queue(uint64 peer, const uint8* data, int32 numBytes, EUbermundoP2PSendMode mode) {
+	if (numBytes <= 0)
+		return false;
+	numMessagesQueued++;
+	FUbermundoNetStats::Get().OnMessageOut(peer, data, numBytes);
+
+	FPeerOutbox& o = peers.FindOrAdd(peer);
+	if (o.queues.GetQueuedBytes() + numBytes > UBERMUNDO_OUTBOX_MAX_DEFERRED) {
+		UE_LOG(UberMundoSteamLog, Warning, TEXT("Outbox to 0x%llX already holds %d bytes, dropping N=%d"), peer, o.queues.GetQueuedBytes(), numBytes);
+		numMessagesDropped++;
+		return false;
+	}
+
+	// Bulk asks for budget when its turn comes in Flush. Everything else is counted now, and voice may be dropped.
+	FUbermundoRateController& rate = FUbermundoRateController::Get();
+	EUbermundoTrafficClass cls = FUbermundoRateController::ClassOf(data[0]);
+	if (cls != EUbermundoTrafficClass::Bulk && rate.Admit(peer, numBytes, cls) == EUbermundoAdmit::Drop) {
+		numMessagesDropped++;
+		return false;
+	}
+	if (data[0] == UBERMUNDOPC_P2P_Player3DState)
+		rate.OnStateSent(peer);
+	o.queues.Push(FUbermundoSendScheduler::ClassOf(data[0]), data, numBytes, mode, FPlatformTime::Seconds());
+	return true;
+}
+
+int32 FUbermundoP2POutbox::GetDeferredBytes(uint64 peer) const {
+	const FPeerOutbox* o = peers.Find(peer);
+	return o ? o->queues.GetHeldOverBytes() : 0;
+}
+
+bool FUbermundoP2POutbox::QueueNow(uint64 peer, const uint8* data, int32 numBytes, EUbermundoP2PSendMode mode) {
+	int32 modeIdx = (int32)mode;
+	int32 cost = HeaderSize(numBytes) + numBytes;
+	FPendingDatagram& d = peers.FindOrAdd(peer).pending[modeIdx];
+	if (numBytes > UBERMUNDO_BUNDLE_MAX_MSG || 1 + cost > UBERMUNDO_P2P_MAX_UNRELIABLE) {
+		// Would not share a datagram with anything anyway. What was packed before it goes first, or a reliable
+		// message would overtake the ones queued ahead of it.
+		if (d.numMessages > 0)
+			SendPending(peer, modeIdx, d);
+		numDatagramsSent++;
+		return USteamCustomCode::SendP2P(peer, data, (uint32)numBytes, mode);
+	}
+
+	if (d.packet.IsValid() && d.packet.Num() + cost > UBERMUNDO_P2P_MAX_UNRELIABLE)
+		SendPending(peer, modeIdx, d);
+
+	if (!d.packet.IsValid()) {
+		d.packet = FUbermundoPacketBufferPool::Get().Acquire(UBERMUNDO_P2P_MAX_UNRELIABLE);
+		d.packet.GetMutableBytes().Add((uint8)UBERMUNDOPC_P2P_Bundle);
+	}
+
+	TArray<uint8>& b = d.packet.GetMutableBytes();
+	if (d.numMessages == 0)
+		d.firstMessageOffset = b.Num() + HeaderSize(numBytes);
+	AddToBundle(b, data, numBytes);
+	d.numMessages++;
+	return true;
+}
+
+bool FUbermundoP2POutbox::SendPending(uint64 peer, int32 modeIdx, FPendingDatagram& d) {
+	EUbermundoP2PSendMode mode = (EUbermundoP2PSendMode)modeIdx;
+	bool ok;
+	if (d.numMessages == 1) {
+		// Nothing to share the datagram with, skip the bundle header.
+		ok = USteamCustomCode::SendP2P(peer, d.packet.GetData() + d.firstMessageOffset, (uint32)(d.packet.Num() - d.firstMessageOffset), mode);
+	}
+	else {
+		ok = USteamCustomCode::SendP2P(peer, d.packet, mode);
+	}
+	numDatagramsSent++;
+	d.packet.Reset();
+	d.numMessages = 0;
+	d.firstMessageOffset = 0;
+	return ok;
+}
+
+int32 FUbermundoP2POutbox::Flush() {
+	FUbermundoRateController& rate = FUbermundoRateController::Get();
+	double now = FPlatformTime::Seconds();
+
+	// Oversize messages and datagrams that filled up mid pack go out from QueueNow, count those too.
+	int64 sentBefore = numDatagramsSent;
+	for (TPair<uint64, FPeerOutbox>& kv : peers) {
+		uint64 peer = kv.Key;
+		kv.Value.queues.Drain(now, [&](EUbermundoSendClass, const FUbermundoQueuedMessage& msg) {
+			const uint8* data = msg.packet.GetData();
+			int32 numBytes = msg.packet.Num();
+			if (FUbermundoRateController::ClassOf(data[0]) == EUbermundoTrafficClass::Bulk
+				&& rate.Admit(peer, numBytes, EUbermundoTrafficClass::Bulk) != EUbermundoAdmit::Send)
+				return false;
+			QueueNow(peer, data, numBytes, msg.mode);
+			return true;
+		});
+
+		for (int32 m = 0; m < NumModes; m++) {
+			FPendingDatagram& d = kv.Value.pending[m];
+			if (d.numMessages > 0)
+				SendPending(kv.Key, m, d);
+		}
+	}
+	{
+		FUbermundoGameThreadNetScope timing;
+		USteamCustomCode::GetTransport().FlushSends();
+	}
+	return (int32)(numDatagramsSent - sentBefore);
+}
+
+void FUbermundoP2POutbox::ForgetPeer(uint64 peer) {
+	peers.Remove(peer);
+}
@@ -0,0 +1,134 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+
+#include "UbermundoPacketBuffer.h"
+
+// --------------------------------------------------------------------------------- FUbermundoPacketRef
+FUbermundoPacketRef::FUbermundoPacketRef(FUbermundoPacketBuffer* b) : buffer(b) {
+	if (buffer)
+		buffer->RefCount.Increment();
+}
+
+FUbermundoPacketRef::FUbermundoPacketRef(const FUbermundoPacketRef& other) : buffer(other.buffer) {
+	if (buffer)
+		buffer->RefCount.Increment();
+}
+
+FUbermundoPacketRef& FUbermundoPacketRef::operator=(const FUbermundoPacketRef& other) {
+	if (other.buffer)
+		other.buffer->RefCount.Increment();
+	Reset();
+	buffer = other.buffer;
+	return *this;
+}
+
+FUbermundoPacketRef& FUbermundoPacketRef::operator=(FUbermundoPacketRef&& other) {
+	if (this != &other) {
+		Reset();
+		buffer = other.buffer;
+		other.buffer = nullptr;
+	}
+	return *this;
+}
+
+void FUbermundoPacketRef::Reset() {
+	if (buffer && buffer->RefCount.Decrement() == 0)
+		FUbermundoPacketBufferPool::Get().Release(buffer);
+	buffer = nullptr;
+}
+
+// --------------------------------------------------------------------------------- FUbermundoPacketBufferPool
+FUbermundoPacketBufferPool& FUbermundoPacketBufferPool::Get() {
+	static FUbermundoPacketBufferPool pool;
+	return pool;
+}
+
+FUbermundoPacketRef FUbermundoPacketBufferPool::Acquire(int32 reserveBytes) {
+	FUbermundoPacketBuffer* b = nullptr;
+	{
+		FScopeLock l(&lock);
+		if (freeList.Num() > 0)
+			b = freeList.Pop(false);
+	}
+	if (b == nullptr) {
+		b = new FUbermundoPacketBuffer();
+		numAllocated.Increment();
+	}
+	if (b->Bytes.Max() < reserveBytes)
+		b->Bytes.Reserve(reserveBytes);
+	return FUbermundoPacketRef(b);
+}
+
+void FUbermundoPacketBufferPool::Release(FUbermundoPacketBuffer* b) {
+	if (b->Bytes.Max() > UBERMUNDO_P2P_POOL_MAX_KEEP)
+		b->Bytes.Empty(UBERMUNDO_P2P_MAX_UNRELIABLE);
+	else
+		b->Bytes.Reset();
+	FScopeLock l(&lock);
+	freeList.Push(b);
+}
+
+int32 FUbermundoPacketBufferPool::NumFree() {
+	FScopeLock l(&lock);
+	return freeList.Num();
+}
+
+FUbermundoPacketBufferPool::~FUbermundoPacketBufferPool() {
+	for (FUbermundoPacketBuffer* b : freeList)
+		delete b;
+	freeList.Empty();
+}
+
+// --------------------------------------------------------------------------------- FUbermundoPacketBuilder
+FUbermundoPacketBuilder::FUbermundoPacketBuilder(EUbermundoPacketCodes code, int32 reserveBytes)
+	: packet(FUbermundoPacketBufferPool::Get().Acquire(reserveBytes)) {
+	AddByte((uint8)code);
+}
+
+FUbermundoPacketBuilder& FUbermundoPacketBuilder::AddByte(uint8 v) {
+	packet.GetMutableBytes().Add(v);
+	return *this;
+}
+
+FUbermundoPacketBuilder& FUbermundoPacketBuilder::AddInt16(int16 v) {
+	uint8 b[2] = { (uint8)((uint16)v >> 8), (uint8)v };
+	return AddBytes(b, 2);
+}
+
+FUbermundoPacketBuilder& FUbermundoPacketBuilder::AddInt32(int32 v) {
+	uint32 u = (uint32)v;
+	uint8 b[4] = { (uint8)(u >> 24), (uint8)(u >> 16), (uint8)(u >> 8), (uint8)u };
+	return AddBytes(b, 4);
+}
+
+FUbermundoPacketBuilder& FUbermundoPacketBuilder::AddInt64(int64 v) {
+	uint64 u = (uint64)v;
+	uint8 b[8] = { (uint8)(u >> 56), (uint8)(u >> 48), (uint8)(u >> 40), (uint8)(u >> 32),
+		(uint8)(u >> 24), (uint8)(u >> 16), (uint8)(u >> 8), (uint8)u };
+	return AddBytes(b, 8);
+}
+
+FUbermundoPacketBuilder& FUbermundoPacketBuilder::AddFloat(float v) {
+	uint32 u;
+	FMemory::Memcpy(&u, &v, 4);
+	return AddInt32((int32)u);
+}
+
+FUbermundoPacketBuilder& FUbermundoPacketBuilder::AddVector(const FVector& v) {
+	return AddFloat(v.X).AddFloat(v.Y).AddFloat(v.Z);
+}
+
+FUbermundoPacketBuilder& FUbermundoPacketBuilder::AddRotator(const FRotator& r) {
+	return AddFloat(r.Pitch).AddFloat(r.Yaw).AddFloat(r.Roll);
+}
+
+FUbermundoPacketBuilder& FUbermundoPacketBuilder::AddBytes(const uint8* data, int32 n) {
+	packet.GetMutableBytes().Append(data, n);
+	return *this;
+}
+
+FUbermundoPacketBuilder& FUbermundoPacketBuilder::AddString(const FString& s) {
+	FTCHARToUTF8 utf8(*s);
+	AddInt32(utf8.Length());
+	return AddBytes((const uint8*)utf8.Get(), utf8.Length());
+}
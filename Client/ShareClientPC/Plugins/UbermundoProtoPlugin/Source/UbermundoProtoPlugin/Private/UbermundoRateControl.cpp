@@ -0,0 +1,198 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+
+#include "UbermundoRateControl.h"
+#include "SteamCustomCode.h"
+#include "UbermundoPacketCodes.h"
+#include "UbermundoSendScheduler.h"
+
+/** Seconds of traffic each link estimate is made from. */
+#define UBERMUNDO_RATE_WINDOW 0.5
+/** Budget growth per window once out of slow start, bytes per second. */
+#define UBERMUNDO_RATE_STEP 4096.0
+
+// --------------------------------------------------------------------------------- FUbermundoRateController
+FUbermundoRateController& FUbermundoRateController::Get() {
+	static FUbermundoRateController controller;
+	return controller;
+}
+
+EUbermundoTrafficClass FUbermundoRateController::ClassOf(uint8 packetCode) {
+	// Voice is realtime to the scheduler, but the only realtime traffic that may be dropped.
+	if (packetCode == UBERMUNDOPC_P2P_PlayerVoiceMsg)
+		return EUbermundoTrafficClass::Voice;
+	return FUbermundoSendScheduler::ClassOf(packetCode) == EUbermundoSendClass::Bulk ? EUbermundoTrafficClass::Bulk : EUbermundoTrafficClass::Critical;
+}
+
+FUbermundoRateController::FLink& FUbermundoRateController::LinkFor(uint64 peer) {
+	FLink* l = links.Find(peer);
+	if (l == nullptr) {
+		l = &links.Add(peer);
+		l->rate = settings.StartKBps * 1024.0;
+		l->tokens = Burst(*l);
+		l->windowStart = FPlatformTime::Seconds();
+	}
+	return *l;
+}
+
+void FUbermundoRateController::BeginTick(double now) {
+	// A long hitch must not turn into one huge burst.
+	double dt = lastTick > 0.0 ? FMath::Clamp(now - lastTick, 0.0, 0.25) : 0.0;
+	lastTick = now;
+	for (TPair<uint64, FLink>& kv : links) {
+		FLink& l = kv.Value;
+		l.tokens = FMath::Min(l.tokens + l.rate * dt, Burst(l));
+		if (now - l.windowStart >= UBERMUNDO_RATE_WINDOW)
+			EndWindow(l, now);
+	}
+}
+
+void FUbermundoRateController::EndWindow(FLink& l, double now) {
+	double len = now - l.windowStart;
+	// Too few states to say anything about loss, keep the last estimate.
+	if (l.windowStates >= 4) {
+		double delivered = FMath::Clamp((double)l.windowAcks / l.windowStates, 0.0, 1.0);
+		l.loss = 0.7 * l.loss + 0.3 * (1.0 - delivered);
+	}
+	double sentRate = l.windowBytes / len;
+	l.throughput = 0.7 * l.throughput + 0.3 * sentRate * (1.0 - l.loss);
+	l.criticalRate = 0.7 * l.criticalRate + 0.3 * (l.windowCriticalBytes / len);
+
+	bool queueing = l.anyRtt && (l.srtt - l.minRtt) * 1000.0 > settings.QueueDelayThresholdMs;
+	l.congested = l.loss * 100.0 > settings.LossThresholdPercent || queueing;
+	if (l.congested) {
+		l.slowStart = false;
+		l.rate *= 0.75;
+	}
+	else if (sentRate > l.rate * 0.6) {
+		// Only grow a budget that is actually being used, an idle link tells us nothing.
+		l.rate = l.slowStart ? l.rate * 1.5 : l.rate + UBERMUNDO_RATE_STEP;
+	}
+	l.rate = FMath::Clamp(l.rate, (double)settings.MinKBps * 1024.0, (double)settings.MaxKBps * 1024.0);
+
+	// criticalRate already includes the current factor, so adjust it rather than recompute it, or it would flip back and forth.
+	if (l.criticalRate > l.rate * 0.8)
+		l.stateFactor = FMath::Max(0.25f, l.stateFactor * (float)(l.rate * 0.8 / l.criticalRate));
+	else if (l.criticalRate < l.rate * 0.6)
+		l.stateFactor = FMath::Min(1.0f, l.stateFactor * 1.1f);
+
+	// The path may have changed, let the minimum creep up towards what we see now.
+	if (l.anyRtt)
+		l.minRtt += (l.srtt - l.minRtt) * 0.01;
+
+	l.windowStart = now;
+	l.windowBytes = 0;
+	l.windowCriticalBytes = 0;
+	l.windowStates = 0;
+	l.windowAcks = 0;
+}
+
+EUbermundoAdmit FUbermundoRateController::Admit(uint64 peer, int32 numBytes, EUbermundoTrafficClass cls) {
+	FLink& l = LinkFor(peer);
+	double burst = Burst(l);
+	switch (cls) {
+	case EUbermundoTrafficClass::Voice:
+		// May borrow up to one burst ahead.
+		if (l.tokens + burst < numBytes)
+			return EUbermundoAdmit::Drop;
+		break;
+	case EUbermundoTrafficClass::Bulk:
+		// Needs the budget in hand. Something bigger than a burst waits for a full bucket, then goes into debt.
+		if (l.tokens < FMath::Min((double)numBytes, burst))
+			return EUbermundoAdmit::Defer;
+		break;
+	default:
+		break;
+	}
+	OnSent(peer, numBytes, cls);
+	return EUbermundoAdmit::Send;
+}
+
+void FUbermundoRateController::OnSent(uint64 peer, int32 numBytes, EUbermundoTrafficClass cls) {
+	FLink& l = LinkFor(peer);
+	// Critical traffic is never held back, but the debt it runs up is bounded so the link recovers once it eases.
+	l.tokens = FMath::Max(l.tokens - numBytes, -4.0 * Burst(l));
+	l.windowBytes += numBytes;
+	if (cls == EUbermundoTrafficClass::Critical)
+		l.windowCriticalBytes += numBytes;
+}
+
+void FUbermundoRateController::OnStateSent(uint64 peer) {
+	LinkFor(peer).windowStates++;
+}
+
+void FUbermundoRateController::OnStateAck(uint64 peer, double rttSeconds) {
+	FLink* l = links.Find(peer);
+	if (l == nullptr)
+		return;
+	l->windowAcks++;
+	if (!l->anyRtt) {
+		l->srtt = rttSeconds;
+		l->rttVar = rttSeconds / 2.0;
+		l->minRtt = rttSeconds;
+		l->anyRtt = true;
+		return;
+	}
+	l->rttVar = 0.75 * l->rttVar + 0.25 * FMath::Abs(l->srtt - rttSeconds);
+	l->srtt = 0.875 * l->srtt + 0.125 * rttSeconds;
+	l->minRtt = FMath::Min(l->minRtt, rttSeconds);
+}
+
+float FUbermundoRateController::GetStateRateFactor(uint64 peer) const {
+	const FLink* l = links.Find(peer);
+	return l ? l->stateFactor : 1.0f;
+}
+
+int32 FUbermundoRateController::GetVoiceBitrate(uint64 peer) const {
+	const FLink* l = links.Find(peer);
+	if (l == nullptr)
+		return settings.MaxVoiceBitrate;
+	// Half of what critical traffic leaves over, the rest is for images and headroom.
+	double spare = FMath::Max(0.0, l->rate - l->criticalRate);
+	return FMath::Clamp((int32)(spare * 0.5 * 8.0), settings.MinVoiceBitrate, settings.MaxVoiceBitrate);
+}
+
+bool FUbermundoRateController::ShouldDeferBulk(uint64 peer) const {
+	const FLink* l = links.Find(peer);
+	if (l == nullptr)
+		return false;
+	return l->tokens < 0.0 || l->rate - l->criticalRate < l->rate * 0.1;
+}
+
+bool FUbermundoRateController::GetLinkStats(uint64 peer, FUbermundoLinkStats& out) const {
+	out = FUbermundoLinkStats();
+	const FLink* l = links.Find(peer);
+	if (l == nullptr)
+		return false;
+	out.RttMs = (float)(l->srtt * 1000.0);
+	out.RttVarMs = (float)(l->rttVar * 1000.0);
+	out.LossPercent = (float)(l->loss * 100.0);
+	out.ThroughputKBps = (float)(l->throughput / 1024.0);
+	out.BudgetKBps = (float)(l->rate / 1024.0);
+	out.CriticalKBps = (float)(l->criticalRate / 1024.0);
+	out.StateRateFactor = l->stateFactor;
+	out.VoiceBitrate = GetVoiceBitrate(peer);
+	out.Congested = l->congested;
+	return true;
+}
+
+void FUbermundoRateController::ForgetPeer(uint64 peer) {
+	links.Remove(peer);
+}
+
+// --------------------------------------------------------------------------------- UUbermundoRateLibrary
+void UUbermundoRateLibrary::SetRateSettings(const FUbermundoRateSettings& settings) {
+	FUbermundoRateController::Get().SetSettings(settings);
+}
+
+bool UUbermundoRateLibrary::GetPeerLinkStats(int64 peer, FUbermundoLinkStats& stats) {
+	return FUbermundoRateController::Get().GetLinkStats((uint64)peer, stats);
+}
+
+int32 UUbermundoRateLibrary::GetRecommendedVoiceBitrate(int64 peer) {
+	return FUbermundoRateController::Get().GetVoiceBitrate((uint64)peer);
+}
+
+bool UUbermundoRateLibrary::ShouldDeferImages(int64 peer) {
+	return FUbermundoRateController::Get().ShouldDeferBulk((uint64)peer);
+}
@@ -0,0 +1,189 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+
+#include "UbermundoSendScheduler.h"
+#include "SteamCustomCode.h"
+#include "UbermundoPacketCodes.h"
+
+static bool IsReliable(EUbermundoP2PSendMode mode) {
+	return mode == EUbermundoP2PSendMode::Reliable || mode == EUbermundoP2PSendMode::ReliableWithBuffering;
+}
+
+// --------------------------------------------------------------------------------- FUbermundoSendQueues
+void FUbermundoSendQueues::Push(EUbermundoSendClass cls, const uint8* data, int32 numBytes, EUbermundoP2PSendMode mode, double now) {
+	FClassQueue& q = queues[(int32)cls];
+	float weight = FMath::Max(FUbermundoSendScheduler::Get().GetSettings().Get(cls).Weight, 0.01f);
+	FUbermundoQueuedMessage& m = q.items.AddDefaulted_GetRef();
+	m.packet = FUbermundoPacketBufferPool::Get().Acquire(numBytes);
+	m.packet.GetMutableBytes().Append(data, numBytes);
+	m.mode = mode;
+	m.queuedAt = now;
+	m.seq = nextSeq++;
+	if (IsReliable(mode))
+		reliableOrder.Add(m.seq);
+	m.start = FMath::Max(virtualTime, q.lastFinish);
+	m.finish = m.start + numBytes / weight;
+	q.lastFinish = m.finish;
+	queuedBytes += numBytes;
+}
+
+void FUbermundoSendQueues::Drain(double now, TFunctionRef<bool(EUbermundoSendClass, const FUbermundoQueuedMessage&)> send) {
+	FUbermundoSendScheduler& scheduler = FUbermundoSendScheduler::Get();
+	const FUbermundoSendSchedulerSettings& settings = scheduler.GetSettings();
+	int32 sentBytes[UBERMUNDO_SEND_CLASSES] = {};
+	bool blocked[UBERMUNDO_SEND_CLASSES] = {};
+
+	for (;;) {
+		int32 best = -1;
+		bool bestBoosted = false;
+		double bestKey = 0.0;
+		for (int32 c = 0; c < UBERMUNDO_SEND_CLASSES; c++) {
+			FClassQueue& q = queues[c];
+			if (blocked[c] || q.head == q.items.Num())
+				continue;
+			const FUbermundoQueuedMessage& m = q.items[q.head];
+			// A reliable head waits, without blocking its class for the tick, while an older reliable message is queued.
+			if (IsReliable(m.mode) && reliableOrder[reliableHead] != m.seq)
+				continue;
+			const FUbermundoSendClassSettings& cs = settings.Get((EUbermundoSendClass)c);
+			if (cs.MaxBytesPerTick > 0 && sentBytes[c] > 0 && sentBytes[c] + m.packet.Num() > cs.MaxBytesPerTick) {
+				blocked[c] = true;
+				continue;
+			}
+			// Boosted heads go first, oldest first. The rest by finish tag.
+			bool boosted = cs.BoostAfterMs > 0.0f && (now - m.queuedAt) * 1000.0 >= cs.BoostAfterMs;
+			double key = boosted ? m.queuedAt : m.finish;
+			if (best < 0 || (boosted && !bestBoosted) || (boosted == bestBoosted && key < bestKey)) {
+				best = c;
+				bestBoosted = boosted;
+				bestKey = key;
+			}
+		}
+		if (best < 0)
+			break;
+
+		FClassQueue& q = queues[best];
+		FUbermundoQueuedMessage& m = q.items[q.head];
+		if (!send((EUbermundoSendClass)best, m)) {
+			blocked[best] = true;
+			continue;
+		}
+		int32 numBytes = m.packet.Num();
+		sentBytes[best] += numBytes;
+		queuedBytes -= numBytes;
+		virtualTime = m.start;
+		if (IsReliable(m.mode))
+			reliableHead++;
+		scheduler.OnSent((EUbermundoSendClass)best, numBytes, now - m.queuedAt, bestBoosted);
+		// Back to the pool now, not when the queue is next compacted.
+		m = FUbermundoQueuedMessage();
+		q.head++;
+	}
+
+	if (reliableHead > 0) {
+		reliableOrder.RemoveAt(0, reliableHead, false);
+		reliableHead = 0;
+	}
+	bool empty = true;
+	for (int32 c = 0; c < UBERMUNDO_SEND_CLASSES; c++) {
+		FClassQueue& q = queues[c];
+		if (q.head > 0) {
+			q.items.RemoveAt(0, q.head, false);
+			q.head = 0;
+		}
+		if (q.items.Num() > 0) {
+			scheduler.OnHeldOver((EUbermundoSendClass)c, q.items.Num());
+			empty = false;
+		}
+	}
+	if (empty) {
+		// Idle, start the tags again from nothing so they don't grow without end.
+		virtualTime = 0.0;
+		for (FClassQueue& q : queues)
+			q.lastFinish = 0.0;
+	}
+	heldOverBytes = queuedBytes;
+}
+
+// --------------------------------------------------------------------------------- FUbermundoSendScheduler
+FUbermundoSendScheduler& FUbermundoSendScheduler::Get() {
+	static FUbermundoSendScheduler scheduler;
+	return scheduler;
+}
+
+EUbermundoSendClass FUbermundoSendScheduler::ClassOf(uint8 packetCode) {
+	switch (packetCode) {
+	case UBERMUNDOPC_P2P_Player3DState:
+	case UBERMUNDOPC_P2P_Player3DStateAck:
+	case UBERMUNDOPC_P2P_ClockPing:
+	case UBERMUNDOPC_P2P_ClockPong:
+	case UBERMUNDOPC_P2P_SessionPing:
+	case UBERMUNDOPC_P2P_BulkAck:
+	case UBERMUNDOPC_P2P_PlayerVoiceMsg:
+		return EUbermundoSendClass::Realtime;
+	case UBERMUNDOPC_P2P_PlayerTextMsg:
+	case UBERMUNDOPC_P2P_PlayerImageMsg:
+		return EUbermundoSendClass::Chat;
+	case UBERMUNDOPC_P2P_PlayerImageTile:
+	case UBERMUNDOPC_P2P_BulkChunk:
+	case UBERMUNDOPC_P2P_BlockChunk:
+		return EUbermundoSendClass::Bulk;
+	default:
+		return EUbermundoSendClass::Event;
+	}
+}
+
+void FUbermundoSendScheduler::OnSent(EUbermundoSendClass cls, int32 numBytes, double waitSeconds, bool boosted) {
+	FClassTotals& t = totals[(int32)cls];
+	t.messagesSent++;
+	t.bytesSent += numBytes;
+	t.waitTotal += waitSeconds;
+	t.waitMax = FMath::Max(t.waitMax, waitSeconds);
+	if (boosted)
+		t.numBoosted++;
+}
+
+void FUbermundoSendScheduler::OnHeldOver(EUbermundoSendClass cls, int32 numMessages) {
+	totals[(int32)cls].numHeldOver += numMessages;
+}
+
+void FUbermundoSendScheduler::GetStats(TArray<FUbermundoSendClassStats>& out) const {
+	out.Reset(UBERMUNDO_SEND_CLASSES);
+	for (int32 c = 0; c < UBERMUNDO_SEND_CLASSES; c++) {
+		const FClassTotals& t = totals[c];
+		FUbermundoSendClassStats& s = out.AddDefaulted_GetRef();
+		s.Class = (EUbermundoSendClass)c;
+		s.MessagesSent = t.messagesSent;
+		s.BytesSent = t.bytesSent;
+		s.AvgWaitMs = t.messagesSent > 0 ? (float)(t.waitTotal / t.messagesSent * 1000.0) : 0.0f;
+		s.MaxWaitMs = (float)(t.waitMax * 1000.0);
+		s.NumBoosted = t.numBoosted;
+		s.NumHeldOver = t.numHeldOver;
+	}
+}
+
+void FUbermundoSendScheduler::ResetStats() {
+	for (FClassTotals& t : totals)
+		t = FClassTotals();
+}
+
+// --------------------------------------------------------------------------------- UUbermundoSendSchedulerLibrary
+void UUbermundoSendSchedulerLibrary::SetSendSchedulerSettings(const FUbermundoSendSchedulerSettings& settings) {
+	FUbermundoSendScheduler::Get().SetSettings(settings);
+}
+
+FUbermundoSendSchedulerSettings UUbermundoSendSchedulerLibrary::GetSendSchedulerSettings() {
+	return FUbermundoSendScheduler::Get().GetSettings();
+}
+
+EUbermundoSendClass UUbermundoSendSchedulerLibrary::GetSendClassOf(uint8 packetCode) {
+	return FUbermundoSendScheduler::ClassOf(packetCode);
+}
+
+void UUbermundoSendSchedulerLibrary::GetSendSchedulerStats(TArray<FUbermundoSendClassStats>& stats) {
+	FUbermundoSendScheduler::Get().GetStats(stats);
+}
+
+void UUbermundoSendSchedulerLibrary::ResetSendSchedulerStats() {
+	FUbermundoSendScheduler::Get().ResetStats();
+}
@@ -0,0 +1,199 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+
+#include "UbermundoSessionWarmup.h"
+#include "SteamCustomCode.h"
+#include "UbermundoPacketCodes.h"
+#include "UbermundoP2POutbox.h"
+#include "UbermundoMessages.h"
+
+/** Second byte of a SessionPing. */
+#define UBERMUNDO_WARMUP_PING 0
+#define UBERMUNDO_WARMUP_ANSWER 1
+
+static uint64 ToMicros(double seconds) {
+	return (uint64)FMath::Max(seconds * 1000000.0, 0.0);
+}
+
+static uint64 ReadU64(const uint8* p) {
+	uint64 v = 0;
+	for (int32 i = 0; i < 8; i++)
+		v = (v << 8) | p[i];
+	return v;
+}
+
+// --------------------------------------------------------------------------------- FUbermundoSessionWarmup
+FUbermundoSessionWarmup& FUbermundoSessionWarmup::Get() {
+	static FUbermundoSessionWarmup warmup;
+	return warmup;
+}
+
+void FUbermundoSessionWarmup::Announce(TArrayView<const uint64> announced, double now) {
+	uint64 self = USteamCustomCode::GetTransport().GetLocalId();
+	for (uint64 peer : announced) {
+		if (peer == 0 || peer == self)
+			continue;
+		FPeer& p = peers.FindOrAdd(peer);
+		if (p.state == EUbermundoSessionState::Ready || p.state == EUbermundoSessionState::Warming)
+			continue;
+		p.state = EUbermundoSessionState::Warming;
+		p.warmingSince = now;
+		Ping(peer, p, now);
+	}
+}
+
+void FUbermundoSessionWarmup::OnHeard(uint64 peer, double now) {
+	FPeer* p = peers.Find(peer);
+	if (p == nullptr)
+		return;
+	p->lastHeard = now;
+	if (p->state != EUbermundoSessionState::Ready) {
+		if (p->warmupTime < 0.0)
+			p->warmupTime = now - p->warmingSince;
+		p->state = EUbermundoSessionState::Ready;
+	}
+	p->unanswered = 0;
+}
+
+void FUbermundoSessionWarmup::Tick(double now) {
+	TArray<uint64, TInlineAllocator<8>> gone;
+	for (auto it = peers.CreateIterator(); it; ++it) {
+		uint64 peer = it.Key();
+		FPeer& p = it.Value();
+		switch (p.state) {
+		case EUbermundoSessionState::Ready:
+			if (now - p.lastHeard > UBERMUNDO_WARMUP_STALE) {
+				p.state = EUbermundoSessionState::Warming;
+				p.warmingSince = now;
+				Ping(peer, p, now);
+			}
+			else if (now - p.lastHeard > UBERMUNDO_WARMUP_KEEPALIVE && now - p.lastPing > UBERMUNDO_WARMUP_KEEPALIVE) {
+				Ping(peer, p, now);
+			}
+			break;
+		case EUbermundoSessionState::Warming:
+			if (now - p.warmingSince > UBERMUNDO_WARMUP_GIVE_UP) {
+				UE_LOG(UberMundoSteamLog, Warning, TEXT("P2P session with 0x%llX not answering after %d pings"), peer, p.numPings);
+				p.state = EUbermundoSessionState::Unreachable;
+				p.unanswered = 0;
+			}
+			else if (now - p.lastPing >= UBERMUNDO_WARMUP_RETRY) {
+				Ping(peer, p, now);
+			}
+			break;
+		case EUbermundoSessionState::Unreachable:
+			if (now - p.lastPing < UBERMUNDO_WARMUP_KEEPALIVE)
+				break;
+			// Most likely left without game code closing the session.
+			if (p.unanswered >= UBERMUNDO_WARMUP_MAX_UNANSWERED) {
+				UE_LOG(UberMundoSteamLog, Log, TEXT("P2P session with 0x%llX closed, no answer to %d pings"), peer, p.numPings);
+				gone.Add(peer);
+				break;
+			}
+			p.unanswered++;
+			Ping(peer, p, now);
+			break;
+		default:
+			break;
+		}
+	}
+	// Outside the loop, closing forgets the peer here too. Everything else the plugin keeps for it goes with it.
+	for (uint64 peer : gone) {
+		peers.Remove(peer);
+		USteamCustomCode::CloseP2PBySteamID((int64)peer);
+	}
+}
+
+void FUbermundoSessionWarmup::Ping(uint64 peer, FPeer& p, double now) {
+	FUbermundoPacketBuilder b(UBERMUNDOPC_P2P_SessionPing, 1 + 1 + 8);
+	b.AddByte(UBERMUNDO_WARMUP_PING);
+	b.AddInt64((int64)ToMicros(now));
+	// Unreliable, not NoDelay: Steam holds it while it sets the session up instead of dropping it.
+	FUbermundoP2POutbox::Get().Queue(peer, b.GetPacket().View(), EUbermundoP2PSendMode::Unreliable);
+	p.lastPing = now;
+	p.numPings++;
+}
+
+bool FUbermundoSessionWarmup::HandlePacket(uint64 sender, const uint8* data, int32 numBytes, double now) {
+	if (numBytes <= 0 || data[0] != UBERMUNDOPC_P2P_SessionPing)
+		return false;
+	if (numBytes < 1 + 1 + 8)
+		return true;
+	if (data[1] == UBERMUNDO_WARMUP_PING) {
+		// Answer with their time, so they get a round trip out of it.
+		FUbermundoPacketBuilder b(UBERMUNDOPC_P2P_SessionPing, 1 + 1 + 8);
+		b.AddByte(UBERMUNDO_WARMUP_ANSWER);
+		b.AddBytes(data + 2, 8);
+		FUbermundoP2POutbox::Get().Queue(sender, b.GetPacket().View(), EUbermundoP2PSendMode::Unreliable);
+	}
+	else if (FPeer* p = peers.Find(sender)) {
+		p->rtt = FMath::Max(now - ReadU64(data + 2) / 1000000.0, 0.0);
+	}
+	return true;
+}
+
+EUbermundoSessionState FUbermundoSessionWarmup::GetState(uint64 peer) const {
+	const FPeer* p = peers.Find(peer);
+	return p ? p->state : EUbermundoSessionState::None;
+}
+
+bool FUbermundoSessionWarmup::GetStatus(uint64 peer, FUbermundoSessionStatus& out) const {
+	out = FUbermundoSessionStatus();
+	const FPeer* p = peers.Find(peer);
+	if (p == nullptr)
+		return false;
+	out.State = p->state;
+	out.WarmupMs = p->warmupTime >= 0.0 ? (float)(p->warmupTime * 1000.0) : -1.0f;
+	out.RttMs = p->rtt >= 0.0 ? (float)(p->rtt * 1000.0) : -1.0f;
+	out.NumPings = p->numPings;
+	return true;
+}
+
+void FUbermundoSessionWarmup::ForgetPeer(uint64 peer) {
+	peers.Remove(peer);
+}
+
+bool FUbermundoSessionWarmup::DecodeAnnounce(const uint8* data, int32 numBytes, TArray<int32>& ubermundoIds, TArray<uint64>& steamIds) {
+	ubermundoIds.Reset();
+	steamIds.Reset();
+	// Player by player rather than FUbermundoS2PAnnouncePlayersToClient_SteamWire::Decode, so the players
+	// before a fault are still warmed up.
+	FUbermundoWireReader r(data, numBytes);
+	uint8 code;
+	int32 count;
+	if (!r.Read(code) || code != FUbermundoS2PAnnouncePlayersToClient_SteamWire::Code || !r.ReadCount(count))
+		return false;
+	for (int32 n = 0; n < count; n++) {
+		FUbermundoAnnouncedPlayerWire player;
+		if (!r.Read(player))
+			return false;
+		ubermundoIds.Add(player.UbermundoId);
+		steamIds.Add(player.SteamId);
+	}
+	return true;
+}
+
+// --------------------------------------------------------------------------------- UUbermundoSessionWarmupLibrary
+void UUbermundoSessionWarmupLibrary::WarmUpP2PSessions(const TArray<int64>& peers) {
+	FUbermundoSessionWarmup::Get().Announce(TArrayView<const uint64>(reinterpret_cast<const uint64*>(peers.GetData()), peers.Num()), FPlatformTime::Seconds());
+}
+
+bool UUbermundoSessionWarmupLibrary::WarmUpAnnouncedPlayers(const TArray<uint8>& message, TArray<int32>& ubermundoIds, TArray<int64>& steamIds) {
+	TArray<uint64> ids;
+	bool ok = FUbermundoSessionWarmup::DecodeAnnounce(message.GetData(), message.Num(), ubermundoIds, ids);
+	if (!ok)
+		UE_LOG(UberMundoSteamLog, Warning, TEXT("WarmUpAnnouncedPlayers bad announce N=%d, warming up the %d players before the fault"), message.Num(), ids.Num());
+	FUbermundoSessionWarmup::Get().Announce(ids, FPlatformTime::Seconds());
+	steamIds.Reset(ids.Num());
+	for (uint64 id : ids)
+		steamIds.Add((int64)id);
+	return ok;
+}
+
+bool UUbermundoSessionWarmupLibrary::IsP2PSessionReady(int64 peer) {
+	return FUbermundoSessionWarmup::Get().GetState((uint64)peer) == EUbermundoSessionState::Ready;
+}
+
+bool UUbermundoSessionWarmupLibrary::GetP2PSessionStatus(int64 peer, FUbermundoSessionStatus& status) {
+	return FUbermundoSessionWarmup::Get().GetStatus((uint64)peer, status);
+}
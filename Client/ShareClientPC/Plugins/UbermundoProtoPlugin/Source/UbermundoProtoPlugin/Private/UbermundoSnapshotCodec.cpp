@@ -0,0 +1,245 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+
+#include "UbermundoSnapshotCodec.h"
+#include "SteamCustomCode.h"
+#include "UbermundoP2POutbox.h"
+#include "UbermundoJitterBuffer.h"
+
+// --------------------------------------------------------------------------------- FUbermundoQuantizedState
+FUbermundoQuantizedState FUbermundoQuantizedState::Quantize(const FUbermundoPlayer3DState& s) {
+	FUbermundoQuantizedState q;
+	q.Loc[0] = FMath::RoundToInt(s.Location.X);
+	q.Loc[1] = FMath::RoundToInt(s.Location.Y);
+	q.Loc[2] = FMath::RoundToInt(s.Location.Z);
+	q.Rot[0] = FRotator::CompressAxisToShort(s.Rotation.Pitch);
+	q.Rot[1] = FRotator::CompressAxisToShort(s.Rotation.Yaw);
+	q.Rot[2] = FRotator::CompressAxisToShort(s.Rotation.Roll);
+	q.Vel[0] = (int16)FMath::Clamp(FMath::RoundToInt(s.Velocity.X), -32767, 32767);
+	q.Vel[1] = (int16)FMath::Clamp(FMath::RoundToInt(s.Velocity.Y), -32767, 32767);
+	q.Vel[2] = (int16)FMath::Clamp(FMath::RoundToInt(s.Velocity.Z), -32767, 32767);
+	q.Time = s.TimestampMs;
+	return q;
+}
+
+FUbermundoPlayer3DState FUbermundoQuantizedState::Dequantize() const {
+	FUbermundoPlayer3DState s;
+	s.Location = FVector((float)Loc[0], (float)Loc[1], (float)Loc[2]);
+	s.Rotation = FRotator(
+		FRotator::NormalizeAxis(FRotator::DecompressAxisFromShort(Rot[0])),
+		FRotator::NormalizeAxis(FRotator::DecompressAxisFromShort(Rot[1])),
+		FRotator::NormalizeAxis(FRotator::DecompressAxisFromShort(Rot[2])));
+	s.Velocity = FVector((float)Vel[0], (float)Vel[1], (float)Vel[2]);
+	s.TimestampMs = Time;
+	return s;
+}
+
+// --------------------------------------------------------------------------------- Bit I/O
+void FUbermundoBitWriter::WriteBits(uint32 v, int32 n) {
+	uint64 mask = (n >= 32) ? 0xFFFFFFFFull : ((1ull << n) - 1);
+	acc = (acc << n) | (v & mask);
+	numBits += n;
+	while (numBits >= 8) {
+		out.Add((uint8)(acc >> (numBits - 8)));
+		numBits -= 8;
+	}
+	acc &= (1ull << numBits) - 1;
+}
+
+void FUbermundoBitWriter::Finish() {
+	if (numBits > 0) {
+		out.Add((uint8)(acc << (8 - numBits)));
+		acc = 0;
+		numBits = 0;
+	}
+}
+
+uint32 FUbermundoBitReader::ReadBits(int32 n) {
+	uint32 v = 0;
+	for (int32 i = 0; i < n; i++) {
+		int32 byteIdx = bitPos >> 3;
+		uint32 bit = 0;
+		if (byteIdx < numBytes)
+			bit = (data[byteIdx] >> (7 - (bitPos & 7))) & 1;
+		else
+			overrun = true;
+		v = (v << 1) | bit;
+		bitPos++;
+	}
+	return v;
+}
+
+// --------------------------------------------------------------------------------- Field coding
+// One bit "changed", then a 2 bit size class and the zigzag encoded delta in 6, 12, 20 or 32 bits.
+static const int32 FieldClassBits[4] = { 6, 12, 20, 32 };
+
+static void WriteField(FUbermundoBitWriter& w, int32 delta) {
+	if (delta == 0) {
+		w.WriteBit(false);
+		return;
+	}
+	w.WriteBit(true);
+	uint32 z = ((uint32)delta << 1) ^ (uint32)(delta >> 31);
+	int32 cls = z < (1u << 6) ? 0 : z < (1u << 12) ? 1 : z < (1u << 20) ? 2 : 3;
+	w.WriteBits((uint32)cls, 2);
+	w.WriteBits(z, FieldClassBits[cls]);
+}
+
+static int32 ReadField(FUbermundoBitReader& r) {
+	if (!r.ReadBit())
+		return 0;
+	int32 cls = (int32)r.ReadBits(2);
+	uint32 z = r.ReadBits(FieldClassBits[cls]);
+	return (int32)((z >> 1) ^ (0u - (z & 1)));
+}
+
+void FUbermundoSnapshotCodec::EncodeDelta(FUbermundoBitWriter& w, const FUbermundoQuantizedState& s, const FUbermundoQuantizedState& base) {
+	// Differences wrap, so 32 bit fields subtract as uint32 and 16 bit ones as int16.
+	for (int32 i = 0; i < 3; i++)
+		WriteField(w, (int32)((uint32)s.Loc[i] - (uint32)base.Loc[i]));
+	for (int32 i = 0; i < 3; i++)
+		WriteField(w, (int16)(s.Rot[i] - base.Rot[i]));
+	for (int32 i = 0; i < 3; i++)
+		WriteField(w, (int16)(s.Vel[i] - base.Vel[i]));
+	WriteField(w, (int32)((uint32)s.Time - (uint32)base.Time));
+}
+
+void FUbermundoSnapshotCodec::DecodeDelta(FUbermundoBitReader& r, FUbermundoQuantizedState& s, const FUbermundoQuantizedState& base) {
+	for (int32 i = 0; i < 3; i++)
+		s.Loc[i] = (int32)((uint32)base.Loc[i] + (uint32)ReadField(r));
+	for (int32 i = 0; i < 3; i++)
+		s.Rot[i] = (uint16)(base.Rot[i] + ReadField(r));
+	for (int32 i = 0; i < 3; i++)
+		s.Vel[i] = (int16)(base.Vel[i] + ReadField(r));
+	s.Time = (int32)((uint32)base.Time + (uint32)ReadField(r));
+}
+
+void FUbermundoSnapshotCodec::WriteSnapshotPacket(TArray<uint8>& out, uint16 seq, uint8 baseOffset, const FUbermundoQuantizedState& s, const FUbermundoQuantizedState& base) {
+	out.Add((uint8)UBERMUNDOPC_P2P_Player3DState);
+	out.Add((uint8)(seq >> 8));
+	out.Add((uint8)(seq & 0xFF));
+	out.Add(baseOffset);
+	FUbermundoBitWriter w(out);
+	EncodeDelta(w, s, base);
+	w.Finish();
+}
+
+// --------------------------------------------------------------------------------- FUbermundoSnapshotCodec
+FUbermundoSnapshotCodec& FUbermundoSnapshotCodec::Get() {
+	static FUbermundoSnapshotCodec codec;
+	return codec;
+}
+
+void FUbermundoSnapshotCodec::BeginSnapshot(const FUbermundoPlayer3DState& state) {
+	current = FUbermundoQuantizedState::Quantize(state);
+}
+
+const FUbermundoPacketRef& FUbermundoSnapshotCodec::GetPacketFor(uint64 peer) {
+	FLocalSender& l = locals.FindOrAdd(peer);
+	uint16 seq = l.nextSeq++;
+	FHistoryEntry& h = l.history[seq % UBERMUNDO_SNAPSHOT_HISTORY];
+	h.seq = seq;
+	h.valid = true;
+	h.state = current;
+	h.sentAt = FPlatformTime::Seconds();
+
+	uint8 baseOffset = 0;
+	if (l.anyAcked) {
+		uint16 d = seq - l.acked;
+		const FHistoryEntry& b = l.history[l.acked % UBERMUNDO_SNAPSHOT_HISTORY];
+		if (d > 0 && d < UBERMUNDO_SNAPSHOT_HISTORY && b.valid && b.seq == l.acked)
+			baseOffset = (uint8)d;
+	}
+
+	static const FUbermundoQuantizedState zero;
+	const FUbermundoQuantizedState& base = baseOffset == 0 ? zero : l.history[l.acked % UBERMUNDO_SNAPSHOT_HISTORY].state;
+	packet = FUbermundoPacketBufferPool::Get().Acquire(64);
+	WriteSnapshotPacket(packet.GetMutableBytes(), seq, baseOffset, current, base);
+	return packet;
+}
+
+void FUbermundoSnapshotCodec::OnAck(uint64 peer, uint16 seq) {
+	// Ignore acks for things not sent yet, and ones older than what we already have.
+	FLocalSender* l = locals.Find(peer);
+	if (l == nullptr || (int16)(seq - (uint16)(l->nextSeq - 1)) > 0)
+		return;
+	if (!l->anyAcked || (int16)(seq - l->acked) > 0) {
+		l->acked = seq;
+		l->anyAcked = true;
+	}
+}
+
+bool FUbermundoSnapshotCodec::GetSendTime(uint64 peer, uint16 seq, double& sentAt) const {
+	const FLocalSender* l = locals.Find(peer);
+	if (l == nullptr)
+		return false;
+	const FHistoryEntry& h = l->history[seq % UBERMUNDO_SNAPSHOT_HISTORY];
+	if (!h.valid || h.seq != seq)
+		return false;
+	sentAt = h.sentAt;
+	return true;
+}
+
+bool FUbermundoSnapshotCodec::Decode(uint64 sender, const uint8* data, int32 numBytes, FUbermundoPlayer3DState& out, uint16& seq) {
+	if (numBytes < 4 || data[0] != UBERMUNDOPC_P2P_Player3DState)
+		return false;
+	seq = (uint16)((data[1] << 8) | data[2]);
+	uint8 baseOffset = data[3];
+
+	FRemoteSender& r = remotes.FindOrAdd(sender);
+	if (r.any && (int16)(seq - r.newestSeq) <= 0)
+		return false; // Duplicate or arrived after a newer one.
+
+	FUbermundoQuantizedState base;
+	if (baseOffset != 0) {
+		uint16 baseSeq = seq - baseOffset;
+		const FHistoryEntry& h = r.history[baseSeq % UBERMUNDO_SNAPSHOT_HISTORY];
+		if (!h.valid || h.seq != baseSeq)
+			return false; // Never got the baseline. Next one will be against something we acked.
+		base = h.state;
+	}
+
+	FUbermundoQuantizedState q;
+	FUbermundoBitReader br(data + 4, numBytes - 4);
+	DecodeDelta(br, q, base);
+	if (br.IsOverrun())
+		return false;
+
+	FHistoryEntry& h = r.history[seq % UBERMUNDO_SNAPSHOT_HISTORY];
+	h.seq = seq;
+	h.valid = true;
+	h.state = q;
+	r.newestSeq = seq;
+	r.any = true;
+	out = q.Dequantize();
+	return true;
+}
+
+void FUbermundoSnapshotCodec::QueueAck(uint64 sender, uint16 seq) {
+	uint8 ack[3] = { (uint8)UBERMUNDOPC_P2P_Player3DStateAck, (uint8)(seq >> 8), (uint8)(seq & 0xFF) };
+	FUbermundoP2POutbox::Get().Queue(sender, ack, 3, EUbermundoP2PSendMode::UnreliableNoDelay);
+}
+
+void FUbermundoSnapshotCodec::ForgetPeer(uint64 peer) {
+	locals.Remove(peer);
+	remotes.Remove(peer);
+}
+
+// --------------------------------------------------------------------------------- UUbermundoSnapshotLibrary
+void UUbermundoSnapshotLibrary::SendPlayer3DState(const TArray<int64>& peers, const FUbermundoPlayer3DState& state) {
+	FUbermundoSnapshotCodec& codec = FUbermundoSnapshotCodec::Get();
+	codec.BeginSnapshot(state);
+	for (int64 peer : peers) {
+		const FUbermundoPacketRef& p = codec.GetPacketFor((uint64)peer);
+		FUbermundoP2POutbox::Get().Queue((uint64)peer, p.View(), EUbermundoP2PSendMode::UnreliableNoDelay);
+	}
+}
+
+bool UUbermundoSnapshotLibrary::DecodePlayer3DState(int64 sender, const TArray<uint8>& bytes, FUbermundoPlayer3DState& state) {
+	uint16 seq;
+	if (!FUbermundoSnapshotCodec::Get().Decode((uint64)sender, bytes.GetData(), bytes.Num(), state, seq))
+		return false;
+	FUbermundoSnapshotCodec::QueueAck((uint64)sender, seq);
+	FUbermundoJitterBuffer::Get().Push((uint64)sender, state, FPlatformTime::Seconds());
+	return true;
+}
@@ -0,0 +1,368 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+
+#include "UbermundoSteamSocketsTransport.h"
+#include "SteamCustomCode.h"
+
+#include "steam/steam_api.h"
+#include "steam/isteamnetworkingsockets.h"
+#include "steam/isteamnetworkingutils.h"
+
+/** Send rate for CreateLocalPair connections, so a benchmark measures our code and not Steam's rate limiter. */
+#define UBERMUNDO_SOCKETS_LOCAL_RATE (64 * 1024 * 1024)
+
+// --------------------------------------------------------------------------------- FUbermundoSteamSocketsHooks
+class FUbermundoSteamSocketsHooks {
+public:
+	FUbermundoSteamSocketsHooks(FUbermundoSteamSocketsTransport* owner)
+		: owner(owner),
+		m_CallbackConnectionStatus(this, &FUbermundoSteamSocketsHooks::OnConnectionStatus) {
+	}
+
+private:
+	FUbermundoSteamSocketsTransport* owner;
+
+public:
+	STEAM_CALLBACK(FUbermundoSteamSocketsHooks, OnConnectionStatus, SteamNetConnectionStatusChangedCallback_t, m_CallbackConnectionStatus);
+};
+
+void FUbermundoSteamSocketsHooks::OnConnectionStatus(SteamNetConnectionStatusChangedCallback_t* status) {
+	owner->OnConnectionStatus(status->m_hConn, status->m_info.m_hListenSocket, (int32)status->m_info.m_eState,
+		status->m_info.m_identityRemote.GetSteamID64());
+}
+
+// --------------------------------------------------------------------------------- FUbermundoSteamSocketsTransport
+static int ToSendFlags(EUbermundoP2PSendMode mode) {
+	// We already gather a whole tick into one SendMessages, Nagle on top of that would only add latency.
+	switch (mode) {
+	case EUbermundoP2PSendMode::UnreliableNoDelay:
+		return k_nSteamNetworkingSend_UnreliableNoDelay;
+	case EUbermundoP2PSendMode::Unreliable:
+	case EUbermundoP2PSendMode::UnreliableBulk:
+		return k_nSteamNetworkingSend_UnreliableNoNagle;
+	case EUbermundoP2PSendMode::Reliable:
+		return k_nSteamNetworkingSend_ReliableNoNagle;
+	default:
+		return k_nSteamNetworkingSend_Reliable;
+	}
+}
+
+EUbermundoNetLane FUbermundoSteamSocketsTransport::LaneFor(EUbermundoP2PSendMode mode) {
+	switch (mode) {
+	case EUbermundoP2PSendMode::UnreliableNoDelay:
+	case EUbermundoP2PSendMode::Unreliable:
+		return EUbermundoNetLane::State;
+	case EUbermundoP2PSendMode::Reliable:
+		return EUbermundoNetLane::Events;
+	case EUbermundoP2PSendMode::ReliableWithBuffering:
+	case EUbermundoP2PSendMode::UnreliableBulk:
+	default:
+		return EUbermundoNetLane::Bulk;
+	}
+}
+
+FUbermundoSteamSocketsTransport::FUbermundoSteamSocketsTransport(bool listen)
+	: listening(listen), localId(0), pollGroup(k_HSteamNetPollGroup_Invalid), numReceived(0), nextReceived(0),
+	numSendCalls(0), numMessagesSent(0) {
+	for (int32 lane = 0; lane < (int32)EUbermundoNetLane::Num; lane++)
+		listenSockets[lane] = k_HSteamListenSocket_Invalid;
+	outgoing.Reserve(256);
+	sendResults.Reserve(256);
+
+	if (!SteamAPI_IsSteamRunning() || SteamNetworkingSockets() == nullptr) {
+		UE_LOG(UberMundoSteamLog, Warning, TEXT("SteamSockets transport needs Steam running"));
+		return;
+	}
+	ISteamNetworkingSockets* sockets = SteamNetworkingSockets();
+	if (listen)
+		SteamNetworkingUtils()->InitRelayNetworkAccess();
+	pollGroup = sockets->CreatePollGroup();
+	if (listen) {
+		for (int32 lane = 0; lane < (int32)EUbermundoNetLane::Num; lane++) {
+			listenSockets[lane] = sockets->CreateListenSocketP2P(UBERMUNDO_SOCKETS_VIRTUAL_PORT + lane, 0, nullptr);
+			if (listenSockets[lane] == k_HSteamListenSocket_Invalid)
+				UE_LOG(UberMundoSteamLog, Error, TEXT("SteamSockets could not listen on virtual port %d"), UBERMUNDO_SOCKETS_VIRTUAL_PORT + lane);
+		}
+	}
+	hooks = MakeUnique<FUbermundoSteamSocketsHooks>(this);
+}
+
+FUbermundoSteamSocketsTransport::~FUbermundoSteamSocketsTransport() {
+	hooks.Reset();
+	ReleaseReceived();
+	for (SteamNetworkingMessage_t* msg : outgoing)
+		msg->Release();
+	outgoing.Reset();
+
+	if (!SteamAPI_IsSteamRunning() || SteamNetworkingSockets() == nullptr)
+		return;
+	ISteamNetworkingSockets* sockets = SteamNetworkingSockets();
+	for (const TPair<uint32, uint64>& kv : connPeers)
+		sockets->CloseConnection(kv.Key, 0, "Transport closed", false);
+	for (int32 lane = 0; lane < (int32)EUbermundoNetLane::Num; lane++) {
+		if (listenSockets[lane] != k_HSteamListenSocket_Invalid)
+			sockets->CloseListenSocket(listenSockets[lane]);
+	}
+	if (pollGroup != k_HSteamNetPollGroup_Invalid)
+		sockets->DestroyPollGroup(pollGroup);
+}
+
+bool FUbermundoSteamSocketsTransport::CreateLocalPair(uint64 idA, uint64 idB, TUniquePtr<FUbermundoSteamSocketsTransport>& outA, TUniquePtr<FUbermundoSteamSocketsTransport>& outB) {
+	if (!SteamAPI_IsSteamRunning() || SteamNetworkingSockets() == nullptr)
+		return false;
+	outA = MakeUnique<FUbermundoSteamSocketsTransport>(false);
+	outB = MakeUnique<FUbermundoSteamSocketsTransport>(false);
+	outA->localId = idA;
+	outB->localId = idB;
+	for (int32 lane = 0; lane < (int32)EUbermundoNetLane::Num; lane++) {
+		HSteamNetConnection a, b;
+		if (!SteamNetworkingSockets()->CreateSocketPair(&a, &b, true, nullptr, nullptr)) {
+			UE_LOG(UberMundoSteamLog, Error, TEXT("SteamSockets CreateSocketPair failed"));
+			return false;
+		}
+		for (HSteamNetConnection c : { a, b }) {
+			SteamNetworkingUtils()->SetConnectionConfigValueInt32(c, k_ESteamNetworkingConfig_SendRateMin, UBERMUNDO_SOCKETS_LOCAL_RATE);
+			SteamNetworkingUtils()->SetConnectionConfigValueInt32(c, k_ESteamNetworkingConfig_SendRateMax, UBERMUNDO_SOCKETS_LOCAL_RATE);
+		}
+		outA->AddConnection(idB, (EUbermundoNetLane)lane, a);
+		outB->AddConnection(idA, (EUbermundoNetLane)lane, b);
+	}
+	return true;
+}
+
+bool FUbermundoSteamSocketsTransport::IsAvailable() const {
+	return pollGroup != k_HSteamNetPollGroup_Invalid && SteamAPI_IsSteamRunning() && SteamNetworkingSockets() != nullptr;
+}
+
+uint64 FUbermundoSteamSocketsTransport::GetLocalId() const {
+	if (localId != 0)
+		return localId;
+	if (!SteamAPI_IsSteamRunning() || SteamUser() == nullptr)
+		return 0;
+	return SteamUser()->GetSteamID().ConvertToUint64();
+}
+
+void FUbermundoSteamSocketsTransport::AddConnection(uint64 peer, EUbermundoNetLane lane, uint32 conn) {
+	ISteamNetworkingSockets* sockets = SteamNetworkingSockets();
+	sockets->SetConnectionPollGroup(conn, pollGroup);
+	// Received messages carry this, so the sender is known even on a socket pair with no Steam identity.
+	sockets->SetConnectionUserData(conn, (int64)peer);
+	connPeers.Add(conn, peer);
+	// Both ends may have connected at once. Receive on both, send on whichever came first.
+	uint32& laneConn = peers.FindOrAdd(peer).conn[(int32)lane];
+	if (laneConn == k_HSteamNetConnection_Invalid)
+		laneConn = conn;
+}
+
+uint32 FUbermundoSteamSocketsTransport::ConnectionFor(uint64 peer, EUbermundoNetLane lane) {
+	if (FPeerLanes* p = peers.Find(peer)) {
+		if (p->conn[(int32)lane] != k_HSteamNetConnection_Invalid)
+			return p->conn[(int32)lane];
+	}
+	if (!listening)
+		return k_HSteamNetConnection_Invalid;
+
+	SteamNetworkingIdentity identity;
+	identity.SetSteamID64(peer);
+	HSteamNetConnection conn = SteamNetworkingSockets()->ConnectP2P(identity, UBERMUNDO_SOCKETS_VIRTUAL_PORT + (int32)lane, 0, nullptr);
+	if (conn == k_HSteamNetConnection_Invalid) {
+		UE_LOG(UberMundoSteamLog, Warning, TEXT("SteamSockets ConnectP2P 0x%llX lane %d failed"), peer, (int32)lane);
+		return k_HSteamNetConnection_Invalid;
+	}
+	AddConnection(peer, lane, conn);
+	return conn;
+}
+
+void FUbermundoSteamSocketsTransport::OnConnectionStatus(uint32 conn, uint32 listenSocket, int32 state, uint64 remoteId) {
+	ISteamNetworkingSockets* sockets = SteamNetworkingSockets();
+	switch (state) {
+	case k_ESteamNetworkingConnectionState_Connecting:
+		// Only connections to one of our listen sockets need accepting. Ours to them show up here too.
+		for (int32 lane = 0; lane < (int32)EUbermundoNetLane::Num; lane++) {
+			if (listenSocket == k_HSteamListenSocket_Invalid || listenSocket != listenSockets[lane])
+				continue;
+			if (sockets->AcceptConnection(conn) != k_EResultOK) {
+				UE_LOG(UberMundoSteamLog, Warning, TEXT("SteamSockets could not accept 0x%llX lane %d"), remoteId, lane);
+				sockets->CloseConnection(conn, 0, nullptr, false);
+				return;
+			}
+			UE_LOG(UberMundoSteamLog, Log, TEXT("SteamSockets accepted 0x%llX lane %d"), remoteId, lane);
+			AddConnection(remoteId, (EUbermundoNetLane)lane, conn);
+			return;
+		}
+		break;
+	case k_ESteamNetworkingConnectionState_ClosedByPeer:
+	case k_ESteamNetworkingConnectionState_ProblemDetectedLocally: {
+		uint64* peer = connPeers.Find(conn);
+		if (peer == nullptr)
+			return;
+		UE_LOG(UberMundoSteamLog, Warning, TEXT("SteamSockets connection to 0x%llX lost, state %d"), *peer, state);
+		if (FPeerLanes* p = peers.Find(*peer)) {
+			for (uint32& c : p->conn) {
+				if (c == conn)
+					c = k_HSteamNetConnection_Invalid;
+			}
+		}
+		connPeers.Remove(conn);
+		sockets->CloseConnection(conn, 0, nullptr, false);
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+bool FUbermundoSteamSocketsTransport::Send(uint64 peer, const uint8* data, uint32 numBytes, EUbermundoP2PSendMode mode) {
+	if (!IsAvailable())
+		return false;
+	uint32 conn = ConnectionFor(peer, LaneFor(mode));
+	if (conn == k_HSteamNetConnection_Invalid)
+		return false;
+	SteamNetworkingMessage_t* msg = SteamNetworkingUtils()->AllocateMessage((int)numBytes);
+	FMemory::Memcpy(msg->m_pData, data, numBytes);
+	msg->m_conn = conn;
+	msg->m_nFlags = ToSendFlags(mode);
+	outgoing.Add(msg);
+	return true;
+}
+
+/** m_pfnFreeData of SendToMany's messages. Steam may call it from its own thread, the pool doesn't mind. */
+static void ReleaseSharedPacket(SteamNetworkingMessage_t* msg) {
+	delete reinterpret_cast<FUbermundoPacketRef*>(msg->m_nUserData);
+}
+
+int32 FUbermundoSteamSocketsTransport::SendToMany(TArrayView<const uint64> peers, const FUbermundoPacketRef& packet, EUbermundoP2PSendMode mode, TArray<bool, TInlineAllocator<64>>& sent) {
+	sent.SetNumZeroed(peers.Num(), false);
+	if (!IsAvailable())
+		return 0;
+	int32 n = 0;
+	for (int32 i = 0; i < peers.Num(); i++) {
+		uint32 conn = ConnectionFor(peers[i], LaneFor(mode));
+		if (conn == k_HSteamNetConnection_Invalid)
+			continue;
+		// No buffer of its own, the message borrows the shared one and lets go of its handle when freed.
+		SteamNetworkingMessage_t* msg = SteamNetworkingUtils()->AllocateMessage(0);
+		msg->m_pData = const_cast<uint8*>(packet.GetData());
+		msg->m_cbSize = packet.Num();
+		msg->m_nUserData = reinterpret_cast<int64>(new FUbermundoPacketRef(packet));
+		msg->m_pfnFreeData = &ReleaseSharedPacket;
+		msg->m_conn = conn;
+		msg->m_nFlags = ToSendFlags(mode);
+		outgoing.Add(msg);
+		sent[i] = true;
+		n++;
+	}
+	return n;
+}
+
+int32 FUbermundoSteamSocketsTransport::FlushSends() {
+	int32 n = outgoing.Num();
+	if (n == 0)
+		return 0;
+	if (!IsAvailable()) {
+		for (SteamNetworkingMessage_t* msg : outgoing)
+			msg->Release();
+		outgoing.Reset();
+		return 0;
+	}
+
+	// Steam takes ownership of the messages, sent or not.
+	sendResults.SetNumUninitialized(n, false);
+	SteamNetworkingSockets()->SendMessages(n, outgoing.GetData(), sendResults.GetData());
+	outgoing.Reset();
+	numSendCalls++;
+	numMessagesSent += n;
+
+	int32 failed = 0;
+	for (int64 r : sendResults) {
+		if (r < 0)
+			failed++;
+	}
+	if (failed > 0)
+		UE_LOG(UberMundoSteamLog, Verbose, TEXT("SteamSockets FlushSends %d of %d not sent"), failed, n);
+	return n - failed;
+}
+
+void FUbermundoSteamSocketsTransport::ReleaseReceived() {
+	for (int32 i = nextReceived; i < numReceived; i++)
+		received[i]->Release();
+	numReceived = 0;
+	nextReceived = 0;
+}
+
+bool FUbermundoSteamSocketsTransport::IsPacketAvailable(uint32& numBytes) {
+	numBytes = 0;
+	if (nextReceived >= numReceived) {
+		numReceived = 0;
+		nextReceived = 0;
+		if (!IsAvailable())
+			return false;
+		numReceived = FMath::Max(0, SteamNetworkingSockets()->ReceiveMessagesOnPollGroup(pollGroup, received, ReceiveBatch));
+		if (numReceived == 0)
+			return false;
+	}
+	numBytes = received[nextReceived]->GetSize();
+	return true;
+}
+
+bool FUbermundoSteamSocketsTransport::Read(uint8* dest, uint32 destSize, uint32& numBytes, uint64& sender) {
+	numBytes = 0;
+	sender = 0;
+	uint32 size;
+	if (!IsPacketAvailable(size))
+		return false;
+	SteamNetworkingMessage_t* msg = received[nextReceived++];
+	numBytes = FMath::Min(destSize, size);
+	FMemory::Memcpy(dest, msg->m_pData, numBytes);
+	sender = msg->m_nConnUserData != 0 ? (uint64)msg->m_nConnUserData : msg->m_identityPeer.GetSteamID64();
+	msg->Release();
+	return true;
+}
+
+bool FUbermundoSteamSocketsTransport::Close(uint64 peer) {
+	if (!IsAvailable())
+		return false;
+	// Let anything already queued for them go out first, linger delivers it.
+	FlushSends();
+	ISteamNetworkingSockets* sockets = SteamNetworkingSockets();
+	for (auto it = connPeers.CreateIterator(); it; ++it) {
+		if (it.Value() == peer) {
+			sockets->CloseConnection(it.Key(), 0, "Closed", true);
+			it.RemoveCurrent();
+		}
+	}
+	return peers.Remove(peer) > 0;
+}
+
+int32 FUbermundoSteamSocketsTransport::GetPingMs(uint64 peer) const {
+	const FPeerLanes* p = peers.Find(peer);
+	if (p == nullptr || p->conn[(int32)EUbermundoNetLane::State] == k_HSteamNetConnection_Invalid || !IsAvailable())
+		return -1;
+	SteamNetworkingQuickConnectionStatus status;
+	if (!SteamNetworkingSockets()->GetQuickConnectionStatus(p->conn[(int32)EUbermundoNetLane::State], &status))
+		return -1;
+	return status.m_nPing;
+}
+
+bool FUbermundoSteamSocketsTransport::GetPeerStatus(uint64 peer, FUbermundoTransportPeerStatus& out) const {
+	const FPeerLanes* p = peers.Find(peer);
+	if (p == nullptr || !IsAvailable())
+		return false;
+	bool any = false;
+	for (int32 lane = 0; lane < (int32)EUbermundoNetLane::Num; lane++) {
+		SteamNetworkingQuickConnectionStatus status;
+		if (p->conn[lane] == k_HSteamNetConnection_Invalid || !SteamNetworkingSockets()->GetQuickConnectionStatus(p->conn[lane], &status))
+			continue;
+		if (!any) {
+			out.queuedBytes = 0;
+			any = true;
+		}
+		out.queuedBytes += status.m_cbPendingUnreliable + status.m_cbPendingReliable;
+		if (lane == (int32)EUbermundoNetLane::State) {
+			out.pingMs = status.m_nPing;
+			if (status.m_flConnectionQualityLocal >= 0.0f)
+				out.deliveredFraction = status.m_flConnectionQualityLocal;
+		}
+	}
+	return any;
+}
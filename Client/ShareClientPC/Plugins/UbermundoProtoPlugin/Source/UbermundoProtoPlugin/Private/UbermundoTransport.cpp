@@ -0,0 +1,236 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+
+#include "UbermundoTransport.h"
+#include "SteamCustomCode.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "IPAddress.h"
+#include "Common/UdpSocketBuilder.h"
+
+#include "steam/steam_api.h"
+
+// --------------------------------------------------------------------------------- FUbermundoSteamTransport
+static EP2PSend ToEP2PSend(EUbermundoP2PSendMode mode) {
+	switch (mode) {
+	case EUbermundoP2PSendMode::UnreliableNoDelay:
+		return EP2PSend::k_EP2PSendUnreliableNoDelay;
+	case EUbermundoP2PSendMode::Unreliable:
+	case EUbermundoP2PSendMode::UnreliableBulk:
+		return EP2PSend::k_EP2PSendUnreliable;
+	case EUbermundoP2PSendMode::Reliable:
+		return EP2PSend::k_EP2PSendReliable;
+	default:
+		return EP2PSend::k_EP2PSendReliableWithBuffering;
+	}
+}
+
+bool FUbermundoSteamTransport::IsAvailable() const {
+	return SteamAPI_IsSteamRunning() && SteamNetworking() != nullptr;
+}
+
+uint64 FUbermundoSteamTransport::GetLocalId() const {
+	if (!SteamAPI_IsSteamRunning() || SteamUser() == nullptr)
+		return 0;
+	return SteamUser()->GetSteamID().ConvertToUint64();
+}
+
+bool FUbermundoSteamTransport::Send(uint64 peer, const uint8* data, uint32 numBytes, EUbermundoP2PSendMode mode) {
+	if (!IsAvailable())
+		return false;
+	return SteamNetworking()->SendP2PPacket(CSteamID(peer), data, numBytes, ToEP2PSend(mode));
+}
+
+bool FUbermundoSteamTransport::IsPacketAvailable(uint32& numBytes) {
+	numBytes = 0;
+	if (!IsAvailable())
+		return false;
+	return SteamNetworking()->IsP2PPacketAvailable(&numBytes);
+}
+
+bool FUbermundoSteamTransport::Read(uint8* dest, uint32 destSize, uint32& numBytes, uint64& sender) {
+	numBytes = 0;
+	sender = 0;
+	if (!IsAvailable())
+		return false;
+	CSteamID stm;
+	if (!SteamNetworking()->ReadP2PPacket(dest, destSize, &numBytes, &stm))
+		return false;
+	sender = stm.ConvertToUint64();
+	return true;
+}
+
+bool FUbermundoSteamTransport::Close(uint64 peer) {
+	if (!IsAvailable())
+		return false;
+	return SteamNetworking()->CloseP2PSessionWithUser(CSteamID(peer));
+}
+
+bool FUbermundoSteamTransport::GetPeerStatus(uint64 peer, FUbermundoTransportPeerStatus& out) const {
+	P2PSessionState_t state;
+	if (!IsAvailable() || !SteamNetworking()->GetP2PSessionState(CSteamID(peer), &state))
+		return false;
+	out.queuedBytes = state.m_nBytesQueuedForSend;
+	out.queuedPackets = state.m_nPacketsQueuedForSend;
+	return true;
+}
+
+// --------------------------------------------------------------------------------- FUbermundoLoopbackTransport
+FUbermundoLoopbackTransport::FUbermundoLoopbackTransport(int32 localPort, uint64 localId)
+	: socket(nullptr), localId(localId != 0 ? localId : (uint64)localPort), rng(localPort), nextOrder(0),
+	hasStaged(false), stagedBytes(0), stagedSender(0) {
+	socket = FUdpSocketBuilder(TEXT("UbermundoLoopback"))
+		.AsNonBlocking()
+		.AsReusable()
+		.BoundToAddress(FIPv4Address(127, 0, 0, 1))
+		.BoundToPort(localPort)
+		.WithReceiveBufferSize(2 * 1024 * 1024)
+		.WithSendBufferSize(2 * 1024 * 1024)
+		.Build();
+	if (socket == nullptr)
+		UE_LOG(UberMundoSteamLog, Error, TEXT("Loopback transport could not bind 127.0.0.1:%d"), localPort);
+	else
+		UE_LOG(UberMundoSteamLog, Display, TEXT("Loopback transport on 127.0.0.1:%d, local id 0x%llX"), localPort, this->localId);
+
+	recvAddr = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->CreateInternetAddr();
+	sendBuffer.Reserve(MaxPacket + 8);
+	staging.SetNumUninitialized(MaxPacket + 8);
+	delayed.Reserve(1024);
+}
+
+FUbermundoLoopbackTransport::~FUbermundoLoopbackTransport() {
+	if (socket != nullptr) {
+		socket->Close();
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(socket);
+		socket = nullptr;
+	}
+}
+
+bool FUbermundoLoopbackTransport::AddPeer(uint64 peer, const FString& address, int32 port) {
+	TSharedRef<FInternetAddr> a = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->CreateInternetAddr();
+	bool valid = false;
+	a->SetIp(*address, valid);
+	a->SetPort(port);
+	if (!valid)
+		UE_LOG(UberMundoSteamLog, Warning, TEXT("Loopback AddPeer 0x%llX bad address %s"), peer, *address);
+	peerAddresses.Add(peer, a);
+	return valid;
+}
+
+TSharedRef<FInternetAddr> FUbermundoLoopbackTransport::AddressFor(uint64 peer) {
+	if (TSharedRef<FInternetAddr>* a = peerAddresses.Find(peer))
+		return *a;
+	AddPeer(peer, TEXT("127.0.0.1"), (int32)(peer & 0xFFFF));
+	return peerAddresses[peer];
+}
+
+bool FUbermundoLoopbackTransport::SendNow(uint64 peer, const uint8* data, uint32 numBytes) {
+	if (socket == nullptr)
+		return false;
+	sendBuffer.Reset();
+	for (int32 shift = 56; shift >= 0; shift -= 8)
+		sendBuffer.Add((uint8)(localId >> shift));
+	sendBuffer.Append(data, (int32)numBytes);
+	int32 sent = 0;
+	return socket->SendTo(sendBuffer.GetData(), sendBuffer.Num(), sent, *AddressFor(peer)) && sent == sendBuffer.Num();
+}
+
+bool FUbermundoLoopbackTransport::Send(uint64 peer, const uint8* data, uint32 numBytes, EUbermundoP2PSendMode mode) {
+	if (socket == nullptr)
+		return false;
+	if (numBytes > MaxPacket) {
+		UE_LOG(UberMundoSteamLog, Warning, TEXT("Loopback Send N=%u is bigger than a UDP datagram"), numBytes);
+		return false;
+	}
+
+	bool reliable = mode == EUbermundoP2PSendMode::Reliable || mode == EUbermundoP2PSendMode::ReliableWithBuffering;
+	const FUbermundoNetConditions& c = conditions;
+	if (c.LatencyMs <= 0.0f && c.JitterMs <= 0.0f && c.LossPercent <= 0.0f && c.ReorderPercent <= 0.0f && delayed.Num() == 0)
+		return SendNow(peer, data, numBytes);
+
+	if (!reliable && rng.FRand() * 100.0f < c.LossPercent)
+		return true; // Lost on the wire, as far as the sender can tell it went.
+
+	double delay = (c.LatencyMs + rng.FRand() * c.JitterMs) / 1000.0;
+	if (!reliable && rng.FRand() * 100.0f < c.ReorderPercent)
+		delay += (c.LatencyMs + c.JitterMs) / 1000.0;
+	double sendAt = FPlatformTime::Seconds() + delay;
+	if (reliable) {
+		double& last = lastReliableSendAt.FindOrAdd(peer, 0.0);
+		sendAt = FMath::Max(sendAt, last);
+		last = sendAt;
+	}
+
+	FDelayed d;
+	d.sendAt = sendAt;
+	d.order = nextOrder++;
+	d.peer = peer;
+	d.packet = FUbermundoPacketBufferPool::Get().Acquire((int32)numBytes);
+	d.packet.GetMutableBytes().Append(data, (int32)numBytes);
+	delayed.HeapPush(MoveTemp(d));
+	return true;
+}
+
+void FUbermundoLoopbackTransport::Tick(double now) {
+	while (delayed.Num() > 0 && delayed.HeapTop().sendAt <= now) {
+		FDelayed d;
+		delayed.HeapPop(d, false);
+		SendNow(d.peer, d.packet.GetData(), (uint32)d.packet.Num());
+	}
+}
+
+bool FUbermundoLoopbackTransport::GetPeerStatus(uint64 peer, FUbermundoTransportPeerStatus& out) const {
+	out.queuedBytes = 0;
+	out.queuedPackets = 0;
+	for (const FDelayed& d : delayed) {
+		if (d.peer == peer) {
+			out.queuedBytes += d.packet.Num();
+			out.queuedPackets++;
+		}
+	}
+	return true;
+}
+
+bool FUbermundoLoopbackTransport::Stage() {
+	if (hasStaged)
+		return true;
+	if (socket == nullptr)
+		return false;
+	int32 read = 0;
+	while (socket->RecvFrom(staging.GetData(), staging.Num(), read, *recvAddr)) {
+		if (read < 8)
+			continue; // Not one of ours.
+		stagedSender = 0;
+		for (int32 i = 0; i < 8; i++)
+			stagedSender = (stagedSender << 8) | staging[i];
+		stagedBytes = (uint32)(read - 8);
+		hasStaged = true;
+		return true;
+	}
+	return false;
+}
+
+bool FUbermundoLoopbackTransport::IsPacketAvailable(uint32& numBytes) {
+	numBytes = 0;
+	if (!Stage())
+		return false;
+	numBytes = stagedBytes;
+	return true;
+}
+
+bool FUbermundoLoopbackTransport::Read(uint8* dest, uint32 destSize, uint32& numBytes, uint64& sender) {
+	numBytes = 0;
+	sender = 0;
+	if (!Stage())
+		return false;
+	numBytes = FMath::Min(destSize, stagedBytes);
+	FMemory::Memcpy(dest, staging.GetData() + 8, numBytes);
+	sender = stagedSender;
+	hasStaged = false;
+	return true;
+}
+
+bool FUbermundoLoopbackTransport::Close(uint64 peer) {
+	lastReliableSendAt.Remove(peer);
+	return true;
+}
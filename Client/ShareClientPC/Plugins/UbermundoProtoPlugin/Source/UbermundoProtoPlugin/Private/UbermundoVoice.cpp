@@ -0,0 +1,462 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+
+#include "UbermundoVoice.h"
+#include "SteamCustomCode.h"
+#include "UbermundoPacketCodes.h"
+#include "UbermundoP2POutbox.h"
+#include "UbermundoRateControl.h"
+#include "UbermundoClockSync.h"
+#include "VoiceModule.h"
+#include "Sound/SoundWaveProcedural.h"
+#include "Async/Async.h"
+
+// --------------------------------------------------------------------------------- FUbermundoVoiceEncoder
+bool FUbermundoVoiceEncoder::Init() {
+	if (!encoder.IsValid())
+		encoder = FVoiceModule::Get().CreateVoiceEncoder(UBERMUNDO_VOICE_SAMPLE_RATE, 1, EAudioEncodeHint::VoiceEncode_Voice);
+	return encoder.IsValid();
+}
+
+void FUbermundoVoiceEncoder::SetBitrate(int32 bitsPerSecond) {
+	if (encoder.IsValid() && bitsPerSecond != bitrate) {
+		encoder->SetBitrate(bitsPerSecond);
+		bitrate = bitsPerSecond;
+	}
+}
+
+bool FUbermundoVoiceEncoder::Encode(const int16* frame, uint32 stamp, TArray<uint8>& packet) {
+	if (!encoder.IsValid())
+		return false;
+	uint8 opus[UBERMUNDO_VOICE_MAX_FRAME];
+	uint32 numBytes = sizeof(opus);
+	encoder->Encode(reinterpret_cast<const uint8*>(frame), UBERMUNDO_VOICE_FRAME_SAMPLES * sizeof(int16), opus, numBytes);
+	if (numBytes == 0)
+		return false;
+	WriteHeader(stamp, (int32)numBytes, packet);
+	packet.Append(opus, numBytes);
+	return true;
+}
+
+void FUbermundoVoiceEncoder::End(uint32 stamp, TArray<uint8>& packet) {
+	WriteHeader(stamp, 0, packet);
+}
+
+void FUbermundoVoiceEncoder::WriteHeader(uint32 stamp, int32 numBytes, TArray<uint8>& packet) {
+	packet.Reset(UBERMUNDO_VOICE_HEADER + numBytes);
+	packet.Add((uint8)UBERMUNDOPC_P2P_PlayerVoiceMsg);
+	packet.Add((uint8)(seq >> 8));
+	packet.Add((uint8)seq);
+	packet.Add((uint8)(stamp >> 24));
+	packet.Add((uint8)(stamp >> 16));
+	packet.Add((uint8)(stamp >> 8));
+	packet.Add((uint8)stamp);
+	seq++;
+}
+
+// --------------------------------------------------------------------------------- FUbermundoVoiceStream
+FUbermundoVoiceStream::FUbermundoVoiceStream(const FUbermundoVoiceSettings& settings) : settings(settings) {
+}
+
+bool FUbermundoVoiceStream::Init() {
+	decoder = FVoiceModule::Get().CreateVoiceDecoder(UBERMUNDO_VOICE_SAMPLE_RATE, 1);
+	return decoder.IsValid();
+}
+
+void FUbermundoVoiceStream::SetSettings(const FUbermundoVoiceSettings& s) {
+	FScopeLock scope(&lock);
+	settings = s;
+}
+
+int32 FUbermundoVoiceStream::TargetFrames() const {
+	float ms = FMath::Clamp(UBERMUNDO_VOICE_FRAME_MS + settings.JitterMultiplier * (float)(jitter * 1000.0), settings.MinDelayMs, settings.MaxDelayMs);
+	return FMath::Clamp(FMath::CeilToInt(ms / UBERMUNDO_VOICE_FRAME_MS), 1, UBERMUNDO_VOICE_MAX_BUFFERED - 1);
+}
+
+bool FUbermundoVoiceStream::OnPacket(const uint8* data, int32 numBytes, double now) {
+	if (numBytes < UBERMUNDO_VOICE_HEADER || numBytes - UBERMUNDO_VOICE_HEADER > UBERMUNDO_VOICE_MAX_FRAME || data[0] != UBERMUNDOPC_P2P_PlayerVoiceMsg)
+		return false;
+	uint16 seq = (uint16)((data[1] << 8) | data[2]);
+	if (numBytes == UBERMUNDO_VOICE_HEADER) {
+		// No audio: they stopped talking, the frame before this one was the last of the spurt.
+		FScopeLock scope(&lock);
+		ended = true;
+		endSeq = seq;
+		return true;
+	}
+	uint32 stamp = ((uint32)data[3] << 24) | ((uint32)data[4] << 16) | ((uint32)data[5] << 8) | data[6];
+	double capturedAt = FUbermundoClockSync::Get().SharedMsToLocal(stamp);
+
+	bool start;
+	{
+		FScopeLock scope(&lock);
+		// RFC 3550 interarrival jitter: how much the trip from their microphone to us varies frame to frame.
+		double transit = now - capturedAt;
+		if (haveTransit)
+			jitter += (FMath::Abs(transit - lastTransit) - jitter) / 16.0;
+		lastTransit = transit;
+		haveTransit = true;
+		stats.FramesReceived++;
+		stats.JitterMs = (float)(jitter * 1000.0);
+		stats.TargetDelayMs = (float)(TargetFrames() * UBERMUNDO_VOICE_FRAME_MS);
+
+		if (incoming.Num() >= UBERMUNDO_VOICE_MAX_BUFFERED) {
+			// The worker is that far behind, this would only be played late.
+			stats.FramesDropped++;
+			return true;
+		}
+		FIncoming& in = incoming.AddDefaulted_GetRef();
+		in.seq = seq;
+		in.capturedAt = capturedAt;
+		in.data.Append(data + UBERMUNDO_VOICE_HEADER, numBytes - UBERMUNDO_VOICE_HEADER);
+		start = !decoding;
+		decoding = true;
+	}
+	if (start) {
+		TSharedRef<FUbermundoVoiceStream, ESPMode::ThreadSafe> self = AsShared();
+		AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [self]() { DecodePending(self); });
+	}
+	return true;
+}
+
+void FUbermundoVoiceStream::DecodePending(TSharedRef<FUbermundoVoiceStream, ESPMode::ThreadSafe> self) {
+	FUbermundoVoiceStream& s = *self;
+	FIncoming in;
+	while (true) {
+		TArray<int16> pcm;
+		{
+			FScopeLock scope(&s.lock);
+			if (s.incoming.Num() == 0) {
+				s.decoding = false;
+				return;
+			}
+			in = MoveTemp(s.incoming[0]);
+			s.incoming.RemoveAt(0, 1, false);
+			pcm = s.TakeBuffer();
+		}
+		// Only this task touches the decoder, and frames reach it in the order they arrived.
+		pcm.SetNumUninitialized(UBERMUNDO_VOICE_FRAME_SAMPLES, false);
+		uint32 numBytes = UBERMUNDO_VOICE_FRAME_SAMPLES * sizeof(int16);
+		s.decoder->Decode(in.data.GetData(), (uint32)in.data.Num(), reinterpret_cast<uint8*>(pcm.GetData()), numBytes);
+		int32 numSamples = FMath::Min((int32)(numBytes / sizeof(int16)), UBERMUNDO_VOICE_FRAME_SAMPLES);
+		if (numSamples < UBERMUNDO_VOICE_FRAME_SAMPLES)
+			FMemory::Memzero(pcm.GetData() + numSamples, (UBERMUNDO_VOICE_FRAME_SAMPLES - numSamples) * sizeof(int16));
+
+		FScopeLock scope(&s.lock);
+		s.Insert(in.seq, in.capturedAt, MoveTemp(pcm));
+	}
+}
+
+TArray<int16> FUbermundoVoiceStream::TakeBuffer() {
+	if (pool.Num() > 0)
+		return pool.Pop(false);
+	TArray<int16> buffer;
+	buffer.Reserve(UBERMUNDO_VOICE_FRAME_SAMPLES);
+	return buffer;
+}
+
+void FUbermundoVoiceStream::ReleaseBuffer(TArray<int16>&& buffer) {
+	if (pool.Num() < UBERMUNDO_VOICE_MAX_BUFFERED)
+		pool.Add(MoveTemp(buffer));
+}
+
+void FUbermundoVoiceStream::Insert(uint16 seq, double capturedAt, TArray<int16>&& pcm) {
+	int16 ahead = (int16)(seq - playSeq);
+	if (playing && ahead < 0) {
+		stats.FramesLate++;
+		ReleaseBuffer(MoveTemp(pcm));
+		return;
+	}
+	if ((playing && ahead >= UBERMUNDO_VOICE_MAX_BUFFERED) || frames.Num() >= UBERMUNDO_VOICE_MAX_BUFFERED || frames.Contains(seq)) {
+		stats.FramesDropped++;
+		ReleaseBuffer(MoveTemp(pcm));
+		return;
+	}
+	FFrame& f = frames.Add(seq);
+	f.pcm = MoveTemp(pcm);
+	f.capturedAt = capturedAt;
+}
+
+TArrayView<const int16> FUbermundoVoiceStream::Pull(int32 numSamples) {
+	playout.Reset();
+	FScopeLock scope(&lock);
+	while (playout.Num() < numSamples)
+		PlayFrame(playout);
+	return playout;
+}
+
+void FUbermundoVoiceStream::PlayFrame(TArray<int16>& out) {
+	int32 at = out.AddZeroed(UBERMUNDO_VOICE_FRAME_SAMPLES);
+	int16* dest = out.GetData() + at;
+	int32 target = TargetFrames();
+	if (!playing) {
+		if (frames.Num() < target)
+			return;
+		// A talk spurt starts from its oldest frame in.
+		bool any = false;
+		for (const TPair<uint16, FFrame>& kv : frames) {
+			if (!any || (int16)(kv.Key - playSeq) < 0)
+				playSeq = kv.Key;
+			any = true;
+		}
+		if (ended && (int16)(endSeq - playSeq) <= 0)
+			ended = false; // The end of an earlier spurt.
+		playing = true;
+		numConcealed = 0;
+	}
+	else if (frames.Num() > target + 2) {
+		// More buffered than the jitter calls for, which is only latency. Skip a frame.
+		if (FFrame* f = frames.Find(playSeq)) {
+			ReleaseBuffer(MoveTemp(f->pcm));
+			frames.Remove(playSeq);
+		}
+		playSeq++;
+		stats.FramesDropped++;
+	}
+
+	if (FFrame* f = frames.Find(playSeq)) {
+		FMemory::Memcpy(dest, f->pcm.GetData(), UBERMUNDO_VOICE_FRAME_SAMPLES * sizeof(int16));
+		double latency = FPlatformTime::Seconds() - f->capturedAt;
+		latencyTotal += latency;
+		stats.FramesPlayed++;
+		stats.LatencyMs = (float)(latencyTotal * 1000.0 / stats.FramesPlayed);
+		stats.MaxLatencyMs = FMath::Max(stats.MaxLatencyMs, (float)(latency * 1000.0));
+		Swap(last, f->pcm);
+		ReleaseBuffer(MoveTemp(f->pcm));
+		frames.Remove(playSeq);
+		numConcealed = 0;
+	}
+	else if (ended && playSeq == endSeq) {
+		// They went quiet, this is silence rather than loss and there is nothing to conceal.
+		playing = false;
+		ended = false;
+		numConcealed = 0;
+		return;
+	}
+	else if (numConcealed < UBERMUNDO_VOICE_CONCEAL_FRAMES && last.Num() == UBERMUNDO_VOICE_FRAME_SAMPLES) {
+		// Say the last frame again, quieter each time, rather than leave a click and a hole.
+		numConcealed++;
+		float gain = 1.0f - (float)numConcealed / (UBERMUNDO_VOICE_CONCEAL_FRAMES + 1);
+		for (int32 i = 0; i < UBERMUNDO_VOICE_FRAME_SAMPLES; i++)
+			dest[i] = (int16)(last[i] * gain);
+		stats.FramesConcealed++;
+	}
+	else {
+		// Nothing for a while, the spurt is over. The next one buffers up again before it plays.
+		playing = false;
+		numConcealed = 0;
+		return;
+	}
+	playSeq++;
+}
+
+bool FUbermundoVoiceStream::IsTalking() const {
+	FScopeLock scope(&lock);
+	return playing;
+}
+
+FUbermundoVoiceStats FUbermundoVoiceStream::GetStats() const {
+	FScopeLock scope(&lock);
+	return stats;
+}
+
+// --------------------------------------------------------------------------------- FUbermundoVoice
+FUbermundoVoice& FUbermundoVoice::Get() {
+	static FUbermundoVoice voice;
+	return voice;
+}
+
+void FUbermundoVoice::SetSettings(const FUbermundoVoiceSettings& s) {
+	settings = s;
+	for (TPair<uint64, FSpeaker>& kv : speakers)
+		kv.Value.stream->SetSettings(s);
+}
+
+bool FUbermundoVoice::Start(TArrayView<const uint64> newListeners) {
+	SetListeners(newListeners);
+	if (capture.IsValid())
+		return true;
+	FVoiceModule& voice = FVoiceModule::Get();
+	if (!voice.IsVoiceEnabled()) {
+		UE_LOG(UberMundoSteamLog, Warning, TEXT("StartP2PVoice: voice is off, set [Voice] bEnabled=true in DefaultEngine.ini"));
+		return false;
+	}
+	capture = voice.CreateVoiceCapture(FString(), UBERMUNDO_VOICE_SAMPLE_RATE, 1);
+	if (!capture.IsValid() || !encoder.Init()) {
+		UE_LOG(UberMundoSteamLog, Warning, TEXT("StartP2PVoice: no microphone or no voice codec"));
+		capture.Reset();
+		return false;
+	}
+	captured.Reset();
+	capture->Start();
+	return true;
+}
+
+void FUbermundoVoice::SetListeners(TArrayView<const uint64> newListeners) {
+	listeners.Reset();
+	listeners.Append(newListeners.GetData(), newListeners.Num());
+}
+
+void FUbermundoVoice::Stop() {
+	if (talking)
+		SendEnd(FUbermundoClockSync::Get().GetSharedTimeMs());
+	if (capture.IsValid())
+		capture->Stop();
+	capture.Reset();
+	captured.Reset();
+}
+
+void FUbermundoVoice::Tick(double now) {
+	if (!capture.IsValid())
+		return;
+	uint32 available = 0;
+	if (capture->GetCaptureState(available) == EVoiceCaptureState::Ok && available > 0) {
+		int32 old = captured.Num();
+		captured.SetNumUninitialized(old + (int32)available, false);
+		uint32 written = 0;
+		capture->GetVoiceData(captured.GetData() + old, available, written);
+		captured.SetNum(old + (int32)written, false);
+		if (written > 0)
+			lastCaptured = now;
+	}
+	if (listeners.Num() == 0) {
+		captured.Reset();
+		return;
+	}
+
+	const int32 frameBytes = UBERMUNDO_VOICE_FRAME_SAMPLES * sizeof(int16);
+	int32 backlog = captured.Num() - UBERMUNDO_VOICE_MAX_BACKLOG_FRAMES * frameBytes;
+	if (backlog > 0)
+		captured.RemoveAt(0, backlog + (backlog & 1), false);
+
+	// Everyone gets the same frames, so the worst link sets the bitrate.
+	FUbermundoRateController& rate = FUbermundoRateController::Get();
+	int32 bitrate = MAX_int32;
+	for (uint64 l : listeners)
+		bitrate = FMath::Min(bitrate, rate.GetVoiceBitrate(l));
+	encoder.SetBitrate(bitrate);
+
+	FUbermundoP2POutbox& outbox = FUbermundoP2POutbox::Get();
+	uint32 nowMs = FUbermundoClockSync::Get().GetSharedTimeMs();
+	int32 offset = 0;
+	for (; captured.Num() - offset >= frameBytes; offset += frameBytes) {
+		// The frame started this long before the newest sample read.
+		uint32 ageMs = (uint32)((captured.Num() - offset) / sizeof(int16) * 1000 / UBERMUNDO_VOICE_SAMPLE_RATE);
+		if (!encoder.Encode(reinterpret_cast<const int16*>(captured.GetData() + offset), nowMs - ageMs, packet))
+			continue;
+		for (uint64 l : listeners)
+			outbox.Queue(l, packet, EUbermundoP2PSendMode::UnreliableNoDelay);
+		talking = true;
+	}
+	captured.RemoveAt(0, offset, false);
+
+	// The noise gate closed. Without an end the listeners would take the silence for loss and conceal it.
+	if (talking && now - lastCaptured >= UBERMUNDO_VOICE_END_FRAMES * UBERMUNDO_VOICE_FRAME_MS / 1000.0) {
+		SendEnd(nowMs);
+		captured.Reset();
+	}
+}
+
+void FUbermundoVoice::SendEnd(uint32 stamp) {
+	encoder.End(stamp, packet);
+	FUbermundoP2POutbox& outbox = FUbermundoP2POutbox::Get();
+	for (uint64 l : listeners)
+		outbox.Queue(l, packet, EUbermundoP2PSendMode::UnreliableNoDelay);
+	talking = false;
+}
+
+bool FUbermundoVoice::HandlePacket(uint64 sender, const uint8* data, int32 numBytes) {
+	FSpeaker* s = speakers.Find(sender);
+	if (s == nullptr) {
+		TSharedPtr<FUbermundoVoiceStream, ESPMode::ThreadSafe> stream = MakeShared<FUbermundoVoiceStream, ESPMode::ThreadSafe>(settings);
+		if (!stream->Init()) {
+			UE_LOG(UberMundoSteamLog, Verbose, TEXT("No voice decoder, ignoring voice from 0x%llX"), sender);
+			return true;
+		}
+		USoundWaveProcedural* sound = NewObject<USoundWaveProcedural>();
+		sound->SetSampleRate(UBERMUNDO_VOICE_SAMPLE_RATE);
+		sound->NumChannels = 1;
+		sound->Duration = INDEFINITELY_LOOPING_DURATION;
+		sound->SoundGroup = SOUNDGROUP_Voice;
+		sound->bLooping = false;
+		TWeakPtr<FUbermundoVoiceStream, ESPMode::ThreadSafe> weak = stream;
+		// Audio thread, whenever the wave is about to run dry.
+		sound->OnSoundWaveProceduralUnderflow = FOnSoundWaveProceduralUnderflow::CreateLambda([weak](USoundWaveProcedural* wave, int32 samplesRequired) {
+			TSharedPtr<FUbermundoVoiceStream, ESPMode::ThreadSafe> pinned = weak.Pin();
+			if (!pinned.IsValid())
+				return;
+			int32 needed = samplesRequired - wave->GetAvailableAudioByteCount() / (int32)sizeof(int16);
+			if (needed <= 0)
+				return;
+			TArrayView<const int16> pcm = pinned->Pull(needed);
+			wave->QueueAudio(reinterpret_cast<const uint8*>(pcm.GetData()), pcm.Num() * sizeof(int16));
+		});
+		s = &speakers.Add(sender);
+		s->stream = stream;
+		s->sound = sound;
+	}
+	if (!s->stream->OnPacket(data, numBytes, FPlatformTime::Seconds()))
+		UE_LOG(UberMundoSteamLog, Warning, TEXT("Bad P2P_PlayerVoiceMsg from 0x%llX N=%d"), sender, numBytes);
+	return true;
+}
+
+USoundWaveProcedural* FUbermundoVoice::GetSound(uint64 speaker) const {
+	const FSpeaker* s = speakers.Find(speaker);
+	return s ? s->sound : nullptr;
+}
+
+bool FUbermundoVoice::IsTalking(uint64 speaker) const {
+	const FSpeaker* s = speakers.Find(speaker);
+	return s && s->stream->IsTalking();
+}
+
+bool FUbermundoVoice::GetStats(uint64 speaker, FUbermundoVoiceStats& out) const {
+	const FSpeaker* s = speakers.Find(speaker);
+	out = s ? s->stream->GetStats() : FUbermundoVoiceStats();
+	return s != nullptr;
+}
+
+void FUbermundoVoice::ForgetPeer(uint64 peer) {
+	speakers.Remove(peer);
+	listeners.Remove(peer);
+}
+
+void FUbermundoVoice::Reset() {
+	Stop();
+	listeners.Reset();
+	speakers.Empty();
+}
+
+void FUbermundoVoice::AddReferencedObjects(FReferenceCollector& collector) {
+	for (TPair<uint64, FSpeaker>& kv : speakers)
+		collector.AddReferencedObject(kv.Value.sound);
+}
+
+// --------------------------------------------------------------------------------- UUbermundoVoiceLibrary
+bool UUbermundoVoiceLibrary::StartP2PVoice(const TArray<int64>& listeners) {
+	return FUbermundoVoice::Get().Start(TArrayView<const uint64>(reinterpret_cast<const uint64*>(listeners.GetData()), listeners.Num()));
+}
+
+void UUbermundoVoiceLibrary::SetP2PVoiceListeners(const TArray<int64>& listeners) {
+	FUbermundoVoice::Get().SetListeners(TArrayView<const uint64>(reinterpret_cast<const uint64*>(listeners.GetData()), listeners.Num()));
+}
+
+void UUbermundoVoiceLibrary::StopP2PVoice() {
+	FUbermundoVoice::Get().Stop();
+}
+
+USoundWaveProcedural* UUbermundoVoiceLibrary::GetP2PVoiceSound(int64 speaker) {
+	return FUbermundoVoice::Get().GetSound((uint64)speaker);
+}
+
+bool UUbermundoVoiceLibrary::IsP2PSpeakerTalking(int64 speaker) {
+	return FUbermundoVoice::Get().IsTalking((uint64)speaker);
+}
+
+bool UUbermundoVoiceLibrary::GetP2PVoiceStats(int64 speaker, FUbermundoVoiceStats& stats) {
+	return FUbermundoVoice::Get().GetStats((uint64)speaker, stats);
+}
+
+void UUbermundoVoiceLibrary::SetP2PVoiceSettings(const FUbermundoVoiceSettings& settings) {
+	FUbermundoVoice::Get().SetSettings(settings);
+}
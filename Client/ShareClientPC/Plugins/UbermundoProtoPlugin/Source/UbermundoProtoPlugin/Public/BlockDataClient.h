@@ -5,6 +5,8 @@
 // network shared file system like DropBox).
 // It is styled as an async file system, with open, close, read, write of text and/or binary and/or other objects
 // in the future.
+// A block can also be fetched from the other players: from its owner, and at the same time from everyone
+// already holding a copy, see FUbermundoBlockSwarm.
 
 #pragma once
 
@@ -135,6 +137,12 @@ public:
 		static void RequestShareBlock(FString blockPathAndName, int64& requestHandle, bool& success);
 	UFUNCTION(BlueprintCallable, Category = "UberMundo Asset IO", meta = (ToolTip = "Start a request in the background to fetch a Share Block state as a string."))
 		static void RequestShareBlockBinary(FString blockPathAndName, int64& requestHandle, bool& success);
+	UFUNCTION(BlueprintCallable, Category = "UberMundo Asset IO", meta = (ToolTip = "Start a request in the background to fetch a Share Block from its owner and, in parallel, from every one of peers that already has it. Each chunk is checked against the owner's hashes. blockName is the block's name in the world, not a local path. Read the result with Get Share Block Results Binary."))
+		static void RequestShareBlockFromPeers(FString blockName, int64 ownerSteamId, const TArray<int64>& peers, int64& requestHandle, bool& success);
+	UFUNCTION(BlueprintCallable, Category = "UberMundo Asset IO", meta = (ToolTip = "Hand out this Share Block to other players fetching it. Blocks fetched from peers are offered automatically."))
+		static void OfferShareBlock(FString blockName, const TArray<uint8>& contents);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "UberMundo Asset IO", meta = (ToolTip = "How far a Request Share Block From Peers has got, 0 to 1, and how many players it is coming from."))
+		static void GetShareBlockFetchProgress(int64 requestHandle, float& progress, int32& numSources, bool& success);
 	UFUNCTION(BlueprintCallable, Category = "UberMundo Asset IO", meta = (ToolTip = "Start a request in the background to put a Share Block state as a string."))
 		static void WriteShareBlock(FString blockPathAndName, int64& requestHandle, bool& success, FString contents);
 	UFUNCTION(BlueprintCallable, Category = "UberMundo Asset IO", meta = (ToolTip = "Start a request in the background to put a Share Block state as a string."))
@@ -158,6 +166,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "UberMundo Asset Helpers", meta = (ToolTip = "List the assets. Each string is type then path like \"Blueprint /Game/DefaultObjects/BigBox.BigBox\"/"))
 		static bool ListAllAssetsInPath(FString Path, UClass* Class, TArray<FString>& Result);
 
+	/** Called by FUbermundoBlockSwarm when a RequestShareBlockFromPeers finishes. */
+	static void OnPeerFetchDone(int64 requestHandle, const TArray<uint8>& contents, bool ok, const FString& failReason);
+
 private:
 	static TMap<int64, UShareRequest*> outstanding_requests;
 
@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "steam/steam_api.h"
+#include "UbermundoPacketBuffer.h"
+#include "UbermundoTransport.h"
 #include "SteamCustomCode.generated.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(UberMundoSteamLog, Log, All);
@@ -47,12 +49,29 @@ enum EPersonaStateUM
 	EPersonaStateMaxUM,
 };
 
+/** How a P2P packet is sent. The first four match EP2PSend in isteamnetworking.h. */
+UENUM(BlueprintType)
+enum class EUbermundoP2PSendMode : uint8 {
+	/** Send UDP Now. If not connected or routed yet, drops the packet.  MAX 1200 bytes. */
+	UnreliableNoDelay,
+	/** Send via normal UDP. Will wait for the connection to be valid.  MAX 1200 bytes. */
+	Unreliable,
+	/** Max 1 MB. Does reassembly and ordering of packets from fragments. */
+	Reliable,
+	/** Max 1 MB. Like Reliable but accumulates packets over a max of 200 ms. for more efficient send. */
+	ReliableWithBuffering,
+	/** Unreliable, for bulk data chunks that do their own acks. Kept off the lane Player3DState uses.  MAX 1200 bytes. */
+	UnreliableBulk
+};
+
 class ShareSteamCallbackHooks {
 public:
 	ShareSteamCallbackHooks();
 	// These auto-register as callbacks on object createion of this ShareSteamCallbackHooks
 	STEAM_CALLBACK(ShareSteamCallbackHooks, OnP2PSessionRequest, P2PSessionRequest_t, m_CallbackP2PSessionRequest);
 	STEAM_CALLBACK(ShareSteamCallbackHooks, OnP2PSessionConnectFail, P2PSessionConnectFail_t, m_CallbackP2PSessionConnectFail);
+	STEAM_CALLBACK(ShareSteamCallbackHooks, OnPersonaStateChange, PersonaStateChange_t, m_CallbackPersonaStateChange);
+	STEAM_CALLBACK(ShareSteamCallbackHooks, OnAvatarImageLoaded, AvatarImageLoaded_t, m_CallbackAvatarImageLoaded);
 };
 
 /**
@@ -95,22 +114,63 @@ public:
 		static bool Tick();
 
 	UFUNCTION(BlueprintCallable, Category = "ShareSteam|P2P", meta = (ToolTip = "Send UDP Now. If not connected or routed yet, drops the packet.  MAX 1200 bytes."))
-		static bool SendP2PPacket_UnreliableNoDelay(int64 targetUserSteamId, TArray<uint8> bytes);
+		static bool SendP2PPacket_UnreliableNoDelay(int64 targetUserSteamId, const TArray<uint8>& bytes);
 	UFUNCTION(BlueprintCallable, Category = "ShareSteam|P2P", meta = (ToolTip = "Send via normal UDP. Will wait for the connection to be valid.  MAX 1200 bytes."))
-		static bool SendP2PPacket_Unreliable(int64 targetUserSteamId, TArray<uint8> bytes);
+		static bool SendP2PPacket_Unreliable(int64 targetUserSteamId, const TArray<uint8>& bytes);
 	UFUNCTION(BlueprintCallable, Category = "ShareSteam|P2P", meta = (ToolTip = "Max 1 MB. Does reassembly and ordering of packets from fragments."))
-		static bool SendP2PPacket_Reliable(int64 targetUserSteamId, TArray<uint8> bytes);
+		static bool SendP2PPacket_Reliable(int64 targetUserSteamId, const TArray<uint8>& bytes);
 	UFUNCTION(BlueprintCallable, Category = "ShareSteam|P2P", meta = (ToolTip = "Max 1 MB. Does reassembly and ordering of packets from fragments. Will accumulate multiple packets over a max of 200 ms. for more efficient send."))
-		static bool SendP2PPacket_ReliableWithBuffered(int64 targetUserSteamId, TArray<uint8> bytes);
-
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|P2P", meta = (ToolTip = "Is there data to get? Returns 0 if no data, else the number of bytes available."))
+		static bool SendP2PPacket_ReliableWithBuffered(int64 targetUserSteamId, const TArray<uint8>& bytes);
+
+	/** Native send path. The Blueprint SendP2PPacket_* functions are thin wrappers over these.
+		Nothing is copied or allocated, the bytes go straight to Steam. */
+	static bool SendP2P(uint64 targetUserSteamId, const uint8* data, uint32 numBytes, EUbermundoP2PSendMode mode);
+	static bool SendP2P(uint64 targetUserSteamId, TArrayView<const uint8> bytes, EUbermundoP2PSendMode mode) {
+		return SendP2P(targetUserSteamId, bytes.GetData(), (uint32)bytes.Num(), mode);
+	}
+	static bool SendP2P(uint64 targetUserSteamId, const FUbermundoPacketRef& packet, EUbermundoP2PSendMode mode) {
+		return SendP2P(targetUserSteamId, packet.GetData(), (uint32)packet.Num(), mode);
+	}
+	/** The same packet to every target. The transport shares the one buffer between them, see IUbermundoTransport::SendToMany.
+		Returns how many were sent. */
+	static int32 SendP2PToPeers(TArrayView<const uint64> targetUserSteamIds, const FUbermundoPacketRef& packet, EUbermundoP2PSendMode mode);
+
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|P2P", meta = (ToolTip = "Send the same bytes to every peer in the list. The bytes are copied once for all of them, not once per peer, and everything goes to the network together at the end. Returns how many peers it was sent to."))
+		static int32 SendP2PPacketToPeers(const TArray<int64>& targetUserSteamIds, const TArray<uint8>& bytes, EUbermundoP2PSendMode mode);
+
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|P2P", meta = (ToolTip = "Queue a message for a peer. Everything queued for that peer this tick goes out packed into as few datagrams as possible on FlushP2POutbox. Images wait here while the link to the peer is busy, and voice is dropped, so state updates keep flowing. False if it was dropped."))
+		static bool QueueP2PMessage(int64 targetUserSteamId, const TArray<uint8>& bytes, EUbermundoP2PSendMode mode);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|P2P", meta = (ToolTip = "Run the plugin's own network work for this tick (clock sync, voice, bulk transfers...), then send everything queued with QueueP2PMessage. Call once at the end of each tick. Returns the number of datagrams sent."))
+		static int FlushP2POutbox();
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|P2P", meta = (ToolTip = "Is there data to get? Returns 0 if no data, else the number of bytes available. ReadP2PPacket may still find nothing, when all that came were the plugin's own packets."))
 		static int IsP2PPacketAvailable();
-	UFUNCTION(BlueprintCallable, Category = "ShareSteam|P2P", meta = (ToolTip = "Get a packet of data.  If no packets returns false."))
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|P2P", meta = (ToolTip = "Get the next message, bundles unpacked and the plugin's own packets handled on the way. If no messages returns false. To read everything pending at once use the P2P Inbox DrainP2PPackets, but not both in one tick."))
 		static bool ReadP2PPacket(TArray<uint8>& bytes, int64& remoteSteamID);
 
 	UFUNCTION(BlueprintCallable, Category = "ShareSteam|P2P", meta = (ToolTip = "Drop conversations with remote user."))
 		static bool CloseP2PBySteamID(int64 remoteSteamID);
 
+	/** What all P2P sends, reads and closes go through. Steam unless UseLoopbackTransport was called. */
+	static IUbermundoTransport& GetTransport();
+	/** Both swaps first hand what the network thread already read to the inbox, and send what the outbox holds. */
+	static void SetTransport(TUniquePtr<IUbermundoTransport> transport);
+	/** Swap the current transport for what fn makes of it, e.g. the same one run on the network thread. */
+	static void ReplaceTransport(TFunctionRef<TUniquePtr<IUbermundoTransport>(TUniquePtr<IUbermundoTransport>)> fn);
+
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Transport", meta = (ToolTip = "Send and receive P2P packets through Steam. The default."))
+		static void UseSteamTransport();
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Transport", meta = (ToolTip = "Send and receive P2P packets through ISteamNetworkingSockets: separate lanes for state, reliable events and bulk data, and one batched send per tick. Every player in the session must use it. Returns false if Steam is not running."))
+		static bool UseSteamSocketsTransport();
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Transport", meta = (ToolTip = "Send and receive P2P packets as UDP on 127.0.0.1:localPort instead of Steam, for headless runs and load tests. Our peer id becomes localPort. Returns false if the port could not be bound."))
+		static bool UseLoopbackTransport(int32 localPort, const FUbermundoNetConditions& conditions);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Transport", meta = (ToolTip = "Change the fake latency, jitter, loss and reordering of the loopback transport, also while the network thread runs it. False if the transport is not loopback."))
+		static bool SetLoopbackConditions(const FUbermundoNetConditions& conditions);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Transport", meta = (ToolTip = "Loopback transport: send packets for this peer id to address:port. Without this, peer id N goes to 127.0.0.1:N. False if the transport is not loopback or the address is bad."))
+		static bool AddLoopbackPeer(int64 peer, const FString& address, int32 port);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Transport")
+		static FString GetTransportName();
+
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam", meta = (ToolTip = "True if is valid ID. This means Universe, Instance, Type, and Unique 32 bit ID are set."))
 		static bool IsValidSteamID(int64 steamID);
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam", meta = (ToolTip = "Get the account type bits of the steam ID. 1 is k_EAccountTypeIndividual, 3 is k_EAccountTypeGameServer"))
@@ -0,0 +1,118 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// Steam avatars as textures, without holding up the frame.
+// Asking for a player's avatar never waits: it returns the texture if there is one, and otherwise
+// starts getting it and returns nothing (the Blueprint call hands back a placeholder instead). The
+// Steam image is read and its RGBA turned into texture order on a worker thread; only creating the
+// UTexture2D and copying the finished pixels in happens on the game thread, the next time the cache
+// is asked for anything. Steam gives the same image the same handle, so players sharing an avatar
+// share one texture and one fetch. Ready textures are kept most recently used first, up to
+// UBERMUNDO_AVATAR_CACHE_SIZE, then the least recently asked for are let go of.
+// Every texture that becomes ready bumps a version number, like the friends cache, so a UI can tell
+// when to ask again. A PersonaStateChange_t or AvatarImageLoaded_t callback for a player makes the
+// next ask go back to Steam for their current image handle.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "UObject/GCObject.h"
+#include "Containers/Queue.h"
+#include "UbermundoAvatarCache.generated.h"
+
+class UTexture2D;
+
+/** Ready textures kept. */
+#define UBERMUNDO_AVATAR_CACHE_SIZE 128
+/** Seconds before asking Steam again for an avatar it had no image for yet. */
+#define UBERMUNDO_AVATAR_RETRY 1.0
+
+UENUM(BlueprintType)
+enum class EUbermundoAvatarSize : uint8 {
+	/** 32 x 32 */
+	Small,
+	/** 64 x 64 */
+	Medium,
+	/** 184 x 184 */
+	Large
+};
+
+class UBERMUNDOPROTOPLUGIN_API FUbermundoAvatarCache : public FGCObject {
+public:
+	static FUbermundoAvatarCache& Get();
+
+	/** The avatar if it is ready, else nullptr and it is on its way. Game thread. */
+	UTexture2D* Find(uint64 steamId, EUbermundoAvatarSize size);
+	/** Bumped each time a texture becomes ready. */
+	int32 GetVersion() const { return version; }
+
+	/** From Steam callbacks, any thread. The player's image handle may have changed. */
+	void OnAvatarChanged(uint64 steamId);
+
+	/** Drop everything, e.g. when Steam shuts down. Decodes still running are ignored when they finish. */
+	void Reset();
+
+	// FGCObject
+	virtual void AddReferencedObjects(FReferenceCollector& collector) override;
+	virtual FString GetReferencerName() const override { return TEXT("FUbermundoAvatarCache"); }
+
+private:
+	/** What a worker made of an image handle. */
+	struct FDecoded {
+		int32 handle = 0;
+		uint32 generation = 0;
+		int32 width = 0;
+		int32 height = 0;
+		/** B8G8R8A8, empty if Steam would not give the image. */
+		TArray<uint8> pixels;
+	};
+
+	struct FImage {
+		UTexture2D* texture = nullptr;
+		bool decoding = false;
+		/** When Steam last would not give the image, it is tried again UBERMUNDO_AVATAR_RETRY later. */
+		double failedAt = 0.0;
+		uint64 lastUsed = 0;
+	};
+
+	struct FKey {
+		int32 handle = 0;
+		double retryAt = 0.0;
+	};
+
+	static uint64 KeyOf(uint64 steamId, EUbermundoAvatarSize size) { return (steamId << 2) | (uint64)size; }
+	static int32 HandleFromSteam(uint64 steamId, EUbermundoAvatarSize size);
+	void StartDecode(int32 handle);
+	void TakeDecoded();
+	void Evict();
+
+	/** Image handle per player and size. */
+	TMap<uint64, FKey> keys;
+	TMap<int32, FImage> images;
+	int32 numReady = 0;
+	uint64 useCounter = 0;
+	int32 version = 0;
+	uint32 generation = 0;
+	typedef TQueue<FDecoded, EQueueMode::Mpsc> FDecodedQueue;
+	/** Workers hold it weakly, so one finishing after the cache is gone drops its result. */
+	TSharedRef<FDecodedQueue, ESPMode::ThreadSafe> decoded = MakeShared<FDecodedQueue, ESPMode::ThreadSafe>();
+
+	/** Players whose handles are to be asked for again, filled from callbacks. */
+	FCriticalSection changedLock;
+	TSet<uint64> changed;
+};
+
+/**
+ * Blueprint access to Steam avatars.
+ */
+UCLASS()
+class UBERMUNDOPROTOPLUGIN_API UUbermundoAvatarLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Friends", meta = (ToolTip = "A player's Steam avatar. Never waits: until it is ready this returns placeholder and Ready is false, ask again once Get Avatar Cache Version changes."))
+		static UTexture2D* GetSteamAvatar(int64 steamId, EUbermundoAvatarSize size, UTexture2D* placeholder, bool& ready);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Friends", meta = (ToolTip = "Changes every time another avatar is ready."))
+		static int32 GetAvatarCacheVersion();
+};
@@ -0,0 +1,159 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// Share block data fetched from every player who already has it, not just its owner.
+// A block is split into UBERMUNDO_SWARM_CHUNK byte chunks, each with its SHA1 in a manifest.
+// The manifest always comes from the owner, so a chunk from anyone else can be checked against it.
+// A fetch asks the players it is given who has the block (Want). Those holding the same version
+// answer Have, and chunks are then requested from all of them at once, a few in flight per player,
+// more as they keep delivering. A chunk that fails its hash, or goes unanswered twice, is asked of
+// the owner instead, and a player who sends bad data is dropped from the fetch.
+// Once a fetch completes the block is offered in turn, so a popular world loads at the combined
+// upload rate of everyone already in it.
+// Offered blocks are kept in memory, up to UBERMUNDO_SWARM_MAX_OFFERED bytes, least recently used
+// go first. Someone asking for a block we no longer have gets a Missing and looks elsewhere.
+//
+// Packets, all Big Endian, blockId is the CityHash64 of the block name:
+//   Want            [blockId u64]
+//   Have            [blockId u64][version u32]         version is the first 4 bytes of the block's SHA1
+//   ManifestRequest [blockId u64][nonce u32]           the nonce keeps a new fetch from being mistaken for a resend
+//   Manifest        [blockId u64][size u32][block SHA1][chunk SHA1] x chunks    sent as a bulk transfer
+//   ChunkRequest    [blockId u64][n u8][index u16] x n
+//   Chunk           [blockId u64][index u16][bytes]    unreliable, counted as bulk by the rate controller
+//   Missing         [blockId u64]
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/SecureHash.h"
+
+/** Chunk bytes, so a chunk plus its header and bundle length fits UBERMUNDO_P2P_MAX_UNRELIABLE. */
+#define UBERMUNDO_SWARM_CHUNK 1180
+/** Chunk header: code, block id, chunk index. */
+#define UBERMUNDO_SWARM_CHUNK_HEADER (1 + 8 + 2)
+/** 16 bit chunk index. */
+#define UBERMUNDO_SWARM_MAX_BYTES (UBERMUNDO_SWARM_CHUNK * 0xFFFF)
+/** Most memory held by blocks we offer to others. */
+#define UBERMUNDO_SWARM_MAX_OFFERED (128 * 1024 * 1024)
+
+class UBERMUNDOPROTOPLUGIN_API FUbermundoBlockSwarm {
+public:
+	static FUbermundoBlockSwarm& Get();
+
+	static uint64 BlockId(const FString& blockName);
+
+	/** Hold bytes as blockName and hand it out to anyone who asks. Replaces what was offered under that name before. */
+	void Offer(const FString& blockName, TArrayView<const uint8> bytes);
+	void Withdraw(const FString& blockName);
+	bool IsOffered(const FString& blockName) const;
+
+	/** Start fetching blockName from owner and whichever of peers have it. When it is done, or fails,
+		UBlockDataClient::OnPeerFetchDone is called with requestHandle, never before Fetch returns.
+		False if it could not be started. */
+	bool Fetch(int64 requestHandle, const FString& blockName, uint64 owner, TArrayView<const uint64> peers);
+	void Cancel(int64 requestHandle);
+	/** 0 to 1, and how many players chunks are coming from. False if there is no such fetch. */
+	bool GetProgress(int64 requestHandle, float& progress, int32& numSources) const;
+
+	/** Ask for chunks, time out the ones that did not come. A net tick, see FUbermundoNetTick. */
+	void Tick(double now);
+
+	/** One of the swarm packets from sender. False if it is not one. */
+	bool HandlePacket(uint64 sender, const uint8* data, int32 numBytes);
+
+	void ForgetPeer(uint64 peer);
+
+private:
+	struct FOffered {
+		FString name;
+		TArray<uint8> bytes;
+		FSHAHash hash;
+		TArray<FSHAHash> chunkHashes;
+		double lastUsed = 0.0;
+	};
+
+	struct FSource {
+		uint64 peer = 0;
+		bool owner = false;
+		int32 inFlight = 0;
+		float window = 4.0f;
+		int32 badChunks = 0;
+		int64 bytesReceived = 0;
+	};
+
+	enum class EChunk : uint8 {
+		Missing,
+		Requested,
+		Have
+	};
+
+	/** A Fetch of a block we already offer, answered on the next Tick. */
+	struct FReady {
+		int64 requestHandle = 0;
+		uint64 id = 0;
+	};
+
+	struct FFetch {
+		int64 requestHandle = 0;
+		uint64 id = 0;
+		FString name;
+		uint64 owner = 0;
+		TArray<uint64> candidates;
+
+		bool haveManifest = false;
+		uint32 totalBytes = 0;
+		FSHAHash hash;
+		TArray<FSHAHash> chunkHashes;
+
+		TArray<uint8> data;
+		TArray<EChunk> chunks;
+		TArray<uint64> requestedFrom;
+		TArray<double> requestedAt;
+		/** Times each chunk went unanswered or failed its hash. At UBERMUNDO_SWARM_OWNER_AFTER only the owner is asked. */
+		TArray<uint8> tries;
+		int32 numHave = 0;
+		/** Missing chunks below this are all asked of someone already. */
+		int32 nextMissing = 0;
+
+		TArray<FSource> sources;
+		/** Players who sent bad data or said they do not have it. Not asked again by this fetch. */
+		TSet<uint64> dropped;
+		/** Versions players said they have, kept until the manifest says which one we want. */
+		TMap<uint64, uint32> haves;
+
+		/** Last time a chunk or the manifest came in. */
+		double lastProgress = 0.0;
+		double lastManifestRequest = 0.0;
+		int32 manifestRequests = 0;
+		double lastWant = 0.0;
+	};
+
+	static int32 ChunkSize(int32 totalBytes, int32 index);
+	static uint32 VersionOf(const FSHAHash& hash);
+	static FSHAHash HashChunk(const uint8* data, int32 numBytes);
+
+	FFetch* FindFetch(uint64 id);
+	FSource* FindSource(FFetch& f, uint64 peer);
+	void AddSource(FFetch& f, uint64 peer);
+	void DropSource(FFetch& f, uint64 peer);
+	/** Put a requested chunk back to be asked again, of the owner if it has failed too often. */
+	void RequestFailed(FFetch& f, int32 index);
+	void TickFetch(FFetch& f, double now);
+	/** Some chunk can only come from the owner now, and the owner is gone. */
+	bool IsStranded(const FFetch& f) const;
+	void Finish(int32 fetchIdx, bool ok, const FString& failReason);
+	void TrimOffered();
+
+	void SendWants(FFetch& f, double now);
+	void OnManifestRequest(uint64 sender, uint64 id, uint32 nonce);
+	void OnWant(uint64 sender, uint64 id);
+	void OnHave(uint64 sender, uint64 id, uint32 version);
+	void OnManifest(uint64 sender, const uint8* data, int32 numBytes);
+	void OnChunkRequest(uint64 sender, const uint8* data, int32 numBytes);
+	void OnChunk(uint64 sender, const uint8* data, int32 numBytes);
+	void OnMissing(uint64 sender, uint64 id);
+
+	TMap<uint64, FOffered> offered;
+	int64 offeredBytes = 0;
+	TArray<FFetch> fetches;
+	TArray<FReady> ready;
+};
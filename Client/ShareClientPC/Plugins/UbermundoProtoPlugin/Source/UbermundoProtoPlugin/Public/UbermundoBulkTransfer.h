@@ -0,0 +1,131 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// Large P2P messages (images, world previews, block data) as many unreliable chunks.
+// The receiver takes chunks in any order and acks what it has: a count received in order, then
+// a bitmap of the ones after that. The sender resends only the holes, so one lost chunk holds up
+// nothing but itself, and none of it blocks the reliable channel game events use.
+// How many chunks are in flight grows while acks come back and halves on loss, and nothing is
+// sent while the rate controller says the link has no room for bulk.
+// A transfer's id is by default the CRC of its bytes. Sending the same bytes again, after a
+// reconnect say, picks up where it left off: the receiver still has its chunks and acks them.
+// The flip side is that the same bytes sent twice within UBERMUNDO_BULK_KEEP_SECONDS only arrive
+// once. Pass an id of your own to Send if that matters.
+// An outgoing transfer that gets no ack for UBERMUNDO_BULK_MAX_TIMEOUTS timeouts in a row gives up,
+// and GetProgress says -1 for it from then on.
+// The reassembled message goes into the P2P inbox like any other packet, so game code reads a
+// big message exactly like a small one.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "UbermundoPacketBuffer.h"
+#include "UbermundoBulkTransfer.generated.h"
+
+/** Chunk header: code, id, total size, chunk index. */
+#define UBERMUNDO_BULK_HEADER (1 + 4 + 4 + 2)
+/** Chunk bytes, so a chunk plus its bundle length still fits UBERMUNDO_P2P_MAX_UNRELIABLE. */
+#define UBERMUNDO_BULK_CHUNK 1180
+/** 16 bit chunk index. */
+#define UBERMUNDO_BULK_MAX_BYTES (UBERMUNDO_BULK_CHUNK * 0xFFFF)
+/** Most bitmap bytes in an ack, so up to 512 chunks past the in order count. */
+#define UBERMUNDO_BULK_ACK_BITMAP 64
+/** How long a receiver keeps a transfer nothing has arrived for, so it can be resumed. */
+#define UBERMUNDO_BULK_KEEP_SECONDS 300.0
+/** Most unfinished transfers one peer can have coming in to us. Chunks of any more are dropped until one finishes,
+	so a sender only sends this many to one peer at once, the oldest, and the rest wait. */
+#define UBERMUNDO_BULK_MAX_INCOMING 4
+/** Most bytes one peer's unfinished transfers to us can hold between them. Senders keep to this too. */
+#define UBERMUNDO_BULK_MAX_INCOMING_BYTES (UBERMUNDO_BULK_MAX_BYTES + 16 * 1024 * 1024)
+/** Timeouts in a row, an RTO apart with no chunk acked in between, before an outgoing transfer gives up. */
+#define UBERMUNDO_BULK_MAX_TIMEOUTS 10
+
+class UBERMUNDOPROTOPLUGIN_API FUbermundoBulkTransfer {
+public:
+	static FUbermundoBulkTransfer& Get();
+
+	/** Start sending payload to peer, or resume it if it is already going. payload starts with its own packet code.
+		Returns the transfer id, 0 if payload is empty or too big. */
+	uint32 Send(uint64 peer, TArrayView<const uint8> payload);
+	uint32 Send(uint64 peer, TArrayView<const uint8> payload, uint32 id);
+	void Cancel(uint64 peer, uint32 id);
+
+	/** Send what the window and the rate controller allow, resend holes, send acks. A net tick, see FUbermundoNetTick. */
+	void Tick(double now);
+
+	/** A UBERMUNDOPC_P2P_BulkChunk from sender. True, and the whole message in completed, if this was its last chunk. */
+	bool OnChunk(uint64 sender, const uint8* data, int32 numBytes, TArray<uint8>& completed);
+	/** A UBERMUNDOPC_P2P_BulkAck from peer. */
+	void OnAck(uint64 peer, const uint8* data, int32 numBytes);
+
+	/** 0 to 1, -1 if there is no such transfer or it failed. outgoing is ours to peer, else peer's to us. */
+	float GetProgress(uint64 peer, uint32 id, bool outgoing) const;
+	int32 NumOutgoing() const;
+
+	void ForgetPeer(uint64 peer);
+
+private:
+	struct FOutgoing {
+		uint32 id = 0;
+		FUbermundoPacketRef payload;
+		int32 numChunks = 0;
+		TBitArray<> acked;
+		int32 numAcked = 0;
+		/** Chunks below this are all acked. */
+		int32 firstUnacked = 0;
+		int32 highestAcked = -1;
+		/** Next chunk never sent yet. */
+		int32 nextNew = 0;
+		/** When each chunk last went out, 0 never. */
+		TArray<double> sentAt;
+		float window = 8.0f;
+		bool slowStart = true;
+		double lastCut = 0.0;
+		/** Timeouts since a chunk was last acked, an RTO apart at least. */
+		int32 numTimeouts = 0;
+		double lastTimeout = 0.0;
+		/** Gave up, see UBERMUNDO_BULK_MAX_TIMEOUTS. doneAt is set too. */
+		bool failed = false;
+		double doneAt = 0.0;
+	};
+
+	struct FIncoming {
+		uint32 totalBytes = 0;
+		int32 numChunks = 0;
+		TArray<uint8> data;
+		TBitArray<> have;
+		int32 numHave = 0;
+		/** Chunks below this are all in. */
+		int32 inOrder = 0;
+		bool complete = false;
+		bool ackDue = false;
+		double lastActivity = 0.0;
+	};
+
+	static int32 ChunkSize(int32 totalBytes, int32 index);
+	/** Whether sender has room for one more unfinished transfer of totalBytes, not counting the one with this id. */
+	bool CanAcceptIncoming(uint64 sender, uint32 id, uint32 totalBytes) const;
+	bool SendChunk(uint64 peer, const FOutgoing& t, int32 index);
+	void TickOutgoing(uint64 peer, FOutgoing& t, double now, double rto, double rtt);
+	void SendAck(uint64 peer, uint32 id, const FIncoming& in);
+
+	TMap<uint64, TArray<FOutgoing>> outgoing;
+	TMap<uint64, TMap<uint32, FIncoming>> incoming;
+};
+
+/**
+ * Blueprint access to bulk transfers.
+ */
+UCLASS()
+class UBERMUNDOPROTOPLUGIN_API UUbermundoBulkTransferLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|P2P", meta = (ToolTip = "Send a big message (image, world preview...) in chunks that can arrive in any order. It turns up in the P2P inbox like any other packet. Returns the transfer id for GetBulkP2PProgress, 0 if bytes is empty or over 77 MB."))
+		static int64 SendBulkP2P(int64 targetUserSteamId, const TArray<uint8>& bytes);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|P2P", meta = (ToolTip = "How far along a bulk transfer is, 0 to 1. Outgoing for ours to the peer, else theirs to us. -1 if unknown, or if ours gave up with no acks coming back."))
+		static float GetBulkP2PProgress(int64 peer, int64 transferId, bool outgoing);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|P2P")
+		static void CancelBulkP2P(int64 targetUserSteamId, int64 transferId);
+};
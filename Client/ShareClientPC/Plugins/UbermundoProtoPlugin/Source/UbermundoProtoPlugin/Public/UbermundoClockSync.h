@@ -0,0 +1,129 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// Shared clock between peers.
+// Each peer we hear from is sent a ClockPing now and then: our time. The ClockPong back carries it,
+// plus their time when the ping arrived and when the pong left. As in NTP, that gives a round trip
+// and their clock minus ours. Of the last few such samples the one with the shortest round trip is
+// trusted, since it had the least queueing to skew it. Successive trusted offsets tell how fast
+// their clock drifts from ours, so the offset is extrapolated between samples.
+// Pings go four times a second until a peer has a few samples, then every UBERMUNDO_CLOCK_POLL.
+//
+// The shared clock is the clock of the lowest peer id among us and every synced peer, so everyone
+// in a session lands on the same one without agreeing on it. A message stamped with
+// GetSharedTimeMs (32 bits of milliseconds, wrapping) can be mapped into local time by anyone who
+// receives it with SharedMsToLocal. When a peer with a lower id than the current reference syncs,
+// the shared clock steps over to theirs.
+// Times are FPlatformTime::Seconds on our side, microseconds on the wire.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "UbermundoClockSync.generated.h"
+
+/** Samples kept per peer. The best round trip among them is trusted. */
+#define UBERMUNDO_CLOCK_SAMPLES 8
+/** Seconds between pings once a peer is synced. */
+#define UBERMUNDO_CLOCK_POLL 10.0
+/** Seconds between pings until then. */
+#define UBERMUNDO_CLOCK_FAST_POLL 0.25
+/** Peers not heard from for this long are no longer pinged. */
+#define UBERMUNDO_CLOCK_IDLE 30.0
+/** Most drift believed, parts per million. Real crystals are well inside this. */
+#define UBERMUNDO_CLOCK_MAX_DRIFT_PPM 500.0
+
+USTRUCT(BlueprintType)
+struct FUbermundoClockStats
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoClockStats() : Synced(false), OffsetMs(0.0f), RttMs(0.0f), DriftPpm(0.0f), NumSamples(0) {}
+
+	UPROPERTY(BlueprintReadOnly)
+		bool Synced;
+	/** Their clock minus ours, right now. */
+	UPROPERTY(BlueprintReadOnly)
+		float OffsetMs;
+	/** Round trip of the sample the offset comes from. Half of it is how far off the offset can be. */
+	UPROPERTY(BlueprintReadOnly)
+		float RttMs;
+	UPROPERTY(BlueprintReadOnly)
+		float DriftPpm;
+	UPROPERTY(BlueprintReadOnly)
+		int32 NumSamples;
+};
+
+class UBERMUNDOPROTOPLUGIN_API FUbermundoClockSync {
+public:
+	static FUbermundoClockSync& Get();
+
+	/** A packet came from peer, so it is worth keeping in sync with. */
+	void OnHeard(uint64 peer, double now);
+	/** Send pings that are due. A net tick, see FUbermundoNetTick. */
+	void Tick(double now);
+	/** ClockPing and ClockPong. True if it was one. */
+	bool HandlePacket(uint64 sender, const uint8* data, int32 numBytes, double now);
+
+	/** Peer's clock minus ours at now, seconds. False until there is a sample. */
+	bool GetOffset(uint64 peer, double now, double& offset) const;
+	double RemoteToLocal(uint64 peer, double remoteTime) const;
+	double LocalToRemote(uint64 peer, double localTime) const;
+
+	/** Whose clock the shared one is. Our own id when alone. */
+	uint64 GetReferencePeer() const;
+	double LocalToShared(double localTime) const;
+	double SharedToLocal(double sharedTime) const;
+	double GetSharedTime() const { return LocalToShared(FPlatformTime::Seconds()); }
+	/** GetSharedTime as a compact stamp for messages, milliseconds in 32 bits. Wraps every 49 days. */
+	uint32 GetSharedTimeMs() const;
+	/** Local time a stamp from GetSharedTimeMs stands for. Taken as the nearest to now, so good for 24 days either way. */
+	double SharedMsToLocal(uint32 stamp) const;
+
+	bool GetStats(uint64 peer, FUbermundoClockStats& out) const;
+	void ForgetPeer(uint64 peer);
+
+private:
+	struct FSample {
+		double localTime;
+		double offset;
+		double rtt;
+	};
+
+	struct FPeer {
+		FSample samples[UBERMUNDO_CLOCK_SAMPLES];
+		int32 numSamples = 0;
+		int32 nextSample = 0;
+		/** The estimate: offset at refTime, changing by drift seconds per second. */
+		bool synced = false;
+		double refTime = 0.0;
+		double refOffset = 0.0;
+		double refRtt = 0.0;
+		double drift = 0.0;
+		double lastHeard = 0.0;
+		double nextPing = 0.0;
+	};
+
+	void OnPong(uint64 sender, uint64 t0, uint64 t1, uint64 t2, double now);
+	static double Offset(const FPeer& p, double localTime) { return p.refOffset + p.drift * (localTime - p.refTime); }
+
+	TMap<uint64, FPeer> peers;
+};
+
+/**
+ * Blueprint access to the shared clock.
+ */
+UCLASS()
+class UBERMUNDOPROTOPLUGIN_API UUbermundoClockSyncLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Clock", meta = (ToolTip = "The time every player in the session agrees on, in milliseconds, wrapping. Put it in a message to say when something happened."))
+		static int32 GetSharedTimeMs();
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Clock", meta = (ToolTip = "How long ago, in milliseconds, a Get Shared Time Ms stamp from any player was. Negative if it is in the future."))
+		static float GetSharedTimeAgeMs(int32 stamp);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Clock", meta = (ToolTip = "The player whose clock the shared time follows."))
+		static int64 GetClockReferencePeer();
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Clock", meta = (ToolTip = "Offset, round trip and drift of our clock against this peer's. False if nothing is known yet."))
+		static bool GetPeerClockStats(int64 peer, FUbermundoClockStats& stats);
+};
@@ -0,0 +1,111 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// Send on change for the local player's Player3DState.
+// A remote player's jitter buffer shows us, between our states, where our last state's velocity
+// would have carried us, for at most its MaxExtrapolationMs, still facing the way we last did.
+// This runs the same prediction per peer from the last state each of them was sent, and only lets a
+// due state through (see FUbermundoInterestManager) when what they would be showing is off by more
+// than the thresholds: position, facing or velocity. Standing still then costs a heartbeat every
+// HeartbeatSeconds, which also covers a lost state. Moving in a straight line at a steady speed costs
+// more: the receiver stops extrapolating MaxExtrapolationMs after our last state, so a new one is due
+// once we have gone PositionErrorCm past that point. With the defaults (250 ms, 2 cm) that is about
+// four a second for a walking player, against FullRateHz (20 by default) when every due state is sent.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "UbermundoSnapshotCodec.h"
+#include "UbermundoDeadReckoning.generated.h"
+
+USTRUCT(BlueprintType)
+struct FUbermundoDeadReckoningSettings
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoDeadReckoningSettings() :
+		Enabled(true),
+		PositionErrorCm(2.0f),
+		RotationErrorDegrees(3.0f),
+		VelocityErrorCmPerSec(100.0f),
+		HeartbeatSeconds(1.0f) {
+	}
+
+	/** Off sends every due state, as before. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		bool Enabled;
+	/** How far the receiver's prediction may be from where we are. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float PositionErrorCm;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float RotationErrorDegrees;
+	/** A change of speed or direction this big goes out before it shows as position error, so curves stay smooth. 0 for no check. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float VelocityErrorCmPerSec;
+	/** Longest a peer goes without a state, however well the prediction holds. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float HeartbeatSeconds;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoDeadReckoningStats
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoDeadReckoningStats() : NumSent(0), NumSkipped(0), NumHeartbeats(0) {}
+
+	/** Due states that went out. */
+	UPROPERTY(BlueprintReadOnly)
+		int32 NumSent;
+	/** Due states held back because the receiver's prediction was still good enough. */
+	UPROPERTY(BlueprintReadOnly)
+		int32 NumSkipped;
+	/** Of NumSent, the ones only sent because the heartbeat was due. */
+	UPROPERTY(BlueprintReadOnly)
+		int32 NumHeartbeats;
+};
+
+class UBERMUNDOPROTOPLUGIN_API FUbermundoDeadReckoning {
+public:
+	static FUbermundoDeadReckoning& Get();
+
+	void SetSettings(const FUbermundoDeadReckoningSettings& s) { settings = s; }
+	const FUbermundoDeadReckoningSettings& GetSettings() const { return settings; }
+
+	/** Does peer need state now? If so it is taken as sent to them. */
+	bool ShouldSend(uint64 peer, const FUbermundoPlayer3DState& state, double now);
+
+	const FUbermundoDeadReckoningStats& GetStats() const { return stats; }
+	void ResetStats() { stats = FUbermundoDeadReckoningStats(); }
+	void ForgetPeer(uint64 peer);
+
+private:
+	struct FSent {
+		FVector location;
+		FVector velocity;
+		FQuat rotation;
+		int32 timestampMs;
+		double sentAt;
+	};
+
+	FUbermundoDeadReckoningSettings settings;
+	FUbermundoDeadReckoningStats stats;
+	TMap<uint64, FSent> lastSent;
+};
+
+/**
+ * Blueprint access to send on change.
+ */
+UCLASS()
+class UBERMUNDOPROTOPLUGIN_API UUbermundoDeadReckoningLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Interest", meta = (ToolTip = "How far off the remote players' prediction of us may get before a new state is sent, and the heartbeat."))
+		static void SetDeadReckoningSettings(const FUbermundoDeadReckoningSettings& settings);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Diagnostics", meta = (ToolTip = "How many due Player3DStates were sent and how many were not needed."))
+		static void GetDeadReckoningStats(FUbermundoDeadReckoningStats& stats);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Diagnostics")
+		static void ResetDeadReckoningStats();
+};
@@ -0,0 +1,88 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// Friends list, fetched from Steam once and then kept up to date.
+// GetFriendCount, GetFriendByIndex, GetFriendPersonalName and GetFriendPersonaState each go into
+// Steam, and a friends panel calls them for every friend on every refresh. The cache instead reads
+// the whole list once into one array of structs. After that, only the entry a PersonaStateChange_t
+// callback names is read again. Every change bumps a version number, so the UI can ask for the
+// whole list and its version in one call and only rebuild when the version moved.
+// Steam callbacks can run on the network thread (see UbermundoNetThread.h), so the cache is locked.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "SteamCustomCode.h"
+#include "UbermundoFriendsCache.generated.h"
+
+USTRUCT(BlueprintType)
+struct FUbermundoFriend
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoFriend() : SteamId(0), PersonaState(EPersonaStateOfflineUM), InGame(false), InThisGame(false) {}
+
+	UPROPERTY(BlueprintReadOnly)
+		int64 SteamId;
+	UPROPERTY(BlueprintReadOnly)
+		FString Name;
+	UPROPERTY(BlueprintReadOnly)
+		TEnumAsByte<EPersonaStateUM> PersonaState;
+	/** Playing any game. */
+	UPROPERTY(BlueprintReadOnly)
+		bool InGame;
+	/** Playing this one. */
+	UPROPERTY(BlueprintReadOnly)
+		bool InThisGame;
+};
+
+class UBERMUNDOPROTOPLUGIN_API FUbermundoFriendsCache {
+public:
+	static FUbermundoFriendsCache& Get();
+
+	/** Which friends are cached. Immediate, i.e. regular friends, unless set. Refetches on the next Snapshot. */
+	void SetFlags(int32 friendFlags);
+	/** Fetch the whole list again on the next Snapshot. */
+	void Invalidate();
+	/** Any thread. Only names a user, the entry is read again on the next Snapshot. */
+	void OnPersonaStateChange(uint64 steamId, int32 changeFlags);
+
+	/** Game thread. Brings the cache up to date, and copies it into out only if its version is not sinceVersion. */
+	bool Snapshot(int32 sinceVersion, TArray<FUbermundoFriend>& out, int32& version);
+	int32 GetVersion() const;
+	/** Steam shut down. */
+	void Reset();
+
+private:
+	static void Read(uint64 steamId, FUbermundoFriend& out);
+	void Refetch();
+	void ApplyChanges();
+
+	mutable FCriticalSection lock;
+	TArray<FUbermundoFriend> friends;
+	TMap<uint64, int32> indexOf;
+	/** Users named by PersonaStateChange_t since the last Snapshot. */
+	TSet<uint64> changed;
+	int32 flags = EFriendFlagImmediateUM;
+	int32 version = 0;
+	bool stale = true;
+};
+
+/**
+ * Blueprint access to the friends cache.
+ */
+UCLASS()
+class UBERMUNDOPROTOPLUGIN_API UUbermundoFriendsCacheLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Friends", meta = (ToolTip = "The whole cached friends list and its version. Pass the version from the last call as Since Version: if nothing changed, Changed is false and Friends is left alone. Pass -1 to always get the list."))
+		static void GetFriendsSnapshot(int32 sinceVersion, TArray<FUbermundoFriend>& friends, int32& version, bool& changed);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Friends", meta = (ToolTip = "Goes up every time the cached friends list changes."))
+		static int32 GetFriendsCacheVersion();
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Friends", meta = (ToolTip = "Which friends the cache holds, Immediate (regular friends) by default. The list is fetched again."))
+		static void SetFriendsCacheFlags(EFriendFlagsUM friendFlags);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Friends", meta = (ToolTip = "Fetch the whole friends list from Steam again on the next Get Friends Snapshot."))
+		static void RefreshFriendsCache();
+};
@@ -0,0 +1,195 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// Image chat messages that show up at once and get sharper as they arrive.
+// Sending one used to mean one reliable blob, and the other player saw nothing, and got nothing
+// else over the reliable channel either, until its last byte was in. Now the image is decoded
+// (PNG, JPEG, BMP... whatever ImageWrapper knows), scaled to fit MaxSize, and cut into tiles on a
+// worker thread. What goes out is:
+//   P2P_PlayerImageMsg  - the image's size and tiling, and a thumbnail of a few hundred bytes, in one
+//                         reliable datagram. Game code gets it from the inbox as before, so a chat
+//                         line can go up straight away, one round trip after the send.
+//   P2P_PlayerImageTile - each tile as a coarse JPEG, then each again as a fine one, as bulk
+//                         transfers of a bundle of tiles, UBERMUNDO_IMAGE_BATCH_BYTES or so each.
+//                         They wait their turn behind game traffic and the rate controller's
+//                         budget like any bulk, so a big image never hogs the link.
+// The receiver decodes on a worker too. Its texture starts as the thumbnail stretched to full
+// size, and each tile is written over it as it comes in, a fine tile never being overwritten by a
+// coarse one that arrived late. Only texture creation and the region uploads are game thread work.
+// What one sender's images may take up is capped: past UBERMUNDO_IMAGE_MAX_SENDER_BYTES their oldest
+// images are let go of, and nothing bigger than UBERMUNDO_IMAGE_MAX_SIZE is ever decoded.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "UObject/GCObject.h"
+#include "Containers/Queue.h"
+#include "UbermundoImageMessages.generated.h"
+
+class UTexture2D;
+
+/** Neither side of an image may be bigger, whatever the sender's settings. 4 MB of pixels at most. */
+#define UBERMUNDO_IMAGE_MAX_SIZE 1024
+/** Most bytes of thumbnail, so the whole P2P_PlayerImageMsg fits one datagram. */
+#define UBERMUNDO_IMAGE_MAX_THUMBNAIL 1000
+/** P2P_PlayerImageMsg before the thumbnail: code, image id, width, height, tile size, passes. */
+#define UBERMUNDO_IMAGE_HEADER (1 + 4 + 2 + 2 + 2 + 1)
+/** P2P_PlayerImageTile before the JPEG: code, image id, tile x, tile y, pass. */
+#define UBERMUNDO_IMAGE_TILE_HEADER (1 + 4 + 1 + 1 + 1)
+/** Pass of the thumbnail in a decode, tiles count up from 0. */
+#define UBERMUNDO_IMAGE_THUMBNAIL_PASS 0xFF
+/** Roughly the bytes of tiles of one pass sent as one bulk transfer. */
+#define UBERMUNDO_IMAGE_BATCH_BYTES (32 * 1024)
+/** Received images kept per sender. Past this that sender's oldest are let go of. */
+#define UBERMUNDO_IMAGE_KEEP 32
+/** Most pixel bytes one sender's received images, and tiles waiting for their thumbnail, may hold. */
+#define UBERMUNDO_IMAGE_MAX_SENDER_BYTES (16 * 1024 * 1024)
+
+USTRUCT(BlueprintType)
+struct FUbermundoImageSettings
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoImageSettings() :
+		MaxSize(1024),
+		ThumbnailSize(32),
+		TileSize(128),
+		CoarseQuality(30),
+		FineQuality(85) {
+	}
+
+	/** Longest side sent. Bigger images are scaled down first. At most UBERMUNDO_IMAGE_MAX_SIZE. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 MaxSize;
+	/** Longest side of the thumbnail. Made smaller still if it will not fit UBERMUNDO_IMAGE_MAX_THUMBNAIL. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 ThumbnailSize;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 TileSize;
+	/** JPEG quality of the first pass over the tiles. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 CoarseQuality;
+	/** JPEG quality of the second pass. No second pass if this is not above CoarseQuality. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 FineQuality;
+};
+
+class UBERMUNDOPROTOPLUGIN_API FUbermundoImageMessages : public FGCObject {
+public:
+	static FUbermundoImageMessages& Get();
+
+	void SetSettings(const FUbermundoImageSettings& s) { settings = s; }
+	const FUbermundoImageSettings& GetSettings() const { return settings; }
+
+	/** Encode imageFile on a worker and send it to peers once it is done. Returns the image id, 0 if there is nothing to send. */
+	uint32 Send(TArrayView<const uint64> peers, TArrayView<const uint8> imageFile);
+
+	/** Send what the workers have finished, and put what they decoded into textures. A net tick, see FUbermundoNetTick. */
+	void Tick(double now);
+
+	/** A P2P_PlayerImageMsg or P2P_PlayerImageTile from sender. True if it was a tile, which game code has no use for. */
+	bool HandlePacket(uint64 sender, const uint8* data, int32 numBytes);
+	/** The header of a P2P_PlayerImageMsg. */
+	static bool DecodeHeader(const uint8* data, int32 numBytes, uint32& id, int32& width, int32& height);
+
+	/** The image as far as it has got, nullptr until the thumbnail is decoded. progress is 0 to 1, -1 if there is no such image. */
+	UTexture2D* Find(uint64 sender, uint32 id, float& progress) const;
+	/** Bumped each time a received image gets its texture or a tile. */
+	int32 GetVersion() const { return version; }
+
+	/** Drop every received image. Decodes still running are ignored when they finish. */
+	void Reset();
+
+	// FGCObject
+	virtual void AddReferencedObjects(FReferenceCollector& collector) override;
+	virtual FString GetReferencerName() const override { return TEXT("FUbermundoImageMessages"); }
+
+private:
+	/** What a worker made of an image to send. */
+	struct FEncoded {
+		uint32 id = 0;
+		TArray<uint64> peers;
+		/** The P2P_PlayerImageMsg, empty if the image could not be read. */
+		TArray<uint8> header;
+		/** Bulk payloads, each a UBERMUNDOPC_P2P_Bundle of one pass's P2P_PlayerImageTiles, coarse pass first.
+			A tile too big for a bundle goes on its own. */
+		TArray<TArray<uint8>> batches;
+	};
+
+	/** What a worker made of a received thumbnail or tile. */
+	struct FDecoded {
+		uint64 sender = 0;
+		uint32 id = 0;
+		uint32 generation = 0;
+		/** UBERMUNDO_IMAGE_THUMBNAIL_PASS for the thumbnail, already stretched to the image's size. */
+		uint8 pass = 0;
+		int32 x = 0;
+		int32 y = 0;
+		int32 width = 0;
+		int32 height = 0;
+		/** B8G8R8A8, empty if it would not decode. */
+		TArray<uint8> pixels;
+	};
+
+	struct FReceived {
+		uint64 sender = 0;
+		int32 width = 0;
+		int32 height = 0;
+		int32 tileSize = 0;
+		int32 numPasses = 0;
+		int32 numTiles = 0;
+		/** Passes shown, summed over the tiles. Done at numTiles * numPasses. */
+		int32 numShown = 0;
+		UTexture2D* texture = nullptr;
+		/** Best pass shown per tile, by x | y << 8. */
+		TMap<uint16, uint8> shown;
+		/** Tiles decoded before the thumbnail was, or before the header came. */
+		TArray<FDecoded> waiting;
+		double receivedAt = 0.0;
+	};
+
+	static uint64 KeyOf(uint64 sender, uint32 id) { return (sender << 32) ^ id; }
+	void SendEncoded(const FEncoded& e);
+	void Decode(uint64 sender, uint32 id, uint8 pass, int32 x, int32 y, int32 width, int32 height, TArrayView<const uint8> jpeg);
+	void ShowThumbnail(FReceived& r, const FDecoded& d);
+	void ShowTile(FReceived& r, const FDecoded& d);
+	void DropOldest(uint64 sender);
+	/** Pixel bytes r holds or will hold. */
+	static int64 BytesOf(const FReceived& r);
+	/** Let go of sender's oldest images, not keep, until numBytes more fit under UBERMUNDO_IMAGE_MAX_SENDER_BYTES.
+		False if they still do not. */
+	bool MakeRoom(uint64 sender, int64 numBytes, uint64 keep);
+
+	FUbermundoImageSettings settings;
+	uint32 lastId = 0;
+	typedef TQueue<FEncoded, EQueueMode::Mpsc> FEncodedQueue;
+	typedef TQueue<FDecoded, EQueueMode::Mpsc> FDecodedQueue;
+	/** Workers hold these weakly, so one finishing after we are gone drops its result. */
+	TSharedRef<FEncodedQueue, ESPMode::ThreadSafe> encoded = MakeShared<FEncodedQueue, ESPMode::ThreadSafe>();
+
+	TMap<uint64, FReceived> received;
+	TSharedRef<FDecodedQueue, ESPMode::ThreadSafe> decoded = MakeShared<FDecodedQueue, ESPMode::ThreadSafe>();
+	int32 version = 0;
+	uint32 generation = 0;
+};
+
+/**
+ * Blueprint access to image messages.
+ */
+UCLASS()
+class UBERMUNDOPROTOPLUGIN_API UUbermundoImageMessageLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|P2P", meta = (ToolTip = "Send an image file (PNG, JPEG...) to players as a thumbnail first, then tiles that get sharper. Returns the image id, 0 if the file is empty."))
+		static int64 SendP2PImage(const TArray<int64>& peers, const TArray<uint8>& imageFile);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|P2P", meta = (ToolTip = "Read a P2P_PlayerImageMsg from the inbox. Pass the sender and image id to Get P2P Image."))
+		static bool DecodeP2PImageMsg(const TArray<uint8>& message, int64& imageId, int32& width, int32& height);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|P2P", meta = (ToolTip = "A received image as far as it has got. Placeholder until its thumbnail is in. Progress is 0 to 1, ask again once Get P2P Image Version changes."))
+		static UTexture2D* GetP2PImage(int64 sender, int64 imageId, UTexture2D* placeholder, float& progress);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|P2P", meta = (ToolTip = "Changes every time a received image gets sharper."))
+		static int32 GetP2PImageVersion();
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|P2P", meta = (ToolTip = "Size, tiling and JPEG quality of images sent from now on."))
+		static void SetP2PImageSettings(const FUbermundoImageSettings& settings);
+};
@@ -0,0 +1,140 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// Interest management for the local player's state updates.
+// Each remote player gets our Player3DState at a rate that depends on how much they care:
+// full rate when close or recently interacting with us (grab, chat), a fraction of it with
+// distance and when we are behind them, and only a heartbeat when out of range. The base rate is
+// scaled by the world's FWorldDefinitionStruct::PlayerUpdateFactor, and per peer by the rate
+// controller when the link to them can't take it.
+// Peers are kept in a heap ordered by when they are next due, so a tick only touches the peers
+// that actually get a send, not every peer in the world. A due peer is then only sent a state if
+// FUbermundoDeadReckoning says their prediction of us needs one.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "WorldDefinitionStruct.h"
+#include "UbermundoSnapshotCodec.h"
+#include "UbermundoInterest.generated.h"
+
+USTRUCT(BlueprintType)
+struct FUbermundoInterestSettings
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoInterestSettings() :
+		FullRateHz(20.0f),
+		HeartbeatHz(1.0f),
+		FullRateDistance(2000.0f),
+		MaxDistance(20000.0f),
+		MinFraction(0.1f),
+		ViewConeDegrees(70.0f),
+		OutOfViewFactor(0.5f),
+		InteractionSeconds(5.0f) {
+	}
+
+	/** Sends per second to a nearby player, before PlayerUpdateFactor. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float FullRateHz;
+	/** Sends per second to a player out of range. Keeps the P2P session and their player list alive. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float HeartbeatHz;
+	/** Closer than this (cm) gets the full rate. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float FullRateDistance;
+	/** Further than this (cm) only gets heartbeats. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float MaxDistance;
+	/** Lowest fraction of the full rate for someone in range. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float MinFraction;
+	/** Half angle of the remote player's view cone. Outside it they probably can't see us. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float ViewConeDegrees;
+	/** Rate multiplier when we are outside their view cone. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float OutOfViewFactor;
+	/** How long a grab or chat with a player keeps them at full rate. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float InteractionSeconds;
+};
+
+class UBERMUNDOPROTOPLUGIN_API FUbermundoInterestManager {
+public:
+	static FUbermundoInterestManager& Get();
+
+	void SetSettings(const FUbermundoInterestSettings& s) { settings = s; }
+	const FUbermundoInterestSettings& GetSettings() const { return settings; }
+	void SetPlayerUpdateFactor(float f) { playerUpdateFactor = FMath::Max(f, 0.01f); }
+
+	void SetLocalLocation(const FVector& location) { localLocation = location; }
+	/** Where a remote player is and which way they face. Adds them if new. */
+	void UpdatePeer(uint64 peer, const FVector& location, const FRotator& rotation, double now);
+	/** A grab, release, chat etc. with this player. Puts them at full rate right away. */
+	void NoteInteraction(uint64 peer, double now);
+	void RemovePeer(uint64 peer);
+
+	/** Peers due a state update at now. Only due peers are looked at. */
+	void CollectDuePeers(double now, TArray<uint64>& outPeers);
+	/** Queue state for the due peers whose prediction of us needs it. Returns how many got one. */
+	int32 SendStateToDuePeers(const FUbermundoPlayer3DState& state, double now);
+	/** Current sends per second to peer, 0 if unknown. */
+	float GetRateHz(uint64 peer) const;
+	int32 NumPeers() const { return peers.Num(); }
+
+private:
+	struct FPeer {
+		FVector location = FVector::ZeroVector;
+		FVector forward = FVector::ForwardVector;
+		double lastInteraction = -1.0e9;
+		float rateHz = 0.0f;
+		/** Its latest heap entry's, so older ones for it can be told apart and skipped. */
+		uint32 generation = 0;
+	};
+
+	struct FDue {
+		double time;
+		uint64 peer;
+		uint32 generation;
+		bool operator<(const FDue& o) const { return time < o.time; }
+	};
+
+	float ComputeRateHz(uint64 peer, const FPeer& p, double now) const;
+	void Schedule(uint64 peer, FPeer& p, double when);
+
+	FUbermundoInterestSettings settings;
+	float playerUpdateFactor = 1.0f;
+	FVector localLocation = FVector::ZeroVector;
+	TMap<uint64, FPeer> peers;
+	TArray<FDue> heap;
+	/** Shared by all peers and never reset, so a peer removed and added again can't match its old heap entries. */
+	uint32 nextGeneration = 0;
+	/** SendStateToDuePeers' due list, kept to reuse its memory. */
+	TArray<uint64> due;
+};
+
+/**
+ * Blueprint access to interest management.
+ */
+UCLASS()
+class UBERMUNDOPROTOPLUGIN_API UUbermundoInterestLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Interest")
+		static void SetInterestSettings(const FUbermundoInterestSettings& settings);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Interest", meta = (ToolTip = "Use the world's PlayerUpdateFactor to scale all update rates."))
+		static void SetInterestWorld(const FWorldDefinitionStruct& world);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Interest", meta = (ToolTip = "Where a remote player is and which way they face, usually from their decoded Player3DState."))
+		static void UpdateRemotePlayerView(int64 peer, FVector location, FRotator rotation);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Interest", meta = (ToolTip = "A grab, release or chat with this player. Keeps them at full update rate for a while."))
+		static void NoteRemotePlayerInteraction(int64 peer);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Interest")
+		static void RemoveRemotePlayer(int64 peer);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Interest", meta = (ToolTip = "Current Player3DState sends per second to this player."))
+		static float GetRemotePlayerUpdateRate(int64 peer);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Interest", meta = (ToolTip = "Send the local player's state to just the players due an update this tick. Returns how many got one."))
+		static int32 SendPlayer3DStateToDuePeers(const FUbermundoPlayer3DState& state);
+};
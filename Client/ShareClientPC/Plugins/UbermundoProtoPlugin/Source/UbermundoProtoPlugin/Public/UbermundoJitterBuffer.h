@@ -0,0 +1,160 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// Smooth playback of remote players' Player3DStates.
+// Decoded states are put in a small buffer per remote player, ordered by the sender's timestamp,
+// not by when they happened to be read. Each frame every remote player is shown where they were a
+// playout delay ago on their own clock, interpolated between the two states either side of that
+// time with a cubic Hermite curve through both positions and velocities, and rotations slerped.
+// The delay adapts per player: one send interval plus a multiple of the measured jitter (how much
+// later than its fastest packet each one arrives), so a steady link plays close to live and a bad one
+// buys itself more slack. It grows straight away when a state arrives too late to be used and shrinks
+// slowly, so playback never visibly jumps back in time.
+// When the next state has not arrived yet (loss, or a stall) the player is dead reckoned from their
+// last velocity, for at most MaxExtrapolationMs, then held still.
+// All remote players are evaluated in one pass over a flat array, and the results are left in a
+// second flat array the game reads from.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "UbermundoSnapshotCodec.h"
+#include "UbermundoJitterBuffer.generated.h"
+
+/** States kept per remote player. At 20 Hz that is most of a second, more than any sane playout delay. */
+#define UBERMUNDO_JITTER_SNAPSHOTS 16
+
+USTRUCT(BlueprintType)
+struct FUbermundoJitterSettings
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoJitterSettings() :
+		MinDelayMs(20.0f),
+		MaxDelayMs(400.0f),
+		JitterMultiplier(2.5f),
+		MaxExtrapolationMs(250.0f),
+		ShrinkMsPerSecond(10.0f) {
+	}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float MinDelayMs;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float MaxDelayMs;
+	/** Playout delay is one send interval plus this many times the jitter. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float JitterMultiplier;
+	/** How far past the newest state a player is dead reckoned before being held still. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float MaxExtrapolationMs;
+	/** How fast the playout delay may come down when the link calms down. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float ShrinkMsPerSecond;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoJitterStats
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoJitterStats() : DelayMs(0.0f), JitterMs(0.0f), IntervalMs(0.0f), NumBuffered(0), NumLate(0), NumExtrapolated(0) {}
+
+	UPROPERTY(BlueprintReadOnly)
+		float DelayMs;
+	UPROPERTY(BlueprintReadOnly)
+		float JitterMs;
+	/** Time between their states, on their clock. */
+	UPROPERTY(BlueprintReadOnly)
+		float IntervalMs;
+	UPROPERTY(BlueprintReadOnly)
+		int32 NumBuffered;
+	/** States that came after their time had already been played. */
+	UPROPERTY(BlueprintReadOnly)
+		int32 NumLate;
+	/** Frames this player was dead reckoned. */
+	UPROPERTY(BlueprintReadOnly)
+		int32 NumExtrapolated;
+};
+
+class UBERMUNDOPROTOPLUGIN_API FUbermundoJitterBuffer {
+public:
+	static FUbermundoJitterBuffer& Get();
+
+	void SetSettings(const FUbermundoJitterSettings& s) { settings = s; }
+	const FUbermundoJitterSettings& GetSettings() const { return settings; }
+
+	/** A decoded state from sender that arrived at now, FPlatformTime::Seconds. */
+	void Push(uint64 sender, const FUbermundoPlayer3DState& state, double now);
+
+	/** Work out where every remote player is to be shown at now. Once per frame. */
+	void Evaluate(double now);
+	/** Results of the last Evaluate, one per remote player, in the same order. */
+	const TArray<uint64>& GetPeers() const { return peers; }
+	const TArray<FTransform>& GetTransforms() const { return transforms; }
+	bool GetTransform(uint64 peer, FTransform& out, bool& extrapolating) const;
+
+	bool GetStats(uint64 peer, FUbermundoJitterStats& out) const;
+	void ForgetPeer(uint64 peer);
+
+private:
+	struct FSnapshot {
+		/** Sender's clock, milliseconds, unwrapped. */
+		double time;
+		FVector location;
+		FVector velocity;
+		FQuat rotation;
+	};
+
+	struct FRemote {
+		/** Oldest first. */
+		FSnapshot snapshots[UBERMUNDO_JITTER_SNAPSHOTS];
+		int32 numSnapshots = 0;
+		int32 lastTimestampMs = 0;
+		double lastTime = 0.0;
+
+		/** Our clock minus theirs for the quickest packet lately, milliseconds. */
+		double minOffset = 0.0;
+		double jitter = 0.0;
+		double interval = 50.0;
+		double delay = 100.0;
+		/** Sender time last played, nothing older than this is any use. */
+		double playedTime = 0.0;
+		bool any = false;
+		bool extrapolating = false;
+
+		int32 numLate = 0;
+		int32 numExtrapolated = 0;
+	};
+
+	void Insert(FRemote& r, const FSnapshot& s);
+	void EvaluateRemote(FRemote& r, FTransform& out, double nowMs, double dt);
+
+	FUbermundoJitterSettings settings;
+	double lastEvaluate = 0.0;
+	/** Parallel arrays, the same index in each is the same remote player. */
+	TArray<uint64> peers;
+	TArray<FRemote> remotes;
+	TArray<FTransform> transforms;
+	TMap<uint64, int32> indexOf;
+};
+
+/**
+ * Blueprint access to the remote player jitter buffer.
+ */
+UCLASS()
+class UBERMUNDOPROTOPLUGIN_API UUbermundoJitterBufferLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Snapshot")
+		static void SetJitterBufferSettings(const FUbermundoJitterSettings& settings);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Snapshot", meta = (ToolTip = "Add a remote player's state by hand. Decode Player3DState already does this."))
+		static void PushRemotePlayer3DState(int64 sender, const FUbermundoPlayer3DState& state);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Snapshot", meta = (ToolTip = "Where every remote player should be drawn this frame, smoothed over network jitter. Call once per frame and apply each transform to that peer's avatar."))
+		static void EvaluateRemotePlayers(TArray<int64>& peers, TArray<FTransform>& transforms);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Snapshot", meta = (ToolTip = "One remote player's transform from the last Evaluate Remote Players. Extrapolating is true while their states are late and they are being dead reckoned."))
+		static bool GetRemotePlayerTransform(int64 peer, FTransform& transform, bool& extrapolating);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Snapshot")
+		static bool GetJitterBufferStats(int64 peer, FUbermundoJitterStats& stats);
+};
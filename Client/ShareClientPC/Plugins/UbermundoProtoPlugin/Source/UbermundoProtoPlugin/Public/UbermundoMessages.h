@@ -0,0 +1,1305 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// Generated by Tools/gen_message_codecs.py from Tools/ubermundo_messages.schema. Do not edit, change the schema and run it again.
+// The codec of every packet. For each message there are two structs:
+//   FUbermundo<Name>Wire  native. Encode and Decode allocate nothing: strings, byte arrays and lists of
+//                         a decoded message point into the packet, which has to outlive it.
+//   FUbermundo<Name>Msg   for Blueprints, with Encode<Name> and Decode<Name> in UUbermundoMessageLibrary.
+// Server messages have UberMundoEventCode's codes, which are not EUbermundoPacketCodes' DB codes.
+// UUbermundoNetBenchmarks::BenchmarkMessageCodecs measures both against FUbermundoPacketBuilder.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "UbermundoWire.h"
+#include "UbermundoMessages.generated.h"
+
+/** A player in an announce, as the server keeps them. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoAnnouncedPlayerWire {
+	int32 UbermundoId = 0;
+	uint64 SteamId = 0;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** A world's metadata, as WorldData.WriteData on the server writes it. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoWorldMetadataWire {
+	int32 WorldId = 0;
+	/** UTF8. */
+	TArrayView<const uint8> WorldName;
+	int32 OwningPlayerId = 0;
+	/** 0 to 100. */
+	uint8 WotToSee = 0;
+	int32 WorldVersion = 0;
+	/** How often P2P position updates go out, times 0.1 seconds. */
+	float PlayerUpdateIntervalFactor = 0.0f;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoBlockChunkHashWire {
+	/** 20 bytes. */
+	TArrayView<const uint8> Sha1;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/**
+ * The first message on a connection. The server answers with S2PYourUbermundoID.
+ * Code 6, player to server.
+ */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoP2SPlayerAnnounce_SteamWire : public TUbermundoWireMessage<FUbermundoP2SPlayerAnnounce_SteamWire, 6> {
+	uint64 SteamId = 0;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/**
+ * Where the player is, every few seconds. Also keeps the connection alive.
+ * Code 2, player to server.
+ */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoP2SPlayerUpdateWire : public TUbermundoWireMessage<FUbermundoP2SPlayerUpdateWire, 2> {
+	int32 WorldId = 0;
+	/** Decameters, 10 m per unit. */
+	int16 X = 0;
+	int16 Y = 0;
+	int16 Z = 0;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 3, player to server. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoP2SLeavingGameWire : public TUbermundoWireMessage<FUbermundoP2SLeavingGameWire, 3> {
+	int32 UbermundoId = 0;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 30, player to server. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoP2SRequestLevelDataWire : public TUbermundoWireMessage<FUbermundoP2SRequestLevelDataWire, 30> {
+	int32 WorldId = 0;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 32, player to server. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoP2SSaveLevelDataWire : public TUbermundoWireMessage<FUbermundoP2SSaveLevelDataWire, 32> {
+	FUbermundoWorldMetadataWire Metadata;
+	TArrayView<const uint8> Contents;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/**
+ * Only WorldName, WotToSee, WorldVersion and PlayerUpdateIntervalFactor of Metadata are used.
+ * Code 33, player to server.
+ */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoP2SCreateNewWorldWire : public TUbermundoWireMessage<FUbermundoP2SCreateNewWorldWire, 33> {
+	FUbermundoWorldMetadataWire Metadata;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 40, player to server. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoP2SRequestLevelMetadataWire : public TUbermundoWireMessage<FUbermundoP2SRequestLevelMetadataWire, 40> {
+	int32 WorldId = 0;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 43, player to server. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoP2SRequestAllLevelMetasWire : public TUbermundoWireMessage<FUbermundoP2SRequestAllLevelMetasWire, 43> {
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/**
+ * Not implemented on the server yet.
+ * Code 50, player to server.
+ */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoP2SAddThingWire : public TUbermundoWireMessage<FUbermundoP2SAddThingWire, 50> {
+	/** UTF8. */
+	TArrayView<const uint8> AssetPath;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/**
+ * Not implemented on the server yet.
+ * Code 51, player to server.
+ */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoP2SRemoveThingWire : public TUbermundoWireMessage<FUbermundoP2SRemoveThingWire, 51> {
+	int32 ThingId = 0;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 52, player to server. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoP2SGetNextObjectIDWire : public TUbermundoWireMessage<FUbermundoP2SGetNextObjectIDWire, 52> {
+	int32 WorldId = 0;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 1, server to player. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoS2PYourUbermundoIDWire : public TUbermundoWireMessage<FUbermundoS2PYourUbermundoIDWire, 1> {
+	int32 UbermundoId = 0;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 4, server to player. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoS2PPlayerLeftLevelWire : public TUbermundoWireMessage<FUbermundoS2PPlayerLeftLevelWire, 4> {
+	int32 UbermundoId = 0;
+	uint64 SteamId = 0;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 5, server to player. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoS2PPlayerEnteredLevelWire : public TUbermundoWireMessage<FUbermundoS2PPlayerEnteredLevelWire, 5> {
+	int32 UbermundoId = 0;
+	uint64 SteamId = 0;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/**
+ * Everyone else in the world the player is in.
+ * Code 10, server to player.
+ */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoS2PAnnouncePlayersToClient_SteamWire : public TUbermundoWireMessage<FUbermundoS2PAnnouncePlayersToClient_SteamWire, 10> {
+	TUbermundoWireList<FUbermundoAnnouncedPlayerWire> Players;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/**
+ * Answer to P2SRequestLevelData. All zero metadata and no contents if there is no such world.
+ * Code 31, server to player.
+ */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoS2PLevelDataWire : public TUbermundoWireMessage<FUbermundoS2PLevelDataWire, 31> {
+	FUbermundoWorldMetadataWire Metadata;
+	TArrayView<const uint8> Contents;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 34, server to player. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoS2PWorldCreatedWire : public TUbermundoWireMessage<FUbermundoS2PWorldCreatedWire, 34> {
+	int32 WorldId = 0;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/**
+ * Answer to P2SRequestLevelMetadata. All zero if there is no such world.
+ * Code 42, server to player.
+ */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoS2PLevelMetadataWire : public TUbermundoWireMessage<FUbermundoS2PLevelMetadataWire, 42> {
+	FUbermundoWorldMetadataWire Metadata;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 44, server to player. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoS2PAllLevelMetadataWire : public TUbermundoWireMessage<FUbermundoS2PAllLevelMetadataWire, 44> {
+	TUbermundoWireList<FUbermundoWorldMetadataWire> Worlds;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/**
+ * 0 if there is no such world.
+ * Code 53, server to player.
+ */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoS2PNextObjectIDWire : public TUbermundoWireMessage<FUbermundoS2PNextObjectIDWire, 53> {
+	int32 ObjectId = 0;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 200, server to player. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoS2PAnnouncementMsgWire : public TUbermundoWireMessage<FUbermundoS2PAnnouncementMsgWire, 200> {
+	/** UTF8. */
+	TArrayView<const uint8> Message;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/**
+ * Packed by the outbox, each message a 1 or 2 byte length then the message.
+ * Code 101, player to player.
+ */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoBundleWire : public TUbermundoWireMessage<FUbermundoBundleWire, 101> {
+	TArrayView<const uint8> Messages;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/**
+ * See FUbermundoSnapshotCodec.
+ * Code 102, player to player.
+ */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoPlayer3DStateWire : public TUbermundoWireMessage<FUbermundoPlayer3DStateWire, 102> {
+	uint16 Sequence = 0;
+	/** 0 for a full snapshot, else the baseline is Sequence minus this. */
+	uint8 BaselineOffset = 0;
+	/** The bit packed delta. */
+	TArrayView<const uint8> Bits;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/**
+ * Layout is still the game's own.
+ * Code 103, player to player.
+ */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoPlayerGrabbedWire : public TUbermundoWireMessage<FUbermundoPlayerGrabbedWire, 103> {
+	TArrayView<const uint8> Payload;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/**
+ * Layout is still the game's own.
+ * Code 104, player to player.
+ */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoPlayerReleasedWire : public TUbermundoWireMessage<FUbermundoPlayerReleasedWire, 104> {
+	TArrayView<const uint8> Payload;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 105, player to player. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoPlayer3DStateAckWire : public TUbermundoWireMessage<FUbermundoPlayer3DStateAckWire, 105> {
+	uint16 Sequence = 0;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 106, player to player. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoClockPingWire : public TUbermundoWireMessage<FUbermundoClockPingWire, 106> {
+	/** Sender's clock. */
+	uint64 SentMicros = 0;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 107, player to player. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoClockPongWire : public TUbermundoWireMessage<FUbermundoClockPongWire, 107> {
+	uint64 PingSentMicros = 0;
+	/** Answerer's clock when the ping came in. */
+	uint64 ArrivedMicros = 0;
+	/** Answerer's clock when this went out. */
+	uint64 SentMicros = 0;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 108, player to player. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoSessionPingWire : public TUbermundoWireMessage<FUbermundoSessionPingWire, 108> {
+	/** 0 ping, 1 answer. */
+	uint8 Kind = 0;
+	/** The pinger's clock, echoed back in the answer. */
+	uint64 Micros = 0;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 110, player to player. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoBulkChunkWire : public TUbermundoWireMessage<FUbermundoBulkChunkWire, 110> {
+	uint32 TransferId = 0;
+	uint32 TotalSize = 0;
+	uint16 Index = 0;
+	TArrayView<const uint8> Bytes;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 111, player to player. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoBulkAckWire : public TUbermundoWireMessage<FUbermundoBulkAckWire, 111> {
+	uint32 TransferId = 0;
+	/** Chunks received in order. */
+	uint16 InOrder = 0;
+	/** One bit per chunk after those, lowest bit first. */
+	TArrayView<const uint8> Bitmap;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 120, player to player. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoPlayerTextMsgWire : public TUbermundoWireMessage<FUbermundoPlayerTextMsgWire, 120> {
+	/** UTF8. */
+	TArrayView<const uint8> Text;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/**
+ * Followed by PlayerImageTiles, see FUbermundoImageMessages.
+ * Code 121, player to player.
+ */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoPlayerImageMsgWire : public TUbermundoWireMessage<FUbermundoPlayerImageMsgWire, 121> {
+	uint32 ImageId = 0;
+	uint16 Width = 0;
+	uint16 Height = 0;
+	uint16 TileSize = 0;
+	uint8 NumPasses = 0;
+	/** JPEG. */
+	TArrayView<const uint8> Thumbnail;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 122, player to player. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoPlayerVoiceMsgWire : public TUbermundoWireMessage<FUbermundoPlayerVoiceMsgWire, 122> {
+	uint16 Sequence = 0;
+	/** Shared clock, ms. */
+	uint32 CapturedMs = 0;
+	TArrayView<const uint8> Opus;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/**
+ * Layout is still the game's own.
+ * Code 123, player to player.
+ */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoPlayerEmoteMsgWire : public TUbermundoWireMessage<FUbermundoPlayerEmoteMsgWire, 123> {
+	TArrayView<const uint8> Payload;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 124, player to player. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoPlayerImageTileWire : public TUbermundoWireMessage<FUbermundoPlayerImageTileWire, 124> {
+	uint32 ImageId = 0;
+	uint8 TileX = 0;
+	uint8 TileY = 0;
+	uint8 Pass = 0;
+	/** JPEG. */
+	TArrayView<const uint8> Tile;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 130, player to player. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoBlockWantWire : public TUbermundoWireMessage<FUbermundoBlockWantWire, 130> {
+	uint64 BlockId = 0;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 131, player to player. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoBlockHaveWire : public TUbermundoWireMessage<FUbermundoBlockHaveWire, 131> {
+	uint64 BlockId = 0;
+	uint32 Version = 0;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 132, player to player. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoBlockManifestRequestWire : public TUbermundoWireMessage<FUbermundoBlockManifestRequestWire, 132> {
+	uint64 BlockId = 0;
+	uint32 Nonce = 0;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 133, player to player. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoBlockManifestWire : public TUbermundoWireMessage<FUbermundoBlockManifestWire, 133> {
+	uint64 BlockId = 0;
+	uint32 BlockSize = 0;
+	/** 20 bytes. */
+	TArrayView<const uint8> Sha1;
+	TUbermundoWireList<FUbermundoBlockChunkHashWire> Chunks;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 134, player to player. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoBlockChunkRequestWire : public TUbermundoWireMessage<FUbermundoBlockChunkRequestWire, 134> {
+	uint64 BlockId = 0;
+	TUbermundoWireList<uint16> Chunks;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 135, player to player. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoBlockChunkWire : public TUbermundoWireMessage<FUbermundoBlockChunkWire, 135> {
+	uint64 BlockId = 0;
+	uint16 Index = 0;
+	TArrayView<const uint8> Bytes;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** Code 136, player to player. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoBlockMissingWire : public TUbermundoWireMessage<FUbermundoBlockMissingWire, 136> {
+	uint64 BlockId = 0;
+
+	void Write(FUbermundoWireWriter& w) const;
+	bool Read(FUbermundoWireReader& r);
+};
+
+/** A player in an announce, as the server keeps them. */
+USTRUCT(BlueprintType)
+struct FUbermundoAnnouncedPlayerMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoAnnouncedPlayerMsg() : UbermundoId(0), SteamId(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 UbermundoId;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int64 SteamId;
+};
+
+/** A world's metadata, as WorldData.WriteData on the server writes it. */
+USTRUCT(BlueprintType)
+struct FUbermundoWorldMetadataMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoWorldMetadataMsg() : WorldId(0), OwningPlayerId(0), WotToSee(0), WorldVersion(0), PlayerUpdateIntervalFactor(0.0f) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 WorldId;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		FString WorldName;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 OwningPlayerId;
+
+	/** 0 to 100. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		uint8 WotToSee;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 WorldVersion;
+
+	/** How often P2P position updates go out, times 0.1 seconds. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float PlayerUpdateIntervalFactor;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoBlockChunkHashMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** 20 bytes. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		TArray<uint8> Sha1;
+};
+
+/** The first message on a connection. The server answers with S2PYourUbermundoID. */
+USTRUCT(BlueprintType)
+struct FUbermundoP2SPlayerAnnounce_SteamMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoP2SPlayerAnnounce_SteamMsg() : SteamId(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int64 SteamId;
+};
+
+/** Where the player is, every few seconds. Also keeps the connection alive. */
+USTRUCT(BlueprintType)
+struct FUbermundoP2SPlayerUpdateMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoP2SPlayerUpdateMsg() : WorldId(0), X(0), Y(0), Z(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 WorldId;
+
+	/** Decameters, 10 m per unit. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 X;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 Y;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 Z;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoP2SLeavingGameMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoP2SLeavingGameMsg() : UbermundoId(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 UbermundoId;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoP2SRequestLevelDataMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoP2SRequestLevelDataMsg() : WorldId(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 WorldId;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoP2SSaveLevelDataMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		FUbermundoWorldMetadataMsg Metadata;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		TArray<uint8> Contents;
+};
+
+/** Only WorldName, WotToSee, WorldVersion and PlayerUpdateIntervalFactor of Metadata are used. */
+USTRUCT(BlueprintType)
+struct FUbermundoP2SCreateNewWorldMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		FUbermundoWorldMetadataMsg Metadata;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoP2SRequestLevelMetadataMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoP2SRequestLevelMetadataMsg() : WorldId(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 WorldId;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoP2SRequestAllLevelMetasMsg
+{
+	GENERATED_USTRUCT_BODY()
+};
+
+/** Not implemented on the server yet. */
+USTRUCT(BlueprintType)
+struct FUbermundoP2SAddThingMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		FString AssetPath;
+};
+
+/** Not implemented on the server yet. */
+USTRUCT(BlueprintType)
+struct FUbermundoP2SRemoveThingMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoP2SRemoveThingMsg() : ThingId(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 ThingId;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoP2SGetNextObjectIDMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoP2SGetNextObjectIDMsg() : WorldId(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 WorldId;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoS2PYourUbermundoIDMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoS2PYourUbermundoIDMsg() : UbermundoId(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 UbermundoId;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoS2PPlayerLeftLevelMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoS2PPlayerLeftLevelMsg() : UbermundoId(0), SteamId(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 UbermundoId;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int64 SteamId;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoS2PPlayerEnteredLevelMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoS2PPlayerEnteredLevelMsg() : UbermundoId(0), SteamId(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 UbermundoId;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int64 SteamId;
+};
+
+/** Everyone else in the world the player is in. */
+USTRUCT(BlueprintType)
+struct FUbermundoS2PAnnouncePlayersToClient_SteamMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		TArray<FUbermundoAnnouncedPlayerMsg> Players;
+};
+
+/** Answer to P2SRequestLevelData. All zero metadata and no contents if there is no such world. */
+USTRUCT(BlueprintType)
+struct FUbermundoS2PLevelDataMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		FUbermundoWorldMetadataMsg Metadata;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		TArray<uint8> Contents;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoS2PWorldCreatedMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoS2PWorldCreatedMsg() : WorldId(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 WorldId;
+};
+
+/** Answer to P2SRequestLevelMetadata. All zero if there is no such world. */
+USTRUCT(BlueprintType)
+struct FUbermundoS2PLevelMetadataMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		FUbermundoWorldMetadataMsg Metadata;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoS2PAllLevelMetadataMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		TArray<FUbermundoWorldMetadataMsg> Worlds;
+};
+
+/** 0 if there is no such world. */
+USTRUCT(BlueprintType)
+struct FUbermundoS2PNextObjectIDMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoS2PNextObjectIDMsg() : ObjectId(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 ObjectId;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoS2PAnnouncementMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		FString Message;
+};
+
+/** Packed by the outbox, each message a 1 or 2 byte length then the message. */
+USTRUCT(BlueprintType)
+struct FUbermundoBundleMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		TArray<uint8> Messages;
+};
+
+/** See FUbermundoSnapshotCodec. */
+USTRUCT(BlueprintType)
+struct FUbermundoPlayer3DStateMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoPlayer3DStateMsg() : Sequence(0), BaselineOffset(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 Sequence;
+
+	/** 0 for a full snapshot, else the baseline is Sequence minus this. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		uint8 BaselineOffset;
+
+	/** The bit packed delta. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		TArray<uint8> Bits;
+};
+
+/** Layout is still the game's own. */
+USTRUCT(BlueprintType)
+struct FUbermundoPlayerGrabbedMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		TArray<uint8> Payload;
+};
+
+/** Layout is still the game's own. */
+USTRUCT(BlueprintType)
+struct FUbermundoPlayerReleasedMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		TArray<uint8> Payload;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoPlayer3DStateAckMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoPlayer3DStateAckMsg() : Sequence(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 Sequence;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoClockPingMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoClockPingMsg() : SentMicros(0) {}
+
+	/** Sender's clock. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int64 SentMicros;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoClockPongMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoClockPongMsg() : PingSentMicros(0), ArrivedMicros(0), SentMicros(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int64 PingSentMicros;
+
+	/** Answerer's clock when the ping came in. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int64 ArrivedMicros;
+
+	/** Answerer's clock when this went out. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int64 SentMicros;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoSessionPingMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoSessionPingMsg() : Kind(0), Micros(0) {}
+
+	/** 0 ping, 1 answer. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		uint8 Kind;
+
+	/** The pinger's clock, echoed back in the answer. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int64 Micros;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoBulkChunkMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoBulkChunkMsg() : TransferId(0), TotalSize(0), Index(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int64 TransferId;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int64 TotalSize;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 Index;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		TArray<uint8> Bytes;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoBulkAckMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoBulkAckMsg() : TransferId(0), InOrder(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int64 TransferId;
+
+	/** Chunks received in order. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 InOrder;
+
+	/** One bit per chunk after those, lowest bit first. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		TArray<uint8> Bitmap;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoPlayerTextMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		FString Text;
+};
+
+/** Followed by PlayerImageTiles, see FUbermundoImageMessages. */
+USTRUCT(BlueprintType)
+struct FUbermundoPlayerImageMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoPlayerImageMsg() : ImageId(0), Width(0), Height(0), TileSize(0), NumPasses(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int64 ImageId;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 Width;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 Height;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 TileSize;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		uint8 NumPasses;
+
+	/** JPEG. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		TArray<uint8> Thumbnail;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoPlayerVoiceMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoPlayerVoiceMsg() : Sequence(0), CapturedMs(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 Sequence;
+
+	/** Shared clock, ms. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int64 CapturedMs;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		TArray<uint8> Opus;
+};
+
+/** Layout is still the game's own. */
+USTRUCT(BlueprintType)
+struct FUbermundoPlayerEmoteMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		TArray<uint8> Payload;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoPlayerImageTileMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoPlayerImageTileMsg() : ImageId(0), TileX(0), TileY(0), Pass(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int64 ImageId;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		uint8 TileX;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		uint8 TileY;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		uint8 Pass;
+
+	/** JPEG. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		TArray<uint8> Tile;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoBlockWantMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoBlockWantMsg() : BlockId(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int64 BlockId;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoBlockHaveMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoBlockHaveMsg() : BlockId(0), Version(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int64 BlockId;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int64 Version;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoBlockManifestRequestMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoBlockManifestRequestMsg() : BlockId(0), Nonce(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int64 BlockId;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int64 Nonce;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoBlockManifestMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoBlockManifestMsg() : BlockId(0), BlockSize(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int64 BlockId;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int64 BlockSize;
+
+	/** 20 bytes. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		TArray<uint8> Sha1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		TArray<FUbermundoBlockChunkHashMsg> Chunks;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoBlockChunkRequestMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoBlockChunkRequestMsg() : BlockId(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int64 BlockId;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		TArray<int32> Chunks;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoBlockChunkMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoBlockChunkMsg() : BlockId(0), Index(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int64 BlockId;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 Index;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		TArray<uint8> Bytes;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoBlockMissingMsg
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoBlockMissingMsg() : BlockId(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int64 BlockId;
+};
+
+/**
+ * Blueprint access to the message codecs. Encoded messages include their code.
+ */
+UCLASS()
+class UBERMUNDOPROTOPLUGIN_API UUbermundoMessageLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|Server")
+		static TArray<uint8> EncodeP2SPlayerAnnounce_Steam(const FUbermundoP2SPlayerAnnounce_SteamMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|Server", meta = (ToolTip = "False if it is not a P2SPlayerAnnounce_Steam or is cut short."))
+		static bool DecodeP2SPlayerAnnounce_Steam(const TArray<uint8>& message, FUbermundoP2SPlayerAnnounce_SteamMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|Server")
+		static TArray<uint8> EncodeP2SPlayerUpdate(const FUbermundoP2SPlayerUpdateMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|Server", meta = (ToolTip = "False if it is not a P2SPlayerUpdate or is cut short."))
+		static bool DecodeP2SPlayerUpdate(const TArray<uint8>& message, FUbermundoP2SPlayerUpdateMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|Server")
+		static TArray<uint8> EncodeP2SLeavingGame(const FUbermundoP2SLeavingGameMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|Server", meta = (ToolTip = "False if it is not a P2SLeavingGame or is cut short."))
+		static bool DecodeP2SLeavingGame(const TArray<uint8>& message, FUbermundoP2SLeavingGameMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|Server")
+		static TArray<uint8> EncodeP2SRequestLevelData(const FUbermundoP2SRequestLevelDataMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|Server", meta = (ToolTip = "False if it is not a P2SRequestLevelData or is cut short."))
+		static bool DecodeP2SRequestLevelData(const TArray<uint8>& message, FUbermundoP2SRequestLevelDataMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|Server")
+		static TArray<uint8> EncodeP2SSaveLevelData(const FUbermundoP2SSaveLevelDataMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|Server", meta = (ToolTip = "False if it is not a P2SSaveLevelData or is cut short."))
+		static bool DecodeP2SSaveLevelData(const TArray<uint8>& message, FUbermundoP2SSaveLevelDataMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|Server")
+		static TArray<uint8> EncodeP2SCreateNewWorld(const FUbermundoP2SCreateNewWorldMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|Server", meta = (ToolTip = "False if it is not a P2SCreateNewWorld or is cut short."))
+		static bool DecodeP2SCreateNewWorld(const TArray<uint8>& message, FUbermundoP2SCreateNewWorldMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|Server")
+		static TArray<uint8> EncodeP2SRequestLevelMetadata(const FUbermundoP2SRequestLevelMetadataMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|Server", meta = (ToolTip = "False if it is not a P2SRequestLevelMetadata or is cut short."))
+		static bool DecodeP2SRequestLevelMetadata(const TArray<uint8>& message, FUbermundoP2SRequestLevelMetadataMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|Server")
+		static TArray<uint8> EncodeP2SRequestAllLevelMetas(const FUbermundoP2SRequestAllLevelMetasMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|Server", meta = (ToolTip = "False if it is not a P2SRequestAllLevelMetas or is cut short."))
+		static bool DecodeP2SRequestAllLevelMetas(const TArray<uint8>& message, FUbermundoP2SRequestAllLevelMetasMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|Server")
+		static TArray<uint8> EncodeP2SAddThing(const FUbermundoP2SAddThingMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|Server", meta = (ToolTip = "False if it is not a P2SAddThing or is cut short."))
+		static bool DecodeP2SAddThing(const TArray<uint8>& message, FUbermundoP2SAddThingMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|Server")
+		static TArray<uint8> EncodeP2SRemoveThing(const FUbermundoP2SRemoveThingMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|Server", meta = (ToolTip = "False if it is not a P2SRemoveThing or is cut short."))
+		static bool DecodeP2SRemoveThing(const TArray<uint8>& message, FUbermundoP2SRemoveThingMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|Server")
+		static TArray<uint8> EncodeP2SGetNextObjectID(const FUbermundoP2SGetNextObjectIDMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|Server", meta = (ToolTip = "False if it is not a P2SGetNextObjectID or is cut short."))
+		static bool DecodeP2SGetNextObjectID(const TArray<uint8>& message, FUbermundoP2SGetNextObjectIDMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|Server")
+		static TArray<uint8> EncodeS2PYourUbermundoID(const FUbermundoS2PYourUbermundoIDMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|Server", meta = (ToolTip = "False if it is not a S2PYourUbermundoID or is cut short."))
+		static bool DecodeS2PYourUbermundoID(const TArray<uint8>& message, FUbermundoS2PYourUbermundoIDMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|Server")
+		static TArray<uint8> EncodeS2PPlayerLeftLevel(const FUbermundoS2PPlayerLeftLevelMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|Server", meta = (ToolTip = "False if it is not a S2PPlayerLeftLevel or is cut short."))
+		static bool DecodeS2PPlayerLeftLevel(const TArray<uint8>& message, FUbermundoS2PPlayerLeftLevelMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|Server")
+		static TArray<uint8> EncodeS2PPlayerEnteredLevel(const FUbermundoS2PPlayerEnteredLevelMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|Server", meta = (ToolTip = "False if it is not a S2PPlayerEnteredLevel or is cut short."))
+		static bool DecodeS2PPlayerEnteredLevel(const TArray<uint8>& message, FUbermundoS2PPlayerEnteredLevelMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|Server")
+		static TArray<uint8> EncodeS2PAnnouncePlayersToClient_Steam(const FUbermundoS2PAnnouncePlayersToClient_SteamMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|Server", meta = (ToolTip = "False if it is not a S2PAnnouncePlayersToClient_Steam or is cut short."))
+		static bool DecodeS2PAnnouncePlayersToClient_Steam(const TArray<uint8>& message, FUbermundoS2PAnnouncePlayersToClient_SteamMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|Server")
+		static TArray<uint8> EncodeS2PLevelData(const FUbermundoS2PLevelDataMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|Server", meta = (ToolTip = "False if it is not a S2PLevelData or is cut short."))
+		static bool DecodeS2PLevelData(const TArray<uint8>& message, FUbermundoS2PLevelDataMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|Server")
+		static TArray<uint8> EncodeS2PWorldCreated(const FUbermundoS2PWorldCreatedMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|Server", meta = (ToolTip = "False if it is not a S2PWorldCreated or is cut short."))
+		static bool DecodeS2PWorldCreated(const TArray<uint8>& message, FUbermundoS2PWorldCreatedMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|Server")
+		static TArray<uint8> EncodeS2PLevelMetadata(const FUbermundoS2PLevelMetadataMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|Server", meta = (ToolTip = "False if it is not a S2PLevelMetadata or is cut short."))
+		static bool DecodeS2PLevelMetadata(const TArray<uint8>& message, FUbermundoS2PLevelMetadataMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|Server")
+		static TArray<uint8> EncodeS2PAllLevelMetadata(const FUbermundoS2PAllLevelMetadataMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|Server", meta = (ToolTip = "False if it is not a S2PAllLevelMetadata or is cut short."))
+		static bool DecodeS2PAllLevelMetadata(const TArray<uint8>& message, FUbermundoS2PAllLevelMetadataMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|Server")
+		static TArray<uint8> EncodeS2PNextObjectID(const FUbermundoS2PNextObjectIDMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|Server", meta = (ToolTip = "False if it is not a S2PNextObjectID or is cut short."))
+		static bool DecodeS2PNextObjectID(const TArray<uint8>& message, FUbermundoS2PNextObjectIDMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|Server")
+		static TArray<uint8> EncodeS2PAnnouncementMsg(const FUbermundoS2PAnnouncementMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|Server", meta = (ToolTip = "False if it is not a S2PAnnouncementMsg or is cut short."))
+		static bool DecodeS2PAnnouncementMsg(const TArray<uint8>& message, FUbermundoS2PAnnouncementMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|P2P")
+		static TArray<uint8> EncodeBundle(const FUbermundoBundleMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|P2P", meta = (ToolTip = "False if it is not a Bundle or is cut short."))
+		static bool DecodeBundle(const TArray<uint8>& message, FUbermundoBundleMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|P2P")
+		static TArray<uint8> EncodePlayer3DState(const FUbermundoPlayer3DStateMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|P2P", meta = (ToolTip = "False if it is not a Player3DState or is cut short."))
+		static bool DecodePlayer3DState(const TArray<uint8>& message, FUbermundoPlayer3DStateMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|P2P")
+		static TArray<uint8> EncodePlayerGrabbed(const FUbermundoPlayerGrabbedMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|P2P", meta = (ToolTip = "False if it is not a PlayerGrabbed or is cut short."))
+		static bool DecodePlayerGrabbed(const TArray<uint8>& message, FUbermundoPlayerGrabbedMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|P2P")
+		static TArray<uint8> EncodePlayerReleased(const FUbermundoPlayerReleasedMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|P2P", meta = (ToolTip = "False if it is not a PlayerReleased or is cut short."))
+		static bool DecodePlayerReleased(const TArray<uint8>& message, FUbermundoPlayerReleasedMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|P2P")
+		static TArray<uint8> EncodePlayer3DStateAck(const FUbermundoPlayer3DStateAckMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|P2P", meta = (ToolTip = "False if it is not a Player3DStateAck or is cut short."))
+		static bool DecodePlayer3DStateAck(const TArray<uint8>& message, FUbermundoPlayer3DStateAckMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|P2P")
+		static TArray<uint8> EncodeClockPing(const FUbermundoClockPingMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|P2P", meta = (ToolTip = "False if it is not a ClockPing or is cut short."))
+		static bool DecodeClockPing(const TArray<uint8>& message, FUbermundoClockPingMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|P2P")
+		static TArray<uint8> EncodeClockPong(const FUbermundoClockPongMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|P2P", meta = (ToolTip = "False if it is not a ClockPong or is cut short."))
+		static bool DecodeClockPong(const TArray<uint8>& message, FUbermundoClockPongMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|P2P")
+		static TArray<uint8> EncodeSessionPing(const FUbermundoSessionPingMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|P2P", meta = (ToolTip = "False if it is not a SessionPing or is cut short."))
+		static bool DecodeSessionPing(const TArray<uint8>& message, FUbermundoSessionPingMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|P2P")
+		static TArray<uint8> EncodeBulkChunk(const FUbermundoBulkChunkMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|P2P", meta = (ToolTip = "False if it is not a BulkChunk or is cut short."))
+		static bool DecodeBulkChunk(const TArray<uint8>& message, FUbermundoBulkChunkMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|P2P")
+		static TArray<uint8> EncodeBulkAck(const FUbermundoBulkAckMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|P2P", meta = (ToolTip = "False if it is not a BulkAck or is cut short."))
+		static bool DecodeBulkAck(const TArray<uint8>& message, FUbermundoBulkAckMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|P2P")
+		static TArray<uint8> EncodePlayerTextMsg(const FUbermundoPlayerTextMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|P2P", meta = (ToolTip = "False if it is not a PlayerTextMsg or is cut short."))
+		static bool DecodePlayerTextMsg(const TArray<uint8>& message, FUbermundoPlayerTextMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|P2P")
+		static TArray<uint8> EncodePlayerImageMsg(const FUbermundoPlayerImageMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|P2P", meta = (ToolTip = "False if it is not a PlayerImageMsg or is cut short."))
+		static bool DecodePlayerImageMsg(const TArray<uint8>& message, FUbermundoPlayerImageMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|P2P")
+		static TArray<uint8> EncodePlayerVoiceMsg(const FUbermundoPlayerVoiceMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|P2P", meta = (ToolTip = "False if it is not a PlayerVoiceMsg or is cut short."))
+		static bool DecodePlayerVoiceMsg(const TArray<uint8>& message, FUbermundoPlayerVoiceMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|P2P")
+		static TArray<uint8> EncodePlayerEmoteMsg(const FUbermundoPlayerEmoteMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|P2P", meta = (ToolTip = "False if it is not a PlayerEmoteMsg or is cut short."))
+		static bool DecodePlayerEmoteMsg(const TArray<uint8>& message, FUbermundoPlayerEmoteMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|P2P")
+		static TArray<uint8> EncodePlayerImageTile(const FUbermundoPlayerImageTileMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|P2P", meta = (ToolTip = "False if it is not a PlayerImageTile or is cut short."))
+		static bool DecodePlayerImageTile(const TArray<uint8>& message, FUbermundoPlayerImageTileMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|P2P")
+		static TArray<uint8> EncodeBlockWant(const FUbermundoBlockWantMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|P2P", meta = (ToolTip = "False if it is not a BlockWant or is cut short."))
+		static bool DecodeBlockWant(const TArray<uint8>& message, FUbermundoBlockWantMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|P2P")
+		static TArray<uint8> EncodeBlockHave(const FUbermundoBlockHaveMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|P2P", meta = (ToolTip = "False if it is not a BlockHave or is cut short."))
+		static bool DecodeBlockHave(const TArray<uint8>& message, FUbermundoBlockHaveMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|P2P")
+		static TArray<uint8> EncodeBlockManifestRequest(const FUbermundoBlockManifestRequestMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|P2P", meta = (ToolTip = "False if it is not a BlockManifestRequest or is cut short."))
+		static bool DecodeBlockManifestRequest(const TArray<uint8>& message, FUbermundoBlockManifestRequestMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|P2P")
+		static TArray<uint8> EncodeBlockManifest(const FUbermundoBlockManifestMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|P2P", meta = (ToolTip = "False if it is not a BlockManifest or is cut short."))
+		static bool DecodeBlockManifest(const TArray<uint8>& message, FUbermundoBlockManifestMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|P2P")
+		static TArray<uint8> EncodeBlockChunkRequest(const FUbermundoBlockChunkRequestMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|P2P", meta = (ToolTip = "False if it is not a BlockChunkRequest or is cut short."))
+		static bool DecodeBlockChunkRequest(const TArray<uint8>& message, FUbermundoBlockChunkRequestMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|P2P")
+		static TArray<uint8> EncodeBlockChunk(const FUbermundoBlockChunkMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|P2P", meta = (ToolTip = "False if it is not a BlockChunk or is cut short."))
+		static bool DecodeBlockChunk(const TArray<uint8>& message, FUbermundoBlockChunkMsg& decoded);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Messages|P2P")
+		static TArray<uint8> EncodeBlockMissing(const FUbermundoBlockMissingMsg& message);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Messages|P2P", meta = (ToolTip = "False if it is not a BlockMissing or is cut short."))
+		static bool DecodeBlockMissing(const TArray<uint8>& message, FUbermundoBlockMissingMsg& decoded);
+};
@@ -0,0 +1,43 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// Repeatable measurements of the networking code that don't need Steam or a second machine.
+// Each benchmark returns a human readable report, and also logs it to UberMundoSteamLog.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "UbermundoSnapshotCodec.h"
+#include "UbermundoTransport.h"
+#include "UbermundoNetBenchmarks.generated.h"
+
+/**
+ *
+ */
+UCLASS()
+class UBERMUNDOPROTOPLUGIN_API UUbermundoNetBenchmarks : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "UberMundo Benchmarks", meta = (ToolTip = "Add the local player's state to the in memory movement trace. Call at the normal send rate while playing."))
+		static void RecordMovementTraceSample(const FUbermundoPlayer3DState& state);
+	UFUNCTION(BlueprintCallable, Category = "UberMundo Benchmarks", meta = (ToolTip = "Write the recorded movement trace as CSV and clear it. One line per sample: time ms, location xyz, rotation pitch yaw roll, velocity xyz."))
+		static bool SaveMovementTrace(const FString& csvPath);
+	UFUNCTION(BlueprintCallable, Category = "UberMundo Benchmarks", meta = (ToolTip = "Read a movement trace written by SaveMovementTrace."))
+		static bool LoadMovementTrace(const FString& csvPath, TArray<FUbermundoPlayer3DState>& trace);
+
+	UFUNCTION(BlueprintCallable, Category = "UberMundo Benchmarks", meta = (ToolTip = "Run a movement trace through the Player3DState codec with simulated loss and ack delay. Reports bytes per snapshot against uncompressed floats, full snapshot fallbacks and encode/decode time."))
+		static bool BenchmarkSnapshotCodec(const FString& traceCsvPath, float lossRate, int32 ackDelaySnapshots, FString& report);
+	UFUNCTION(BlueprintCallable, Category = "UberMundo Benchmarks", meta = (ToolTip = "Push messages between two local transports: the UDP loopback stand-in with one send call per message like the legacy Steam path, then SteamSockets with one SendMessages per message and with one per tick of messagesPerTick. The SteamSockets runs need Steam running and are skipped otherwise."))
+		static bool BenchmarkP2PTransports(int32 numMessages, int32 messageBytes, int32 messagesPerTick, FString& report);
+	UFUNCTION(BlueprintCallable, Category = "UberMundo Benchmarks", meta = (ToolTip = "Feed a P2P capture through the receive path (inbox drain, OnPacketsReceived, outbox flush) instead of the network, at its original pace or as fast as it goes. Reports packets per second and time per drain, and for the paced run how late packets were handled. Restores the transport afterwards."))
+		static bool BenchmarkCaptureReplay(const FString& capturePath, bool realTime, FString& report);
+	UFUNCTION(BlueprintCallable, Category = "UberMundo Benchmarks", meta = (ToolTip = "Speak a test tone through the voice pipeline (encode, loopback transport with these conditions, worker decode, jitter buffer, playout every 20 ms) for this many seconds. Reports capture to playout latency, jitter, and late, concealed and dropped frames. Needs the voice codec, not a microphone."))
+		static bool BenchmarkVoiceLoopback(float seconds, const FUbermundoNetConditions& conditions, FString& report);
+	UFUNCTION(BlueprintCallable, Category = "UberMundo Benchmarks", meta = (ToolTip = "Encode and decode ClockPong, a 1 KB BlockChunk, an announce of 16 players and a level's metadata this many times each with the generated codecs, native and Blueprint, and the P2P ones by hand with FUbermundoPacketBuilder too. Reports ns per message and MB/s. False if a native and a Blueprint encode gave different bytes."))
+		static bool BenchmarkMessageCodecs(int32 iterations, FString& report);
+
+private:
+	static TArray<FUbermundoPlayer3DState> recordedTrace;
+};
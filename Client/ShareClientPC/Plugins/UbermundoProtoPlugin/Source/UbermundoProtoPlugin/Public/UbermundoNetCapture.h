@@ -0,0 +1,136 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// P2P traffic capture and replay.
+// While capturing, every packet that goes through USteamCustomCode::SendP2P or comes out of a read
+// (the inbox drain or ReadP2PPacket) is appended to a file: time since the capture started, peer,
+// direction, send mode and the bytes. Records are gathered in memory and written in large appends.
+// FUbermundoReplayTransport plays a capture back as if it were the network. Its reads hand out the
+// captured incoming packets, either when they originally arrived or all at once, and its sends only
+// count what the game sends back. So the whole receive path above the transport (bundles, acks, the
+// codec, swarm, Blueprint OnPacketsReceived) can be run on a recorded session, the same run every
+// time, headless and with no Steam. UUbermundoNetBenchmarks::BenchmarkCaptureReplay times it.
+//
+// File layout, little endian:
+//   "UMCP", u16 version, u16 unused, u64 our own peer id
+//   then per packet: u64 microseconds, u64 peer, u32 bytes, u8 direction (0 in, 1 out), u8 send mode, the bytes
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "UbermundoTransport.h"
+#include "UbermundoNetCapture.generated.h"
+
+#define UBERMUNDO_NET_CAPTURE_VERSION 1
+/** Bytes gathered in memory before they are appended to the file. */
+#define UBERMUNDO_NET_CAPTURE_FLUSH (1024 * 1024)
+
+class UBERMUNDOPROTOPLUGIN_API FUbermundoNetCapture {
+public:
+	static FUbermundoNetCapture& Get();
+
+	/** Start a new capture file at path, replacing any. */
+	bool Start(const FString& path);
+	/** Write what is left and close. Returns the number of packets captured. */
+	int32 Stop();
+	bool IsCapturing() const { return !path.IsEmpty(); }
+
+	void OnSend(uint64 peer, const uint8* data, uint32 numBytes, EUbermundoP2PSendMode mode) { Add(peer, data, numBytes, 1, (uint8)mode); }
+	void OnReceive(uint64 sender, const uint8* data, uint32 numBytes) { Add(sender, data, numBytes, 0, 0); }
+
+private:
+	void Add(uint64 peer, const uint8* data, uint32 numBytes, uint8 direction, uint8 mode);
+	bool Write();
+
+	FString path;
+	double start = 0.0;
+	TArray<uint8> buffer;
+	int32 numPackets = 0;
+};
+
+/** A capture file in memory. Packets are views into the file's bytes. */
+struct UBERMUNDOPROTOPLUGIN_API FUbermundoCapture {
+	struct FPacket {
+		double time;
+		uint64 peer;
+		bool outgoing;
+		EUbermundoP2PSendMode mode;
+		int32 offset;
+		int32 numBytes;
+	};
+
+	bool Load(const FString& path);
+	TArrayView<const uint8> Bytes(const FPacket& p) const { return TArrayView<const uint8>(data.GetData() + p.offset, p.numBytes); }
+
+	uint64 localId = 0;
+	TArray<FPacket> packets;
+	int32 numIncoming = 0;
+	int64 incomingBytes = 0;
+	int32 numOutgoing = 0;
+	int64 outgoingBytes = 0;
+
+private:
+	TArray<uint8> data;
+};
+
+/** Plays a capture's incoming packets back as a transport. Sends go nowhere and are only counted. */
+class UBERMUNDOPROTOPLUGIN_API FUbermundoReplayTransport : public IUbermundoTransport {
+public:
+	/** realTime hands each packet out when it arrived in the capture, counted from the first Tick. Otherwise all at once. */
+	FUbermundoReplayTransport(TSharedRef<const FUbermundoCapture> capture, bool realTime);
+
+	virtual const TCHAR* GetName() const override { return TEXT("Replay"); }
+	virtual bool IsAvailable() const override { return true; }
+	virtual uint64 GetLocalId() const override { return capture->localId; }
+	virtual bool Send(uint64 peer, const uint8* data, uint32 numBytes, EUbermundoP2PSendMode mode) override;
+	virtual bool IsPacketAvailable(uint32& numBytes) override;
+	virtual bool Read(uint8* dest, uint32 destSize, uint32& numBytes, uint64& sender) override;
+	virtual bool Close(uint64 peer) override { return true; }
+	virtual void Tick(double now) override;
+
+	/** Every captured incoming packet has been read. */
+	bool IsFinished() const { return next >= capture->packets.Num(); }
+	/** When the next packet is due, FPlatformTime::Seconds, or 0 if there is none or the replay isn't paced. */
+	double GetNextDue() const;
+	/** How long after they were due, by the wall clock, packets were read. Seconds, 0 when not paced. */
+	double GetTotalLateness() const { return totalLateness; }
+	double GetMaxLateness() const { return maxLateness; }
+
+	int32 GetNumRead() const { return numRead; }
+	int32 GetNumSent() const { return numSent; }
+	int64 GetBytesSent() const { return bytesSent; }
+
+private:
+	/** Skip to the next incoming packet. */
+	void Advance();
+
+	TSharedRef<const FUbermundoCapture> capture;
+	bool realTime;
+	double start = 0.0;
+	double now = 0.0;
+	int32 next = 0;
+	double totalLateness = 0.0;
+	double maxLateness = 0.0;
+	int32 numRead = 0;
+	int32 numSent = 0;
+	int64 bytesSent = 0;
+};
+
+/**
+ * Blueprint access to capture and replay.
+ */
+UCLASS()
+class UBERMUNDOPROTOPLUGIN_API UUbermundoNetCaptureLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Diagnostics", meta = (ToolTip = "Record every P2P packet sent and received, with timestamps and peers, to a capture file."))
+		static bool StartP2PCapture(const FString& path);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Diagnostics", meta = (ToolTip = "Finish the capture file. Returns the number of packets in it."))
+		static int32 StopP2PCapture();
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Diagnostics")
+		static bool IsP2PCapturing();
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Transport", meta = (ToolTip = "Receive the incoming packets of a capture file instead of the network, at their original pace or as fast as they can be drained. Sends go nowhere. Use Steam Transport to go back."))
+		static bool UseReplayTransport(const FString& capturePath, bool realTime);
+};
@@ -0,0 +1,164 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// Per peer link statistics.
+// Counts what goes to and comes from each peer, both as datagrams on the wire and as the messages
+// inside them, the latter per packet code. Every UBERMUNDO_NET_STATS_WINDOW seconds the counts become
+// per second rates. Those are joined with RTT and loss, from our own state acks through
+// FUbermundoRateController, or from the transport where it measures them (SteamSockets). Queue depth
+// is both what the outbox holds back for budget and what the transport has not sent yet.
+// Optionally appends a line per peer to a CSV every so often, to line up complaints with the link.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "UbermundoNetStats.generated.h"
+
+/** Seconds counted before they are turned into rates. */
+#define UBERMUNDO_NET_STATS_WINDOW 1.0
+
+USTRUCT(BlueprintType)
+struct FUbermundoCodeNetStats
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoCodeNetStats() : Code(0), MessagesInPerSec(0.0f), MessagesOutPerSec(0.0f), BytesInPerSec(0.0f), BytesOutPerSec(0.0f) {}
+
+	/** EUbermundoPacketCodes. */
+	UPROPERTY(BlueprintReadOnly)
+		int32 Code;
+	UPROPERTY(BlueprintReadOnly)
+		float MessagesInPerSec;
+	UPROPERTY(BlueprintReadOnly)
+		float MessagesOutPerSec;
+	UPROPERTY(BlueprintReadOnly)
+		float BytesInPerSec;
+	UPROPERTY(BlueprintReadOnly)
+		float BytesOutPerSec;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoPeerNetStats
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoPeerNetStats() : Peer(0), PacketsInPerSec(0.0f), PacketsOutPerSec(0.0f), BytesInPerSec(0.0f), BytesOutPerSec(0.0f),
+		MessagesInPerSec(0.0f), MessagesOutPerSec(0.0f), RttMs(-1.0f), LossPercent(-1.0f), OutboxQueuedBytes(0),
+		TransportQueuedBytes(-1), TransportQueuedPackets(-1), TotalBytesIn(0), TotalBytesOut(0) {}
+
+	UPROPERTY(BlueprintReadOnly)
+		int64 Peer;
+	/** Datagrams, a bundle is one. */
+	UPROPERTY(BlueprintReadOnly)
+		float PacketsInPerSec;
+	UPROPERTY(BlueprintReadOnly)
+		float PacketsOutPerSec;
+	UPROPERTY(BlueprintReadOnly)
+		float BytesInPerSec;
+	UPROPERTY(BlueprintReadOnly)
+		float BytesOutPerSec;
+	/** Messages, each one in a bundle counts. */
+	UPROPERTY(BlueprintReadOnly)
+		float MessagesInPerSec;
+	UPROPERTY(BlueprintReadOnly)
+		float MessagesOutPerSec;
+	/** -1 until known. */
+	UPROPERTY(BlueprintReadOnly)
+		float RttMs;
+	/** -1 until known. */
+	UPROPERTY(BlueprintReadOnly)
+		float LossPercent;
+	/** Held back in the outbox waiting for send budget. */
+	UPROPERTY(BlueprintReadOnly)
+		int32 OutboxQueuedBytes;
+	/** Handed to the transport but not sent yet, -1 if the transport can't tell. */
+	UPROPERTY(BlueprintReadOnly)
+		int32 TransportQueuedBytes;
+	UPROPERTY(BlueprintReadOnly)
+		int32 TransportQueuedPackets;
+	UPROPERTY(BlueprintReadOnly)
+		int64 TotalBytesIn;
+	UPROPERTY(BlueprintReadOnly)
+		int64 TotalBytesOut;
+	/** Only codes seen in the last window, lowest code first. */
+	UPROPERTY(BlueprintReadOnly)
+		TArray<FUbermundoCodeNetStats> Codes;
+};
+
+class UBERMUNDOPROTOPLUGIN_API FUbermundoNetStats {
+public:
+	static FUbermundoNetStats& Get();
+
+	/** A datagram on the wire. */
+	void OnPacketOut(uint64 peer, int32 numBytes);
+	void OnPacketIn(uint64 peer, int32 numBytes);
+	/** A message, on its own or inside a bundle. */
+	void OnMessageOut(uint64 peer, const uint8* data, int32 numBytes);
+	void OnMessageIn(uint64 peer, const uint8* data, int32 numBytes);
+
+	/** Close the window when it is due, and write the CSV when that is due. A net tick, see FUbermundoNetTick. */
+	void Tick(double now);
+
+	bool GetPeerStats(uint64 peer, FUbermundoPeerNetStats& out) const;
+	void GetAllPeerStats(TArray<FUbermundoPeerNetStats>& out) const;
+
+	bool StartCsv(const FString& path, float intervalSeconds);
+	void StopCsv();
+
+	void ForgetPeer(uint64 peer);
+
+private:
+	struct FCounts {
+		int32 packetsIn = 0;
+		int32 packetsOut = 0;
+		int64 bytesIn = 0;
+		int64 bytesOut = 0;
+		int32 messagesIn = 0;
+		int32 messagesOut = 0;
+		/** Per packet code. */
+		int32 codeMessagesIn[256] = {};
+		int32 codeMessagesOut[256] = {};
+		int32 codeBytesIn[256] = {};
+		int32 codeBytesOut[256] = {};
+	};
+
+	struct FPeer {
+		FCounts window;
+		/** Rates from the last whole window. */
+		FUbermundoPeerNetStats last;
+		int64 totalBytesIn = 0;
+		int64 totalBytesOut = 0;
+	};
+
+	void EndWindow(uint64 peer, FPeer& p, double seconds);
+	/** Last window's rates plus what is current right now: RTT, loss, queues. */
+	void Fill(uint64 peer, const FPeer& p, FUbermundoPeerNetStats& out) const;
+	void WriteCsv(double now);
+
+	TMap<uint64, FPeer> peers;
+	double windowStart = 0.0;
+
+	FString csvPath;
+	double csvInterval = 0.0;
+	double csvNext = 0.0;
+	double csvStart = 0.0;
+};
+
+/**
+ * Blueprint access to the per peer link statistics.
+ */
+UCLASS()
+class UBERMUNDOPROTOPLUGIN_API UUbermundoNetStatsLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Diagnostics", meta = (ToolTip = "Traffic per second in and out, per packet code, RTT, loss and queued bytes for one peer. False if nothing has gone either way yet."))
+		static bool GetPeerNetStats(int64 peer, FUbermundoPeerNetStats& stats);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Diagnostics")
+		static void GetAllPeerNetStats(TArray<FUbermundoPeerNetStats>& stats);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Diagnostics", meta = (ToolTip = "Append a line per peer to a CSV every intervalSeconds, starting with a header line if the file is new."))
+		static bool StartNetStatsCsv(const FString& path, float intervalSeconds = 5.0f);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Diagnostics")
+		static void StopNetStatsCsv();
+};
@@ -0,0 +1,215 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// Opt in network thread.
+// Normally everything network happens on the game thread: SteamAPI_RunCallbacks in
+// USteamCustomCode::Tick, reads in the inbox drain, sends in the outbox flush. A long frame then
+// means Steam callbacks, reads and sends all wait for it.
+// With the network thread started, the current transport is wrapped in FUbermundoThreadedTransport.
+// Its own thread runs Steam callbacks and the real transport at a fixed rate: it sends what the game
+// thread queued, reads whatever has arrived, and hands both ways through lock free single producer
+// single consumer rings. The game thread only copies bytes in and out of those rings, the rest of the
+// P2P code does not know the difference.
+// Steam callbacks then run on the network thread, under the lock that guards the real transport, so
+// callback handlers must not touch UObjects.
+//
+// FUbermundoNetLatency measures both modes the same way, so they can be compared: how long the game
+// thread spends inside the transport each frame, the time between frames that drain the inbox, and,
+// with the thread, how long packets sat in the rings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "UbermundoTransport.h"
+#include "UbermundoPacketBuffer.h"
+#include "UbermundoSpscRing.h"
+#include "UbermundoNetThread.generated.h"
+
+class FRunnableThread;
+class FEvent;
+
+/** Packets each ring holds. A full inbound ring leaves packets with the transport, a full outbound ring drops unreliable sends. */
+#define UBERMUNDO_NET_THREAD_RING 4096
+/** Seconds a reliable send waits for room in a full outbound ring before it fails. */
+#define UBERMUNDO_NET_THREAD_RELIABLE_WAIT 0.1
+
+USTRUCT(BlueprintType)
+struct FUbermundoNetLatencyStats
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoNetLatencyStats() : NetworkThread(false), NetTickHz(0.0f), AvgGameThreadNetMs(0.0f), MaxGameThreadNetMs(0.0f),
+		AvgDrainGapMs(0.0f), MaxDrainGapMs(0.0f), AvgInboundWaitMs(0.0f), MaxInboundWaitMs(0.0f),
+		AvgOutboundWaitMs(0.0f), MaxOutboundWaitMs(0.0f), NumOutboundDropped(0) {}
+
+	UPROPERTY(BlueprintReadOnly)
+		bool NetworkThread;
+	/** Network thread loops per second, 0 without it. */
+	UPROPERTY(BlueprintReadOnly)
+		float NetTickHz;
+	/** Game thread time per frame spent inside the transport: sends, reads, callbacks. */
+	UPROPERTY(BlueprintReadOnly)
+		float AvgGameThreadNetMs;
+	UPROPERTY(BlueprintReadOnly)
+		float MaxGameThreadNetMs;
+	/** Time between inbox drains. Without the thread packets wait in Steam this long at worst, about half of it on average. */
+	UPROPERTY(BlueprintReadOnly)
+		float AvgDrainGapMs;
+	UPROPERTY(BlueprintReadOnly)
+		float MaxDrainGapMs;
+	/** With the thread, from the network thread reading a packet to the game thread taking it. */
+	UPROPERTY(BlueprintReadOnly)
+		float AvgInboundWaitMs;
+	UPROPERTY(BlueprintReadOnly)
+		float MaxInboundWaitMs;
+	/** With the thread, from the game thread sending a packet to the network thread handing it to the transport. */
+	UPROPERTY(BlueprintReadOnly)
+		float AvgOutboundWaitMs;
+	UPROPERTY(BlueprintReadOnly)
+		float MaxOutboundWaitMs;
+	UPROPERTY(BlueprintReadOnly)
+		int32 NumOutboundDropped;
+};
+
+/** Running totals behind FUbermundoNetLatencyStats. Game thread calls only, the network thread reports through its transport. */
+class UBERMUNDOPROTOPLUGIN_API FUbermundoNetLatency {
+public:
+	static FUbermundoNetLatency& Get();
+
+	/** Time the game thread just spent in the transport. */
+	void AddGameThreadCycles(uint64 cycles) { frameCycles += cycles; }
+	/** The inbox drained. Closes the frame for the per frame figures. */
+	void OnDrain(double now);
+	void OnInbound(double waitSeconds);
+
+	void GetStats(FUbermundoNetLatencyStats& out) const;
+	void Reset();
+
+private:
+	struct FAccum {
+		double total = 0.0;
+		double max = 0.0;
+		int64 count = 0;
+		void Add(double v) { total += v; max = FMath::Max(max, v); count++; }
+		float AvgMs() const { return count > 0 ? (float)(total / count * 1000.0) : 0.0f; }
+		float MaxMs() const { return (float)(max * 1000.0); }
+	};
+
+	uint64 frameCycles = 0;
+	double lastDrain = 0.0;
+	FAccum gameThreadNet;
+	FAccum drainGap;
+	FAccum inboundWait;
+};
+
+/** Times the enclosing scope into FUbermundoNetLatency's game thread figure. */
+struct FUbermundoGameThreadNetScope {
+	uint64 start;
+	FUbermundoGameThreadNetScope() : start(FPlatformTime::Cycles64()) {}
+	~FUbermundoGameThreadNetScope() { FUbermundoNetLatency::Get().AddGameThreadCycles(FPlatformTime::Cycles64() - start); }
+};
+
+/**
+ * Runs another transport on a thread of its own. Send, IsPacketAvailable, Read, Close and FlushSends
+ * are for the game thread, everything on the wrapped transport happens on the network thread.
+ */
+class UBERMUNDOPROTOPLUGIN_API FUbermundoThreadedTransport : public IUbermundoTransport, public FRunnable {
+public:
+	FUbermundoThreadedTransport(TUniquePtr<IUbermundoTransport> inner, float tickHz);
+	virtual ~FUbermundoThreadedTransport();
+
+	/** Stop the network thread. Packets it already read can still be Read, sends queue up for Release. */
+	void StopThread();
+	/** Stop the thread, send what is still queued and hand back the wrapped transport. Read what the thread
+		already received first, see USteamCustomCode::ReplaceTransport. This object is no use afterwards. */
+	TUniquePtr<IUbermundoTransport> Release();
+
+	virtual const TCHAR* GetName() const override { return TEXT("Threaded"); }
+	virtual bool IsAvailable() const override { return inner.IsValid() && inner->IsAvailable(); }
+	virtual uint64 GetLocalId() const override { return inner.IsValid() ? inner->GetLocalId() : 0; }
+	virtual bool Send(uint64 peer, const uint8* data, uint32 numBytes, EUbermundoP2PSendMode mode) override;
+	/** Every peer's ring entry holds a handle on the one buffer, nothing is copied. */
+	virtual int32 SendToMany(TArrayView<const uint64> peers, const FUbermundoPacketRef& packet, EUbermundoP2PSendMode mode, TArray<bool, TInlineAllocator<64>>& sent) override;
+	virtual bool IsPacketAvailable(uint32& numBytes) override;
+	virtual bool Read(uint8* dest, uint32 destSize, uint32& numBytes, uint64& sender) override;
+	virtual bool Close(uint64 peer) override;
+	/** Wake the network thread so this tick's sends go now, not on its next loop. */
+	virtual int32 FlushSends() override;
+	/** The wrapped transport's, asked under the lock the network thread holds while it uses it. */
+	virtual bool GetPeerStatus(uint64 peer, FUbermundoTransportPeerStatus& out) const override;
+	/** Passed on to the wrapped transport under the same lock. */
+	virtual bool SetConditions(const FUbermundoNetConditions& c) override;
+	virtual bool AddPeer(uint64 peer, const FString& address, int32 port) override;
+
+	/** Adds the network thread's figures. */
+	void GetStats(FUbermundoNetLatencyStats& out) const;
+
+	// FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override { stopping = true; }
+
+private:
+	struct FOutbound {
+		uint64 peer = 0;
+		FUbermundoPacketRef packet;
+		EUbermundoP2PSendMode mode{};
+		/** Close the session with peer instead of sending. */
+		bool close = false;
+		double queuedAt = 0.0;
+	};
+
+	struct FInbound {
+		uint64 sender = 0;
+		FUbermundoPacketRef packet;
+		double readAt = 0.0;
+	};
+
+	/** Queue o. A reliable send or a close waits for room in a full ring, anything else is dropped. */
+	bool PushOutbound(FOutbound&& o, const uint8* data, uint32 numBytes);
+	void Service(double now);
+	/** Hand the game thread's sends and closes to the wrapped transport. Returns how many were sent. */
+	int32 SendQueued(double now, double& waitTotal, double& waitMax);
+	void ReadArrived(double now);
+
+	TUniquePtr<IUbermundoTransport> inner;
+	/** Held by the network thread while it uses inner, and by the game thread calls forwarded to it. */
+	mutable FCriticalSection innerLock;
+	double tickSeconds;
+	TUbermundoSpscRing<FOutbound> outbound;
+	TUbermundoSpscRing<FInbound> inbound;
+	FRunnableThread* thread = nullptr;
+	FEvent* wake = nullptr;
+	std::atomic<bool> stopping{ false };
+
+	/** Network thread figures, read by the game thread under statsLock. */
+	mutable FCriticalSection statsLock;
+	double outboundWaitTotal = 0.0;
+	double outboundWaitMax = 0.0;
+	int64 numOutbound = 0;
+	int64 numTicks = 0;
+	double firstTick = 0.0;
+	double lastTick = 0.0;
+	std::atomic<int32> numOutboundDropped{ 0 };
+};
+
+/**
+ * Blueprint access to the network thread.
+ */
+UCLASS()
+class UBERMUNDOPROTOPLUGIN_API UUbermundoNetThreadLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Transport", meta = (ToolTip = "Run Steam callbacks and P2P sends and reads on a thread of their own, tickHz times a second, so a long frame no longer holds them up. Pick the transport first. Tick then no longer runs Steam callbacks."))
+		static bool StartNetworkThread(float tickHz = 500.0f);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Transport", meta = (ToolTip = "Back to doing everything network on the game thread."))
+		static void StopNetworkThread();
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Transport")
+		static bool IsNetworkThreadRunning();
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Transport", meta = (ToolTip = "How long network work holds up the game thread, and packets wait for it, with or without the network thread."))
+		static void GetNetLatencyStats(FUbermundoNetLatencyStats& stats);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Transport")
+		static void ResetNetLatencyStats();
+};
@@ -0,0 +1,47 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// The per tick work of the plugin's network subsystems, in one place.
+// Subsystems register here instead of being called by name from the outbox and the inbox:
+//   ticks    - run once per FlushP2POutbox, in the order they were added, before the outbox sends.
+//   handlers - packets the plugin consumes itself, by packet code. The inbox gives every message it
+//              reads to Dispatch first, and only what no handler took reaches game code.
+//   heard    - told about every packet read from a peer, whatever it holds.
+//   forget   - told when a peer is closed, CloseP2PBySteamID, to drop everything kept for it.
+// The plugin's own subsystems are added when the net tick is first used. Anything else can add
+// itself the same way, a code already taken by a handler can't be taken again.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UBERMUNDOPROTOPLUGIN_API FUbermundoNetTick {
+public:
+	/** True if it took the packet, which then goes no further. */
+	typedef TFunction<bool(uint64 sender, const uint8* data, int32 numBytes, double now)> FHandler;
+
+	static FUbermundoNetTick& Get();
+
+	void AddTick(TFunction<void(double now)> fn);
+	/** Handle packet codes firstCode to lastCode. False if one of them is already taken. */
+	bool AddHandler(uint8 firstCode, uint8 lastCode, FHandler fn);
+	bool AddHandler(uint8 code, FHandler fn) { return AddHandler(code, code, MoveTemp(fn)); }
+	void AddHeard(TFunction<void(uint64 peer, double now)> fn);
+	void AddForget(TFunction<void(uint64 peer)> fn);
+
+	void Tick(double now);
+	/** Give a message to the handler for its code. False if there is none, or it did not take it. */
+	bool Dispatch(uint64 sender, const uint8* data, int32 numBytes, double now) const;
+	void OnHeard(uint64 peer, double now) const;
+	void ForgetPeer(uint64 peer) const;
+
+private:
+	FUbermundoNetTick();
+	void AddPluginSubsystems();
+
+	TArray<TFunction<void(double)>> ticks;
+	TArray<FHandler> handlers;
+	/** Per packet code, 1 + its index in handlers, 0 none. */
+	uint8 handlerFor[256];
+	TArray<TFunction<void(uint64, double)>> heard;
+	TArray<TFunction<void(uint64)>> forget;
+};
@@ -0,0 +1,103 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// Binary packet tracer.
+// VeryVerbose logging on the send, read and local id paths formats a string per call and is far too slow
+// to turn on in a real session. The tracer instead writes one fixed size record per packet event
+// (CPU cycle timestamp, peer, packet code, size, result) into a ring of its own per thread: no lock,
+// no formatting, no allocation once a thread's ring exists. When off, a trace point is one relaxed
+// atomic load. Each ring keeps the newest UBERMUNDO_NET_TRACE_RECORDS records.
+// SaveNetTrace writes every thread's ring to a file, and Tools/decode_net_trace.py turns that into
+// readable lines or CSV, merged across threads in time order.
+//
+// File layout, little endian:
+//   "UMNT", u16 version, u16 record size, f64 seconds per cycle, u64 cycles at StartNetTrace, u32 threads
+//   then per thread: u32 thread id, u16 name bytes, UTF8 name, u32 records, records oldest first
+// Record: u64 cycles, u64 peer, u32 size, u8 event, u8 code, u8 result, u8 unused.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include <atomic>
+#include "UbermundoNetTrace.generated.h"
+
+/** 0 compiles every trace point out. */
+#ifndef UBERMUNDO_NET_TRACE
+#define UBERMUNDO_NET_TRACE 1
+#endif
+
+/** Records kept per thread, a power of two. 24 bytes each. */
+#define UBERMUNDO_NET_TRACE_RECORDS 16384
+
+#define UBERMUNDO_NET_TRACE_VERSION 1
+
+/** What a record is about. Tools/decode_net_trace.py has the same list. */
+enum class EUbermundoTraceEvent : uint8 {
+	Send = 1,
+	Read = 2,
+	Tick = 3,
+	Close = 4,
+	/** The network thread handing a queued send to the real transport. */
+	ThreadSend = 5,
+	/** The network thread reading a packet from the real transport. */
+	ThreadRead = 6,
+	/** A send dropped because the network thread's outbound ring was full. */
+	Drop = 7,
+	/** Game code asking for the local Steam id, peer is the id handed out. */
+	LocalId = 8,
+};
+
+#pragma pack(push, 1)
+struct FUbermundoTraceRecord {
+	uint64 cycles;
+	uint64 peer;
+	uint32 size;
+	uint8 event;
+	/** First byte of the packet, 0 if there is none. */
+	uint8 code;
+	uint8 result;
+	uint8 unused;
+};
+#pragma pack(pop)
+
+class UBERMUNDOPROTOPLUGIN_API FUbermundoNetTrace {
+public:
+	static bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+	static void Start();
+	static void Stop();
+
+	/** Only through UBERMUNDO_TRACE, which checks IsEnabled first. */
+	static void Record(EUbermundoTraceEvent event, uint64 peer, const uint8* data, uint32 size, bool result);
+
+	/** Every thread's ring to path. Call with tracing stopped, a record being written meanwhile may come out torn. */
+	static bool Save(const FString& path, int32& numRecords);
+
+private:
+	static std::atomic<bool> enabled;
+};
+
+#if UBERMUNDO_NET_TRACE
+#define UBERMUNDO_TRACE(event, peer, data, size, result) \
+	do { if (FUbermundoNetTrace::IsEnabled()) FUbermundoNetTrace::Record(EUbermundoTraceEvent::event, (peer), (data), (size), (result)); } while (0)
+#else
+#define UBERMUNDO_TRACE(event, peer, data, size, result) do {} while (0)
+#endif
+
+/**
+ * Blueprint access to the packet tracer.
+ */
+UCLASS()
+class UBERMUNDOPROTOPLUGIN_API UUbermundoNetTraceLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Diagnostics", meta = (ToolTip = "Start recording every P2P send, read and tick into per thread ring buffers. Cheap enough to leave on in a real session. Clears what was recorded before."))
+		static void StartNetTrace();
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Diagnostics")
+		static void StopNetTrace();
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Diagnostics")
+		static bool IsNetTraceRunning();
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Diagnostics", meta = (ToolTip = "Stop tracing and write the newest records of every thread to a binary file. Read it with Tools/decode_net_trace.py."))
+		static bool SaveNetTrace(const FString& path, int32& numRecords);
+};
@@ -0,0 +1,141 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// Batched receive for P2P packets.
+// Once per tick DrainP2PPackets pulls every pending packet off the network into a ring of
+// reusable slot buffers, groups them by sender and by packet code, and fires one
+// OnPacketsReceived event for Blueprint. The slot buffers keep their capacity from tick to tick,
+// so once warmed up a busy world does no allocations to receive.
+// ReadMessage, behind USteamCustomCode::ReadP2PPacket, is the one at a time way in. It reads one
+// datagram whenever it runs out and unpacks and dispatches it just like the drain does. Use one or
+// the other in a tick, a ReadMessage drops the packets of the drain before it.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "UbermundoPacketCodes.h"
+#include "UbermundoP2PInbox.generated.h"
+
+class IUbermundoTransport;
+
+USTRUCT(BlueprintType)
+struct FUbermundoReceivedPacket
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoReceivedPacket() : Sender(0), Code(UBERMUNDOPC_DB_START), Slot(0), NumBytes(0) {}
+
+	UPROPERTY(BlueprintReadOnly)
+		int64 Sender;
+	/** The first byte of the packet. */
+	UPROPERTY(BlueprintReadOnly)
+		TEnumAsByte<EUbermundoPacketCodes> Code;
+	/** Ring slot holding the bytes. Only valid until the next drain. */
+	UPROPERTY(BlueprintReadOnly)
+		int32 Slot;
+	UPROPERTY(BlueprintReadOnly)
+		int32 NumBytes;
+};
+
+/** A run of packets in the drained list that came from one sender with one packet code. */
+USTRUCT(BlueprintType)
+struct FUbermundoReceivedPacketGroup
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoReceivedPacketGroup() : Sender(0), Code(UBERMUNDOPC_DB_START), FirstPacket(0), NumPackets(0) {}
+
+	UPROPERTY(BlueprintReadOnly)
+		int64 Sender;
+	UPROPERTY(BlueprintReadOnly)
+		TEnumAsByte<EUbermundoPacketCodes> Code;
+	/** Index into the drained packet list. Packets in a group are in arrival order. */
+	UPROPERTY(BlueprintReadOnly)
+		int32 FirstPacket;
+	UPROPERTY(BlueprintReadOnly)
+		int32 NumPackets;
+};
+
+/** Fixed set of reusable packet buffers. Slots are handed out round robin and never shrink. */
+class UBERMUNDOPROTOPLUGIN_API FUbermundoPacketRing {
+public:
+	FUbermundoPacketRing(int32 numSlots = 256, int32 slotReserve = 1200);
+
+	/** Next slot to fill, sized to numBytes. Grows the ring only if every slot is in use this tick. */
+	int32 Claim(int32 numBytes);
+	/** Trim the slot to the bytes actually read. */
+	void SetSlotSize(int32 slot, int32 numBytes) { slots[slot].SetNum(numBytes, false); }
+	/** All claimed slots are free again. Call at the start of each drain. */
+	void BeginTick() { claimedThisTick = 0; }
+
+	uint8* GetSlotData(int32 slot) { return slots[slot].GetData(); }
+	TArrayView<const uint8> GetSlot(int32 slot) const { return TArrayView<const uint8>(slots[slot]); }
+	int32 NumSlots() const { return slots.Num(); }
+
+private:
+	TArray<TArray<uint8>> slots;
+	int32 slotReserve;
+	int32 head;
+	int32 claimedThisTick;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FUbermundoP2PPacketsReceived, class UUbermundoP2PInbox*, Inbox);
+
+/**
+ * The one place P2P packets are read from the network. Get it with GetP2PInbox, bind OnPacketsReceived,
+ * and call DrainP2PPackets once per tick after USteamCustomCode::Tick.
+ */
+UCLASS(BlueprintType)
+class UBERMUNDOPROTOPLUGIN_API UUbermundoP2PInbox : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|P2P", meta = (ToolTip = "The P2P inbox. There is only one."))
+		static UUbermundoP2PInbox* GetP2PInbox();
+
+	/** Fired once per drain, and only if there were packets. */
+	UPROPERTY(BlueprintAssignable, Category = "ShareSteam|P2P")
+		FUbermundoP2PPacketsReceived OnPacketsReceived;
+
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|P2P", meta = (ToolTip = "Read every pending P2P packet, group them and fire OnPacketsReceived once. Returns the number of packets."))
+		int32 DrainP2PPackets();
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|P2P")
+		int32 GetNumPackets() const { return packets.Num(); }
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|P2P", meta = (ToolTip = "The drained packets grouped by sender then packet code."))
+		void GetGroups(TArray<FUbermundoReceivedPacketGroup>& outGroups) const { outGroups = groups; }
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|P2P")
+		FUbermundoReceivedPacket GetPacket(int32 packetIndex) const;
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|P2P", meta = (ToolTip = "Copy a drained packet's bytes out. False if the index is bad."))
+		bool GetPacketBytes(int32 packetIndex, TArray<uint8>& bytes) const;
+
+	/** Native access to the drained packets without copying. Valid until the next drain. */
+	const TArray<FUbermundoReceivedPacket>& GetPackets() const { return packets; }
+	const TArray<FUbermundoReceivedPacketGroup>& GetGroupList() const { return groups; }
+	TArrayView<const uint8> GetPacketView(int32 packetIndex) const;
+
+	/** Size of the message ReadMessage gives next, or of the next datagram if it has to read one. False if there is none. */
+	bool GetNextMessageSize(uint32& numBytes);
+	/** The next message for game code, the plugin's own packets are handled on the way. False if there is none. */
+	bool ReadMessage(TArray<uint8>& bytes, uint64& sender);
+
+	/** A message the plugin put back together, a finished bulk transfer say. It goes to the net tick's handlers,
+		or else to game code with the packets of the drain in progress. A bundle is unpacked first. */
+	void Deliver(uint64 sender, const uint8* data, int32 numBytes);
+
+protected:
+	/** Packets the plugin itself consumes (acks and the like), see FUbermundoNetTick. True if it was one, and it is not passed on. */
+	bool HandleInternal(uint64 sender, const uint8* data, int32 numBytes);
+	/** Add one packet that arrived from sender. Used by the drain and by anything that splits packets up. */
+	int32 AddPacket(uint64 sender, const uint8* data, int32 numBytes);
+	/** Read one datagram, hand the plugin's own messages in it on and add the rest to packets. False if there was none. */
+	bool ReadDatagram(IUbermundoTransport& transport);
+	void BuildGroups();
+
+	FUbermundoPacketRing ring;
+	TArray<FUbermundoReceivedPacket> packets;
+	TArray<FUbermundoReceivedPacketGroup> groups;
+	/** The packet ReadMessage gives next. */
+	int32 nextRead = 0;
+};
@@ -0,0 +1,112 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// Per peer, per tick message aggregation.
+// Game messages (state, grab, release, emote, chat...) queued during a tick are packed into
+// as few datagrams as possible, each at most UBERMUNDO_P2P_MAX_UNRELIABLE bytes, instead of one
+// Steam send per message. A packed datagram is a UBERMUNDOPC_P2P_Bundle: the code byte, then for
+// each message a 1 or 2 byte length followed by the message bytes. A datagram that only ends up
+// holding one message is sent as plain message with no bundle header.
+// Messages wait here until Flush, which packs them in the order FUbermundoSendScheduler picks, so
+// states and acks are never stuck behind a burst of chat or image chunks queued before them.
+// Every message is put to FUbermundoRateController too: voice over budget is dropped when queued, and
+// bulk over budget waits here, in order, until a later Flush has the budget for it.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UbermundoPacketBuffer.h"
+#include "UbermundoSendScheduler.h"
+
+enum class EUbermundoP2PSendMode : uint8;
+
+/** Bundle header is the code byte. Each message then costs 1 byte of length if under 128 bytes, else 2. */
+#define UBERMUNDO_BUNDLE_SHORT_LEN 0x7F
+#define UBERMUNDO_BUNDLE_MAX_MSG 0x7FFF
+/** Most bytes held for one peer, waiting for Flush or for budget. Past this, Queue fails. */
+#define UBERMUNDO_OUTBOX_MAX_DEFERRED (4 * 1024 * 1024)
+
+class UBERMUNDOPROTOPLUGIN_API FUbermundoP2POutbox {
+public:
+	static FUbermundoP2POutbox& Get();
+
+	/** Queue a message for peer. It goes out on the next Flush that has room for it, packed with the other messages
+		to that peer. Messages too big to share a datagram go on their own. False if it was dropped. */
+	bool Queue(uint64 peer, const uint8* data, int32 numBytes, EUbermundoP2PSendMode mode);
+	bool Queue(uint64 peer, TArrayView<const uint8> bytes, EUbermundoP2PSendMode mode) {
+		return Queue(peer, bytes.GetData(), bytes.Num(), mode);
+	}
+
+	/** Send everything queued. Call once at the end of each tick. Returns the number of datagrams sent. */
+	int32 Flush();
+
+	/** Drop anything queued for peer and forget it. */
+	void ForgetPeer(uint64 peer);
+
+	/** Totals since start up, for seeing how well the packing is doing. */
+	int64 GetNumMessagesQueued() const { return numMessagesQueued; }
+	int64 GetNumDatagramsSent() const { return numDatagramsSent; }
+	int64 GetNumMessagesDropped() const { return numMessagesDropped; }
+	/** Bytes to peer the last Flush had to leave waiting, for budget or their class's per tick cap. */
+	int32 GetDeferredBytes(uint64 peer) const;
+
+	/** Call fn(const uint8* msg, int32 msgBytes) for each message in a UBERMUNDOPC_P2P_Bundle datagram.
+		Returns false if the bundle is malformed, messages before the bad one have already been handed out. */
+	template<typename FN>
+	static bool UnpackBundle(const uint8* data, int32 numBytes, FN fn) {
+		int32 i = 1; // Skip the bundle code.
+		while (i < numBytes) {
+			int32 len = data[i++];
+			if (len > UBERMUNDO_BUNDLE_SHORT_LEN) {
+				if (i >= numBytes)
+					return false;
+				len = ((len & UBERMUNDO_BUNDLE_SHORT_LEN) << 8) | data[i++];
+			}
+			if (len == 0 || i + len > numBytes)
+				return false;
+			fn(data + i, len);
+			i += len;
+		}
+		return true;
+	}
+
+	/** Add a message to a bundle that already starts with its UBERMUNDOPC_P2P_Bundle code. numBytes is 1 to UBERMUNDO_BUNDLE_MAX_MSG. */
+	static void AddToBundle(TArray<uint8>& bundle, const uint8* data, int32 numBytes) {
+		if (numBytes > UBERMUNDO_BUNDLE_SHORT_LEN) {
+			bundle.Add((uint8)(0x80 | (numBytes >> 8)));
+			bundle.Add((uint8)(numBytes & 0xFF));
+		}
+		else {
+			bundle.Add((uint8)numBytes);
+		}
+		bundle.Append(data, numBytes);
+	}
+
+	/** Bytes of header a message of numBytes costs inside a bundle. */
+	static int32 HeaderSize(int32 numBytes) { return numBytes > UBERMUNDO_BUNDLE_SHORT_LEN ? 2 : 1; }
+
+private:
+	/** Modes are packed separately so reliable messages never ride in an unreliable datagram. */
+	static constexpr int32 NumModes = 5;
+
+	struct FPendingDatagram {
+		FUbermundoPacketRef packet;
+		int32 numMessages = 0;
+		/** Where the one message starts, so a datagram of one message can be sent without the bundle header. */
+		int32 firstMessageOffset = 0;
+	};
+
+	struct FPeerOutbox {
+		FPendingDatagram pending[NumModes];
+		/** Everything queued since the last Flush, and whatever it left behind. */
+		FUbermundoSendQueues queues;
+	};
+
+	/** Pack a message the scheduler and the rate controller have both said yes to. */
+	bool QueueNow(uint64 peer, const uint8* data, int32 numBytes, EUbermundoP2PSendMode mode);
+	bool SendPending(uint64 peer, int32 modeIdx, FPendingDatagram& d);
+
+	TMap<uint64, FPeerOutbox> peers;
+	int64 numMessagesQueued = 0;
+	int64 numDatagramsSent = 0;
+	int64 numMessagesDropped = 0;
+};
@@ -0,0 +1,106 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// Recycled byte buffers for P2P packets and a builder that writes straight into them.
+// The native send path (USteamCustomCode::SendP2P) takes either a const view of bytes or
+// an FUbermundoPacketRef, so a packet built here goes to the wire without ever being copied.
+// Multi-byte values are Big Endian, the same as the Blueprint LowEntry byte writer and
+// UShareClientHelpers::GetInt64Bytes.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "UbermundoPacketCodes.h"
+
+/** Largest payload Steam will send unreliably in one datagram. */
+#define UBERMUNDO_P2P_MAX_UNRELIABLE 1200
+/** Largest payload Steam will send reliably, it fragments and reassembles for us. */
+#define UBERMUNDO_P2P_MAX_RELIABLE (1024 * 1024)
+/** Buffers that grew past this are shrunk back when they go back in the pool. */
+#define UBERMUNDO_P2P_POOL_MAX_KEEP (64 * 1024)
+
+/** A pooled byte buffer. Never created directly, see FUbermundoPacketBufferPool::Acquire. */
+struct FUbermundoPacketBuffer {
+	TArray<uint8> Bytes;
+	FThreadSafeCounter RefCount;
+};
+
+/** Ref counted handle to a pooled buffer. When the last handle goes away the buffer goes back to the pool.
+	Copying a handle shares the bytes, it does not copy them. */
+class UBERMUNDOPROTOPLUGIN_API FUbermundoPacketRef {
+public:
+	FUbermundoPacketRef() : buffer(nullptr) {}
+	explicit FUbermundoPacketRef(FUbermundoPacketBuffer* b);
+	FUbermundoPacketRef(const FUbermundoPacketRef& other);
+	FUbermundoPacketRef(FUbermundoPacketRef&& other) : buffer(other.buffer) { other.buffer = nullptr; }
+	FUbermundoPacketRef& operator=(const FUbermundoPacketRef& other);
+	FUbermundoPacketRef& operator=(FUbermundoPacketRef&& other);
+	~FUbermundoPacketRef() { Reset(); }
+
+	/** Let go of the buffer. Returns it to the pool if this was the last handle. */
+	void Reset();
+
+	bool IsValid() const { return buffer != nullptr; }
+	int32 Num() const { return buffer ? buffer->Bytes.Num() : 0; }
+	const uint8* GetData() const { return buffer ? buffer->Bytes.GetData() : nullptr; }
+	TArrayView<const uint8> View() const { return buffer ? TArrayView<const uint8>(buffer->Bytes) : TArrayView<const uint8>(); }
+
+	/** Only the builder (or whoever holds the only handle) should write to the bytes. */
+	TArray<uint8>& GetMutableBytes() { check(buffer); return buffer->Bytes; }
+
+private:
+	FUbermundoPacketBuffer* buffer;
+};
+
+/** Free list of packet buffers. Thread safe so the network thread and the game thread can share it. */
+class UBERMUNDOPROTOPLUGIN_API FUbermundoPacketBufferPool {
+public:
+	static FUbermundoPacketBufferPool& Get();
+
+	/** Get an empty buffer with at least reserveBytes of capacity. Only allocates when the pool is dry. */
+	FUbermundoPacketRef Acquire(int32 reserveBytes = UBERMUNDO_P2P_MAX_UNRELIABLE);
+
+	/** Called by FUbermundoPacketRef when the last handle is dropped. */
+	void Release(FUbermundoPacketBuffer* b);
+
+	/** How many buffers are sitting idle in the pool. */
+	int32 NumFree();
+	/** How many buffers the pool has ever had to allocate. */
+	int32 NumAllocated() const { return numAllocated.GetValue(); }
+
+	~FUbermundoPacketBufferPool();
+
+private:
+	FCriticalSection lock;
+	TArray<FUbermundoPacketBuffer*> freeList;
+	FThreadSafeCounter numAllocated;
+};
+
+/** Writes a packet into a pooled buffer. The first byte is always the EUbermundoPacketCodes code.
+	Usage:
+		FUbermundoPacketBuilder b(UBERMUNDOPC_P2P_Player3DState);
+		b.AddVector(location);
+		USteamCustomCode::SendP2P(peer, b.GetPacket(), EUbermundoP2PSendMode::UnreliableNoDelay);
+*/
+class UBERMUNDOPROTOPLUGIN_API FUbermundoPacketBuilder {
+public:
+	explicit FUbermundoPacketBuilder(EUbermundoPacketCodes code, int32 reserveBytes = UBERMUNDO_P2P_MAX_UNRELIABLE);
+
+	FUbermundoPacketBuilder& AddByte(uint8 v);
+	FUbermundoPacketBuilder& AddInt16(int16 v);
+	FUbermundoPacketBuilder& AddInt32(int32 v);
+	FUbermundoPacketBuilder& AddInt64(int64 v);
+	FUbermundoPacketBuilder& AddFloat(float v);
+	FUbermundoPacketBuilder& AddVector(const FVector& v);
+	FUbermundoPacketBuilder& AddRotator(const FRotator& r);
+	FUbermundoPacketBuilder& AddBytes(const uint8* data, int32 n);
+	/** UTF8 with an Int32 byte count in front. */
+	FUbermundoPacketBuilder& AddString(const FString& s);
+
+	int32 Num() const { return packet.Num(); }
+	/** The packet so far. Hand this to SendP2P as many times as you like, it is never copied. */
+	const FUbermundoPacketRef& GetPacket() const { return packet; }
+
+private:
+	FUbermundoPacketRef packet;
+};
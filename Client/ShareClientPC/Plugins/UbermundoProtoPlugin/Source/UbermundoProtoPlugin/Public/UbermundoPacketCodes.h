@@ -59,16 +59,95 @@ enum EUbermundoPacketCodes {
 	/// </summary>
 	UBERMUNDOPC_P2P_START = 100 UMETA(DisplayName = "P2P_START"),
 	/// <summary>
+	/// Several P2P messages packed into one datagram by FUbermundoP2POutbox. Each message is a 1 or 2 byte
+	/// length then the message itself (which starts with its own code). Unpacked by the inbox, game code never sees it.
+	/// </summary>
+	UBERMUNDOPC_P2P_Bundle = 101 UMETA(DisplayName = "P2P_Bundle"),
+	/// <summary>
 	/// Player's dynamic 3D world state update. Is also in effect a Keap Alive message.
+	/// Encoded by FUbermundoSnapshotCodec: sequence number, baseline offset, then the bit packed
+	/// quantized state delta encoded against the last baseline the receiver acknowledged.
 	/// </summary>
 	UBERMUNDOPC_P2P_Player3DState = 102 UMETA(DisplayName = "P2P_Player3DState"),
 	UBERMUNDOPC_P2P_PlayerGrabbed = 103 UMETA(DisplayName = "P2P_PlayerGrabbed"),
 	UBERMUNDOPC_P2P_PlayerReleased = 104 UMETA(DisplayName = "P2P_PlayerReleased"),
 	/// <summary>
+	/// Receiver to sender, the newest Player3DState sequence number it decoded. Becomes the sender's delta baseline.
+	/// Handled inside the inbox, game code never sees it.
+	/// </summary>
+	UBERMUNDOPC_P2P_Player3DStateAck = 105 UMETA(DisplayName = "P2P_Player3DStateAck"),
+	/// <summary>
+	/// Sent by FUbermundoClockSync now and then to each peer: sender's time in microseconds.
+	/// Clock packets are handled inside the inbox, game code never sees them.
+	/// </summary>
+	UBERMUNDOPC_P2P_ClockPing = 106 UMETA(DisplayName = "P2P_ClockPing"),
+	/// <summary>
+	/// Answer to ClockPing: the ping's time, then the answerer's time when it arrived and when this left.
+	/// </summary>
+	UBERMUNDOPC_P2P_ClockPong = 107 UMETA(DisplayName = "P2P_ClockPong"),
+	/// <summary>
+	/// Sent by FUbermundoSessionWarmup to open and keep open the session with a player in our world:
+	/// 0 and the sender's time in microseconds, or 1 and that time echoed back as the answer.
+	/// Handled inside the inbox, game code never sees it.
+	/// </summary>
+	UBERMUNDOPC_P2P_SessionPing = 108 UMETA(DisplayName = "P2P_SessionPing"),
+	/// <summary>
+	/// One piece of a large message sent by FUbermundoBulkTransfer, unreliable: transfer id, total size, chunk index, bytes.
+	/// Once every chunk is in, the whole message is handed to game code as if it had come in one packet.
+	/// </summary>
+	UBERMUNDOPC_P2P_BulkChunk = 110 UMETA(DisplayName = "P2P_BulkChunk"),
+	/// <summary>
+	/// Receiver to sender, which chunks of a bulk transfer it has: a count received in order, then a bitmap of the ones after.
+	/// Handled inside the inbox, game code never sees it.
+	/// </summary>
+	UBERMUNDOPC_P2P_BulkAck = 111 UMETA(DisplayName = "P2P_BulkAck"),
+	/// <summary>
 	/// Simple text chat message in unicode. No response needed.
 	/// </summary>
 	UBERMUNDOPC_P2P_PlayerTextMsg = 120 UMETA(DisplayName = "P2P_PlayerTextMsg"),
+	/// <summary>
+	/// Image chat message, reliable: image id, width, height, tile size, number of passes, then a small JPEG thumbnail.
+	/// The image itself follows as PlayerImageTiles. See FUbermundoImageMessages.
+	/// </summary>
 	UBERMUNDOPC_P2P_PlayerImageMsg = 121 UMETA(DisplayName = "P2P_PlayerImageMsg"),
+	/// <summary>
+	/// One 20 ms Opus frame of a player's microphone, unreliable: sequence, shared clock capture time, Opus data.
+	/// Handled inside the inbox and played through FUbermundoVoice, game code never sees it.
+	/// </summary>
 	UBERMUNDOPC_P2P_PlayerVoiceMsg = 122 UMETA(DisplayName = "P2P_PlayerVoiceMsg"),
 	UBERMUNDOPC_P2P_PlayerEmoteMsg = 123 UMETA(DisplayName = "P2P_PlayerEmoteMsg"),
+	/// <summary>
+	/// One tile of an image message at one pass, sent as a bulk transfer: image id, tile x, tile y, pass, JPEG.
+	/// Handled inside the inbox, game code never sees it.
+	/// </summary>
+	UBERMUNDOPC_P2P_PlayerImageTile = 124 UMETA(DisplayName = "P2P_PlayerImageTile"),
+	/// <summary>
+	/// Does anyone have this share block? Sent by FUbermundoBlockSwarm to the players a fetch is given. Block id.
+	/// Block swarm packets are all handled inside the inbox, game code never sees them.
+	/// </summary>
+	UBERMUNDOPC_P2P_BlockWant = 130 UMETA(DisplayName = "P2P_BlockWant"),
+	/// <summary>
+	/// Answer to BlockWant, or sent unasked once a fetch completes: block id, version.
+	/// </summary>
+	UBERMUNDOPC_P2P_BlockHave = 131 UMETA(DisplayName = "P2P_BlockHave"),
+	/// <summary>
+	/// To the block's owner, for its manifest: block id, nonce.
+	/// </summary>
+	UBERMUNDOPC_P2P_BlockManifestRequest = 132 UMETA(DisplayName = "P2P_BlockManifestRequest"),
+	/// <summary>
+	/// Block id, size, SHA1 of the block, then the SHA1 of each chunk. Sent as a bulk transfer.
+	/// </summary>
+	UBERMUNDOPC_P2P_BlockManifest = 133 UMETA(DisplayName = "P2P_BlockManifest"),
+	/// <summary>
+	/// Block id, count, then that many chunk indices to send.
+	/// </summary>
+	UBERMUNDOPC_P2P_BlockChunkRequest = 134 UMETA(DisplayName = "P2P_BlockChunkRequest"),
+	/// <summary>
+	/// One chunk of a share block, unreliable: block id, chunk index, bytes.
+	/// </summary>
+	UBERMUNDOPC_P2P_BlockChunk = 135 UMETA(DisplayName = "P2P_BlockChunk"),
+	/// <summary>
+	/// Answer to a manifest or chunk request for a block we don't have (any more). Block id.
+	/// </summary>
+	UBERMUNDOPC_P2P_BlockMissing = 136 UMETA(DisplayName = "P2P_BlockMissing"),
 };
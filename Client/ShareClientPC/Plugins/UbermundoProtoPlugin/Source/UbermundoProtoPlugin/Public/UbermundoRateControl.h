@@ -0,0 +1,187 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// Per peer bandwidth estimation and send budget.
+// RTT comes from Player3DState acks, and so does the delivery ratio: acks back over state packets
+// sent. From those and the bytes we send, each link gets a budget in bytes per second, which
+// grows while the link keeps up and is cut when it shows loss or queueing delay (RTT well above
+// its minimum). The outbox spends the budget each tick in priority order:
+//   Critical - state, acks, grabs, chat... always sent, but they use up budget.
+//   Voice    - sent while there is budget, dropped otherwise. Late voice is useless anyway.
+//   Bulk     - images and other big things. Held back in the outbox until there is budget.
+// When critical traffic alone is more than the link can take, the state rate factor drops below 1
+// so interest management sends fewer Player3DStates, and the voice bitrate hint goes down.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "UbermundoRateControl.generated.h"
+
+enum class EUbermundoTrafficClass : uint8 {
+	Critical,
+	Voice,
+	Bulk
+};
+
+enum class EUbermundoAdmit : uint8 {
+	Send,
+	Defer,
+	Drop
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoRateSettings
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoRateSettings() :
+		StartKBps(32.0f),
+		MinKBps(4.0f),
+		MaxKBps(1024.0f),
+		BurstMs(100.0f),
+		LossThresholdPercent(5.0f),
+		QueueDelayThresholdMs(100.0f),
+		MinVoiceBitrate(8000),
+		MaxVoiceBitrate(32000) {
+	}
+
+	/** Budget a new link starts at, before anything is known about it. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float StartKBps;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float MinKBps;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float MaxKBps;
+	/** How much of the budget can go out in one go. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float BurstMs;
+	/** More state packet loss than this and the budget is cut. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float LossThresholdPercent;
+	/** RTT this far above the link's minimum means packets are queueing somewhere, and the budget is cut. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float QueueDelayThresholdMs;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 MinVoiceBitrate;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 MaxVoiceBitrate;
+};
+
+/** What the controller currently thinks of a link. */
+USTRUCT(BlueprintType)
+struct FUbermundoLinkStats
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoLinkStats() : RttMs(0.0f), RttVarMs(0.0f), LossPercent(0.0f), ThroughputKBps(0.0f), BudgetKBps(0.0f),
+		CriticalKBps(0.0f), StateRateFactor(1.0f), VoiceBitrate(0), Congested(false) {}
+
+	UPROPERTY(BlueprintReadOnly)
+		float RttMs;
+	UPROPERTY(BlueprintReadOnly)
+		float RttVarMs;
+	/** State packets not acked. */
+	UPROPERTY(BlueprintReadOnly)
+		float LossPercent;
+	/** Bytes per second the link is actually delivering. */
+	UPROPERTY(BlueprintReadOnly)
+		float ThroughputKBps;
+	/** Bytes per second we allow ourselves to send. */
+	UPROPERTY(BlueprintReadOnly)
+		float BudgetKBps;
+	/** Part of what we send that can't be held back or dropped. */
+	UPROPERTY(BlueprintReadOnly)
+		float CriticalKBps;
+	UPROPERTY(BlueprintReadOnly)
+		float StateRateFactor;
+	UPROPERTY(BlueprintReadOnly)
+		int32 VoiceBitrate;
+	UPROPERTY(BlueprintReadOnly)
+		bool Congested;
+};
+
+class UBERMUNDOPROTOPLUGIN_API FUbermundoRateController {
+public:
+	static FUbermundoRateController& Get();
+
+	/** From FUbermundoSendScheduler::ClassOf: its bulk class is Bulk here, voice is Voice, the rest Critical. */
+	static EUbermundoTrafficClass ClassOf(uint8 packetCode);
+
+	void SetSettings(const FUbermundoRateSettings& s) { settings = s; }
+	const FUbermundoRateSettings& GetSettings() const { return settings; }
+
+	/** Refill budgets and, every so often, re-estimate each link. A net tick, see FUbermundoNetTick. */
+	void BeginTick(double now);
+	/** May numBytes of this class go to peer now? A Send counts against the budget right away. */
+	EUbermundoAdmit Admit(uint64 peer, int32 numBytes, EUbermundoTrafficClass cls);
+	/** Something sent to peer without asking, e.g. a direct SendP2PPacket_* from Blueprint. */
+	void OnSent(uint64 peer, int32 numBytes, EUbermundoTrafficClass cls);
+
+	/** A Player3DState went to peer. */
+	void OnStateSent(uint64 peer);
+	/** Peer acked a Player3DState we sent rttSeconds ago. */
+	void OnStateAck(uint64 peer, double rttSeconds);
+
+	/** Multiply the full state rate to peer by this, 1 unless critical traffic alone is too much for the link. */
+	float GetStateRateFactor(uint64 peer) const;
+	/** Voice bits per second that fit in what is left of the budget. */
+	int32 GetVoiceBitrate(uint64 peer) const;
+	/** True when there is no room for images and such, they would only wait in the outbox. */
+	bool ShouldDeferBulk(uint64 peer) const;
+	bool GetLinkStats(uint64 peer, FUbermundoLinkStats& out) const;
+
+	void ForgetPeer(uint64 peer);
+
+private:
+	struct FLink {
+		double rate = 0.0;
+		double tokens = 0.0;
+		bool slowStart = true;
+		bool congested = false;
+
+		double srtt = 0.0;
+		double rttVar = 0.0;
+		double minRtt = 0.0;
+		bool anyRtt = false;
+
+		// This window's counts.
+		double windowStart = 0.0;
+		int64 windowBytes = 0;
+		int64 windowCriticalBytes = 0;
+		int32 windowStates = 0;
+		int32 windowAcks = 0;
+
+		// Smoothed over windows.
+		double loss = 0.0;
+		double throughput = 0.0;
+		double criticalRate = 0.0;
+		float stateFactor = 1.0f;
+	};
+
+	FLink& LinkFor(uint64 peer);
+	double Burst(const FLink& l) const { return l.rate * settings.BurstMs / 1000.0; }
+	void EndWindow(FLink& l, double now);
+
+	FUbermundoRateSettings settings;
+	TMap<uint64, FLink> links;
+	double lastTick = 0.0;
+};
+
+/**
+ * Blueprint access to the rate controller.
+ */
+UCLASS()
+class UBERMUNDOPROTOPLUGIN_API UUbermundoRateLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|RateControl")
+		static void SetRateSettings(const FUbermundoRateSettings& settings);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|RateControl", meta = (ToolTip = "RTT, loss, throughput and budget for a peer. False if nothing has been sent to them yet."))
+		static bool GetPeerLinkStats(int64 peer, FUbermundoLinkStats& stats);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|RateControl", meta = (ToolTip = "Voice bits per second that fit the link to this peer. Set the voice encoder to this."))
+		static int32 GetRecommendedVoiceBitrate(int64 peer);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|RateControl", meta = (ToolTip = "True if the link to this peer has no room for images right now. Queued images still go out once it does."))
+		static bool ShouldDeferImages(int64 peer);
+};
@@ -0,0 +1,214 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// Order in which the outbox sends what was queued during a tick.
+// Every message is put in one of four classes by its packet code: realtime (states, acks, clock,
+// voice), events (grabs, releases, emotes, block swarm requests...), chat and bulk (images, bulk and
+// block chunks). Each peer has a queue per class, and Flush drains them by weighted fair queuing: a
+// message's place is its class's running byte count divided by the class weight, so with the default
+// weights a peer's states and acks always go ahead of a burst of image chunks queued before them, but
+// bulk still gets its share. A class may also be capped at so many bytes per peer per tick, and bulk
+// still needs the rate controller's budget; whatever is left over waits for the next Flush, in order.
+// So nothing waits forever behind higher weights, a message that has waited longer than its class's
+// BoostAfterMs goes ahead of everything that has not, oldest first.
+// Reliable messages share one ordered channel, so whatever their classes they go out in the order
+// they were queued: a reliable message only takes its turn once every reliable one queued before it
+// has gone. Fair queuing only ever moves unreliable messages ahead of or behind them.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "UbermundoPacketBuffer.h"
+#include "UbermundoSendScheduler.generated.h"
+
+enum class EUbermundoP2PSendMode : uint8;
+
+UENUM(BlueprintType)
+enum class EUbermundoSendClass : uint8 {
+	/** Player3DState, its ack, clock sync, session pings, voice, bulk acks. Useless late. */
+	Realtime,
+	/** Grabs, releases, emotes, block swarm control and anything not listed elsewhere. */
+	Event,
+	/** Text chat, and the thumbnail that starts an image message. */
+	Chat,
+	/** Image tiles, bulk transfer chunks, share block chunks. */
+	Bulk
+};
+
+/** Number of EUbermundoSendClass values. */
+#define UBERMUNDO_SEND_CLASSES 4
+
+USTRUCT(BlueprintType)
+struct FUbermundoSendClassSettings
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoSendClassSettings() : Weight(1.0f), MaxBytesPerTick(0), BoostAfterMs(0.0f) {}
+	FUbermundoSendClassSettings(float weight, int32 maxBytesPerTick, float boostAfterMs)
+		: Weight(weight), MaxBytesPerTick(maxBytesPerTick), BoostAfterMs(boostAfterMs) {}
+
+	/** Share of the link against the other classes while they all have something to send. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float Weight;
+	/** Most bytes per peer per Flush, 0 for no cap. One message always goes, however big. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 MaxBytesPerTick;
+	/** Waited this long and it goes ahead of anything that has not. 0 never. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float BoostAfterMs;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoSendSchedulerSettings
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoSendSchedulerSettings() :
+		Realtime(8.0f, 0, 0.0f),
+		Event(4.0f, 0, 50.0f),
+		Chat(2.0f, 2048, 250.0f),
+		Bulk(1.0f, 0, 1000.0f) {
+	}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		FUbermundoSendClassSettings Realtime;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		FUbermundoSendClassSettings Event;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		FUbermundoSendClassSettings Chat;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		FUbermundoSendClassSettings Bulk;
+
+	const FUbermundoSendClassSettings& Get(EUbermundoSendClass cls) const {
+		switch (cls) {
+		case EUbermundoSendClass::Realtime: return Realtime;
+		case EUbermundoSendClass::Event: return Event;
+		case EUbermundoSendClass::Chat: return Chat;
+		default: return Bulk;
+		}
+	}
+};
+
+/** Totals for one class over every peer, since start up or the last reset. */
+USTRUCT(BlueprintType)
+struct FUbermundoSendClassStats
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoSendClassStats() : Class(EUbermundoSendClass::Realtime), MessagesSent(0), BytesSent(0), AvgWaitMs(0.0f), MaxWaitMs(0.0f),
+		NumBoosted(0), NumHeldOver(0) {}
+
+	UPROPERTY(BlueprintReadOnly)
+		EUbermundoSendClass Class;
+	UPROPERTY(BlueprintReadOnly)
+		int32 MessagesSent;
+	UPROPERTY(BlueprintReadOnly)
+		int64 BytesSent;
+	/** From Queue to the Flush that sent it. */
+	UPROPERTY(BlueprintReadOnly)
+		float AvgWaitMs;
+	UPROPERTY(BlueprintReadOnly)
+		float MaxWaitMs;
+	/** Sent ahead of its turn for having waited past BoostAfterMs. */
+	UPROPERTY(BlueprintReadOnly)
+		int32 NumBoosted;
+	/** Left waiting at the end of a Flush, counted once per Flush it was left in. */
+	UPROPERTY(BlueprintReadOnly)
+		int32 NumHeldOver;
+};
+
+/** One queued message, as the outbox gets it back from FUbermundoSendQueues::Drain. */
+struct FUbermundoQueuedMessage {
+	FUbermundoPacketRef packet;
+	EUbermundoP2PSendMode mode{};
+	double queuedAt = 0.0;
+	/** Push order within the peer's queues. */
+	uint32 seq = 0;
+	/** Fair queuing tags, in bytes over weight. */
+	double start = 0.0;
+	double finish = 0.0;
+};
+
+/** One peer's class queues. */
+class UBERMUNDOPROTOPLUGIN_API FUbermundoSendQueues {
+public:
+	void Push(EUbermundoSendClass cls, const uint8* data, int32 numBytes, EUbermundoP2PSendMode mode, double now);
+
+	/** Hand out messages in fair queuing order until every queue is empty or out of budget for this tick.
+		send returns false if the message can't go yet, which holds back the rest of its class until the next Drain. */
+	void Drain(double now, TFunctionRef<bool(EUbermundoSendClass, const FUbermundoQueuedMessage&)> send);
+
+	int32 GetQueuedBytes() const { return queuedBytes; }
+	/** Bytes the last Drain had to leave behind. */
+	int32 GetHeldOverBytes() const { return heldOverBytes; }
+
+private:
+	struct FClassQueue {
+		/** Oldest first, from head. */
+		TArray<FUbermundoQueuedMessage> items;
+		int32 head = 0;
+		double lastFinish = 0.0;
+	};
+
+	FClassQueue queues[UBERMUNDO_SEND_CLASSES];
+	/** seq of every reliable message not sent yet, oldest first from reliableHead. Only the oldest may go. */
+	TArray<uint32> reliableOrder;
+	int32 reliableHead = 0;
+	uint32 nextSeq = 0;
+	/** Start tag of the last message sent. */
+	double virtualTime = 0.0;
+	int32 queuedBytes = 0;
+	int32 heldOverBytes = 0;
+};
+
+/** Classification, settings and statistics shared by every peer's queues. Game thread only. */
+class UBERMUNDOPROTOPLUGIN_API FUbermundoSendScheduler {
+public:
+	static FUbermundoSendScheduler& Get();
+
+	/** The one table of which packet code is sent in which class. FUbermundoRateController::ClassOf is read off it. */
+	static EUbermundoSendClass ClassOf(uint8 packetCode);
+
+	void SetSettings(const FUbermundoSendSchedulerSettings& s) { settings = s; }
+	const FUbermundoSendSchedulerSettings& GetSettings() const { return settings; }
+
+	void OnSent(EUbermundoSendClass cls, int32 numBytes, double waitSeconds, bool boosted);
+	void OnHeldOver(EUbermundoSendClass cls, int32 numMessages);
+
+	void GetStats(TArray<FUbermundoSendClassStats>& out) const;
+	void ResetStats();
+
+private:
+	struct FClassTotals {
+		int32 messagesSent = 0;
+		int64 bytesSent = 0;
+		double waitTotal = 0.0;
+		double waitMax = 0.0;
+		int32 numBoosted = 0;
+		int32 numHeldOver = 0;
+	};
+
+	FUbermundoSendSchedulerSettings settings;
+	FClassTotals totals[UBERMUNDO_SEND_CLASSES];
+};
+
+/**
+ * Blueprint access to the send scheduler.
+ */
+UCLASS()
+class UBERMUNDOPROTOPLUGIN_API UUbermundoSendSchedulerLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|RateControl", meta = (ToolTip = "Weights, per tick byte caps and age boosts of the four message classes the outbox sends in."))
+		static void SetSendSchedulerSettings(const FUbermundoSendSchedulerSettings& settings);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|RateControl")
+		static FUbermundoSendSchedulerSettings GetSendSchedulerSettings();
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|RateControl", meta = (ToolTip = "Which class the outbox sends a message with this packet code in."))
+		static EUbermundoSendClass GetSendClassOf(uint8 packetCode);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Diagnostics", meta = (ToolTip = "Messages and bytes sent per class, how long they waited in the outbox, and how many were boosted or held over."))
+		static void GetSendSchedulerStats(TArray<FUbermundoSendClassStats>& stats);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Diagnostics")
+		static void ResetSendSchedulerStats();
+};
@@ -0,0 +1,119 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// Opens P2P sessions before there is anything to send on them.
+// Steam only sets up a session, and its route, on the first send to a peer, and drops
+// UnreliableNoDelay packets until that is done, so a player's first states used to be lost and they
+// appeared late. When the server announces the players in our world (S2PAnnouncePlayersToClient_Steam)
+// each of them is sent a small SessionPing, reliable enough that Steam waits for the route rather
+// than dropping it, and again every UBERMUNDO_WARMUP_RETRY until we hear anything back. From then on
+// the session counts as ready. A ready peer nothing has been heard from for UBERMUNDO_WARMUP_KEEPALIVE
+// is pinged again so Steam doesn't let the session go idle, and one silent for UBERMUNDO_WARMUP_STALE
+// goes back to warming up. A peer that never answers is marked unreachable after UBERMUNDO_WARMUP_GIVE_UP
+// and then only tried every UBERMUNDO_WARMUP_KEEPALIVE. After UBERMUNDO_WARMUP_MAX_UNANSWERED of those
+// its session is closed with USteamCustomCode::CloseP2PBySteamID, so outbox queues, bulk transfers,
+// clock sync and the rest of what the plugin kept for it go too. Announcing it again starts over.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "UbermundoSessionWarmup.generated.h"
+
+/** Seconds between pings while a session warms up. */
+#define UBERMUNDO_WARMUP_RETRY 0.5
+/** Seconds of silence before a ready session is pinged to keep it open. */
+#define UBERMUNDO_WARMUP_KEEPALIVE 5.0
+/** Seconds of silence before a ready session is taken to be gone and warmed up again. */
+#define UBERMUNDO_WARMUP_STALE 15.0
+/** Seconds of warming up with no answer before a peer is marked unreachable. */
+#define UBERMUNDO_WARMUP_GIVE_UP 20.0
+/** Pings an unreachable peer gets before its session is closed. */
+#define UBERMUNDO_WARMUP_MAX_UNANSWERED 12
+
+UENUM(BlueprintType)
+enum class EUbermundoSessionState : uint8 {
+	/** Never announced or sent a ping. */
+	None,
+	/** Pinging, nothing heard back yet. */
+	Warming,
+	/** Heard from lately, the path is open both ways. */
+	Ready,
+	/** Never answered. Still tried now and then. */
+	Unreachable
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoSessionStatus
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoSessionStatus() : State(EUbermundoSessionState::None), WarmupMs(-1.0f), RttMs(-1.0f), NumPings(0) {}
+
+	UPROPERTY(BlueprintReadOnly)
+		EUbermundoSessionState State;
+	/** From the first ping to the first answer. -1 until then. */
+	UPROPERTY(BlueprintReadOnly)
+		float WarmupMs;
+	/** Round trip of the last ping answered. -1 until one is. */
+	UPROPERTY(BlueprintReadOnly)
+		float RttMs;
+	UPROPERTY(BlueprintReadOnly)
+		int32 NumPings;
+};
+
+class UBERMUNDOPROTOPLUGIN_API FUbermundoSessionWarmup {
+public:
+	static FUbermundoSessionWarmup& Get();
+
+	/** Start warming up a session with each of peers that isn't already. Our own id is skipped. */
+	void Announce(TArrayView<const uint64> peers, double now);
+	/** A packet came from peer. */
+	void OnHeard(uint64 peer, double now);
+	/** Send pings that are due. A net tick, see FUbermundoNetTick. */
+	void Tick(double now);
+	/** SessionPing, ping or answer. True if it was one. */
+	bool HandlePacket(uint64 sender, const uint8* data, int32 numBytes, double now);
+
+	EUbermundoSessionState GetState(uint64 peer) const;
+	bool GetStatus(uint64 peer, FUbermundoSessionStatus& out) const;
+	void ForgetPeer(uint64 peer);
+
+	/** The Steam ids in an S2PAnnouncePlayersToClient_Steam message, code byte first. False if it is not one or is cut short. */
+	static bool DecodeAnnounce(const uint8* data, int32 numBytes, TArray<int32>& ubermundoIds, TArray<uint64>& steamIds);
+
+private:
+	struct FPeer {
+		EUbermundoSessionState state = EUbermundoSessionState::None;
+		double warmingSince = 0.0;
+		double lastHeard = 0.0;
+		double lastPing = 0.0;
+		double warmupTime = -1.0;
+		double rtt = -1.0;
+		int32 numPings = 0;
+		/** Pings since the peer went unreachable. */
+		int32 unanswered = 0;
+	};
+
+	void Ping(uint64 peer, FPeer& p, double now);
+
+	TMap<uint64, FPeer> peers;
+};
+
+/**
+ * Blueprint access to P2P session warm up.
+ */
+UCLASS()
+class UBERMUNDOPROTOPLUGIN_API UUbermundoSessionWarmupLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|P2P", meta = (ToolTip = "Open P2P sessions with these players now, in the background, so the first real packet to each of them is not lost while Steam finds a route."))
+		static void WarmUpP2PSessions(const TArray<int64>& peers);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|P2P", meta = (ToolTip = "Hand this the server's S2PAnnouncePlayersToClient_Steam message as it came, code byte first. Warms up a session with every player in it and gives back their ids. False if the message is not one."))
+		static bool WarmUpAnnouncedPlayers(const TArray<uint8>& message, TArray<int32>& ubermundoIds, TArray<int64>& steamIds);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|P2P", meta = (ToolTip = "True once we have heard from this player lately, so a packet sent to them now goes straight out."))
+		static bool IsP2PSessionReady(int64 peer);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|P2P")
+		static bool GetP2PSessionStatus(int64 peer, FUbermundoSessionStatus& status);
+};
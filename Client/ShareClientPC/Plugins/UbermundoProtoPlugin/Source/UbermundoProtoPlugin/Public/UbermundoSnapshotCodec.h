@@ -0,0 +1,163 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// Compression for UBERMUNDOPC_P2P_Player3DState.
+// The state is quantized (location 1 cm, rotation 16 bits per axis, velocity 1 cm/s) and then
+// delta encoded against the newest snapshot the receiver has acknowledged. Each field that did not
+// change costs one bit. Fields that did change cost one bit, a 2 bit size class and the zigzag delta.
+// If the receiver has not acknowledged anything recent enough (loss, or a new peer) the snapshot
+// is sent in full, which is the same encoding against an all zero baseline.
+// Sequence numbers and the history of what was sent are kept per peer, so a peer that interest
+// management or dead reckoning sends to only now and then still has a recent baseline.
+//
+// Packet: code, Int16 sequence, 1 byte baseline offset (0 = full snapshot, else seq - offset), bits.
+// Ack:    UBERMUNDOPC_P2P_Player3DStateAck, Int16 sequence.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "UbermundoPacketBuffer.h"
+#include "UbermundoSnapshotCodec.generated.h"
+
+/** How many snapshots back a delta baseline may be. Older than this and the snapshot is sent in full. */
+#define UBERMUNDO_SNAPSHOT_HISTORY 32
+
+USTRUCT(BlueprintType)
+struct FUbermundoPlayer3DState
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoPlayer3DState() : Location(FVector::ZeroVector), Rotation(FRotator::ZeroRotator), Velocity(FVector::ZeroVector), TimestampMs(0) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		FVector Location;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		FRotator Rotation;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		FVector Velocity;
+	/** Sender's clock when the state was taken, milliseconds. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		int32 TimestampMs;
+};
+
+/** The state as it goes on the wire. */
+struct FUbermundoQuantizedState {
+	int32 Loc[3] = { 0, 0, 0 };
+	uint16 Rot[3] = { 0, 0, 0 };
+	int16 Vel[3] = { 0, 0, 0 };
+	int32 Time = 0;
+
+	bool operator==(const FUbermundoQuantizedState& o) const { return FMemory::Memcmp(this, &o, sizeof(*this)) == 0; }
+
+	static FUbermundoQuantizedState Quantize(const FUbermundoPlayer3DState& s);
+	FUbermundoPlayer3DState Dequantize() const;
+};
+
+/** Writes bits Most Significant first into a byte array. Call Finish to flush the last partial byte. */
+class UBERMUNDOPROTOPLUGIN_API FUbermundoBitWriter {
+public:
+	explicit FUbermundoBitWriter(TArray<uint8>& out) : out(out), acc(0), numBits(0) {}
+	void WriteBits(uint32 v, int32 n);
+	void WriteBit(bool b) { WriteBits(b ? 1 : 0, 1); }
+	void Finish();
+private:
+	TArray<uint8>& out;
+	uint64 acc;
+	int32 numBits;
+};
+
+class UBERMUNDOPROTOPLUGIN_API FUbermundoBitReader {
+public:
+	FUbermundoBitReader(const uint8* data, int32 numBytes) : data(data), numBytes(numBytes), bitPos(0), overrun(false) {}
+	uint32 ReadBits(int32 n);
+	bool ReadBit() { return ReadBits(1) != 0; }
+	/** True if a read went past the end. Everything read after that was zeros. */
+	bool IsOverrun() const { return overrun; }
+private:
+	const uint8* data;
+	int32 numBytes;
+	int32 bitPos;
+	bool overrun;
+};
+
+/**
+ * Native codec. The sender side keeps, per peer, its own sequence numbers, the history of what was
+ * sent to it and the newest of those it acked.
+ */
+class UBERMUNDOPROTOPLUGIN_API FUbermundoSnapshotCodec {
+public:
+	/** The codec for the local player. Benchmarks make their own. */
+	static FUbermundoSnapshotCodec& Get();
+
+	// ----- Sender side
+	/** Record the local player's state for this send. */
+	void BeginSnapshot(const FUbermundoPlayer3DState& state);
+	/** The packet for peer for the current snapshot, under peer's next sequence number and delta encoded against
+		what peer last acked. Valid until the next call. */
+	const FUbermundoPacketRef& GetPacketFor(uint64 peer);
+	/** Peer has decoded seq. */
+	void OnAck(uint64 peer, uint16 seq);
+	/** When seq went to peer, for RTT. False if it has left the history. */
+	bool GetSendTime(uint64 peer, uint16 seq, double& sentAt) const;
+
+	// ----- Receiver side
+	/** Decode a Player3DState packet from sender. False if it can't be decoded (its baseline is gone), or is
+		older than one already decoded. On success seq should be acked back to the sender with QueueAck. */
+	bool Decode(uint64 sender, const uint8* data, int32 numBytes, FUbermundoPlayer3DState& out, uint16& seq);
+	/** Queue a UBERMUNDOPC_P2P_Player3DStateAck for seq to sender on the outbox. */
+	static void QueueAck(uint64 sender, uint16 seq);
+
+	/** Drop all state for a peer in both directions. */
+	void ForgetPeer(uint64 peer);
+
+	// ----- Encoding, public so the benchmarks can drive it without a network.
+	static void EncodeDelta(FUbermundoBitWriter& w, const FUbermundoQuantizedState& s, const FUbermundoQuantizedState& base);
+	static void DecodeDelta(FUbermundoBitReader& r, FUbermundoQuantizedState& s, const FUbermundoQuantizedState& base);
+	static void WriteSnapshotPacket(TArray<uint8>& out, uint16 seq, uint8 baseOffset, const FUbermundoQuantizedState& s, const FUbermundoQuantizedState& base);
+
+private:
+	struct FHistoryEntry {
+		uint16 seq = 0;
+		bool valid = false;
+		FUbermundoQuantizedState state;
+		/** Sender side only. */
+		double sentAt = 0.0;
+	};
+
+	struct FRemoteSender {
+		FHistoryEntry history[UBERMUNDO_SNAPSHOT_HISTORY];
+		uint16 newestSeq = 0;
+		bool any = false;
+	};
+
+	struct FLocalSender {
+		FHistoryEntry history[UBERMUNDO_SNAPSHOT_HISTORY];
+		uint16 nextSeq = 1;
+		/** Newest seq the peer acked, if any. */
+		uint16 acked = 0;
+		bool anyAcked = false;
+	};
+
+	FUbermundoQuantizedState current;
+	/** The last packet GetPacketFor made. */
+	FUbermundoPacketRef packet;
+	/** What we send, per peer. */
+	TMap<uint64, FLocalSender> locals;
+	/** What peers send us. */
+	TMap<uint64, FRemoteSender> remotes;
+};
+
+/**
+ * Blueprint access to the Player3DState codec.
+ */
+UCLASS()
+class UBERMUNDOPROTOPLUGIN_API UUbermundoSnapshotLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Snapshot", meta = (ToolTip = "Encode the local player's state and queue it to each peer, delta compressed against what that peer last acknowledged."))
+		static void SendPlayer3DState(const TArray<int64>& peers, const FUbermundoPlayer3DState& state);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Snapshot", meta = (ToolTip = "Decode a received P2P_Player3DState packet. False if it could not be decoded or is out of date. Acknowledges it to the sender and adds it to the jitter buffer, see Evaluate Remote Players."))
+		static bool DecodePlayer3DState(int64 sender, const TArray<uint8>& bytes, FUbermundoPlayer3DState& state);
+};
@@ -0,0 +1,61 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// Fixed size, lock free, single producer single consumer queue.
+// One thread only ever pushes and one other thread only ever peeks and pops. Nothing is allocated
+// after construction, and each side only writes its own index, so neither ever waits on the other.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+template<typename T>
+class TUbermundoSpscRing {
+public:
+	/** capacity is rounded up to a power of two. */
+	explicit TUbermundoSpscRing(uint32 capacity) {
+		uint32 n = FMath::RoundUpToPowerOfTwo(FMath::Max(capacity, 2u));
+		slots.SetNum((int32)n);
+		mask = n - 1;
+	}
+
+	// ----- Producer thread
+	/** False, and item untouched, if the ring is full. */
+	bool Push(T&& item) {
+		uint32 t = tail.load(std::memory_order_relaxed);
+		if (t - head.load(std::memory_order_acquire) > mask)
+			return false;
+		slots[t & mask] = MoveTemp(item);
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+	bool IsFull() const {
+		return tail.load(std::memory_order_relaxed) - head.load(std::memory_order_acquire) > mask;
+	}
+
+	// ----- Consumer thread
+	/** The oldest item, nullptr if empty. Stays put until Pop. */
+	T* Peek() {
+		uint32 h = head.load(std::memory_order_relaxed);
+		if (h == tail.load(std::memory_order_acquire))
+			return nullptr;
+		return &slots[h & mask];
+	}
+	/** Drop the item Peek returned. Its slot is reset here, on the consumer, so whatever it holds is let go of here too. */
+	void Pop() {
+		uint32 h = head.load(std::memory_order_relaxed);
+		slots[h & mask] = T();
+		head.store(h + 1, std::memory_order_release);
+	}
+
+	/** Either thread, only a snapshot. */
+	int32 Num() const { return (int32)(tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire)); }
+
+private:
+	TArray<T> slots;
+	uint32 mask;
+	/** Next to pop, only the consumer writes it. On its own cache line so the two sides don't fight over one. */
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> head{ 0 };
+	/** Next to push, only the producer writes it. */
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> tail{ 0 };
+};
@@ -0,0 +1,100 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// P2P over ISteamNetworkingSockets instead of the legacy ISteamNetworking.
+// Each peer gets one connection per lane, so a big bulk transfer or a lost reliable event never
+// holds up the state stream behind it. This SDK has no lanes on a single connection, so a lane is
+// its own connection on its own virtual port. Sends are only queued; everything for the tick goes
+// to Steam in one SendMessages call on FlushSends. Receives come off one poll group in batches.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UbermundoTransport.h"
+
+struct SteamNetworkingMessage_t;
+class FUbermundoSteamSocketsHooks;
+
+/** What a lane carries. The lane of a send follows from its mode. */
+enum class EUbermundoNetLane : uint8 {
+	/** UnreliableNoDelay and Unreliable: Player3DState and other fire and forget updates. */
+	State,
+	/** Reliable: grab, release, chat and other events that must arrive in order. */
+	Events,
+	/** ReliableWithBuffering and UnreliableBulk: block data, bulk transfer chunks and other big transfers. */
+	Bulk,
+	Num
+};
+
+/** Virtual port of the State lane. Events and Bulk are the next two. */
+#define UBERMUNDO_SOCKETS_VIRTUAL_PORT 7700
+
+class UBERMUNDOPROTOPLUGIN_API FUbermundoSteamSocketsTransport : public IUbermundoTransport {
+public:
+	/** listen false makes a transport that can only be wired up by CreateLocalPair. */
+	FUbermundoSteamSocketsTransport(bool listen = true);
+	virtual ~FUbermundoSteamSocketsTransport();
+
+	/**
+	 * Two transports connected to each other in this process, through Steam's own network loopback,
+	 * so the full send and receive path can be measured without a second machine. Needs Steam running.
+	 */
+	static bool CreateLocalPair(uint64 idA, uint64 idB, TUniquePtr<FUbermundoSteamSocketsTransport>& outA, TUniquePtr<FUbermundoSteamSocketsTransport>& outB);
+
+	static EUbermundoNetLane LaneFor(EUbermundoP2PSendMode mode);
+
+	virtual const TCHAR* GetName() const override { return TEXT("SteamSockets"); }
+	virtual bool IsAvailable() const override;
+	virtual uint64 GetLocalId() const override;
+	virtual bool Send(uint64 peer, const uint8* data, uint32 numBytes, EUbermundoP2PSendMode mode) override;
+	/** One message per peer, all pointing at packet's buffer. Each holds a handle on it until Steam is done with it. */
+	virtual int32 SendToMany(TArrayView<const uint64> peers, const FUbermundoPacketRef& packet, EUbermundoP2PSendMode mode, TArray<bool, TInlineAllocator<64>>& sent) override;
+	virtual int32 FlushSends() override;
+	virtual bool IsPacketAvailable(uint32& numBytes) override;
+	virtual bool Read(uint8* dest, uint32 destSize, uint32& numBytes, uint64& sender) override;
+	virtual bool Close(uint64 peer) override;
+	virtual void Tick(double now) override { FlushSends(); }
+	/** Ping and delivery from the State lane, queued bytes summed over all lanes. */
+	virtual bool GetPeerStatus(uint64 peer, FUbermundoTransportPeerStatus& out) const override;
+
+	/** Round trip to peer in ms from Steam's own stats on its State lane, -1 if not connected. */
+	int32 GetPingMs(uint64 peer) const;
+
+	/** Totals since start up. */
+	int64 GetNumSendCalls() const { return numSendCalls; }
+	int64 GetNumMessagesSent() const { return numMessagesSent; }
+
+private:
+	friend class FUbermundoSteamSocketsHooks;
+
+	struct FPeerLanes {
+		uint32 conn[(int32)EUbermundoNetLane::Num] = { 0, 0, 0 };
+	};
+
+	/** Connection for peer's lane, connecting if there isn't one yet. 0 if it can't. */
+	uint32 ConnectionFor(uint64 peer, EUbermundoNetLane lane);
+	void AddConnection(uint64 peer, EUbermundoNetLane lane, uint32 conn);
+	/** Called by the hooks on every connection state change. */
+	void OnConnectionStatus(uint32 conn, uint32 listenSocket, int32 state, uint64 remoteId);
+	void ReleaseReceived();
+
+	bool listening;
+	/** Set by CreateLocalPair, else our Steam ID. */
+	uint64 localId;
+	uint32 listenSockets[(int32)EUbermundoNetLane::Num];
+	uint32 pollGroup;
+	TMap<uint64, FPeerLanes> peers;
+	/** Every connection we know, back to its peer. */
+	TMap<uint32, uint64> connPeers;
+	TUniquePtr<FUbermundoSteamSocketsHooks> hooks;
+
+	TArray<SteamNetworkingMessage_t*> outgoing;
+	TArray<int64> sendResults;
+
+	static constexpr int32 ReceiveBatch = 256;
+	SteamNetworkingMessage_t* received[ReceiveBatch];
+	int32 numReceived;
+	int32 nextReceived;
+
+	int64 numSendCalls;
+	int64 numMessagesSent;
+};
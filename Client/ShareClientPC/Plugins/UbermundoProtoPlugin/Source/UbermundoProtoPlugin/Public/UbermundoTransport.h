@@ -0,0 +1,166 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// What USteamCustomCode sends, receives and closes P2P sessions through.
+// FUbermundoSteamTransport is the real thing. FUbermundoLoopbackTransport is plain UDP on this
+// machine, with a conditioner that adds latency, jitter, loss and reordering, so the networking
+// code can be run and load tested headless (e.g. on a Linux box) with no Steam client.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UbermundoPacketBuffer.h"
+#include "UbermundoTransport.generated.h"
+
+enum class EUbermundoP2PSendMode : uint8;
+class FSocket;
+class FInternetAddr;
+
+/** Fake network conditions for the loopback transport. */
+USTRUCT(BlueprintType)
+struct FUbermundoNetConditions
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoNetConditions() : LatencyMs(0.0f), JitterMs(0.0f), LossPercent(0.0f), ReorderPercent(0.0f) {}
+
+	/** One way delay added to every packet. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float LatencyMs;
+	/** Up to this much more delay, random per packet. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float JitterMs;
+	/** Unreliable packets dropped. Reliable ones are never dropped, like Steam. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float LossPercent;
+	/** Unreliable packets held back an extra LatencyMs + JitterMs so they arrive after later ones. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float ReorderPercent;
+};
+
+/** What a transport can tell about its link to one peer. -1 for anything it can't. */
+struct FUbermundoTransportPeerStatus {
+	int32 pingMs = -1;
+	/** Share of packets getting through, 0 to 1. */
+	float deliveredFraction = -1.0f;
+	/** Handed to the transport but not on the wire yet. */
+	int32 queuedBytes = -1;
+	int32 queuedPackets = -1;
+};
+
+class UBERMUNDOPROTOPLUGIN_API IUbermundoTransport {
+public:
+	virtual ~IUbermundoTransport() {}
+
+	virtual const TCHAR* GetName() const = 0;
+	/** False if it can't send or receive right now (e.g. Steam not running). */
+	virtual bool IsAvailable() const = 0;
+	/** Our own peer id on this transport. */
+	virtual uint64 GetLocalId() const = 0;
+
+	virtual bool Send(uint64 peer, const uint8* data, uint32 numBytes, EUbermundoP2PSendMode mode) = 0;
+	/** The same packet to every one of peers, sent gets whether each one went. Transports that hold on to packets
+		share packet's buffer between the peers instead of copying it for each. Returns how many were sent. */
+	virtual int32 SendToMany(TArrayView<const uint64> peers, const FUbermundoPacketRef& packet, EUbermundoP2PSendMode mode, TArray<bool, TInlineAllocator<64>>& sent) {
+		sent.SetNumUninitialized(peers.Num(), false);
+		int32 n = 0;
+		for (int32 i = 0; i < peers.Num(); i++) {
+			sent[i] = Send(peers[i], packet.GetData(), (uint32)packet.Num(), mode);
+			n += sent[i] ? 1 : 0;
+		}
+		return n;
+	}
+	/** Is there a packet to read? numBytes is its size. */
+	virtual bool IsPacketAvailable(uint32& numBytes) = 0;
+	/** Read the next packet into dest. numBytes is how much was read. */
+	virtual bool Read(uint8* dest, uint32 destSize, uint32& numBytes, uint64& sender) = 0;
+	/** Drop the session with peer. */
+	virtual bool Close(uint64 peer) = 0;
+	/** Hand anything the transport is holding back to the network. Called at the end of FUbermundoP2POutbox::Flush.
+		Returns the number of packets handed over. */
+	virtual int32 FlushSends() { return 0; }
+	/** Called from USteamCustomCode::Tick. */
+	virtual void Tick(double now) {}
+	/** False if the transport knows nothing about peer, or nothing at all. */
+	virtual bool GetPeerStatus(uint64 peer, FUbermundoTransportPeerStatus& out) const { return false; }
+	/** Fake network conditions. False if the transport has no conditioner. */
+	virtual bool SetConditions(const FUbermundoNetConditions& c) { return false; }
+	/** Send packets for peer to this address and port. False if the transport finds peers some other way, or address is bad. */
+	virtual bool AddPeer(uint64 peer, const FString& address, int32 port) { return false; }
+};
+
+/** Legacy ISteamNetworking P2P. */
+class UBERMUNDOPROTOPLUGIN_API FUbermundoSteamTransport : public IUbermundoTransport {
+public:
+	virtual const TCHAR* GetName() const override { return TEXT("Steam"); }
+	virtual bool IsAvailable() const override;
+	virtual uint64 GetLocalId() const override;
+	virtual bool Send(uint64 peer, const uint8* data, uint32 numBytes, EUbermundoP2PSendMode mode) override;
+	virtual bool IsPacketAvailable(uint32& numBytes) override;
+	virtual bool Read(uint8* dest, uint32 destSize, uint32& numBytes, uint64& sender) override;
+	virtual bool Close(uint64 peer) override;
+	virtual bool GetPeerStatus(uint64 peer, FUbermundoTransportPeerStatus& out) const override;
+};
+
+/**
+ * UDP on this machine. Each datagram is the 8 byte sender id then the packet. A peer is found either
+ * from AddPeer or, if never added, by taking the peer id as a port on 127.0.0.1. So by default
+ * our local id is simply our port.
+ */
+class UBERMUNDOPROTOPLUGIN_API FUbermundoLoopbackTransport : public IUbermundoTransport {
+public:
+	/** Bind to 127.0.0.1:localPort. localId 0 means use the port as the id. */
+	FUbermundoLoopbackTransport(int32 localPort, uint64 localId = 0);
+	virtual ~FUbermundoLoopbackTransport();
+
+	const FUbermundoNetConditions& GetConditions() const { return conditions; }
+
+	virtual const TCHAR* GetName() const override { return TEXT("Loopback"); }
+	virtual bool IsAvailable() const override { return socket != nullptr; }
+	virtual uint64 GetLocalId() const override { return localId; }
+	virtual bool Send(uint64 peer, const uint8* data, uint32 numBytes, EUbermundoP2PSendMode mode) override;
+	virtual bool IsPacketAvailable(uint32& numBytes) override;
+	virtual bool Read(uint8* dest, uint32 destSize, uint32& numBytes, uint64& sender) override;
+	virtual bool Close(uint64 peer) override;
+	/** Puts conditioned packets whose time has come on the wire. */
+	virtual void Tick(double now) override;
+	/** Queued is what the conditioner is still holding. */
+	virtual bool GetPeerStatus(uint64 peer, FUbermundoTransportPeerStatus& out) const override;
+	virtual bool SetConditions(const FUbermundoNetConditions& c) override { conditions = c; return true; }
+	virtual bool AddPeer(uint64 peer, const FString& address, int32 port) override;
+
+	/** Largest packet, a UDP datagram less our 8 byte header. Reliable sends bigger than this fail. */
+	static constexpr uint32 MaxPacket = 65000;
+
+private:
+	struct FDelayed {
+		double sendAt;
+		/** Ties on sendAt go in the order they were sent. */
+		uint64 order;
+		uint64 peer;
+		FUbermundoPacketRef packet;
+		bool operator<(const FDelayed& o) const { return sendAt < o.sendAt || (sendAt == o.sendAt && order < o.order); }
+	};
+
+	bool SendNow(uint64 peer, const uint8* data, uint32 numBytes);
+	TSharedRef<FInternetAddr> AddressFor(uint64 peer);
+	/** Pull the next datagram off the socket into staging, if there is one. */
+	bool Stage();
+
+	FSocket* socket;
+	uint64 localId;
+	FUbermundoNetConditions conditions;
+	FRandomStream rng;
+	TMap<uint64, TSharedRef<FInternetAddr>> peerAddresses;
+	TArray<FDelayed> delayed;
+	/** Reliable packets to a peer must not overtake each other. */
+	TMap<uint64, double> lastReliableSendAt;
+
+	uint64 nextOrder;
+
+	TArray<uint8> sendBuffer;
+	TArray<uint8> staging;
+	TSharedPtr<FInternetAddr> recvAddr;
+	bool hasStaged;
+	uint32 stagedBytes;
+	uint64 stagedSender;
+};
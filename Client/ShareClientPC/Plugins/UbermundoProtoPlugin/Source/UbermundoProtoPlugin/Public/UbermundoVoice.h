@@ -0,0 +1,261 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// Streaming P2P voice.
+// The microphone is read every Flush and cut into 20 ms frames, each Opus encoded (the engine's
+// Voice module codec) and sent on its own as an unreliable P2P_PlayerVoiceMsg with a sequence
+// number and the shared clock time it was captured. Going through the outbox makes it voice traffic
+// to the rate controller: dropped rather than queued when the link is full, and encoded at the
+// bitrate the controller says fits.
+// Each remote speaker has a stream: arriving frames are decoded on a worker thread, one task per
+// speaker at a time so the decoder sees them in order, into pooled buffers, and kept by sequence
+// number. The audio thread pulls from the stream when the speaker's sound wave runs low, which makes
+// the sound card the playout clock. Playback of a talk spurt starts once enough frames are buffered
+// to cover the measured jitter (RFC 3550 style, from arrival times against capture times); after
+// that a missing frame is concealed by repeating the last one, fading, and a few missing in a row
+// end the spurt. The capture's noise gate sends nothing during silence, so when the microphone goes
+// quiet the sender follows the last frame with an empty one, and the spurt ends there without
+// concealing anything. A buffer grown past its target is trimmed a frame at a time to win latency back.
+// Capture to playout latency per speaker is in the stats, and
+// UUbermundoNetBenchmarks::BenchmarkVoiceLoopback measures it over the loopback transport.
+// Capture needs [Voice] bEnabled=true in the project's DefaultEngine.ini.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "UObject/GCObject.h"
+#include "UbermundoVoice.generated.h"
+
+class IVoiceCapture;
+class IVoiceEncoder;
+class IVoiceDecoder;
+class USoundWaveProcedural;
+
+#define UBERMUNDO_VOICE_SAMPLE_RATE 16000
+#define UBERMUNDO_VOICE_FRAME_MS 20
+#define UBERMUNDO_VOICE_FRAME_SAMPLES (UBERMUNDO_VOICE_SAMPLE_RATE * UBERMUNDO_VOICE_FRAME_MS / 1000)
+/** P2P_PlayerVoiceMsg before the Opus data: code, sequence, capture time. */
+#define UBERMUNDO_VOICE_HEADER (1 + 2 + 4)
+/** Most Opus bytes in a frame. 20 ms at 64 kbit/s is 160. */
+#define UBERMUNDO_VOICE_MAX_FRAME 400
+/** Frames a stream keeps, 500 ms. Anything further ahead than this is dropped. */
+#define UBERMUNDO_VOICE_MAX_BUFFERED 25
+/** Missing frames in a row that are concealed before the talk spurt is taken to have ended. */
+#define UBERMUNDO_VOICE_CONCEAL_FRAMES 5
+/** Most captured audio held back when Flush runs late, older is thrown away. */
+#define UBERMUNDO_VOICE_MAX_BACKLOG_FRAMES 10
+/** Frames' worth of time the microphone gives nothing before the talk spurt is taken to have ended and listeners are told. */
+#define UBERMUNDO_VOICE_END_FRAMES 2
+
+USTRUCT(BlueprintType)
+struct FUbermundoVoiceSettings
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoVoiceSettings() :
+		MinDelayMs(40.0f),
+		MaxDelayMs(300.0f),
+		JitterMultiplier(3.0f) {
+	}
+
+	/** Least audio buffered before a talk spurt starts playing. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float MinDelayMs;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float MaxDelayMs;
+	/** Buffered before playing is one frame plus this many times the jitter. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		float JitterMultiplier;
+};
+
+USTRUCT(BlueprintType)
+struct FUbermundoVoiceStats
+{
+	GENERATED_USTRUCT_BODY()
+
+	FUbermundoVoiceStats() : FramesReceived(0), FramesPlayed(0), FramesConcealed(0), FramesLate(0), FramesDropped(0),
+		JitterMs(0.0f), TargetDelayMs(0.0f), LatencyMs(0.0f), MaxLatencyMs(0.0f) {}
+
+	UPROPERTY(BlueprintReadOnly)
+		int32 FramesReceived;
+	UPROPERTY(BlueprintReadOnly)
+		int32 FramesPlayed;
+	/** Missing when their turn came, and made up from the one before. */
+	UPROPERTY(BlueprintReadOnly)
+		int32 FramesConcealed;
+	/** Came after their turn. */
+	UPROPERTY(BlueprintReadOnly)
+		int32 FramesLate;
+	/** Skipped to bring the buffer back down to its target. */
+	UPROPERTY(BlueprintReadOnly)
+		int32 FramesDropped;
+	UPROPERTY(BlueprintReadOnly)
+		float JitterMs;
+	/** Buffered before a talk spurt starts. */
+	UPROPERTY(BlueprintReadOnly)
+		float TargetDelayMs;
+	/** Capture to playout, averaged over the frames played. */
+	UPROPERTY(BlueprintReadOnly)
+		float LatencyMs;
+	UPROPERTY(BlueprintReadOnly)
+		float MaxLatencyMs;
+};
+
+/** Our microphone, 20 ms frames at a time, into P2P_PlayerVoiceMsgs. */
+class UBERMUNDOPROTOPLUGIN_API FUbermundoVoiceEncoder {
+public:
+	bool Init();
+	void SetBitrate(int32 bitsPerSecond);
+	/** One UBERMUNDO_VOICE_FRAME_SAMPLES frame captured at the shared time stamp. */
+	bool Encode(const int16* frame, uint32 stamp, TArray<uint8>& packet);
+	/** The empty frame that ends a talk spurt: header only, the next sequence number and no Opus data. */
+	void End(uint32 stamp, TArray<uint8>& packet);
+
+private:
+	void WriteHeader(uint32 stamp, int32 numBytes, TArray<uint8>& packet);
+
+	TSharedPtr<IVoiceEncoder> encoder;
+	uint16 seq = 0;
+	int32 bitrate = 0;
+};
+
+/** One remote speaker: worker decode, jitter buffer and concealment. Safe to use from the game, worker and audio threads. */
+class UBERMUNDOPROTOPLUGIN_API FUbermundoVoiceStream : public TSharedFromThis<FUbermundoVoiceStream, ESPMode::ThreadSafe> {
+public:
+	explicit FUbermundoVoiceStream(const FUbermundoVoiceSettings& settings);
+	bool Init();
+	void SetSettings(const FUbermundoVoiceSettings& s);
+
+	/** A P2P_PlayerVoiceMsg that arrived at now. Decoding happens on a worker; an empty one ends the talk spurt. */
+	bool OnPacket(const uint8* data, int32 numBytes, double now);
+	/** At least numSamples of playout, in whole frames. Valid until the next Pull; only one thread may pull. */
+	TArrayView<const int16> Pull(int32 numSamples);
+
+	/** Playing a talk spurt. */
+	bool IsTalking() const;
+	FUbermundoVoiceStats GetStats() const;
+
+private:
+	struct FIncoming {
+		uint16 seq = 0;
+		double capturedAt = 0.0;
+		TArray<uint8, TInlineAllocator<UBERMUNDO_VOICE_MAX_FRAME>> data;
+	};
+
+	struct FFrame {
+		TArray<int16> pcm;
+		double capturedAt = 0.0;
+	};
+
+	static void DecodePending(TSharedRef<FUbermundoVoiceStream, ESPMode::ThreadSafe> self);
+	TArray<int16> TakeBuffer();
+	void ReleaseBuffer(TArray<int16>&& buffer);
+	void Insert(uint16 seq, double capturedAt, TArray<int16>&& pcm);
+	void PlayFrame(TArray<int16>& out);
+	int32 TargetFrames() const;
+
+	mutable FCriticalSection lock;
+	FUbermundoVoiceSettings settings;
+	FUbermundoVoiceStats stats;
+	double latencyTotal = 0.0;
+	double lastTransit = 0.0;
+	bool haveTransit = false;
+	double jitter = 0.0;
+
+	// Queued under lock, decoded by one worker task at a time.
+	TSharedPtr<IVoiceDecoder> decoder;
+	TArray<FIncoming> incoming;
+	bool decoding = false;
+
+	// Under lock, filled by the worker and played by the audio thread.
+	TMap<uint16, FFrame> frames;
+	TArray<TArray<int16>> pool;
+	bool playing = false;
+	uint16 playSeq = 0;
+	int32 numConcealed = 0;
+	TArray<int16> last;
+	/** The sender said the spurt ends at endSeq, the sequence number of its empty frame. */
+	bool ended = false;
+	uint16 endSeq = 0;
+
+	// Audio thread.
+	TArray<int16> playout;
+};
+
+class UBERMUNDOPROTOPLUGIN_API FUbermundoVoice : public FGCObject {
+public:
+	static FUbermundoVoice& Get();
+
+	void SetSettings(const FUbermundoVoiceSettings& s);
+	const FUbermundoVoiceSettings& GetSettings() const { return settings; }
+
+	/** Open the microphone and send to listeners. False if there is no capture device or voice is off in the config. */
+	bool Start(TArrayView<const uint64> listeners);
+	void SetListeners(TArrayView<const uint64> listeners);
+	void Stop();
+	bool IsCapturing() const { return capture.IsValid(); }
+
+	/** Read the microphone and send whole frames, and the end of the talk spurt once it goes quiet. A net tick, see FUbermundoNetTick. */
+	void Tick(double now);
+
+	/** A P2P_PlayerVoiceMsg from sender. */
+	bool HandlePacket(uint64 sender, const uint8* data, int32 numBytes);
+
+	/** The sound to play sender's voice with, nullptr until they have said something. */
+	USoundWaveProcedural* GetSound(uint64 speaker) const;
+	bool IsTalking(uint64 speaker) const;
+	bool GetStats(uint64 speaker, FUbermundoVoiceStats& out) const;
+
+	void ForgetPeer(uint64 peer);
+	void Reset();
+
+	// FGCObject
+	virtual void AddReferencedObjects(FReferenceCollector& collector) override;
+	virtual FString GetReferencerName() const override { return TEXT("FUbermundoVoice"); }
+
+private:
+	struct FSpeaker {
+		TSharedPtr<FUbermundoVoiceStream, ESPMode::ThreadSafe> stream;
+		USoundWaveProcedural* sound = nullptr;
+	};
+
+	void SendEnd(uint32 stamp);
+
+	FUbermundoVoiceSettings settings;
+	TSharedPtr<IVoiceCapture> capture;
+	FUbermundoVoiceEncoder encoder;
+	TArray<uint64> listeners;
+	/** 16 bit mono PCM read but not yet sent. */
+	TArray<uint8> captured;
+	TArray<uint8> packet;
+	/** Frames went out since the last end was sent. */
+	bool talking = false;
+	double lastCaptured = 0.0;
+
+	TMap<uint64, FSpeaker> speakers;
+};
+
+/**
+ * Blueprint access to P2P voice.
+ */
+UCLASS()
+class UBERMUNDOPROTOPLUGIN_API UUbermundoVoiceLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Voice", meta = (ToolTip = "Start sending the microphone to these players. False if there is no microphone or voice is off in the config."))
+		static bool StartP2PVoice(const TArray<int64>& listeners);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Voice", meta = (ToolTip = "Change who hears us, e.g. as players come into range."))
+		static void SetP2PVoiceListeners(const TArray<int64>& listeners);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Voice")
+		static void StopP2PVoice();
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Voice", meta = (ToolTip = "The sound a player's voice plays through. Play it once, attached to their avatar; it stays silent while they are. None until they have spoken."))
+		static USoundWaveProcedural* GetP2PVoiceSound(int64 speaker);
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ShareSteam|Voice")
+		static bool IsP2PSpeakerTalking(int64 speaker);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Voice", meta = (ToolTip = "How much buffering, loss and latency a player's voice has. False if they have not spoken."))
+		static bool GetP2PVoiceStats(int64 speaker, FUbermundoVoiceStats& stats);
+	UFUNCTION(BlueprintCallable, Category = "ShareSteam|Voice")
+		static void SetP2PVoiceSettings(const FUbermundoVoiceSettings& settings);
+};
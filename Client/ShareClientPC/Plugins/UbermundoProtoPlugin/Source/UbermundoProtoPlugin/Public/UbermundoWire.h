@@ -0,0 +1,299 @@
+// Copyright 2020 Bahnda. All rights reserved.
+
+// Reader and writer under the generated message codecs (UbermundoMessages.h).
+// Both work on a caller's buffer and never allocate. Multi-byte values are Big Endian, the same as
+// FUbermundoPacketBuilder and the LowEntry byte reader and writer the server and Blueprints use. The
+// LowEntry pieces are here too: a count is a "positive integer 1" (one byte under 128, else four
+// with the top bit set), and a string or byte array is a count then the bytes.
+// A writer made with no buffer only counts, which is how a message finds its size.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UbermundoPacketBuffer.h"
+
+class FUbermundoWireWriter {
+public:
+	/** Writes to data, at most capacity bytes. With data nullptr nothing is written, only counted. */
+	FUbermundoWireWriter(uint8* data, int32 capacity) : data(data), capacity(capacity) {}
+
+	/** Bytes written, or that would have been. */
+	int32 Num() const { return at; }
+	/** Everything fitted. */
+	bool IsOk() const { return ok; }
+
+	void Write(uint8 v) { uint8* p = Take(1); if (p) p[0] = v; }
+	void Write(int8 v) { Write((uint8)v); }
+	void Write(uint16 v) { uint8* p = Take(2); if (p) { p[0] = (uint8)(v >> 8); p[1] = (uint8)v; } }
+	void Write(int16 v) { Write((uint16)v); }
+	void Write(uint32 v) {
+		uint8* p = Take(4);
+		if (p) { p[0] = (uint8)(v >> 24); p[1] = (uint8)(v >> 16); p[2] = (uint8)(v >> 8); p[3] = (uint8)v; }
+	}
+	void Write(int32 v) { Write((uint32)v); }
+	void Write(uint64 v) { Write((uint32)(v >> 32)); Write((uint32)v); }
+	void Write(int64 v) { Write((uint64)v); }
+	void Write(float v) { uint32 u; FMemory::Memcpy(&u, &v, 4); Write(u); }
+	/** A generated struct. */
+	template<typename T>
+	void Write(const T& v) { v.Write(*this); }
+
+	/** LowEntry positive integer 1. Negative counts are written as 0 and fail the write. */
+	void WriteCount(int32 n) {
+		if (n < 0) {
+			ok = false;
+			n = 0;
+		}
+		if (n < 128)
+			Write((uint8)n);
+		else
+			Write((uint32)n | 0x80000000u);
+	}
+	/** A count as a plain integer. Counts it can not hold fail the write. */
+	template<typename TCount>
+	void WriteCountAs(int32 n) {
+		if (n < 0 || (int64)n > (int64)TNumericLimits<TCount>::Max()) {
+			ok = false;
+			n = 0;
+		}
+		Write((TCount)n);
+	}
+	void WriteRaw(const uint8* bytes, int32 n) {
+		uint8* p = Take(n);
+		if (p && n > 0)
+			FMemory::Memcpy(p, bytes, n);
+	}
+	void WriteRaw(TArrayView<const uint8> bytes) { WriteRaw(bytes.GetData(), bytes.Num()); }
+	/** Exactly n bytes, which bytes must have. */
+	void WriteFixed(TArrayView<const uint8> bytes, int32 n) {
+		if (bytes.Num() != n)
+			ok = false;
+		uint8* p = Take(n);
+		if (p)
+			FMemory::Memcpy(p, bytes.GetData(), FMath::Min(n, bytes.Num()));
+	}
+	/** LowEntry byte array, or a string already in UTF8. */
+	void WriteSized(TArrayView<const uint8> bytes) { WriteCount(bytes.Num()); WriteRaw(bytes); }
+	/** LowEntry UTF8 string. */
+	void WriteString(const FString& s) {
+		FTCHARToUTF8 utf8(*s);
+		WriteSized(TArrayView<const uint8>((const uint8*)utf8.Get(), utf8.Length()));
+	}
+	/** LowEntry byte array holding a Big Endian 64 bit Steam id. */
+	void WriteSteamId(uint64 id) { WriteCount(8); Write(id); }
+
+private:
+	uint8* Take(int32 n) {
+		int32 from = at;
+		at += n;
+		if (data == nullptr)
+			return nullptr;
+		if (at > capacity) {
+			ok = false;
+			return nullptr;
+		}
+		return data + from;
+	}
+
+	uint8* data;
+	int32 capacity;
+	int32 at = 0;
+	bool ok = true;
+};
+
+class FUbermundoWireReader {
+public:
+	FUbermundoWireReader(const uint8* data, int32 numBytes) : data(data), numBytes(numBytes) {}
+	explicit FUbermundoWireReader(TArrayView<const uint8> bytes) : data(bytes.GetData()), numBytes(bytes.Num()) {}
+
+	int32 Remaining() const { return numBytes - at; }
+
+	bool Read(uint8& v) { const uint8* p = Take(1); if (!p) return false; v = p[0]; return true; }
+	bool Read(int8& v) { return Read((uint8&)v); }
+	bool Read(uint16& v) { const uint8* p = Take(2); if (!p) return false; v = (uint16)((p[0] << 8) | p[1]); return true; }
+	bool Read(int16& v) { return Read((uint16&)v); }
+	bool Read(uint32& v) {
+		const uint8* p = Take(4);
+		if (!p)
+			return false;
+		v = ((uint32)p[0] << 24) | ((uint32)p[1] << 16) | ((uint32)p[2] << 8) | p[3];
+		return true;
+	}
+	bool Read(int32& v) { return Read((uint32&)v); }
+	bool Read(uint64& v) {
+		uint32 hi, lo;
+		if (!Read(hi) || !Read(lo))
+			return false;
+		v = ((uint64)hi << 32) | lo;
+		return true;
+	}
+	bool Read(int64& v) { return Read((uint64&)v); }
+	bool Read(float& v) { uint32 u; if (!Read(u)) return false; FMemory::Memcpy(&v, &u, 4); return true; }
+	/** A generated struct. */
+	template<typename T>
+	bool Read(T& v) { return v.Read(*this); }
+
+	bool ReadCount(int32& n) {
+		uint8 b;
+		if (!Read(b))
+			return false;
+		if ((b & 0x80) == 0) {
+			n = b;
+			return true;
+		}
+		const uint8* p = Take(3);
+		if (!p)
+			return false;
+		n = ((int32)(b & 0x7F) << 24) | (p[0] << 16) | (p[1] << 8) | p[2];
+		return true;
+	}
+	template<typename TCount>
+	bool ReadCountAs(int32& n) {
+		TCount v;
+		if (!Read(v) || (int64)v < 0 || (int64)v > (int64)MAX_int32)
+			return false;
+		n = (int32)v;
+		return true;
+	}
+	/** n bytes, as a view into the packet. */
+	bool ReadRaw(int32 n, TArrayView<const uint8>& out) {
+		const uint8* p = Take(n);
+		if (!p)
+			return false;
+		out = TArrayView<const uint8>(p, n);
+		return true;
+	}
+	bool ReadRest(TArrayView<const uint8>& out) { return ReadRaw(Remaining(), out); }
+	bool ReadSized(TArrayView<const uint8>& out) { int32 n; return ReadCount(n) && ReadRaw(n, out); }
+	bool ReadString(FString& out) {
+		TArrayView<const uint8> utf8;
+		if (!ReadSized(utf8))
+			return false;
+		FUTF8ToTCHAR chars((const ANSICHAR*)utf8.GetData(), utf8.Num());
+		out = FString(chars.Length(), chars.Get());
+		return true;
+	}
+	bool ReadBytes(int32 n, TArray<uint8>& out) {
+		TArrayView<const uint8> v;
+		if (!ReadRaw(n, v))
+			return false;
+		out = TArray<uint8>(v.GetData(), v.Num());
+		return true;
+	}
+	bool ReadSteamId(uint64& id) { int32 n; return ReadCount(n) && n == 8 && Read(id); }
+
+private:
+	const uint8* Take(int32 n) {
+		if (n < 0 || n > numBytes - at)
+			return nullptr;
+		const uint8* p = data + at;
+		at += n;
+		return p;
+	}
+
+	const uint8* data;
+	int32 numBytes;
+	int32 at = 0;
+};
+
+/**
+ * A list field of a native message. To encode, point Items at the elements. A decode leaves Num
+ * and the list's bytes in the packet, already checked, to be read with MakeReader:
+ *
+ *		TUbermundoWireList<FUbermundoAnnouncedPlayerWire>::FReader r = msg.Players.MakeReader();
+ *		FUbermundoAnnouncedPlayerWire p;
+ *		while (r.Next(p)) ...
+ *
+ * Encoding a decoded list writes its bytes back as they were.
+ */
+template<typename T>
+struct TUbermundoWireList {
+	TArrayView<const T> Items;
+	int32 Num = 0;
+	TArrayView<const uint8> Bytes;
+
+	struct FReader {
+		FReader(TArrayView<const uint8> bytes, int32 num) : r(bytes), left(num) {}
+		bool Next(T& out) { return left-- > 0 && r.Read(out); }
+
+	private:
+		FUbermundoWireReader r;
+		int32 left;
+	};
+
+	FReader MakeReader() const { return FReader(Bytes, Num); }
+	int32 Count() const { return Items.Num() > 0 ? Items.Num() : Num; }
+
+	void WriteItems(FUbermundoWireWriter& w) const {
+		if (Items.Num() > 0) {
+			for (const T& v : Items)
+				w.Write(v);
+		}
+		else {
+			w.WriteRaw(Bytes);
+		}
+	}
+
+	/** num items from r, or to its end if num is negative. */
+	bool ReadItems(FUbermundoWireReader& r, int32 num) {
+		Items = TArrayView<const T>();
+		FUbermundoWireReader check = r;
+		T v;
+		int32 n = 0;
+		while (num < 0 ? check.Remaining() > 0 : n < num) {
+			if (!check.Read(v))
+				return false;
+			n++;
+		}
+		Num = n;
+		return r.ReadRaw(r.Remaining() - check.Remaining(), Bytes);
+	}
+};
+
+/** What every generated native message has, TDerived giving Write and Read of the fields after the code. */
+template<typename TDerived, uint8 InCode>
+struct TUbermundoWireMessage {
+	static constexpr uint8 Code = InCode;
+
+	/** Bytes Encode needs, the code included. */
+	int32 Size() const {
+		FUbermundoWireWriter w(nullptr, 0);
+		w.Write(Code);
+		Self().Write(w);
+		return w.Num();
+	}
+	/** Write the code and the fields to out, at most capacity bytes. Returns the bytes written, 0 if they did not fit. */
+	int32 Encode(uint8* out, int32 capacity) const {
+		FUbermundoWireWriter w(out, capacity);
+		w.Write(Code);
+		Self().Write(w);
+		return w.IsOk() ? w.Num() : 0;
+	}
+	/** Append to out. Allocates only if out has no room. */
+	bool Encode(TArray<uint8>& out) const {
+		int32 n = Size();
+		int32 at = out.AddUninitialized(n);
+		if (Encode(out.GetData() + at, n) == n)
+			return true;
+		out.SetNum(at, false);
+		return false;
+	}
+	/** Into a pooled buffer, ready for SendP2P or the outbox. Invalid if a field is out of range. */
+	FUbermundoPacketRef ToPacket() const {
+		FUbermundoPacketRef packet = FUbermundoPacketBufferPool::Get().Acquire(Size());
+		if (!Encode(packet.GetMutableBytes()))
+			packet.Reset();
+		return packet;
+	}
+	/** Read a whole packet, code included. False if it is some other message or is cut short. */
+	bool Decode(const uint8* data, int32 numBytes) {
+		FUbermundoWireReader r(data, numBytes);
+		uint8 code;
+		return r.Read(code) && code == Code && Self().Read(r);
+	}
+	bool Decode(TArrayView<const uint8> packet) { return Decode(packet.GetData(), packet.Num()); }
+
+private:
+	const TDerived& Self() const { return static_cast<const TDerived&>(*this); }
+	TDerived& Self() { return static_cast<TDerived&>(*this); }
+};
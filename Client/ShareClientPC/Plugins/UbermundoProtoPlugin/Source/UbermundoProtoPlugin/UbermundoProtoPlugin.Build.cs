@@ -38,6 +38,10 @@ public class UbermundoProtoPlugin : ModuleRules
                 "Engine",
                 "Slate",
                 "SlateCore",
+                "Sockets",
+                "Networking",
+                "ImageWrapper",
+                "Voice",
 				// ... add private dependencies that you statically link with here ...	
 			}
             );
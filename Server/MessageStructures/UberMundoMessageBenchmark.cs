@@ -0,0 +1,191 @@
+﻿using LowEntryNetworkCSharp;
+using System;
+using System.Diagnostics;
+
+namespace UberMundo
+{
+    /// <summary>
+    /// Times the generated message codecs (UberMundoMessages.cs) against the LowEntryByteWriter and
+    /// LowEntryByteReader code the handlers use, on the messages the server sends most.
+    /// Run with: UberMundoServer --benchmark-messages [iterations]
+    /// </summary>
+    public static class UberMundoMessageBenchmark
+    {
+        /// <summary>
+        /// Everything decoded is added here, so the JIT can't drop the work.
+        /// </summary>
+        private static long sink;
+
+        public static void Run(int iterations)
+        {
+            iterations = Math.Max(iterations, 1);
+            Console.WriteLine($"Message codecs: {iterations} iterations each");
+            byte[] buf = new byte[64 * 1024 + 64];
+
+            // S2PAnnouncePlayersToClient_Steam, as SendAllPlayersInLevelToThisPlayer builds it, for 16 players.
+            var announce = new S2PAnnouncePlayersToClient_Steam { Players = new AnnouncedPlayer[16] };
+            byte[][] steamIds = new byte[16][];
+            for (int i = 0; i < 16; i++)
+            {
+                announce.Players[i] = new AnnouncedPlayer { UbermundoId = 1000 + i, SteamId = 76561197960265728UL + (ulong)i };
+                steamIds[i] = new byte[8];
+                System.Buffers.Binary.BinaryPrimitives.WriteUInt64BigEndian(steamIds[i], announce.Players[i].SteamId);
+            }
+            Compare("Announce 16", iterations, buf, announce.Encode, announce.ToArray,
+                () =>
+                {
+                    var bw = new LowEntryByteWriter();
+                    bw.AddByte((byte)UberMundoEventCode.S2PAnnouncePlayersToClient_Steam);
+                    bw.AddPositiveInteger1(16);
+                    for (int i = 0; i < 16; i++)
+                    {
+                        bw.AddInteger(1000 + i);
+                        bw.AddByteArray(steamIds[i]);
+                    }
+                    return bw.buf.ToArray();
+                },
+                bytes => S2PAnnouncePlayersToClient_Steam.TryDecode(bytes, out var m) ? m.Players.Length : 0,
+                bytes =>
+                {
+                    var br = new LowEntryByteReader(bytes);
+                    br.GetByte();
+                    int n = br.GetPositiveInteger1();
+                    for (int i = 0; i < n; i++)
+                    {
+                        sink += br.GetInteger();
+                        sink += br.GetByteArray().Length;
+                    }
+                    return n;
+                });
+
+            // S2PLevelMetadata, as WorldData.WriteData writes it.
+            var metadata = new WorldMetadata
+            {
+                WorldId = 42,
+                WorldName = "Bahnda's test world",
+                OwningPlayerId = 1000,
+                WotToSee = 50,
+                WorldVersion = 300,
+                PlayerUpdateIntervalFactor = 1.0f,
+            };
+            var levelMetadata = new S2PLevelMetadata { Metadata = metadata };
+            Compare("LevelMetadata", iterations, buf, levelMetadata.Encode, levelMetadata.ToArray,
+                () =>
+                {
+                    var bw = new LowEntryByteWriter();
+                    bw.AddByte((byte)UberMundoEventCode.S2PLevelMetadata);
+                    WriteLowEntry(bw, metadata);
+                    return bw.buf.ToArray();
+                },
+                bytes => S2PLevelMetadata.TryDecode(bytes, out var m) ? m.Metadata.WorldId : 0,
+                bytes =>
+                {
+                    var br = new LowEntryByteReader(bytes);
+                    br.GetByte();
+                    return ReadLowEntry(br);
+                });
+
+            // S2PLevelData with 64 KB of contents, as ActOnP2SRequestLevelData sends it.
+            byte[] contents = new byte[64 * 1024];
+            new Random(1234).NextBytes(contents);
+            var levelData = new S2PLevelData { Metadata = metadata, Contents = contents };
+            Compare("LevelData 64 KB", iterations, buf, levelData.Encode, levelData.ToArray,
+                () =>
+                {
+                    var bw = new LowEntryByteWriter();
+                    bw.AddByte((byte)UberMundoEventCode.S2PLevelData);
+                    WriteLowEntry(bw, metadata);
+                    bw.AddByteArray(contents);
+                    return bw.buf.ToArray();
+                },
+                bytes => S2PLevelData.TryDecode(bytes, out var m) ? m.Contents.Length : 0,
+                bytes =>
+                {
+                    var br = new LowEntryByteReader(bytes);
+                    br.GetByte();
+                    ReadLowEntry(br);
+                    return br.GetByteArray().Length;
+                });
+
+            // P2SPlayerUpdate, what every client sends every few seconds.
+            var update = new P2SPlayerUpdate { WorldId = 42, X = 12, Y = -3, Z = 250 };
+            Compare("PlayerUpdate", iterations, buf, update.Encode, update.ToArray,
+                () =>
+                {
+                    var bw = new LowEntryByteWriter();
+                    bw.AddByte((byte)UberMundoEventCode.P2SPlayerUpdate);
+                    bw.AddInteger(42);
+                    UberMundoConnectionThread.WriteInt16(bw, 12);
+                    UberMundoConnectionThread.WriteInt16(bw, -3);
+                    UberMundoConnectionThread.WriteInt16(bw, 250);
+                    return bw.buf.ToArray();
+                },
+                bytes => P2SPlayerUpdate.TryDecode(bytes, out var m) ? m.Z : 0,
+                bytes =>
+                {
+                    var br = new LowEntryByteReader(bytes);
+                    br.GetByte();
+                    sink += br.GetInteger();
+                    sink += UberMundoConnectionThread.ReadInt16(br);
+                    sink += UberMundoConnectionThread.ReadInt16(br);
+                    return UberMundoConnectionThread.ReadInt16(br);
+                });
+        }
+
+        private delegate int EncodeInto(Span<byte> dst);
+
+        private static void Compare(string name, int iterations, byte[] buf, EncodeInto encode, Func<byte[]> toArray,
+            Func<byte[]> lowEntryEncode, Func<byte[], int> decode, Func<byte[], int> lowEntryDecode)
+        {
+            byte[] generated = toArray();
+            byte[] lowEntry = lowEntryEncode();
+            if (!generated.AsSpan().SequenceEqual(lowEntry))
+                Console.WriteLine($"  {name}: generated and LowEntry bytes differ ({generated.Length} and {lowEntry.Length})");
+
+            Line(name, "Encode into a span", generated.Length, Time(iterations, () => encode(buf)));
+            Line(name, "ToArray", generated.Length, Time(iterations, () => toArray().Length));
+            Line(name, "LowEntryByteWriter", lowEntry.Length, Time(iterations, () => lowEntryEncode().Length));
+            Line(name, "TryDecode", generated.Length, Time(iterations, () => decode(generated)));
+            Line(name, "LowEntryByteReader", lowEntry.Length, Time(iterations, () => lowEntryDecode(lowEntry)));
+        }
+
+        /// <summary>
+        /// ns per call of f, after a warm up so the JIT has done its work.
+        /// </summary>
+        private static double Time(int iterations, Func<int> f)
+        {
+            for (int i = 0; i < Math.Min(iterations, 1000); i++)
+                sink += f();
+            var sw = Stopwatch.StartNew();
+            for (int i = 0; i < iterations; i++)
+                sink += f();
+            return sw.Elapsed.TotalMilliseconds * 1000000.0 / iterations;
+        }
+
+        private static void Line(string name, string path, int bytes, double ns)
+        {
+            Console.WriteLine($"  {name,-18} {path,-20} {bytes,6} bytes {ns,10:F1} ns {(ns > 0 ? bytes * 1000.0 / ns : 0),9:F1} MB/s");
+        }
+
+        private static void WriteLowEntry(LowEntryByteWriter bw, WorldMetadata m)
+        {
+            bw.AddInteger(m.WorldId);
+            bw.AddStringUtf8(m.WorldName);
+            bw.AddInteger(m.OwningPlayerId);
+            bw.AddByte(m.WotToSee);
+            bw.AddPositiveInteger1(m.WorldVersion);
+            bw.AddFloat(m.PlayerUpdateIntervalFactor);
+        }
+
+        private static int ReadLowEntry(LowEntryByteReader br)
+        {
+            int worldId = br.GetInteger();
+            sink += br.GetStringUtf8().Length;
+            sink += br.GetInteger();
+            sink += br.GetByte();
+            sink += br.GetPositiveInteger1();
+            sink += (long)br.GetFloat();
+            return worldId;
+        }
+    }
+}
@@ -0,0 +1,1564 @@
+// <auto-generated>
+//     Generated by Tools/gen_message_codecs.py from Tools/ubermundo_messages.schema. Do not edit, change the schema and run it again.
+// </auto-generated>
+using System;
+
+namespace UberMundo
+{
+    /// <summary>
+    /// A player in an announce, as the server keeps them.
+    /// </summary>
+    public struct AnnouncedPlayer
+    {
+        public int UbermundoId;
+        public ulong SteamId;
+
+        public void Write(ref WireWriter w)
+        {
+            w.Write(UbermundoId);
+            w.WriteSteamId(SteamId);
+        }
+
+        public static bool Read(ref WireReader r, out AnnouncedPlayer m)
+        {
+            m = default;
+            if (!r.Read(out m.UbermundoId))
+                return false;
+            if (!r.ReadSteamId(out m.SteamId))
+                return false;
+            return true;
+        }
+    }
+
+    /// <summary>
+    /// A world's metadata, as WorldData.WriteData on the server writes it.
+    /// </summary>
+    public struct WorldMetadata
+    {
+        public int WorldId;
+        public string WorldName;
+        public int OwningPlayerId;
+        /// <summary>
+        /// 0 to 100.
+        /// </summary>
+        public byte WotToSee;
+        public int WorldVersion;
+        /// <summary>
+        /// How often P2P position updates go out, times 0.1 seconds.
+        /// </summary>
+        public float PlayerUpdateIntervalFactor;
+
+        public void Write(ref WireWriter w)
+        {
+            w.Write(WorldId);
+            w.WriteString(WorldName);
+            w.Write(OwningPlayerId);
+            w.Write(WotToSee);
+            w.WriteCount(WorldVersion, WireCount.LowEntry);
+            w.Write(PlayerUpdateIntervalFactor);
+        }
+
+        public static bool Read(ref WireReader r, out WorldMetadata m)
+        {
+            m = default;
+            if (!r.Read(out m.WorldId))
+                return false;
+            if (!r.ReadString(out m.WorldName))
+                return false;
+            if (!r.Read(out m.OwningPlayerId))
+                return false;
+            if (!r.Read(out m.WotToSee))
+                return false;
+            if (!r.ReadCount(out m.WorldVersion, WireCount.LowEntry))
+                return false;
+            if (!r.Read(out m.PlayerUpdateIntervalFactor))
+                return false;
+            return true;
+        }
+    }
+
+    /// <summary>
+    /// The first message on a connection. The server answers with S2PYourUbermundoID.
+    /// Code 6, UberMundoEventCode.P2SPlayerAnnounce_Steam.
+    /// </summary>
+    public struct P2SPlayerAnnounce_Steam
+    {
+        public const UberMundoEventCode Code = UberMundoEventCode.P2SPlayerAnnounce_Steam;
+
+        public ulong SteamId;
+
+        public void Write(ref WireWriter w)
+        {
+            w.WriteSteamId(SteamId);
+        }
+
+        public static bool Read(ref WireReader r, out P2SPlayerAnnounce_Steam m)
+        {
+            m = default;
+            if (!r.ReadSteamId(out m.SteamId))
+                return false;
+            return true;
+        }
+
+        /// <summary>
+        /// Bytes Encode needs, the code included.
+        /// </summary>
+        public int Size
+        {
+            get
+            {
+                var w = WireWriter.Counting();
+                w.Write((byte)Code);
+                Write(ref w);
+                return w.Length;
+            }
+        }
+
+        /// <summary>
+        /// Writes the code and the fields into dst. Returns the bytes written, 0 if they did not fit.
+        /// </summary>
+        public int Encode(Span<byte> dst)
+        {
+            var w = new WireWriter(dst);
+            w.Write((byte)Code);
+            Write(ref w);
+            return w.Ok ? w.Length : 0;
+        }
+
+        public byte[] ToArray()
+        {
+            byte[] a = new byte[Size];
+            return Encode(a) == a.Length ? a : null;
+        }
+
+        /// <summary>
+        /// False if src is not a P2SPlayerAnnounce_Steam or is cut short.
+        /// </summary>
+        public static bool TryDecode(ReadOnlySpan<byte> src, out P2SPlayerAnnounce_Steam m)
+        {
+            var r = new WireReader(src);
+            if (!r.Read(out byte code) || code != (byte)Code)
+            {
+                m = default;
+                return false;
+            }
+            return Read(ref r, out m);
+        }
+    }
+
+    /// <summary>
+    /// Where the player is, every few seconds. Also keeps the connection alive.
+    /// Code 2, UberMundoEventCode.P2SPlayerUpdate.
+    /// </summary>
+    public struct P2SPlayerUpdate
+    {
+        public const UberMundoEventCode Code = UberMundoEventCode.P2SPlayerUpdate;
+
+        public int WorldId;
+        /// <summary>
+        /// Decameters, 10 m per unit.
+        /// </summary>
+        public short X;
+        public short Y;
+        public short Z;
+
+        public void Write(ref WireWriter w)
+        {
+            w.Write(WorldId);
+            w.Write(X);
+            w.Write(Y);
+            w.Write(Z);
+        }
+
+        public static bool Read(ref WireReader r, out P2SPlayerUpdate m)
+        {
+            m = default;
+            if (!r.Read(out m.WorldId))
+                return false;
+            if (!r.Read(out m.X))
+                return false;
+            if (!r.Read(out m.Y))
+                return false;
+            if (!r.Read(out m.Z))
+                return false;
+            return true;
+        }
+
+        /// <summary>
+        /// Bytes Encode needs, the code included.
+        /// </summary>
+        public int Size
+        {
+            get
+            {
+                var w = WireWriter.Counting();
+                w.Write((byte)Code);
+                Write(ref w);
+                return w.Length;
+            }
+        }
+
+        /// <summary>
+        /// Writes the code and the fields into dst. Returns the bytes written, 0 if they did not fit.
+        /// </summary>
+        public int Encode(Span<byte> dst)
+        {
+            var w = new WireWriter(dst);
+            w.Write((byte)Code);
+            Write(ref w);
+            return w.Ok ? w.Length : 0;
+        }
+
+        public byte[] ToArray()
+        {
+            byte[] a = new byte[Size];
+            return Encode(a) == a.Length ? a : null;
+        }
+
+        /// <summary>
+        /// False if src is not a P2SPlayerUpdate or is cut short.
+        /// </summary>
+        public static bool TryDecode(ReadOnlySpan<byte> src, out P2SPlayerUpdate m)
+        {
+            var r = new WireReader(src);
+            if (!r.Read(out byte code) || code != (byte)Code)
+            {
+                m = default;
+                return false;
+            }
+            return Read(ref r, out m);
+        }
+    }
+
+    /// <summary>
+    /// Code 3, UberMundoEventCode.P2SLeavingGame.
+    /// </summary>
+    public struct P2SLeavingGame
+    {
+        public const UberMundoEventCode Code = UberMundoEventCode.P2SLeavingGame;
+
+        public int UbermundoId;
+
+        public void Write(ref WireWriter w)
+        {
+            w.Write(UbermundoId);
+        }
+
+        public static bool Read(ref WireReader r, out P2SLeavingGame m)
+        {
+            m = default;
+            if (!r.Read(out m.UbermundoId))
+                return false;
+            return true;
+        }
+
+        /// <summary>
+        /// Bytes Encode needs, the code included.
+        /// </summary>
+        public int Size
+        {
+            get
+            {
+                var w = WireWriter.Counting();
+                w.Write((byte)Code);
+                Write(ref w);
+                return w.Length;
+            }
+        }
+
+        /// <summary>
+        /// Writes the code and the fields into dst. Returns the bytes written, 0 if they did not fit.
+        /// </summary>
+        public int Encode(Span<byte> dst)
+        {
+            var w = new WireWriter(dst);
+            w.Write((byte)Code);
+            Write(ref w);
+            return w.Ok ? w.Length : 0;
+        }
+
+        public byte[] ToArray()
+        {
+            byte[] a = new byte[Size];
+            return Encode(a) == a.Length ? a : null;
+        }
+
+        /// <summary>
+        /// False if src is not a P2SLeavingGame or is cut short.
+        /// </summary>
+        public static bool TryDecode(ReadOnlySpan<byte> src, out P2SLeavingGame m)
+        {
+            var r = new WireReader(src);
+            if (!r.Read(out byte code) || code != (byte)Code)
+            {
+                m = default;
+                return false;
+            }
+            return Read(ref r, out m);
+        }
+    }
+
+    /// <summary>
+    /// Code 30, UberMundoEventCode.P2SRequestLevelData.
+    /// </summary>
+    public struct P2SRequestLevelData
+    {
+        public const UberMundoEventCode Code = UberMundoEventCode.P2SRequestLevelData;
+
+        public int WorldId;
+
+        public void Write(ref WireWriter w)
+        {
+            w.Write(WorldId);
+        }
+
+        public static bool Read(ref WireReader r, out P2SRequestLevelData m)
+        {
+            m = default;
+            if (!r.Read(out m.WorldId))
+                return false;
+            return true;
+        }
+
+        /// <summary>
+        /// Bytes Encode needs, the code included.
+        /// </summary>
+        public int Size
+        {
+            get
+            {
+                var w = WireWriter.Counting();
+                w.Write((byte)Code);
+                Write(ref w);
+                return w.Length;
+            }
+        }
+
+        /// <summary>
+        /// Writes the code and the fields into dst. Returns the bytes written, 0 if they did not fit.
+        /// </summary>
+        public int Encode(Span<byte> dst)
+        {
+            var w = new WireWriter(dst);
+            w.Write((byte)Code);
+            Write(ref w);
+            return w.Ok ? w.Length : 0;
+        }
+
+        public byte[] ToArray()
+        {
+            byte[] a = new byte[Size];
+            return Encode(a) == a.Length ? a : null;
+        }
+
+        /// <summary>
+        /// False if src is not a P2SRequestLevelData or is cut short.
+        /// </summary>
+        public static bool TryDecode(ReadOnlySpan<byte> src, out P2SRequestLevelData m)
+        {
+            var r = new WireReader(src);
+            if (!r.Read(out byte code) || code != (byte)Code)
+            {
+                m = default;
+                return false;
+            }
+            return Read(ref r, out m);
+        }
+    }
+
+    /// <summary>
+    /// Code 32, UberMundoEventCode.P2SSaveLevelData.
+    /// </summary>
+    public struct P2SSaveLevelData
+    {
+        public const UberMundoEventCode Code = UberMundoEventCode.P2SSaveLevelData;
+
+        public WorldMetadata Metadata;
+        public byte[] Contents;
+
+        public void Write(ref WireWriter w)
+        {
+            Metadata.Write(ref w);
+            w.WriteSized(Contents);
+        }
+
+        public static bool Read(ref WireReader r, out P2SSaveLevelData m)
+        {
+            m = default;
+            if (!WorldMetadata.Read(ref r, out m.Metadata))
+                return false;
+            if (!r.ReadSized(out m.Contents))
+                return false;
+            return true;
+        }
+
+        /// <summary>
+        /// Bytes Encode needs, the code included.
+        /// </summary>
+        public int Size
+        {
+            get
+            {
+                var w = WireWriter.Counting();
+                w.Write((byte)Code);
+                Write(ref w);
+                return w.Length;
+            }
+        }
+
+        /// <summary>
+        /// Writes the code and the fields into dst. Returns the bytes written, 0 if they did not fit.
+        /// </summary>
+        public int Encode(Span<byte> dst)
+        {
+            var w = new WireWriter(dst);
+            w.Write((byte)Code);
+            Write(ref w);
+            return w.Ok ? w.Length : 0;
+        }
+
+        public byte[] ToArray()
+        {
+            byte[] a = new byte[Size];
+            return Encode(a) == a.Length ? a : null;
+        }
+
+        /// <summary>
+        /// False if src is not a P2SSaveLevelData or is cut short.
+        /// </summary>
+        public static bool TryDecode(ReadOnlySpan<byte> src, out P2SSaveLevelData m)
+        {
+            var r = new WireReader(src);
+            if (!r.Read(out byte code) || code != (byte)Code)
+            {
+                m = default;
+                return false;
+            }
+            return Read(ref r, out m);
+        }
+    }
+
+    /// <summary>
+    /// Only WorldName, WotToSee, WorldVersion and PlayerUpdateIntervalFactor of Metadata are used.
+    /// Code 33, UberMundoEventCode.P2SCreateNewWorld.
+    /// </summary>
+    public struct P2SCreateNewWorld
+    {
+        public const UberMundoEventCode Code = UberMundoEventCode.P2SCreateNewWorld;
+
+        public WorldMetadata Metadata;
+
+        public void Write(ref WireWriter w)
+        {
+            Metadata.Write(ref w);
+        }
+
+        public static bool Read(ref WireReader r, out P2SCreateNewWorld m)
+        {
+            m = default;
+            if (!WorldMetadata.Read(ref r, out m.Metadata))
+                return false;
+            return true;
+        }
+
+        /// <summary>
+        /// Bytes Encode needs, the code included.
+        /// </summary>
+        public int Size
+        {
+            get
+            {
+                var w = WireWriter.Counting();
+                w.Write((byte)Code);
+                Write(ref w);
+                return w.Length;
+            }
+        }
+
+        /// <summary>
+        /// Writes the code and the fields into dst. Returns the bytes written, 0 if they did not fit.
+        /// </summary>
+        public int Encode(Span<byte> dst)
+        {
+            var w = new WireWriter(dst);
+            w.Write((byte)Code);
+            Write(ref w);
+            return w.Ok ? w.Length : 0;
+        }
+
+        public byte[] ToArray()
+        {
+            byte[] a = new byte[Size];
+            return Encode(a) == a.Length ? a : null;
+        }
+
+        /// <summary>
+        /// False if src is not a P2SCreateNewWorld or is cut short.
+        /// </summary>
+        public static bool TryDecode(ReadOnlySpan<byte> src, out P2SCreateNewWorld m)
+        {
+            var r = new WireReader(src);
+            if (!r.Read(out byte code) || code != (byte)Code)
+            {
+                m = default;
+                return false;
+            }
+            return Read(ref r, out m);
+        }
+    }
+
+    /// <summary>
+    /// Code 40, UberMundoEventCode.P2SRequestLevelMetadata.
+    /// </summary>
+    public struct P2SRequestLevelMetadata
+    {
+        public const UberMundoEventCode Code = UberMundoEventCode.P2SRequestLevelMetadata;
+
+        public int WorldId;
+
+        public void Write(ref WireWriter w)
+        {
+            w.Write(WorldId);
+        }
+
+        public static bool Read(ref WireReader r, out P2SRequestLevelMetadata m)
+        {
+            m = default;
+            if (!r.Read(out m.WorldId))
+                return false;
+            return true;
+        }
+
+        /// <summary>
+        /// Bytes Encode needs, the code included.
+        /// </summary>
+        public int Size
+        {
+            get
+            {
+                var w = WireWriter.Counting();
+                w.Write((byte)Code);
+                Write(ref w);
+                return w.Length;
+            }
+        }
+
+        /// <summary>
+        /// Writes the code and the fields into dst. Returns the bytes written, 0 if they did not fit.
+        /// </summary>
+        public int Encode(Span<byte> dst)
+        {
+            var w = new WireWriter(dst);
+            w.Write((byte)Code);
+            Write(ref w);
+            return w.Ok ? w.Length : 0;
+        }
+
+        public byte[] ToArray()
+        {
+            byte[] a = new byte[Size];
+            return Encode(a) == a.Length ? a : null;
+        }
+
+        /// <summary>
+        /// False if src is not a P2SRequestLevelMetadata or is cut short.
+        /// </summary>
+        public static bool TryDecode(ReadOnlySpan<byte> src, out P2SRequestLevelMetadata m)
+        {
+            var r = new WireReader(src);
+            if (!r.Read(out byte code) || code != (byte)Code)
+            {
+                m = default;
+                return false;
+            }
+            return Read(ref r, out m);
+        }
+    }
+
+    /// <summary>
+    /// Code 43, UberMundoEventCode.P2SRequestAllLevelMetas.
+    /// </summary>
+    public struct P2SRequestAllLevelMetas
+    {
+        public const UberMundoEventCode Code = UberMundoEventCode.P2SRequestAllLevelMetas;
+
+        public void Write(ref WireWriter w)
+        {
+        }
+
+        public static bool Read(ref WireReader r, out P2SRequestAllLevelMetas m)
+        {
+            m = default;
+            return true;
+        }
+
+        /// <summary>
+        /// Bytes Encode needs, the code included.
+        /// </summary>
+        public int Size
+        {
+            get
+            {
+                var w = WireWriter.Counting();
+                w.Write((byte)Code);
+                Write(ref w);
+                return w.Length;
+            }
+        }
+
+        /// <summary>
+        /// Writes the code and the fields into dst. Returns the bytes written, 0 if they did not fit.
+        /// </summary>
+        public int Encode(Span<byte> dst)
+        {
+            var w = new WireWriter(dst);
+            w.Write((byte)Code);
+            Write(ref w);
+            return w.Ok ? w.Length : 0;
+        }
+
+        public byte[] ToArray()
+        {
+            byte[] a = new byte[Size];
+            return Encode(a) == a.Length ? a : null;
+        }
+
+        /// <summary>
+        /// False if src is not a P2SRequestAllLevelMetas or is cut short.
+        /// </summary>
+        public static bool TryDecode(ReadOnlySpan<byte> src, out P2SRequestAllLevelMetas m)
+        {
+            var r = new WireReader(src);
+            if (!r.Read(out byte code) || code != (byte)Code)
+            {
+                m = default;
+                return false;
+            }
+            return Read(ref r, out m);
+        }
+    }
+
+    /// <summary>
+    /// Not implemented on the server yet.
+    /// Code 50, UberMundoEventCode.P2SAddThing.
+    /// </summary>
+    public struct P2SAddThing
+    {
+        public const UberMundoEventCode Code = UberMundoEventCode.P2SAddThing;
+
+        public string AssetPath;
+
+        public void Write(ref WireWriter w)
+        {
+            w.WriteString(AssetPath);
+        }
+
+        public static bool Read(ref WireReader r, out P2SAddThing m)
+        {
+            m = default;
+            if (!r.ReadString(out m.AssetPath))
+                return false;
+            return true;
+        }
+
+        /// <summary>
+        /// Bytes Encode needs, the code included.
+        /// </summary>
+        public int Size
+        {
+            get
+            {
+                var w = WireWriter.Counting();
+                w.Write((byte)Code);
+                Write(ref w);
+                return w.Length;
+            }
+        }
+
+        /// <summary>
+        /// Writes the code and the fields into dst. Returns the bytes written, 0 if they did not fit.
+        /// </summary>
+        public int Encode(Span<byte> dst)
+        {
+            var w = new WireWriter(dst);
+            w.Write((byte)Code);
+            Write(ref w);
+            return w.Ok ? w.Length : 0;
+        }
+
+        public byte[] ToArray()
+        {
+            byte[] a = new byte[Size];
+            return Encode(a) == a.Length ? a : null;
+        }
+
+        /// <summary>
+        /// False if src is not a P2SAddThing or is cut short.
+        /// </summary>
+        public static bool TryDecode(ReadOnlySpan<byte> src, out P2SAddThing m)
+        {
+            var r = new WireReader(src);
+            if (!r.Read(out byte code) || code != (byte)Code)
+            {
+                m = default;
+                return false;
+            }
+            return Read(ref r, out m);
+        }
+    }
+
+    /// <summary>
+    /// Not implemented on the server yet.
+    /// Code 51, UberMundoEventCode.P2SRemoveThing.
+    /// </summary>
+    public struct P2SRemoveThing
+    {
+        public const UberMundoEventCode Code = UberMundoEventCode.P2SRemoveThing;
+
+        public int ThingId;
+
+        public void Write(ref WireWriter w)
+        {
+            w.Write(ThingId);
+        }
+
+        public static bool Read(ref WireReader r, out P2SRemoveThing m)
+        {
+            m = default;
+            if (!r.Read(out m.ThingId))
+                return false;
+            return true;
+        }
+
+        /// <summary>
+        /// Bytes Encode needs, the code included.
+        /// </summary>
+        public int Size
+        {
+            get
+            {
+                var w = WireWriter.Counting();
+                w.Write((byte)Code);
+                Write(ref w);
+                return w.Length;
+            }
+        }
+
+        /// <summary>
+        /// Writes the code and the fields into dst. Returns the bytes written, 0 if they did not fit.
+        /// </summary>
+        public int Encode(Span<byte> dst)
+        {
+            var w = new WireWriter(dst);
+            w.Write((byte)Code);
+            Write(ref w);
+            return w.Ok ? w.Length : 0;
+        }
+
+        public byte[] ToArray()
+        {
+            byte[] a = new byte[Size];
+            return Encode(a) == a.Length ? a : null;
+        }
+
+        /// <summary>
+        /// False if src is not a P2SRemoveThing or is cut short.
+        /// </summary>
+        public static bool TryDecode(ReadOnlySpan<byte> src, out P2SRemoveThing m)
+        {
+            var r = new WireReader(src);
+            if (!r.Read(out byte code) || code != (byte)Code)
+            {
+                m = default;
+                return false;
+            }
+            return Read(ref r, out m);
+        }
+    }
+
+    /// <summary>
+    /// Code 52, UberMundoEventCode.P2SGetNextObjectID.
+    /// </summary>
+    public struct P2SGetNextObjectID
+    {
+        public const UberMundoEventCode Code = UberMundoEventCode.P2SGetNextObjectID;
+
+        public int WorldId;
+
+        public void Write(ref WireWriter w)
+        {
+            w.Write(WorldId);
+        }
+
+        public static bool Read(ref WireReader r, out P2SGetNextObjectID m)
+        {
+            m = default;
+            if (!r.Read(out m.WorldId))
+                return false;
+            return true;
+        }
+
+        /// <summary>
+        /// Bytes Encode needs, the code included.
+        /// </summary>
+        public int Size
+        {
+            get
+            {
+                var w = WireWriter.Counting();
+                w.Write((byte)Code);
+                Write(ref w);
+                return w.Length;
+            }
+        }
+
+        /// <summary>
+        /// Writes the code and the fields into dst. Returns the bytes written, 0 if they did not fit.
+        /// </summary>
+        public int Encode(Span<byte> dst)
+        {
+            var w = new WireWriter(dst);
+            w.Write((byte)Code);
+            Write(ref w);
+            return w.Ok ? w.Length : 0;
+        }
+
+        public byte[] ToArray()
+        {
+            byte[] a = new byte[Size];
+            return Encode(a) == a.Length ? a : null;
+        }
+
+        /// <summary>
+        /// False if src is not a P2SGetNextObjectID or is cut short.
+        /// </summary>
+        public static bool TryDecode(ReadOnlySpan<byte> src, out P2SGetNextObjectID m)
+        {
+            var r = new WireReader(src);
+            if (!r.Read(out byte code) || code != (byte)Code)
+            {
+                m = default;
+                return false;
+            }
+            return Read(ref r, out m);
+        }
+    }
+
+    /// <summary>
+    /// Code 1, UberMundoEventCode.S2PYourUbermundoID.
+    /// </summary>
+    public struct S2PYourUbermundoID
+    {
+        public const UberMundoEventCode Code = UberMundoEventCode.S2PYourUbermundoID;
+
+        public int UbermundoId;
+
+        public void Write(ref WireWriter w)
+        {
+            w.Write(UbermundoId);
+        }
+
+        public static bool Read(ref WireReader r, out S2PYourUbermundoID m)
+        {
+            m = default;
+            if (!r.Read(out m.UbermundoId))
+                return false;
+            return true;
+        }
+
+        /// <summary>
+        /// Bytes Encode needs, the code included.
+        /// </summary>
+        public int Size
+        {
+            get
+            {
+                var w = WireWriter.Counting();
+                w.Write((byte)Code);
+                Write(ref w);
+                return w.Length;
+            }
+        }
+
+        /// <summary>
+        /// Writes the code and the fields into dst. Returns the bytes written, 0 if they did not fit.
+        /// </summary>
+        public int Encode(Span<byte> dst)
+        {
+            var w = new WireWriter(dst);
+            w.Write((byte)Code);
+            Write(ref w);
+            return w.Ok ? w.Length : 0;
+        }
+
+        public byte[] ToArray()
+        {
+            byte[] a = new byte[Size];
+            return Encode(a) == a.Length ? a : null;
+        }
+
+        /// <summary>
+        /// False if src is not a S2PYourUbermundoID or is cut short.
+        /// </summary>
+        public static bool TryDecode(ReadOnlySpan<byte> src, out S2PYourUbermundoID m)
+        {
+            var r = new WireReader(src);
+            if (!r.Read(out byte code) || code != (byte)Code)
+            {
+                m = default;
+                return false;
+            }
+            return Read(ref r, out m);
+        }
+    }
+
+    /// <summary>
+    /// Code 4, UberMundoEventCode.S2PPlayerLeftLevel.
+    /// </summary>
+    public struct S2PPlayerLeftLevel
+    {
+        public const UberMundoEventCode Code = UberMundoEventCode.S2PPlayerLeftLevel;
+
+        public int UbermundoId;
+        public ulong SteamId;
+
+        public void Write(ref WireWriter w)
+        {
+            w.Write(UbermundoId);
+            w.WriteSteamId(SteamId);
+        }
+
+        public static bool Read(ref WireReader r, out S2PPlayerLeftLevel m)
+        {
+            m = default;
+            if (!r.Read(out m.UbermundoId))
+                return false;
+            if (!r.ReadSteamId(out m.SteamId))
+                return false;
+            return true;
+        }
+
+        /// <summary>
+        /// Bytes Encode needs, the code included.
+        /// </summary>
+        public int Size
+        {
+            get
+            {
+                var w = WireWriter.Counting();
+                w.Write((byte)Code);
+                Write(ref w);
+                return w.Length;
+            }
+        }
+
+        /// <summary>
+        /// Writes the code and the fields into dst. Returns the bytes written, 0 if they did not fit.
+        /// </summary>
+        public int Encode(Span<byte> dst)
+        {
+            var w = new WireWriter(dst);
+            w.Write((byte)Code);
+            Write(ref w);
+            return w.Ok ? w.Length : 0;
+        }
+
+        public byte[] ToArray()
+        {
+            byte[] a = new byte[Size];
+            return Encode(a) == a.Length ? a : null;
+        }
+
+        /// <summary>
+        /// False if src is not a S2PPlayerLeftLevel or is cut short.
+        /// </summary>
+        public static bool TryDecode(ReadOnlySpan<byte> src, out S2PPlayerLeftLevel m)
+        {
+            var r = new WireReader(src);
+            if (!r.Read(out byte code) || code != (byte)Code)
+            {
+                m = default;
+                return false;
+            }
+            return Read(ref r, out m);
+        }
+    }
+
+    /// <summary>
+    /// Code 5, UberMundoEventCode.S2PPlayerEnteredLevel.
+    /// </summary>
+    public struct S2PPlayerEnteredLevel
+    {
+        public const UberMundoEventCode Code = UberMundoEventCode.S2PPlayerEnteredLevel;
+
+        public int UbermundoId;
+        public ulong SteamId;
+
+        public void Write(ref WireWriter w)
+        {
+            w.Write(UbermundoId);
+            w.WriteSteamId(SteamId);
+        }
+
+        public static bool Read(ref WireReader r, out S2PPlayerEnteredLevel m)
+        {
+            m = default;
+            if (!r.Read(out m.UbermundoId))
+                return false;
+            if (!r.ReadSteamId(out m.SteamId))
+                return false;
+            return true;
+        }
+
+        /// <summary>
+        /// Bytes Encode needs, the code included.
+        /// </summary>
+        public int Size
+        {
+            get
+            {
+                var w = WireWriter.Counting();
+                w.Write((byte)Code);
+                Write(ref w);
+                return w.Length;
+            }
+        }
+
+        /// <summary>
+        /// Writes the code and the fields into dst. Returns the bytes written, 0 if they did not fit.
+        /// </summary>
+        public int Encode(Span<byte> dst)
+        {
+            var w = new WireWriter(dst);
+            w.Write((byte)Code);
+            Write(ref w);
+            return w.Ok ? w.Length : 0;
+        }
+
+        public byte[] ToArray()
+        {
+            byte[] a = new byte[Size];
+            return Encode(a) == a.Length ? a : null;
+        }
+
+        /// <summary>
+        /// False if src is not a S2PPlayerEnteredLevel or is cut short.
+        /// </summary>
+        public static bool TryDecode(ReadOnlySpan<byte> src, out S2PPlayerEnteredLevel m)
+        {
+            var r = new WireReader(src);
+            if (!r.Read(out byte code) || code != (byte)Code)
+            {
+                m = default;
+                return false;
+            }
+            return Read(ref r, out m);
+        }
+    }
+
+    /// <summary>
+    /// Everyone else in the world the player is in.
+    /// Code 10, UberMundoEventCode.S2PAnnouncePlayersToClient_Steam.
+    /// </summary>
+    public struct S2PAnnouncePlayersToClient_Steam
+    {
+        public const UberMundoEventCode Code = UberMundoEventCode.S2PAnnouncePlayersToClient_Steam;
+
+        public AnnouncedPlayer[] Players;
+
+        public void Write(ref WireWriter w)
+        {
+            w.WriteCount(Players?.Length ?? 0, WireCount.LowEntry);
+            if (Players != null)
+            {
+                foreach (var v in Players)
+                    v.Write(ref w);
+            }
+        }
+
+        public static bool Read(ref WireReader r, out S2PAnnouncePlayersToClient_Steam m)
+        {
+            m = default;
+            if (!r.ReadCount(out int numPlayers, WireCount.LowEntry) || numPlayers > r.Remaining / 13)
+                return false;
+            m.Players = new AnnouncedPlayer[numPlayers];
+            for (int i = 0; i < numPlayers; i++)
+            {
+                if (!AnnouncedPlayer.Read(ref r, out m.Players[i]))
+                    return false;
+            }
+            return true;
+        }
+
+        /// <summary>
+        /// Bytes Encode needs, the code included.
+        /// </summary>
+        public int Size
+        {
+            get
+            {
+                var w = WireWriter.Counting();
+                w.Write((byte)Code);
+                Write(ref w);
+                return w.Length;
+            }
+        }
+
+        /// <summary>
+        /// Writes the code and the fields into dst. Returns the bytes written, 0 if they did not fit.
+        /// </summary>
+        public int Encode(Span<byte> dst)
+        {
+            var w = new WireWriter(dst);
+            w.Write((byte)Code);
+            Write(ref w);
+            return w.Ok ? w.Length : 0;
+        }
+
+        public byte[] ToArray()
+        {
+            byte[] a = new byte[Size];
+            return Encode(a) == a.Length ? a : null;
+        }
+
+        /// <summary>
+        /// False if src is not a S2PAnnouncePlayersToClient_Steam or is cut short.
+        /// </summary>
+        public static bool TryDecode(ReadOnlySpan<byte> src, out S2PAnnouncePlayersToClient_Steam m)
+        {
+            var r = new WireReader(src);
+            if (!r.Read(out byte code) || code != (byte)Code)
+            {
+                m = default;
+                return false;
+            }
+            return Read(ref r, out m);
+        }
+    }
+
+    /// <summary>
+    /// Answer to P2SRequestLevelData. All zero metadata and no contents if there is no such world.
+    /// Code 31, UberMundoEventCode.S2PLevelData.
+    /// </summary>
+    public struct S2PLevelData
+    {
+        public const UberMundoEventCode Code = UberMundoEventCode.S2PLevelData;
+
+        public WorldMetadata Metadata;
+        public byte[] Contents;
+
+        public void Write(ref WireWriter w)
+        {
+            Metadata.Write(ref w);
+            w.WriteSized(Contents);
+        }
+
+        public static bool Read(ref WireReader r, out S2PLevelData m)
+        {
+            m = default;
+            if (!WorldMetadata.Read(ref r, out m.Metadata))
+                return false;
+            if (!r.ReadSized(out m.Contents))
+                return false;
+            return true;
+        }
+
+        /// <summary>
+        /// Bytes Encode needs, the code included.
+        /// </summary>
+        public int Size
+        {
+            get
+            {
+                var w = WireWriter.Counting();
+                w.Write((byte)Code);
+                Write(ref w);
+                return w.Length;
+            }
+        }
+
+        /// <summary>
+        /// Writes the code and the fields into dst. Returns the bytes written, 0 if they did not fit.
+        /// </summary>
+        public int Encode(Span<byte> dst)
+        {
+            var w = new WireWriter(dst);
+            w.Write((byte)Code);
+            Write(ref w);
+            return w.Ok ? w.Length : 0;
+        }
+
+        public byte[] ToArray()
+        {
+            byte[] a = new byte[Size];
+            return Encode(a) == a.Length ? a : null;
+        }
+
+        /// <summary>
+        /// False if src is not a S2PLevelData or is cut short.
+        /// </summary>
+        public static bool TryDecode(ReadOnlySpan<byte> src, out S2PLevelData m)
+        {
+            var r = new WireReader(src);
+            if (!r.Read(out byte code) || code != (byte)Code)
+            {
+                m = default;
+                return false;
+            }
+            return Read(ref r, out m);
+        }
+    }
+
+    /// <summary>
+    /// Code 34, UberMundoEventCode.S2PWorldCreated.
+    /// </summary>
+    public struct S2PWorldCreated
+    {
+        public const UberMundoEventCode Code = UberMundoEventCode.S2PWorldCreated;
+
+        public int WorldId;
+
+        public void Write(ref WireWriter w)
+        {
+            w.Write(WorldId);
+        }
+
+        public static bool Read(ref WireReader r, out S2PWorldCreated m)
+        {
+            m = default;
+            if (!r.Read(out m.WorldId))
+                return false;
+            return true;
+        }
+
+        /// <summary>
+        /// Bytes Encode needs, the code included.
+        /// </summary>
+        public int Size
+        {
+            get
+            {
+                var w = WireWriter.Counting();
+                w.Write((byte)Code);
+                Write(ref w);
+                return w.Length;
+            }
+        }
+
+        /// <summary>
+        /// Writes the code and the fields into dst. Returns the bytes written, 0 if they did not fit.
+        /// </summary>
+        public int Encode(Span<byte> dst)
+        {
+            var w = new WireWriter(dst);
+            w.Write((byte)Code);
+            Write(ref w);
+            return w.Ok ? w.Length : 0;
+        }
+
+        public byte[] ToArray()
+        {
+            byte[] a = new byte[Size];
+            return Encode(a) == a.Length ? a : null;
+        }
+
+        /// <summary>
+        /// False if src is not a S2PWorldCreated or is cut short.
+        /// </summary>
+        public static bool TryDecode(ReadOnlySpan<byte> src, out S2PWorldCreated m)
+        {
+            var r = new WireReader(src);
+            if (!r.Read(out byte code) || code != (byte)Code)
+            {
+                m = default;
+                return false;
+            }
+            return Read(ref r, out m);
+        }
+    }
+
+    /// <summary>
+    /// Answer to P2SRequestLevelMetadata. All zero if there is no such world.
+    /// Code 42, UberMundoEventCode.S2PLevelMetadata.
+    /// </summary>
+    public struct S2PLevelMetadata
+    {
+        public const UberMundoEventCode Code = UberMundoEventCode.S2PLevelMetadata;
+
+        public WorldMetadata Metadata;
+
+        public void Write(ref WireWriter w)
+        {
+            Metadata.Write(ref w);
+        }
+
+        public static bool Read(ref WireReader r, out S2PLevelMetadata m)
+        {
+            m = default;
+            if (!WorldMetadata.Read(ref r, out m.Metadata))
+                return false;
+            return true;
+        }
+
+        /// <summary>
+        /// Bytes Encode needs, the code included.
+        /// </summary>
+        public int Size
+        {
+            get
+            {
+                var w = WireWriter.Counting();
+                w.Write((byte)Code);
+                Write(ref w);
+                return w.Length;
+            }
+        }
+
+        /// <summary>
+        /// Writes the code and the fields into dst. Returns the bytes written, 0 if they did not fit.
+        /// </summary>
+        public int Encode(Span<byte> dst)
+        {
+            var w = new WireWriter(dst);
+            w.Write((byte)Code);
+            Write(ref w);
+            return w.Ok ? w.Length : 0;
+        }
+
+        public byte[] ToArray()
+        {
+            byte[] a = new byte[Size];
+            return Encode(a) == a.Length ? a : null;
+        }
+
+        /// <summary>
+        /// False if src is not a S2PLevelMetadata or is cut short.
+        /// </summary>
+        public static bool TryDecode(ReadOnlySpan<byte> src, out S2PLevelMetadata m)
+        {
+            var r = new WireReader(src);
+            if (!r.Read(out byte code) || code != (byte)Code)
+            {
+                m = default;
+                return false;
+            }
+            return Read(ref r, out m);
+        }
+    }
+
+    /// <summary>
+    /// Code 44, UberMundoEventCode.S2PAllLevelMetadata.
+    /// </summary>
+    public struct S2PAllLevelMetadata
+    {
+        public const UberMundoEventCode Code = UberMundoEventCode.S2PAllLevelMetadata;
+
+        public WorldMetadata[] Worlds;
+
+        public void Write(ref WireWriter w)
+        {
+            w.WriteCount(Worlds?.Length ?? 0, WireCount.I32);
+            if (Worlds != null)
+            {
+                foreach (var v in Worlds)
+                    v.Write(ref w);
+            }
+        }
+
+        public static bool Read(ref WireReader r, out S2PAllLevelMetadata m)
+        {
+            m = default;
+            if (!r.ReadCount(out int numWorlds, WireCount.I32) || numWorlds > r.Remaining / 15)
+                return false;
+            m.Worlds = new WorldMetadata[numWorlds];
+            for (int i = 0; i < numWorlds; i++)
+            {
+                if (!WorldMetadata.Read(ref r, out m.Worlds[i]))
+                    return false;
+            }
+            return true;
+        }
+
+        /// <summary>
+        /// Bytes Encode needs, the code included.
+        /// </summary>
+        public int Size
+        {
+            get
+            {
+                var w = WireWriter.Counting();
+                w.Write((byte)Code);
+                Write(ref w);
+                return w.Length;
+            }
+        }
+
+        /// <summary>
+        /// Writes the code and the fields into dst. Returns the bytes written, 0 if they did not fit.
+        /// </summary>
+        public int Encode(Span<byte> dst)
+        {
+            var w = new WireWriter(dst);
+            w.Write((byte)Code);
+            Write(ref w);
+            return w.Ok ? w.Length : 0;
+        }
+
+        public byte[] ToArray()
+        {
+            byte[] a = new byte[Size];
+            return Encode(a) == a.Length ? a : null;
+        }
+
+        /// <summary>
+        /// False if src is not a S2PAllLevelMetadata or is cut short.
+        /// </summary>
+        public static bool TryDecode(ReadOnlySpan<byte> src, out S2PAllLevelMetadata m)
+        {
+            var r = new WireReader(src);
+            if (!r.Read(out byte code) || code != (byte)Code)
+            {
+                m = default;
+                return false;
+            }
+            return Read(ref r, out m);
+        }
+    }
+
+    /// <summary>
+    /// 0 if there is no such world.
+    /// Code 53, UberMundoEventCode.S2PNextObjectID.
+    /// </summary>
+    public struct S2PNextObjectID
+    {
+        public const UberMundoEventCode Code = UberMundoEventCode.S2PNextObjectID;
+
+        public int ObjectId;
+
+        public void Write(ref WireWriter w)
+        {
+            w.Write(ObjectId);
+        }
+
+        public static bool Read(ref WireReader r, out S2PNextObjectID m)
+        {
+            m = default;
+            if (!r.Read(out m.ObjectId))
+                return false;
+            return true;
+        }
+
+        /// <summary>
+        /// Bytes Encode needs, the code included.
+        /// </summary>
+        public int Size
+        {
+            get
+            {
+                var w = WireWriter.Counting();
+                w.Write((byte)Code);
+                Write(ref w);
+                return w.Length;
+            }
+        }
+
+        /// <summary>
+        /// Writes the code and the fields into dst. Returns the bytes written, 0 if they did not fit.
+        /// </summary>
+        public int Encode(Span<byte> dst)
+        {
+            var w = new WireWriter(dst);
+            w.Write((byte)Code);
+            Write(ref w);
+            return w.Ok ? w.Length : 0;
+        }
+
+        public byte[] ToArray()
+        {
+            byte[] a = new byte[Size];
+            return Encode(a) == a.Length ? a : null;
+        }
+
+        /// <summary>
+        /// False if src is not a S2PNextObjectID or is cut short.
+        /// </summary>
+        public static bool TryDecode(ReadOnlySpan<byte> src, out S2PNextObjectID m)
+        {
+            var r = new WireReader(src);
+            if (!r.Read(out byte code) || code != (byte)Code)
+            {
+                m = default;
+                return false;
+            }
+            return Read(ref r, out m);
+        }
+    }
+
+    /// <summary>
+    /// Code 200, UberMundoEventCode.S2PAnnouncementMsg.
+    /// </summary>
+    public struct S2PAnnouncementMsg
+    {
+        public const UberMundoEventCode Code = UberMundoEventCode.S2PAnnouncementMsg;
+
+        public string Message;
+
+        public void Write(ref WireWriter w)
+        {
+            w.WriteString(Message);
+        }
+
+        public static bool Read(ref WireReader r, out S2PAnnouncementMsg m)
+        {
+            m = default;
+            if (!r.ReadString(out m.Message))
+                return false;
+            return true;
+        }
+
+        /// <summary>
+        /// Bytes Encode needs, the code included.
+        /// </summary>
+        public int Size
+        {
+            get
+            {
+                var w = WireWriter.Counting();
+                w.Write((byte)Code);
+                Write(ref w);
+                return w.Length;
+            }
+        }
+
+        /// <summary>
+        /// Writes the code and the fields into dst. Returns the bytes written, 0 if they did not fit.
+        /// </summary>
+        public int Encode(Span<byte> dst)
+        {
+            var w = new WireWriter(dst);
+            w.Write((byte)Code);
+            Write(ref w);
+            return w.Ok ? w.Length : 0;
+        }
+
+        public byte[] ToArray()
+        {
+            byte[] a = new byte[Size];
+            return Encode(a) == a.Length ? a : null;
+        }
+
+        /// <summary>
+        /// False if src is not a S2PAnnouncementMsg or is cut short.
+        /// </summary>
+        public static bool TryDecode(ReadOnlySpan<byte> src, out S2PAnnouncementMsg m)
+        {
+            var r = new WireReader(src);
+            if (!r.Read(out byte code) || code != (byte)Code)
+            {
+                m = default;
+                return false;
+            }
+            return Read(ref r, out m);
+        }
+    }
+}
@@ -0,0 +1,355 @@
+﻿using System;
+using System.Buffers.Binary;
+using System.Text;
+
+namespace UberMundo
+{
+    /// <summary>
+    /// How a list or byte array count is written. LowEntry is the positive integer 1 of LowEntryByteWriter.AddPositiveInteger1.
+    /// </summary>
+    public enum WireCount
+    {
+        LowEntry,
+        U8,
+        U16,
+        U32,
+        I32,
+    }
+
+    /// <summary>
+    /// Writes the generated messages (UberMundoMessages.cs) into a span without allocating.
+    /// Big Endian, with LowEntry counts, strings and byte arrays, the same bytes as LowEntryByteWriter
+    /// and the client's FUbermundoWireWriter.
+    /// One made with Counting() writes nothing and only counts, which is how a message finds its size.
+    /// </summary>
+    public ref struct WireWriter
+    {
+        private readonly Span<byte> buf;
+        private readonly bool counting;
+
+        /// <summary>
+        /// Bytes written, or that would have been.
+        /// </summary>
+        public int Length { get; private set; }
+        /// <summary>
+        /// Everything fitted.
+        /// </summary>
+        public bool Ok { get; private set; }
+
+        public WireWriter(Span<byte> buf)
+        {
+            this.buf = buf;
+            counting = false;
+            Length = 0;
+            Ok = true;
+        }
+
+        private WireWriter(bool counting)
+        {
+            buf = Span<byte>.Empty;
+            this.counting = counting;
+            Length = 0;
+            Ok = true;
+        }
+
+        public static WireWriter Counting()
+        {
+            return new WireWriter(true);
+        }
+
+        private bool Take(int n, out Span<byte> s)
+        {
+            int from = Length;
+            Length += n;
+            s = Span<byte>.Empty;
+            if (counting)
+                return false;
+            if (Length > buf.Length)
+            {
+                Ok = false;
+                return false;
+            }
+            s = buf.Slice(from, n);
+            return true;
+        }
+
+        public void Write(byte v)
+        {
+            if (Take(1, out Span<byte> s))
+                s[0] = v;
+        }
+
+        public void Write(ushort v)
+        {
+            if (Take(2, out Span<byte> s))
+                BinaryPrimitives.WriteUInt16BigEndian(s, v);
+        }
+
+        public void Write(short v)
+        {
+            if (Take(2, out Span<byte> s))
+                BinaryPrimitives.WriteInt16BigEndian(s, v);
+        }
+
+        public void Write(uint v)
+        {
+            if (Take(4, out Span<byte> s))
+                BinaryPrimitives.WriteUInt32BigEndian(s, v);
+        }
+
+        public void Write(int v)
+        {
+            if (Take(4, out Span<byte> s))
+                BinaryPrimitives.WriteInt32BigEndian(s, v);
+        }
+
+        public void Write(ulong v)
+        {
+            if (Take(8, out Span<byte> s))
+                BinaryPrimitives.WriteUInt64BigEndian(s, v);
+        }
+
+        public void Write(long v)
+        {
+            if (Take(8, out Span<byte> s))
+                BinaryPrimitives.WriteInt64BigEndian(s, v);
+        }
+
+        public void Write(float v)
+        {
+            Write(BitConverter.SingleToInt32Bits(v));
+        }
+
+        /// <summary>
+        /// A count the kind can not hold is written as 0 and fails the write.
+        /// </summary>
+        public void WriteCount(int n, WireCount kind)
+        {
+            long max = kind == WireCount.U8 ? byte.MaxValue : kind == WireCount.U16 ? ushort.MaxValue : int.MaxValue;
+            if (n < 0 || n > max)
+            {
+                Ok = false;
+                n = 0;
+            }
+            switch (kind)
+            {
+                case WireCount.LowEntry:
+                    if (n < 128)
+                        Write((byte)n);
+                    else
+                        Write((uint)n | 0x80000000u);
+                    break;
+                case WireCount.U8:
+                    Write((byte)n);
+                    break;
+                case WireCount.U16:
+                    Write((ushort)n);
+                    break;
+                default:
+                    Write(n);
+                    break;
+            }
+        }
+
+        public void WriteRaw(ReadOnlySpan<byte> bytes)
+        {
+            if (Take(bytes.Length, out Span<byte> s))
+                bytes.CopyTo(s);
+        }
+
+        /// <summary>
+        /// Exactly n bytes, which bytes must have.
+        /// </summary>
+        public void WriteFixed(ReadOnlySpan<byte> bytes, int n)
+        {
+            if (bytes.Length != n)
+                Ok = false;
+            if (Take(n, out Span<byte> s))
+                bytes.Slice(0, Math.Min(n, bytes.Length)).CopyTo(s);
+        }
+
+        /// <summary>
+        /// LowEntry byte array. null is written as empty.
+        /// </summary>
+        public void WriteSized(ReadOnlySpan<byte> bytes)
+        {
+            WriteCount(bytes.Length, WireCount.LowEntry);
+            WriteRaw(bytes);
+        }
+
+        /// <summary>
+        /// LowEntry UTF8 string. null is written as empty.
+        /// </summary>
+        public void WriteString(string v)
+        {
+            v ??= "";
+            int n = Encoding.UTF8.GetByteCount(v);
+            WriteCount(n, WireCount.LowEntry);
+            if (Take(n, out Span<byte> s))
+                Encoding.UTF8.GetBytes(v, s);
+        }
+
+        /// <summary>
+        /// LowEntry byte array holding a Big Endian 64 bit Steam id.
+        /// </summary>
+        public void WriteSteamId(ulong id)
+        {
+            WriteCount(8, WireCount.LowEntry);
+            Write(id);
+        }
+    }
+
+    /// <summary>
+    /// Reads the generated messages from a span. Every Read is false if the span is too short.
+    /// </summary>
+    public ref struct WireReader
+    {
+        private readonly ReadOnlySpan<byte> buf;
+        private int at;
+
+        public WireReader(ReadOnlySpan<byte> buf)
+        {
+            this.buf = buf;
+            at = 0;
+        }
+
+        public int Remaining => buf.Length - at;
+
+        private bool Take(int n, out ReadOnlySpan<byte> s)
+        {
+            if (n < 0 || n > Remaining)
+            {
+                s = ReadOnlySpan<byte>.Empty;
+                return false;
+            }
+            s = buf.Slice(at, n);
+            at += n;
+            return true;
+        }
+
+        public bool Read(out byte v)
+        {
+            bool ok = Take(1, out ReadOnlySpan<byte> s);
+            v = ok ? s[0] : (byte)0;
+            return ok;
+        }
+
+        public bool Read(out ushort v)
+        {
+            bool ok = Take(2, out ReadOnlySpan<byte> s);
+            v = ok ? BinaryPrimitives.ReadUInt16BigEndian(s) : (ushort)0;
+            return ok;
+        }
+
+        public bool Read(out short v)
+        {
+            bool ok = Take(2, out ReadOnlySpan<byte> s);
+            v = ok ? BinaryPrimitives.ReadInt16BigEndian(s) : (short)0;
+            return ok;
+        }
+
+        public bool Read(out uint v)
+        {
+            bool ok = Take(4, out ReadOnlySpan<byte> s);
+            v = ok ? BinaryPrimitives.ReadUInt32BigEndian(s) : 0;
+            return ok;
+        }
+
+        public bool Read(out int v)
+        {
+            bool ok = Take(4, out ReadOnlySpan<byte> s);
+            v = ok ? BinaryPrimitives.ReadInt32BigEndian(s) : 0;
+            return ok;
+        }
+
+        public bool Read(out ulong v)
+        {
+            bool ok = Take(8, out ReadOnlySpan<byte> s);
+            v = ok ? BinaryPrimitives.ReadUInt64BigEndian(s) : 0;
+            return ok;
+        }
+
+        public bool Read(out long v)
+        {
+            bool ok = Take(8, out ReadOnlySpan<byte> s);
+            v = ok ? BinaryPrimitives.ReadInt64BigEndian(s) : 0;
+            return ok;
+        }
+
+        public bool Read(out float v)
+        {
+            bool ok = Read(out int bits);
+            v = BitConverter.Int32BitsToSingle(bits);
+            return ok;
+        }
+
+        public bool ReadCount(out int n, WireCount kind)
+        {
+            n = 0;
+            switch (kind)
+            {
+                case WireCount.LowEntry:
+                    if (!Read(out byte b))
+                        return false;
+                    if ((b & 0x80) == 0)
+                    {
+                        n = b;
+                        return true;
+                    }
+                    if (!Take(3, out ReadOnlySpan<byte> s))
+                        return false;
+                    n = ((b & 0x7F) << 24) | (s[0] << 16) | (s[1] << 8) | s[2];
+                    return true;
+                case WireCount.U8:
+                    {
+                        bool ok = Read(out byte v);
+                        n = v;
+                        return ok;
+                    }
+                case WireCount.U16:
+                    {
+                        bool ok = Read(out ushort v);
+                        n = v;
+                        return ok;
+                    }
+                case WireCount.U32:
+                    {
+                        if (!Read(out uint v) || v > int.MaxValue)
+                            return false;
+                        n = (int)v;
+                        return true;
+                    }
+                default:
+                    return Read(out n) && n >= 0;
+            }
+        }
+
+        public bool ReadBytes(int n, out byte[] v)
+        {
+            bool ok = Take(n, out ReadOnlySpan<byte> s);
+            v = ok ? s.ToArray() : null;
+            return ok;
+        }
+
+        public bool ReadSized(out byte[] v)
+        {
+            v = null;
+            return ReadCount(out int n, WireCount.LowEntry) && ReadBytes(n, out v);
+        }
+
+        public bool ReadString(out string v)
+        {
+            v = null;
+            if (!ReadCount(out int n, WireCount.LowEntry) || !Take(n, out ReadOnlySpan<byte> s))
+                return false;
+            v = Encoding.UTF8.GetString(s);
+            return true;
+        }
+
+        public bool ReadSteamId(out ulong id)
+        {
+            id = 0;
+            return ReadCount(out int n, WireCount.LowEntry) && n == 8 && Read(out id);
+        }
+    }
+}
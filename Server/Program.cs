@@ -7,6 +7,11 @@ namespace UberMundo
         static void Main(string[] args)
         {
             Console.WriteLine("Ubermundo Server 0.0.1");
+            if (args.Length > 0 && args[0] == "--benchmark-messages")
+            {
+                UberMundoMessageBenchmark.Run(args.Length > 1 ? int.Parse(args[1]) : 100000);
+                return;
+            }
             UberMundoTCPListener s = new UberMundoTCPListener(args);
             s.Run();
         }
@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+# Copyright 2020 Bahnda. All rights reserved.
+#
+# Decode a packet trace written by SaveNetTrace (UbermundoNetTrace.h) into readable lines or CSV.
+# Records from every thread are merged into one list in time order.
+#
+#   python3 decode_net_trace.py trace.umnt
+#   python3 decode_net_trace.py trace.umnt --csv > trace.csv
+#   python3 decode_net_trace.py trace.umnt --peer 0x110000100000001 --event Send --event Read
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+# Same as EUbermundoTraceEvent.
+EVENTS = {1: "Send", 2: "Read", 3: "Tick", 4: "Close", 5: "ThreadSend", 6: "ThreadRead", 7: "Drop", 8: "LocalId"}
+
+RECORD = struct.Struct("<QQIBBBB")
+
+CODES_HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "Client", "ShareClientPC", "Plugins",
+                            "UbermundoProtoPlugin", "Source", "UbermundoProtoPlugin", "Public", "UbermundoPacketCodes.h")
+
+
+def load_code_names(path):
+    """Packet code names from UbermundoPacketCodes.h, so the decoder never falls behind it."""
+    names = {}
+    try:
+        with open(path, encoding="utf-8", errors="replace") as f:
+            for m in re.finditer(r"UBERMUNDOPC_(\w+)\s*=\s*(\d+)", f.read()):
+                names.setdefault(int(m.group(2)), m.group(1))
+    except OSError:
+        pass
+    return names
+
+
+def read_trace(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != b"UMNT":
+        raise ValueError("%s is not a net trace" % path)
+    version, record_size, seconds_per_cycle, start_cycles, num_threads = struct.unpack_from("<HHdQI", data, 4)
+    if version != 1 or record_size != RECORD.size:
+        raise ValueError("%s is trace version %d with %d byte records, this decoder reads version 1" % (path, version, record_size))
+    at = 4 + struct.calcsize("<HHdQI")
+    threads = []
+    records = []
+    for t in range(num_threads):
+        thread_id, name_len = struct.unpack_from("<IH", data, at)
+        at += 6
+        name = data[at:at + name_len].decode("utf-8", errors="replace") or str(thread_id)
+        at += name_len
+        (count,) = struct.unpack_from("<I", data, at)
+        at += 4
+        threads.append((thread_id, name, count))
+        for i in range(count):
+            cycles, peer, size, event, code, result, _ = RECORD.unpack_from(data, at)
+            at += RECORD.size
+            records.append((cycles, name, event, peer, code, size, result))
+    records.sort(key=lambda r: r[0])
+    return seconds_per_cycle, start_cycles, threads, records
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode an Ubermundo packet trace.")
+    parser.add_argument("trace")
+    parser.add_argument("--csv", action="store_true", help="CSV with a header line instead of aligned text")
+    parser.add_argument("--peer", help="only this peer, decimal or 0x hex")
+    parser.add_argument("--event", action="append", help="only these events, may be given more than once")
+    parser.add_argument("--codes", default=CODES_HEADER, help="UbermundoPacketCodes.h to name packet codes from")
+    args = parser.parse_args()
+
+    seconds_per_cycle, start_cycles, threads, records = read_trace(args.trace)
+    names = load_code_names(args.codes)
+    peer = int(args.peer, 0) if args.peer else None
+    events = set(args.event) if args.event else None
+
+    out = sys.stdout
+    if args.csv:
+        out.write("ms,thread,event,peer,code,code_name,size,result\n")
+    else:
+        for thread_id, name, count in threads:
+            out.write("# thread %s (%d): %d records\n" % (name, thread_id, count))
+    for cycles, thread, event, p, code, size, result in records:
+        event_name = EVENTS.get(event, str(event))
+        if peer is not None and p != peer:
+            continue
+        if events is not None and event_name not in events:
+            continue
+        ms = (cycles - start_cycles) * seconds_per_cycle * 1000.0
+        code_name = names.get(code, "") if size > 0 else ""
+        if args.csv:
+            out.write("%.3f,%s,%s,0x%X,%d,%s,%d,%d\n" % (ms, thread, event_name, p, code, code_name, size, result))
+        else:
+            out.write("%12.3f ms  %-16s %-10s 0x%016X  %3d %-28s %6d  %s\n" % (
+                ms, thread, event_name, p, code, code_name, size, "ok" if result else "FAIL"))
+
+
+if __name__ == "__main__":
+    main()
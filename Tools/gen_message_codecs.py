@@ -0,0 +1,849 @@
+#!/usr/bin/env python3
+# Copyright 2020 Bahnda. All rights reserved.
+#
+# Generate the packet codecs from ubermundo_messages.schema: native and Blueprint C++ for the plugin,
+# C# for the server. Checks the schema's codes against EUbermundoPacketCodes and UberMundoEventCode
+# first, and that every code in them has a layout, so the three can not drift apart.
+#
+#   python3 gen_message_codecs.py            write the generated files
+#   python3 gen_message_codecs.py --check    only say whether they are up to date, exit 1 if not
+
+import argparse
+import os
+import re
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.join(HERE, "..")
+PLUGIN = os.path.join(ROOT, "Client", "ShareClientPC", "Plugins", "UbermundoProtoPlugin", "Source", "UbermundoProtoPlugin")
+
+SCHEMA = os.path.join(HERE, "ubermundo_messages.schema")
+CODES_HEADER = os.path.join(PLUGIN, "Public", "UbermundoPacketCodes.h")
+SERVER_CODES = os.path.join(ROOT, "Server", "UberMundoEventCode.cs")
+OUT_H = os.path.join(PLUGIN, "Public", "UbermundoMessages.h")
+OUT_CPP = os.path.join(PLUGIN, "Private", "UbermundoMessages.cpp")
+OUT_CS = os.path.join(ROOT, "Server", "MessageStructures", "UberMundoMessages.cs")
+
+# Schema type: (native C++, Blueprint C++, C#)
+SCALARS = {
+    "u8": ("uint8", "uint8", "byte"),
+    "u16": ("uint16", "int32", "ushort"),
+    "u32": ("uint32", "int64", "uint"),
+    "u64": ("uint64", "int64", "ulong"),
+    "i16": ("int16", "int32", "short"),
+    "i32": ("int32", "int32", "int"),
+    "i64": ("int64", "int64", "long"),
+    "f32": ("float", "float", "float"),
+}
+SIZES = {"u8": 1, "u16": 2, "u32": 4, "u64": 8, "i16": 2, "i32": 4, "i64": 8, "f32": 4}
+COUNTS = {"uint": "LowEntry", "u8": "U8", "u16": "U16", "u32": "U32", "i32": "I32"}
+# Taken by the methods of a generated message, in C++ or C#.
+RESERVED = {"Code", "Size", "Encode", "Decode", "TryDecode", "ToArray", "ToPacket", "Write", "Read"}
+GENERATED_NOTE = "Generated by Tools/gen_message_codecs.py from Tools/ubermundo_messages.schema. Do not edit, change the schema and run it again."
+
+
+class SchemaError(Exception):
+    pass
+
+
+class Field:
+    def __init__(self, kind, name, doc, line):
+        self.name = name
+        self.doc = doc
+        self.line = line
+        self.count = None  # list or sized bytes count type, "" to the end of the packet
+        self.size = 0  # rawN
+        m = re.fullmatch(r"(\w+)\[(\w*)\]", kind)
+        if m:
+            self.elem = m.group(1)
+            self.count = m.group(2)
+            self.kind = "bytes" if self.elem == "bytes" else "list"
+            if self.count and self.count not in COUNTS:
+                raise SchemaError("line %d: %s can not be a count" % (line, self.count))
+            if self.kind == "bytes" and not self.count:
+                raise SchemaError("line %d: bytes[] is rest" % line)
+            return
+        m = re.fullmatch(r"raw(\d+)", kind)
+        if m:
+            self.kind = "raw"
+            self.size = int(m.group(1))
+            return
+        if kind == "bytes":
+            self.kind = "bytes"
+            self.count = "uint"
+            return
+        self.kind = kind  # scalar, uint, steamid, string, rest, or a struct name, checked later
+
+
+class Struct:
+    def __init__(self, name, doc, line, code=None, channel=None):
+        self.name = name
+        self.doc = doc
+        self.line = line
+        self.code = code
+        self.channel = channel
+        self.fields = []
+
+    @property
+    def is_message(self):
+        return self.code is not None
+
+
+def parse_schema(path):
+    structs = []
+    doc = []
+    current = None
+    with open(path, encoding="utf-8") as f:
+        lines = f.read().splitlines()
+    for n, raw in enumerate(lines, 1):
+        text = raw.strip()
+        if not text:
+            doc = []
+            continue
+        if text.startswith("#"):
+            doc.append(text[1:].strip())
+            continue
+        if not raw[0].isspace():
+            m = re.fullmatch(r"message\s+(\w+)\s*=\s*(\d+)\s+(p2p|server)", text)
+            if m:
+                current = Struct(m.group(1), doc, n, int(m.group(2)), m.group(3))
+            else:
+                m = re.fullmatch(r"struct\s+(\w+)", text)
+                if not m:
+                    raise SchemaError("line %d: expected message or struct: %s" % (n, text))
+                current = Struct(m.group(1), doc, n)
+            structs.append(current)
+        else:
+            m = re.fullmatch(r"(\S+)\s+(\w+)", text)
+            if current is None or not m:
+                raise SchemaError("line %d: expected a field: %s" % (n, text))
+            current.fields.append(Field(m.group(1), m.group(2), doc, n))
+        doc = []
+    return structs
+
+
+def check_schema(structs):
+    names = set()
+    known = {}
+    for s in structs:
+        if s.name in names:
+            raise SchemaError("line %d: %s is already defined" % (s.line, s.name))
+        names.add(s.name)
+        seen = set()
+        for i, f in enumerate(s.fields):
+            if f.name in seen:
+                raise SchemaError("line %d: %s.%s twice" % (f.line, s.name, f.name))
+            if f.name in RESERVED:
+                raise SchemaError("line %d: %s is taken by the generated code, call the field something else" % (f.line, f.name))
+            seen.add(f.name)
+            last = i == len(s.fields) - 1
+            if f.kind in ("rest",) or (f.kind == "list" and not f.count):
+                if not last or not s.is_message:
+                    raise SchemaError("line %d: %s runs to the end of the packet, so it has to be a message's last field" % (f.line, f.name))
+            kinds = [f.elem] if f.kind == "list" else [f.kind]
+            for k in kinds:
+                if k in SCALARS or k in ("uint", "steamid", "string", "bytes", "raw", "rest"):
+                    if f.kind == "list" and k not in SCALARS:
+                        raise SchemaError("line %d: a list holds a struct or an integer type, not %s" % (f.line, k))
+                    continue
+                if k not in known:
+                    raise SchemaError("line %d: %s is not a type, or its struct comes later" % (f.line, k))
+                if known[k].is_message:
+                    raise SchemaError("line %d: %s is a message, not a struct" % (f.line, k))
+        known[s.name] = s
+    return known
+
+
+def min_size(kind, known):
+    """Fewest bytes a value of kind takes, so a list's count can be checked against what is left."""
+    if kind in SIZES:
+        return SIZES[kind]
+    if kind == "steamid":
+        return 9
+    if kind in known:
+        return sum(field_min_size(f, known) for f in known[kind].fields)
+    return 0
+
+
+def field_min_size(f, known):
+    if f.kind == "raw":
+        return f.size
+    if f.kind in ("bytes", "list"):
+        return SIZES.get(f.count, 1) if f.count else 0
+    if f.kind in ("uint", "string"):
+        return 1
+    return min_size(f.kind, known)
+
+
+def load_enum(path, pattern):
+    codes = {}
+    with open(path, encoding="utf-8-sig", errors="replace") as f:
+        text = f.read()
+    for m in re.finditer(pattern, text):
+        codes[m.group(1)] = int(m.group(2))
+    return codes
+
+
+def check_codes(structs, codes_header, server_codes):
+    # The DB codes in EUbermundoPacketCodes are not what the server speaks, UberMundoEventCode is.
+    p2p = {k[4:]: v for k, v in load_enum(codes_header, r"UBERMUNDOPC_(\w+)\s*=\s*(\d+)").items() if k.startswith("P2P_") and k != "P2P_START"}
+    server = load_enum(server_codes, r"(?m)^\s*(\w+)\s*=\s*(\d+)\s*,")
+    if not p2p or not server:
+        raise SchemaError("could not read the packet codes from %s and %s" % (codes_header, server_codes))
+    errors = []
+    for s in structs:
+        if not s.is_message:
+            continue
+        enum, where = (p2p, "EUbermundoPacketCodes") if s.channel == "p2p" else (server, "UberMundoEventCode")
+        if s.name not in enum:
+            errors.append("%s is not in %s" % (s.name, where))
+        elif enum[s.name] != s.code:
+            errors.append("%s is %d in %s but %d in the schema" % (s.name, enum[s.name], where, s.code))
+    for channel, enum, where in (("p2p", p2p, "EUbermundoPacketCodes"), ("server", server, "UberMundoEventCode")):
+        have = {s.name for s in structs if s.channel == channel}
+        for name in sorted(set(enum) - have):
+            errors.append("%s in %s has no layout in the schema" % (name, where))
+    if errors:
+        raise SchemaError("\n".join(errors))
+
+
+# ---------------------------------------------------------------------------------------- C++
+
+def wire_name(s):
+    return "FUbermundo%sWire" % s.name
+
+
+def msg_name(s):
+    return "FUbermundo%s%s" % (s.name, "" if s.name.endswith("Msg") else "Msg")
+
+
+def native_type(f, known):
+    if f.kind in SCALARS:
+        return SCALARS[f.kind][0]
+    if f.kind == "uint":
+        return "int32"
+    if f.kind == "steamid":
+        return "uint64"
+    if f.kind in ("string", "bytes", "raw", "rest"):
+        return "TArrayView<const uint8>"
+    if f.kind == "list":
+        return "TUbermundoWireList<%s>" % (SCALARS[f.elem][0] if f.elem in SCALARS else wire_name(known[f.elem]))
+    return wire_name(known[f.kind])
+
+
+def bp_type(f, known):
+    if f.kind in SCALARS:
+        return SCALARS[f.kind][1]
+    if f.kind == "uint":
+        return "int32"
+    if f.kind == "steamid":
+        return "int64"
+    if f.kind == "string":
+        return "FString"
+    if f.kind in ("bytes", "raw", "rest"):
+        return "TArray<uint8>"
+    if f.kind == "list":
+        return "TArray<%s>" % (SCALARS[f.elem][1] if f.elem in SCALARS else msg_name(known[f.elem]))
+    return msg_name(known[f.kind])
+
+
+def direction(s):
+    if s.channel == "p2p":
+        return "player to player"
+    return "player to server" if s.name.startswith("P2S") else "server to player"
+
+
+def zero(t):
+    return "0.0f" if t == "float" else "0"
+
+
+def is_number(t):
+    return t in ("uint8", "uint16", "uint32", "uint64", "int16", "int32", "int64", "float")
+
+
+def cpp_doc(doc, indent, extra=None):
+    lines = list(doc)
+    if extra:
+        lines.append(extra)
+    if not lines:
+        return []
+    if len(lines) == 1:
+        return ["%s/** %s */" % (indent, lines[0])]
+    return ["%s/**" % indent] + ["%s * %s" % (indent, l) for l in lines] + ["%s */" % indent]
+
+
+def field_note(f, native=False):
+    if f.kind == "string" and native:
+        return "UTF8."
+    if f.kind == "raw":
+        return "%d bytes." % f.size
+    return None
+
+
+def count_writer(count, expr):
+    if count == "uint":
+        return "w.WriteCount(%s);" % expr
+    return "w.WriteCountAs<%s>(%s);" % (SCALARS[count][0], expr)
+
+
+def count_reader(count, var):
+    if count == "uint":
+        return "r.ReadCount(%s)" % var
+    return "r.ReadCountAs<%s>(%s)" % (SCALARS[count][0], var)
+
+
+def cpp_native_write(f):
+    n = f.name
+    if f.kind in SCALARS:
+        return ["w.Write(%s);" % n]
+    if f.kind == "uint":
+        return ["w.WriteCount(%s);" % n]
+    if f.kind == "steamid":
+        return ["w.WriteSteamId(%s);" % n]
+    if f.kind == "string":
+        return ["w.WriteSized(%s);" % n]
+    if f.kind == "bytes":
+        if f.count == "uint":
+            return ["w.WriteSized(%s);" % n]
+        return [count_writer(f.count, "%s.Num()" % n), "w.WriteRaw(%s);" % n]
+    if f.kind == "raw":
+        return ["w.WriteFixed(%s, %d);" % (n, f.size)]
+    if f.kind == "rest":
+        return ["w.WriteRaw(%s);" % n]
+    if f.kind == "list":
+        out = [count_writer(f.count, "%s.Count()" % n)] if f.count else []
+        return out + ["%s.WriteItems(w);" % n]
+    return ["w.Write(%s);" % n]
+
+
+def cpp_native_read(f):
+    """Statements that return false on a short packet."""
+    n = f.name
+    if f.kind in SCALARS or f.kind not in ("uint", "steamid", "string", "bytes", "raw", "rest", "list"):
+        return ["r.Read(%s)" % n]
+    if f.kind == "uint":
+        return ["r.ReadCount(%s)" % n]
+    if f.kind == "steamid":
+        return ["r.ReadSteamId(%s)" % n]
+    if f.kind == "string":
+        return ["r.ReadSized(%s)" % n]
+    if f.kind == "bytes":
+        if f.count == "uint":
+            return ["r.ReadSized(%s)" % n]
+        return [count_reader(f.count, "n"), "r.ReadRaw(n, %s)" % n]
+    if f.kind == "raw":
+        return ["r.ReadRaw(%d, %s)" % (f.size, n)]
+    if f.kind == "rest":
+        return ["r.ReadRest(%s)" % n]
+    if f.count:
+        return [count_reader(f.count, "n"), "%s.ReadItems(r, n)" % n]
+    return ["%s.ReadItems(r, -1)" % n]
+
+
+def cpp_bp_write_value(kind, known, expr):
+    if kind in SCALARS:
+        t = SCALARS[kind][0]
+        return "w.Write(%s);" % (expr if SCALARS[kind][1] == t else "(%s)%s" % (t, expr))
+    return "WriteMsg(w, %s);" % expr
+
+
+def cpp_bp_read_value(kind, known, expr):
+    if kind in SCALARS:
+        return "ReadAs<%s>(r, %s)" % (SCALARS[kind][0], expr)
+    return "ReadMsg(r, %s)" % expr
+
+
+def cpp_bp_write(f, known):
+    n = "m." + f.name
+    if f.kind in SCALARS:
+        return [cpp_bp_write_value(f.kind, known, n)]
+    if f.kind == "uint":
+        return ["w.WriteCount(%s);" % n]
+    if f.kind == "steamid":
+        return ["w.WriteSteamId((uint64)%s);" % n]
+    if f.kind == "string":
+        return ["w.WriteString(%s);" % n]
+    if f.kind == "bytes":
+        if f.count == "uint":
+            return ["w.WriteSized(%s);" % n]
+        return [count_writer(f.count, "%s.Num()" % n), "w.WriteRaw(%s);" % n]
+    if f.kind == "raw":
+        return ["w.WriteFixed(%s, %d);" % (n, f.size)]
+    if f.kind == "rest":
+        return ["w.WriteRaw(%s);" % n]
+    if f.kind == "list":
+        out = [count_writer(f.count, "%s.Num()" % n)] if f.count else []
+        item = "%s v" % SCALARS[f.elem][1] if f.elem in SCALARS else "const %s& v" % msg_name(known[f.elem])
+        return out + ["for (%s : %s)" % (item, n), "\t" + cpp_bp_write_value(f.elem, known, "v")]
+    return ["WriteMsg(w, %s);" % n]
+
+
+def cpp_bp_read(f, known):
+    """Statement blocks, each a list of lines, that return false on a short packet."""
+    n = "m." + f.name
+
+    def check(expr):
+        return ["if (!%s)" % expr, "\treturn false;"]
+
+    if f.kind in SCALARS:
+        return check(cpp_bp_read_value(f.kind, known, n))
+    if f.kind == "uint":
+        return check("r.ReadCount(%s)" % n)
+    if f.kind == "steamid":
+        return check("ReadSteamIdAs(r, %s)" % n)
+    if f.kind == "string":
+        return check("r.ReadString(%s)" % n)
+    if f.kind == "bytes":
+        if f.count == "uint":
+            return ["{", "\tint32 n;"] + ["\t" + l for l in check("r.ReadCount(n) || !r.ReadBytes(n, %s)" % n)] + ["}"]
+        return ["{", "\tint32 n;"] + ["\t" + l for l in check("%s || !r.ReadBytes(n, %s)" % (count_reader(f.count, "n"), n))] + ["}"]
+    if f.kind == "raw":
+        return check("r.ReadBytes(%d, %s)" % (f.size, n))
+    if f.kind == "rest":
+        return check("r.ReadBytes(r.Remaining(), %s)" % n)
+    if f.kind == "list":
+        read = cpp_bp_read_value(f.elem, known, "%s.AddDefaulted_GetRef()" % n)
+        if f.count:
+            return (["{", "\tint32 n;"] + ["\t" + l for l in check(count_reader(f.count, "n"))]
+                    + ["\t%s.Reset();" % n,
+                       "\t// A bad count must not reserve gigabytes.",
+                       "\t%s.Reserve(FMath::Min(n, r.Remaining() / %d));" % (n, max(1, min_size(f.elem, known))),
+                       "\tfor (int32 i = 0; i < n; i++) {"]
+                    + ["\t\t" + l for l in check(read)] + ["\t}", "}"])
+        return (["%s.Reset();" % n, "while (r.Remaining() > 0) {"] + ["\t" + l for l in check(read)] + ["}"])
+    return check("ReadMsg(r, %s)" % n)
+
+
+def gen_header(structs, known):
+    out = []
+    w = out.append
+    w("// Copyright 2020 Bahnda. All rights reserved.")
+    w("")
+    w("// " + GENERATED_NOTE)
+    w("// The codec of every packet. For each message there are two structs:")
+    w("//   FUbermundo<Name>Wire  native. Encode and Decode allocate nothing: strings, byte arrays and lists of")
+    w("//                         a decoded message point into the packet, which has to outlive it.")
+    w("//   FUbermundo<Name>Msg   for Blueprints, with Encode<Name> and Decode<Name> in UUbermundoMessageLibrary.")
+    w("// Server messages have UberMundoEventCode's codes, which are not EUbermundoPacketCodes' DB codes.")
+    w("// UUbermundoNetBenchmarks::BenchmarkMessageCodecs measures both against FUbermundoPacketBuilder.")
+    w("")
+    w("#pragma once")
+    w("")
+    w('#include "CoreMinimal.h"')
+    w('#include "Kismet/BlueprintFunctionLibrary.h"')
+    w('#include "UbermundoWire.h"')
+    w('#include "UbermundoMessages.generated.h"')
+    for s in structs:
+        w("")
+        if s.is_message:
+            extra = "Code %d, %s." % (s.code, direction(s))
+            out.extend(cpp_doc(s.doc, "", extra))
+            w("struct UBERMUNDOPROTOPLUGIN_API %s : public TUbermundoWireMessage<%s, %d> {" % (wire_name(s), wire_name(s), s.code))
+        else:
+            out.extend(cpp_doc(s.doc, ""))
+            w("struct UBERMUNDOPROTOPLUGIN_API %s {" % wire_name(s))
+        for f in s.fields:
+            out.extend(cpp_doc(f.doc, "\t", field_note(f, True)))
+            t = native_type(f, known)
+            w("\t%s %s%s;" % (t, f.name, " = " + zero(t) if is_number(t) else ""))
+        if s.fields:
+            w("")
+        w("\tvoid Write(FUbermundoWireWriter& w) const;")
+        w("\tbool Read(FUbermundoWireReader& r);")
+        w("};")
+    for s in structs:
+        w("")
+        out.extend(cpp_doc(s.doc, ""))
+        w("USTRUCT(BlueprintType)")
+        w("struct %s" % msg_name(s))
+        w("{")
+        w("\tGENERATED_USTRUCT_BODY()")
+        inits = ["%s(%s)" % (f.name, zero(bp_type(f, known))) for f in s.fields if is_number(bp_type(f, known))]
+        if inits:
+            w("")
+            w("\t%s() : %s {}" % (msg_name(s), ", ".join(inits)))
+        for f in s.fields:
+            w("")
+            out.extend(cpp_doc(f.doc, "\t", field_note(f)))
+            w("\tUPROPERTY(EditAnywhere, BlueprintReadWrite)")
+            w("\t\t%s %s;" % (bp_type(f, known), f.name))
+        w("};")
+    w("")
+    w("/**")
+    w(" * Blueprint access to the message codecs. Encoded messages include their code.")
+    w(" */")
+    w("UCLASS()")
+    w("class UBERMUNDOPROTOPLUGIN_API UUbermundoMessageLibrary : public UBlueprintFunctionLibrary")
+    w("{")
+    w("\tGENERATED_BODY()")
+    w("")
+    w("public:")
+    for s in structs:
+        if not s.is_message:
+            continue
+        cat = "ShareSteam|Messages|%s" % ("P2P" if s.channel == "p2p" else "Server")
+        w('\tUFUNCTION(BlueprintCallable, BlueprintPure, Category = "%s")' % cat)
+        w("\t\tstatic TArray<uint8> Encode%s(const %s& message);" % (s.name, msg_name(s)))
+        w('\tUFUNCTION(BlueprintCallable, Category = "%s", meta = (ToolTip = "False if it is not a %s or is cut short."))' % (cat, s.name))
+        w("\t\tstatic bool Decode%s(const TArray<uint8>& message, %s& decoded);" % (s.name, msg_name(s)))
+    w("};")
+    return out
+
+
+def gen_cpp(structs, known):
+    out = []
+    w = out.append
+    w("// Copyright 2020 Bahnda. All rights reserved.")
+    w("// " + GENERATED_NOTE)
+    w("")
+    w("")
+    w('#include "UbermundoMessages.h"')
+    w('#include "SteamCustomCode.h"')
+    w("")
+    w("template<typename TWire, typename TField>")
+    w("static bool ReadAs(FUbermundoWireReader& r, TField& out) {")
+    w("\tTWire v;")
+    w("\tif (!r.Read(v))")
+    w("\t\treturn false;")
+    w("\tout = (TField)v;")
+    w("\treturn true;")
+    w("}")
+    w("")
+    w("static bool ReadSteamIdAs(FUbermundoWireReader& r, int64& out) {")
+    w("\tuint64 v;")
+    w("\tif (!r.ReadSteamId(v))")
+    w("\t\treturn false;")
+    w("\tout = (int64)v;")
+    w("\treturn true;")
+    w("}")
+    for s in structs:
+        w("")
+        w("// --------------------------------------------------------------------------------- %s" % s.name)
+        w("void %s::Write(FUbermundoWireWriter& w) const {" % wire_name(s))
+        for f in s.fields:
+            for l in cpp_native_write(f):
+                w("\t" + l)
+        w("}")
+        w("")
+        w("bool %s::Read(FUbermundoWireReader& r) {" % wire_name(s))
+        reads = [e for f in s.fields for e in cpp_native_read(f)]
+        if any(f.count and f.kind in ("list", "bytes") and not (f.kind == "bytes" and f.count == "uint") for f in s.fields):
+            w("\tint32 n;")
+        if not reads:
+            w("\treturn true;")
+        else:
+            w("\treturn " + reads[0] + ("" if len(reads) > 1 else ";"))
+            for i, e in enumerate(reads[1:], 1):
+                w("\t\t&& " + e + (";" if i == len(reads) - 1 else ""))
+        w("}")
+        w("")
+        param = "& m" if s.fields else "&"
+        w("static void WriteMsg(FUbermundoWireWriter& w, const %s%s) {" % (msg_name(s), param))
+        for f in s.fields:
+            for l in cpp_bp_write(f, known):
+                w("\t" + l)
+        w("}")
+        w("")
+        w("static bool ReadMsg(FUbermundoWireReader& r, %s%s) {" % (msg_name(s), param))
+        for f in s.fields:
+            for l in cpp_bp_read(f, known):
+                w("\t" + l)
+        w("\treturn true;")
+        w("}")
+    w("")
+    w("// --------------------------------------------------------------------------------- UUbermundoMessageLibrary")
+    w("template<typename TMsg>")
+    w("static TArray<uint8> EncodeMsg(uint8 code, const TMsg& m) {")
+    w("\tFUbermundoWireWriter size(nullptr, 0);")
+    w("\tsize.Write(code);")
+    w("\tWriteMsg(size, m);")
+    w("\tTArray<uint8> out;")
+    w("\tout.SetNumUninitialized(size.Num());")
+    w("\tFUbermundoWireWriter w(out.GetData(), out.Num());")
+    w("\tw.Write(code);")
+    w("\tWriteMsg(w, m);")
+    w("\tif (!w.IsOk()) {")
+    w('\t\tUE_LOG(UberMundoSteamLog, Warning, TEXT("Message %d not encoded, a count or fixed size field is out of range"), code);')
+    w("\t\tout.Reset();")
+    w("\t}")
+    w("\treturn out;")
+    w("}")
+    w("")
+    w("template<typename TMsg>")
+    w("static bool DecodeMsg(uint8 code, const TArray<uint8>& message, TMsg& out) {")
+    w("\tout = TMsg();")
+    w("\tFUbermundoWireReader r(message.GetData(), message.Num());")
+    w("\tuint8 c;")
+    w("\treturn r.Read(c) && c == code && ReadMsg(r, out);")
+    w("}")
+    for s in structs:
+        if not s.is_message:
+            continue
+        w("")
+        w("TArray<uint8> UUbermundoMessageLibrary::Encode%s(const %s& message) {" % (s.name, msg_name(s)))
+        w("\treturn EncodeMsg(%s::Code, message);" % wire_name(s))
+        w("}")
+        w("")
+        w("bool UUbermundoMessageLibrary::Decode%s(const TArray<uint8>& message, %s& decoded) {" % (s.name, msg_name(s)))
+        w("\treturn DecodeMsg(%s::Code, message, decoded);" % wire_name(s))
+        w("}")
+    return out
+
+
+# ---------------------------------------------------------------------------------------- C#
+
+def cs_type(f, known):
+    if f.kind in SCALARS:
+        return SCALARS[f.kind][2]
+    if f.kind == "uint":
+        return "int"
+    if f.kind == "steamid":
+        return "ulong"
+    if f.kind == "string":
+        return "string"
+    if f.kind in ("bytes", "raw", "rest"):
+        return "byte[]"
+    if f.kind == "list":
+        return "%s[]" % (SCALARS[f.elem][2] if f.elem in SCALARS else f.elem)
+    return f.kind
+
+
+def cs_doc(doc, indent, extra=None):
+    lines = list(doc)
+    if extra:
+        lines.append(extra)
+    if not lines:
+        return []
+    return ["%s/// <summary>" % indent] + ["%s/// %s" % (indent, l) for l in lines] + ["%s/// </summary>" % indent]
+
+
+def cs_write_value(kind, expr):
+    if kind in SCALARS:
+        return "w.Write(%s);" % expr
+    return "%s.Write(ref w);" % expr
+
+
+def cs_write(f):
+    n = f.name
+    if f.kind in SCALARS:
+        return [cs_write_value(f.kind, n)]
+    if f.kind == "uint":
+        return ["w.WriteCount(%s, WireCount.LowEntry);" % n]
+    if f.kind == "steamid":
+        return ["w.WriteSteamId(%s);" % n]
+    if f.kind == "string":
+        return ["w.WriteString(%s);" % n]
+    if f.kind == "bytes":
+        if f.count == "uint":
+            return ["w.WriteSized(%s);" % n]
+        return ["w.WriteCount(%s?.Length ?? 0, WireCount.%s);" % (n, COUNTS[f.count]), "w.WriteRaw(%s);" % n]
+    if f.kind == "raw":
+        return ["w.WriteFixed(%s, %d);" % (n, f.size)]
+    if f.kind == "rest":
+        return ["w.WriteRaw(%s);" % n]
+    if f.kind == "list":
+        out = ["w.WriteCount(%s?.Length ?? 0, WireCount.%s);" % (n, COUNTS[f.count])] if f.count else []
+        return out + ["if (%s != null)" % n, "{", "    foreach (var v in %s)" % n, "        " + cs_write_value(f.elem, "v"), "}"]
+    return ["%s.Write(ref w);" % n]
+
+
+def cs_read_value(kind, expr):
+    if kind in SCALARS:
+        return "r.Read(out %s)" % expr
+    return "%s.Read(ref r, out %s)" % (kind, expr)
+
+
+def cs_read(f, known):
+    n = "m." + f.name
+    num = "num" + f.name
+
+    def check(expr):
+        return ["if (!%s)" % expr, "    return false;"]
+
+    if f.kind in SCALARS:
+        return check(cs_read_value(f.kind, n))
+    if f.kind == "uint":
+        return check("r.ReadCount(out %s, WireCount.LowEntry)" % n)
+    if f.kind == "steamid":
+        return check("r.ReadSteamId(out %s)" % n)
+    if f.kind == "string":
+        return check("r.ReadString(out %s)" % n)
+    if f.kind == "bytes":
+        if f.count == "uint":
+            return check("r.ReadSized(out %s)" % n)
+        return check("r.ReadCount(out int %s, WireCount.%s) || !r.ReadBytes(%s, out %s)" % (num, COUNTS[f.count], num, n))
+    if f.kind == "raw":
+        return check("r.ReadBytes(%d, out %s)" % (f.size, n))
+    if f.kind == "rest":
+        return check("r.ReadBytes(r.Remaining, out %s)" % n)
+    if f.kind == "list":
+        elem = SCALARS[f.elem][2] if f.elem in SCALARS else f.elem
+        if f.count:
+            # A bad count must not allocate gigabytes.
+            return (check("r.ReadCount(out int %s, WireCount.%s) || %s > r.Remaining / %d" % (num, COUNTS[f.count], num, max(1, min_size(f.elem, known))))
+                    + ["%s = new %s[%s];" % (n, elem, num), "for (int i = 0; i < %s; i++)" % num, "{"]
+                    + ["    " + l for l in check(cs_read_value(f.elem, "%s[i]" % n))] + ["}"])
+        return (["var %s = new System.Collections.Generic.List<%s>();" % (f.name[0].lower() + f.name[1:], elem),
+                 "while (r.Remaining > 0)", "{"]
+                + ["    " + l for l in check(cs_read_value(f.elem, "%s v" % elem))]
+                + ["    %s.Add(v);" % (f.name[0].lower() + f.name[1:]), "}",
+                   "%s = %s.ToArray();" % (n, f.name[0].lower() + f.name[1:])])
+    return check("%s.Read(ref r, out %s)" % (f.kind, n))
+
+
+def gen_cs(structs, known):
+    used = set()
+
+    def use(name):
+        if name in used:
+            return
+        used.add(name)
+        for f in known[name].fields:
+            k = f.elem if f.kind == "list" else f.kind
+            if k in known:
+                use(k)
+
+    for s in structs:
+        if s.channel == "server":
+            use(s.name)
+    out = []
+    w = out.append
+    w("// <auto-generated>")
+    w("//     " + GENERATED_NOTE)
+    w("// </auto-generated>")
+    w("using System;")
+    w("")
+    w("namespace UberMundo")
+    w("{")
+    first = True
+    for s in structs:
+        if s.name not in used:
+            continue
+        if not first:
+            w("")
+        first = False
+        extra = "Code %d, UberMundoEventCode.%s." % (s.code, s.name) if s.is_message else None
+        out.extend(cs_doc(s.doc, "    ", extra))
+        w("    public struct %s" % s.name)
+        w("    {")
+        if s.is_message:
+            w("        public const UberMundoEventCode Code = UberMundoEventCode.%s;" % s.name)
+            w("")
+        for f in s.fields:
+            out.extend(cs_doc(f.doc, "        ", field_note(f)))
+            w("        public %s %s;" % (cs_type(f, known), f.name))
+        if s.fields:
+            w("")
+        w("        public void Write(ref WireWriter w)")
+        w("        {")
+        for f in s.fields:
+            for l in cs_write(f):
+                w("            " + l)
+        w("        }")
+        w("")
+        w("        public static bool Read(ref WireReader r, out %s m)" % s.name)
+        w("        {")
+        w("            m = default;")
+        for f in s.fields:
+            for l in cs_read(f, known):
+                w("            " + l)
+        w("            return true;")
+        w("        }")
+        if s.is_message:
+            w("")
+            w("        /// <summary>")
+            w("        /// Bytes Encode needs, the code included.")
+            w("        /// </summary>")
+            w("        public int Size")
+            w("        {")
+            w("            get")
+            w("            {")
+            w("                var w = WireWriter.Counting();")
+            w("                w.Write((byte)Code);")
+            w("                Write(ref w);")
+            w("                return w.Length;")
+            w("            }")
+            w("        }")
+            w("")
+            w("        /// <summary>")
+            w("        /// Writes the code and the fields into dst. Returns the bytes written, 0 if they did not fit.")
+            w("        /// </summary>")
+            w("        public int Encode(Span<byte> dst)")
+            w("        {")
+            w("            var w = new WireWriter(dst);")
+            w("            w.Write((byte)Code);")
+            w("            Write(ref w);")
+            w("            return w.Ok ? w.Length : 0;")
+            w("        }")
+            w("")
+            w("        public byte[] ToArray()")
+            w("        {")
+            w("            byte[] a = new byte[Size];")
+            w("            return Encode(a) == a.Length ? a : null;")
+            w("        }")
+            w("")
+            w("        /// <summary>")
+            w("        /// False if src is not a %s or is cut short." % s.name)
+            w("        /// </summary>")
+            w("        public static bool TryDecode(ReadOnlySpan<byte> src, out %s m)" % s.name)
+            w("        {")
+            w("            var r = new WireReader(src);")
+            w("            if (!r.Read(out byte code) || code != (byte)Code)")
+            w("            {")
+            w("                m = default;")
+            w("                return false;")
+            w("            }")
+            w("            return Read(ref r, out m);")
+            w("        }")
+        w("    }")
+    w("}")
+    return out
+
+
+# ---------------------------------------------------------------------------------------- main
+
+def render(lines, crlf):
+    text = "\n".join(lines) + "\n"
+    return text.replace("\n", "\r\n") if crlf else text
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate the Ubermundo packet codecs from the message schema.")
+    parser.add_argument("--schema", default=SCHEMA)
+    parser.add_argument("--check", action="store_true", help="write nothing, exit 1 if a generated file is out of date")
+    args = parser.parse_args()
+
+    try:
+        structs = parse_schema(args.schema)
+        known = check_schema(structs)
+        check_codes(structs, CODES_HEADER, SERVER_CODES)
+    except SchemaError as e:
+        print("%s: %s" % (args.schema, e), file=sys.stderr)
+        return 1
+
+    outputs = [
+        (OUT_H, render(gen_header(structs, known), True)),
+        (OUT_CPP, render(gen_cpp(structs, known), True)),
+        (OUT_CS, render(gen_cs(structs, known), True)),
+    ]
+    stale = 0
+    for path, text in outputs:
+        try:
+            with open(path, encoding="utf-8", newline="") as f:
+                same = f.read() == text
+        except OSError:
+            same = False
+        if same:
+            continue
+        stale += 1
+        if args.check:
+            print("%s is out of date" % os.path.relpath(path, ROOT))
+        else:
+            with open(path, "w", encoding="utf-8", newline="") as f:
+                f.write(text)
+            print("wrote %s" % os.path.relpath(path, ROOT))
+    return 1 if args.check and stale else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())